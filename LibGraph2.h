@@ -547,6 +547,7 @@
 #include <codecvt>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <locale>
 #include <string>
@@ -735,6 +736,154 @@ enum font_styles {
   FontStyleBoldItalic = 3
 };
 
+/*!
+ * \brief
+ * Format de la sortie vidéo.
+ * \see
+ * Membre : ILibGraph2_Exp::startVideoOutput()
+ * \ingroup WndManagement
+ */
+enum class video_format {
+  //!\brief YUV4MPEG2 en 4:2:0, lu directement par ffmpeg, x264 ou mpv
+  Y4M,
+  //!\brief Pixels RGBA bruts, sans en-tête
+  RawRGBA
+};
+
+/*!
+ * \brief
+ * Fonction recevant le résultat d'une lecture asynchrone de l'image.
+ *
+ * \c pPixels désigne \c nWidth x \c nHeight pixels ARGB, ligne par ligne de
+ * haut en bas, valables uniquement pendant l'appel. Il vaut \c NULL si la
+ * lecture n'a pas pu avoir lieu (fenêtre fermée entre-temps).
+ * \see
+ * Membre : ILibGraph2_Exp::requestReadback()
+ * \ingroup DrawingBitmap
+ */
+typedef std::function<void(const ARGB *pPixels, unsigned nWidth,
+                           unsigned nHeight)>
+    readback_callback;
+
+/*!
+ * \brief
+ * Coût de la dernière image affichée.
+ *
+ * Une image s'étend d'un appel à endPaint() au suivant : les affichages
+ * provoqués par un dessin hors de beginPaint() / endPaint() sont comptés
+ * dans l'image en cours.
+ * \see
+ * Membre : ILibGraph2_Exp::getFrameStats()
+ * \ingroup WndManagement
+ */
+struct SFrameStats {
+  //!\brief Appels de dessin soumis au processeur graphique (primitives
+  //! rastérisées pour le moteur logiciel)
+  unsigned long nDrawCalls;
+  //!\brief Sommets générés par ces appels
+  unsigned long nVertices;
+  //!\brief Affichages de l'image (un par endPaint(), plus un par dessin
+  //! hors de beginPaint() / endPaint())
+  unsigned long nDisplays;
+  //!\brief Envois de pixels vers des textures (images et glyphes)
+  unsigned long nTextureUploads;
+  //!\brief Images trouvées dans le cache
+  unsigned long nTextureCacheHits;
+  //!\brief Images absentes du cache, chargées depuis le disque
+  unsigned long nTextureCacheMisses;
+  //!\brief Polices chargées depuis le disque
+  unsigned long nFontLoads;
+  //!\brief Primitives ignorées car hors de l'image ou transparentes
+  unsigned long nCulled;
+  /*!\brief Mémoire occupée par les images chargées (textures, ou images
+   * décodées pour le moteur logiciel), en octets, à la fin de l'image
+   */
+  unsigned long long nTextureBytes;
+  /*!\brief Allocations sur le tas faites par la bibliothèque pendant
+   * l'image, pour tout le processus. Toujours nul si la bibliothèque n'est
+   * pas compilée avec l'option \c LIBGRAPH2_COUNT_ALLOCS
+   * \see ILibGraph2_Exp::getFrameAllocations()
+   */
+  unsigned long nAllocations;
+  //!\brief Octets demandés par ces allocations
+  unsigned long long nAllocatedBytes;
+  //!\brief Temps passé dans les fonctions de dessin, en millisecondes
+  double dDrawMs;
+  //!\brief Temps passé à afficher l'image (endPaint()), en millisecondes
+  double dDisplayMs;
+  /*!\brief Temps d'exécution par le processeur graphique, en
+   * millisecondes, mesuré par des requêtes de minutage OpenGL. Toujours nul
+   * si la mesure n'est pas activée ou pas disponible
+   * \see ILibGraph2_Exp::enableGpuTimer()
+   */
+  double dGpuMs;
+};
+
+/*!
+ * \brief
+ * Répartition des latences des entrées, de la réception d'un événement
+ * souris ou clavier à l'affichage de l'image qui suit son traitement.
+ * \see
+ * Membre : ILibGraph2_Exp::getInputLatency()
+ * \ingroup WndManagement
+ */
+struct SInputLatency {
+  //!\brief Nombre d'événements mesurés
+  unsigned long nEvents;
+  //!\brief Nombre d'événements dont la latence dépasse le budget
+  unsigned long nOverBudget;
+  //!\brief Médiane, en millisecondes
+  double dP50Ms;
+  //!\brief 90e centile, en millisecondes
+  double dP90Ms;
+  //!\brief 99e centile, en millisecondes
+  double dP99Ms;
+  //!\brief Latence maximale, en millisecondes
+  double dMaxMs;
+};
+
+/*!
+ * \brief
+ * Allocations sur le tas d'une fonction de la bibliothèque pendant une image.
+ * \see
+ * Membre : ILibGraph2_Exp::getFrameAllocations()
+ * \ingroup WndManagement
+ */
+struct SAllocationStats {
+  //!\brief Fonction appelée par le programme (chaîne statique). Les
+  //! allocations des fonctions qu'elle appelle lui sont attribuées
+  const char *pszFunction;
+  //!\brief Nombre d'allocations
+  unsigned long nAllocations;
+  //!\brief Octets demandés
+  unsigned long long nBytes;
+};
+
+/*!
+ * \brief
+ * Répartition des durées d'image.
+ *
+ * Les centiles sont calculés sur un histogramme à précision relative
+ * constante (1,6 %), de la microseconde à plus d'une heure.
+ * \see
+ * Membre : ILibGraph2_Exp::getFrameTimes()
+ * \ingroup WndManagement
+ */
+struct SFrameTimes {
+  //!\brief Nombre d'images mesurées
+  unsigned long nFrames;
+  //!\brief Nombre d'images dépassant le budget
+  unsigned long nOverBudget;
+  //!\brief Médiane, en millisecondes
+  double dP50Ms;
+  //!\brief 90e centile, en millisecondes
+  double dP90Ms;
+  //!\brief 99e centile, en millisecondes
+  double dP99Ms;
+  //!\brief Durée maximale, en millisecondes
+  double dMaxMs;
+};
+
 #if LIBGRAPH2_LEVEL >= 0 || defined(LIBGRAPH2_EXPORTS)
 /*!
  * \brief
@@ -864,6 +1013,19 @@ struct evt {
    * valeurs : http://msdn.microsoft.com/en-us/library/dd375731.aspx
    */
   unsigned int vkKeyCode;
+  /*!\brief Instant de réception de l'événement par la bibliothèque, en
+   * microsecondes sur une horloge monotone (\c std::chrono::steady_clock).
+   *
+   * Une entrée souris ou clavier est datée à sa lecture dans la file
+   * d'événements du système (ou à sa réception d'un client du serveur
+   * d'images), et non quand waitForEvent() la rend au programme : le temps
+   * passé dans la file de la bibliothèque compte dans sa latence.
+   *
+   * Seules les différences entre deux instants ont un sens, par exemple avec
+   * \c std::chrono::steady_clock::now() pour mesurer un temps de traitement.
+   * \see ILibGraph2_Exp::getInputLatency()
+   */
+  unsigned long long nTimestampUs;
 };
 
 /*!
@@ -1965,6 +2127,83 @@ public:
 };
 #endif
 #if LIBGRAPH2_LEVEL > 3 || defined(LIBGRAPH2_EXPORTS)
+/*!
+ * \brief
+ * Enregistreur de commandes de dessin, utilisable depuis un thread de travail.
+ *
+ * Un enregistreur possède son propre crayon et son propre pinceau. Ses
+ * fonctions de dessin ne dessinent rien immédiatement : elles enregistrent des
+ * commandes dans une mémoire propre à l'enregistreur, sans aucun verrou. Lors
+ * de l'appel à ILibGraph2_Exp::endPaint(), les commandes de tous les
+ * enregistreurs sont rejouées dans l'ordre de création des enregistreurs
+ * (ordre de soumission), puis effacées. Le résultat est donc identique d'une
+ * exécution à l'autre, quel que soit l'ordonnancement des threads.
+ *
+ * Plusieurs threads peuvent dessiner en parallèle, à condition que chacun
+ * utilise son propre enregistreur. Le texte est affiché avec la police
+ * courante de la fenêtre.
+ *
+ * \code
+ *   //Avant la boucle d'événements
+ *   std::vector<ILibGraph2Recorder*> vRec;
+ *   for(int i = 0; i < 8; i++)
+ *     vRec.push_back(libgraph->createRecorder());
+ *
+ *   //Dans le traitement de evt_type::evtRefresh
+ *   libgraph->beginPaint();
+ *   std::vector<std::thread> vThreads;
+ *   for(int i = 0; i < 8; i++)
+ *     vThreads.emplace_back([&, i]{ drawRegion(vRec[i], i); });
+ *   for(auto &t : vThreads)
+ *     t.join();
+ *   libgraph->endPaint(); //Rejoue vRec[0], vRec[1], ..., vRec[7]
+ * \endcode
+ *
+ * \see
+ * Classe : ILibGraph2_Exp \n
+ * Membres : ILibGraph2_Exp::createRecorder(), ILibGraph2_Exp::releaseRecorder()
+ * \ingroup DrawingManagement
+ */
+class LIBGRAPH2_API ILibGraph2Recorder {
+public:
+  //!\brief Définit le crayon de l'enregistreur (voir ILibGraph2_Com::setPen())
+  virtual void setPen(ARGB color, float fWidth,
+                      pen_DashStyles style = pen_DashStyles::Solid) = 0;
+  //!\brief Définit le pinceau de l'enregistreur (voir
+  //! ILibGraph2_Com::setSolidBrush())
+  virtual void setSolidBrush(ARGB color) = 0;
+  //!\brief Enregistre une ellipse (voir ILibGraph2_Com::drawEllipse())
+  virtual void drawEllipse(const CRectangle &rectBounds) = 0;
+  //!\brief Enregistre un camembert (voir ILibGraph2_Com::drawPie())
+  virtual void drawPie(const CRectangle &rectBounds, float startAngle,
+                       float sweepAngle) = 0;
+  //!\brief Enregistre une ligne (voir ILibGraph2_Com::drawLine())
+  virtual void drawLine(const CPoint &ptP1, const CPoint &ptP2) = 0;
+  //!\brief Enregistre un rectangle (voir ILibGraph2_Com::drawRectangle())
+  virtual void drawRectangle(const CRectangle &rectBounds) = 0;
+  //!\brief Enregistre un pixel (voir ILibGraph2_Com::setPixel())
+  virtual void setPixel(const CPoint &ptPos, ARGB color) = 0;
+  //!\brief Enregistre une ligne brisée ou un polygone (voir
+  //! ILibGraph2_Exp::drawPolylines())
+  virtual void drawPolylines(const std::vector<CPoint> &vPoints,
+                             bool bAutoClose = false) = 0;
+  //!\brief Enregistre un texte (voir ILibGraph2_Com::drawString())
+  virtual void drawString(const CString &text, const CPoint &ptPos) = 0;
+  //!\brief Enregistre une image (voir ILibGraph2_Com::drawBitmap())
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          double dScaleFactor = 1.0, double dAngleDeg = 0,
+                          bool bXYIsCenter = false) = 0;
+  //!\brief Enregistre une image (voir ILibGraph2_Com::drawBitmap())
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          const CPoint &ptPosPivot, double dScaleFactor,
+                          double dAngleDeg) = 0;
+  //!\brief Abandonne les commandes enregistrées depuis le dernier endPaint()
+  virtual void discard() = 0;
+
+protected:
+  virtual ~ILibGraph2Recorder() {}
+};
+
 // Cette classe est exportée de LibGraph2.dll
 /*!
  * \brief
@@ -2030,6 +2269,522 @@ public:
   virtual bool guiGetFileName(
       CString &sFileName, bool bOpen = true,
       const std::vector<CString> &vstrFileTypes = std::vector<CString>()) = 0;
+
+  /*!
+   * \brief Active ou désactive le thread de rendu dédié.
+   *
+   * En mode threadé, les fonctions de dessin ne dessinent plus directement :
+   * elles encodent des commandes compactes dans une file sans verrou, qu'un
+   * thread de rendu dédié, propriétaire de la fenêtre, rejoue ensuite. La
+   * logique de l'application et l'envoi au GPU se recouvrent alors, et
+   * endPaint() ne bloque que si plus de deux images sont en attente
+   * d'affichage.
+   *
+   * \param [in] bEnable \c true pour activer le thread de rendu, \c false pour
+   * revenir au rendu synchrone (mode par défaut).
+   *
+   * \remarks Les fonctions de dessin doivent toujours être appelées depuis un
+   * seul et même thread. La fonction getStringDimension() attend que les
+   * commandes en attente aient été exécutées.
+   *
+   * \see
+   * Membres : beginPaint(), endPaint()
+   * \ingroup DrawingManagement
+   */
+  virtual void enableRenderThread(bool bEnable) = 0;
+
+  /*!
+   * \brief Enregistre les événements reçus dans un fichier.
+   *
+   * Chaque événement renvoyé par waitForEvent() est ajouté, avec l'instant
+   * de sa réception mesuré sur une horloge monotone, à un fichier binaire
+   * compact. Ce fichier peut ensuite être rejoué par startEventReplay() afin
+   * de reproduire une session interactive (glissers de souris, rafales de
+   * touches, redimensionnements) à l'identique, par exemple pour mesurer les
+   * performances d'une application.
+   *
+   * L'enregistrement peut aussi être activé sans modifier le programme, en
+   * définissant la variable d'environnement \c LIBGRAPH2_RECORD_EVENTS avec le
+   * nom du fichier.
+   *
+   * \param [in] sFileName Nom du fichier à créer
+   *
+   * \return \c true si le fichier a pu être créé.
+   *
+   * \see
+   * Membres : stopEventRecording(), startEventReplay(), waitForEvent()
+   * \ingroup EventManagement
+   */
+  virtual bool startEventRecording(const CString &sFileName) = 0;
+  /*!
+   * \brief Termine l'enregistrement des événements.
+   *
+   * \see
+   * Membres : startEventRecording()
+   * \ingroup EventManagement
+   */
+  virtual void stopEventRecording() = 0;
+  /*!
+   * \brief Rejoue des événements enregistrés.
+   *
+   * A partir de cet appel, waitForEvent() ne renvoie plus les événements de
+   * l'utilisateur mais ceux du fichier, enregistré par startEventRecording().
+   * A la fin du fichier, waitForEvent() renvoie un événement de fermeture et
+   * la valeur \c false. Le rejeu ne nécessite pas que la fenêtre soit
+   * affichée.
+   *
+   * Le rejeu peut aussi être activé sans modifier le programme, en définissant
+   * la variable d'environnement \c LIBGRAPH2_REPLAY_EVENTS avec le nom du
+   * fichier, et \c LIBGRAPH2_REPLAY_SPEED=max pour rejouer à vitesse maximale.
+   *
+   * \param [in] sFileName Nom du fichier à rejouer
+   * \param [in] bMaxSpeed (optionnel) \c false (par défaut) pour respecter les
+   * délais d'origine entre les événements, \c true pour rejouer aussi vite que
+   * possible.
+   *
+   * \return \c true si le fichier a pu être ouvert.
+   *
+   * \remarks waitForAnyEvent() rejoue de même le journal de chaque fenêtre,
+   * à la place de ses événements réels.
+   *
+   * \see
+   * Membres : startEventRecording(), waitForEvent()
+   * \ingroup EventManagement
+   */
+  virtual bool startEventReplay(const CString &sFileName,
+                                bool bMaxSpeed = false) = 0;
+
+  /*!
+   * \brief Crée un enregistreur de commandes de dessin.
+   *
+   * Crée un enregistreur permettant de préparer des commandes de dessin depuis
+   * un thread de travail. Les enregistreurs sont rejoués par endPaint() dans
+   * leur ordre de création.
+   *
+   * \return Un pointeur vers le nouvel enregistreur, à libérer avec
+   * releaseRecorder().
+   *
+   * \remarks Les fonctions createRecorder() et releaseRecorder() doivent être
+   * appelées depuis le thread qui dessine dans la fenêtre, en dehors d'une
+   * séquence beginPaint() / endPaint().
+   *
+   * \see
+   * Classe : ILibGraph2Recorder \n
+   * Membres : releaseRecorder(), endPaint()
+   * \ingroup DrawingManagement
+   */
+  virtual ILibGraph2Recorder *createRecorder() = 0;
+  /*!
+   * \brief Libère un enregistreur de commandes de dessin.
+   *
+   * Les commandes qu'il contenait et qui n'ont pas encore été rejouées sont
+   * perdues.
+   *
+   * \param [in] pRecorder Enregistreur créé par createRecorder()
+   *
+   * \see
+   * Classe : ILibGraph2Recorder \n
+   * Membres : createRecorder()
+   * \ingroup DrawingManagement
+   */
+  virtual void releaseRecorder(ILibGraph2Recorder *pRecorder) = 0;
+
+  /*!
+   * \brief Dessine hors écran, sans fenêtre.
+   *
+   * Remplace show() pour produire des images sans les afficher : le dessin est
+   * réalisé dans une image en mémoire (texture de rendu) de la taille
+   * demandée, sans attente de la synchronisation verticale. waitForEvent()
+   * renvoie alors un événement de rafraîchissement par image, aussi vite que
+   * le programme les traite, puis un événement de fermeture après \c nFrames
+   * images. Chaque image peut être enregistrée par saveFrame() ou récupérée
+   * par getFramePixels().
+   * \code
+   * libgraph->showOffscreen(CSize(800, 600), 1000);
+   * for (int i = 0; libgraph->waitForEvent(e); i++) {
+   *   libgraph->beginPaint();
+   *   // ... dessin de l'image i
+   *   libgraph->endPaint();
+   *   libgraph->saveFrame(("image" + std::to_string(i) + ".png").c_str());
+   * }
+   * \endcode
+   *
+   * \param [in] szSize  Taille des images, en pixels. Comme pour show(), elle
+   * définit aussi le système de coordonnées.
+   * \param [in] nFrames (optionnel) Nombre d'images à produire avant
+   * l'événement de fermeture. 0 (par défaut) conserve la limite de la
+   * variable d'environnement LIBGRAPH2_FRAMES, ou n'en impose aucune.
+   *
+   * \see
+   * Membres : show(), saveFrame(), getFramePixels(), waitForEvent()
+   * \ingroup WndManagement
+   */
+  virtual void showOffscreen(const CSize &szSize = CSize(),
+                             unsigned long nFrames = 0) = 0;
+  /*!
+   * \brief Enregistre l'image courante dans un fichier.
+   *
+   * Le format est choisi d'après l'extension du fichier : PNG (\c .png), PPM
+   * binaire (\c .ppm) ou QOI (\c .qoi). Les formats PPM et QOI sont les plus
+   * rapides à produire.
+   *
+   * \param [in] sFileName Nom du fichier à créer
+   *
+   * \return \c true si l'image a été enregistrée.
+   *
+   * \remarks A appeler après endPaint(). En mode hors écran, l'image
+   * enregistrée est exactement celle dessinée ; dans une fenêtre, c'est le
+   * contenu affiché, ce qui dépend du pilote graphique.
+   *
+   * \see
+   * Membres : showOffscreen(), getFramePixels()
+   * \ingroup DrawingBitmap
+   */
+  virtual bool saveFrame(const CString &sFileName) = 0;
+  /*!
+   * \brief Récupère les pixels de l'image courante.
+   *
+   * \param [out] vPixels Pixels de l'image au format ARGB, ligne par ligne de
+   * haut en bas
+   * \param [out] nWidth  Largeur de l'image, en pixels
+   * \param [out] nHeight Hauteur de l'image, en pixels
+   *
+   * \return \c true si l'image a pu être lue.
+   *
+   * \see
+   * Membres : showOffscreen(), saveFrame()
+   * \ingroup DrawingBitmap
+   */
+  virtual bool getFramePixels(std::vector<ARGB> &vPixels, unsigned &nWidth,
+                              unsigned &nHeight) = 0;
+  /*!
+   * \brief Écrit chaque image affichée dans un flux vidéo brut.
+   *
+   * Chaque image affichée, en général à chaque appel à endPaint(), est ajoutée
+   * au flux. La lecture des pixels est asynchrone et l'écriture a lieu
+   * dans un thread dédié : le coût pour la boucle de dessin est faible, mais
+   * si le lecteur du flux (un encodeur par exemple) prend du retard, la
+   * boucle de dessin l'attend plutôt que de perdre des images.
+   * \code
+   * // ./programme | ffmpeg -i - -c:v libx264 sortie.mp4
+   * libgraph->showOffscreen(CSize(1280, 720), 600);
+   * libgraph->startVideoOutput("-");
+   * \endcode
+   *
+   * \param [in] sFileName  Nom du fichier à créer, \c "-" pour la sortie
+   * standard. Un tube nommé ou \c /dev/fd/N conviennent aussi.
+   * \param [in] format     (optionnel) Format du flux : Y4M (par défaut),
+   * lisible directement par ffmpeg, ou pixels RGBA bruts.
+   * \param [in] nFrameRate (optionnel) Nombre d'images par seconde indiqué
+   * dans l'en-tête Y4M.
+   *
+   * \return \c true si le flux a été ouvert.
+   *
+   * \remarks La taille du flux est celle de la première image : les images
+   * suivantes sont rognées ou complétées en noir si la fenêtre change de
+   * taille.
+   *
+   * \see
+   * Membres : stopVideoOutput(), showOffscreen(), saveFrame()
+   * \ingroup WndManagement
+   */
+  virtual bool startVideoOutput(const CString &sFileName,
+                                video_format format = video_format::Y4M,
+                                unsigned nFrameRate = 60) = 0;
+  /*!
+   * \brief Termine le flux vidéo ouvert par startVideoOutput().
+   *
+   * Les images en attente sont écrites avant la fermeture. Appelée
+   * automatiquement à la fermeture de la fenêtre.
+   *
+   * \see
+   * Membre : startVideoOutput()
+   * \ingroup WndManagement
+   */
+  virtual void stopVideoOutput() = 0;
+  /*!
+   * \brief Lit une zone de l'image sans bloquer le rendu.
+   *
+   * Contrairement à getFramePixels(), qui attend que le processeur graphique
+   * ait fini de dessiner, la lecture est lancée à l'affichage de l'image
+   * courante et \c callback est appelée une ou deux images plus tard, dès
+   * que la copie est terminée. Convient aux captures d'écran, vignettes ou
+   * comparaisons de pixels pendant que l'application tourne.
+   * \code
+   * libgraph->requestReadback(
+   *     CRectangle(CPoint(0, 0), CSize(64, 64)),
+   *     [](const ARGB *pPixels, unsigned nWidth, unsigned nHeight) {
+   *       if (pPixels)
+   *         // ... pPixels[y * nWidth + x]
+   *     });
+   * \endcode
+   *
+   * \param [in] rect     Zone à lire, dans le système de coordonnées de la
+   * fenêtre. Elle est limitée à l'image.
+   * \param [in] callback Fonction appelée avec le résultat.
+   *
+   * \remarks \c callback est appelée par le thread qui affiche les images :
+   * le thread de rendu s'il est activé (voir enableRenderThread()), sinon
+   * pendant endPaint(). Elle doit être brève et ne pas appeler LibGraph2.
+   * Les lectures encore en attente à la fermeture de la fenêtre sont
+   * terminées avant celle-ci.
+   *
+   * \see
+   * Membres : getFramePixels(), saveFrame()
+   * \ingroup DrawingBitmap
+   */
+  virtual void requestReadback(const CRectangle &rect,
+                               const readback_callback &callback) = 0;
+  /*!
+   * \brief Diffuse les images affichées vers des clients distants.
+   *
+   * Ouvre un serveur sur un socket Unix ou TCP. Chaque image affichée est
+   * comparée à la précédente par tuiles de 64x64 pixels, et seules les
+   * tuiles modifiées sont compressées et envoyées aux clients connectés :
+   * le coût dépend de ce qui change à l'écran, pas de la taille de la
+   * fenêtre. Les entrées souris et clavier des clients sont renvoyées par
+   * waitForEvent(), comme celles de la fenêtre. Le protocole est décrit dans
+   * LibGraph2Stream.h.
+   * \code
+   * libgraph->startFrameServer("unix:/tmp/tableau.sock");
+   * libgraph->startFrameServer("tcp:0.0.0.0:5900"); // Tout le réseau local
+   * \endcode
+   *
+   * La variable d'environnement \c LIBGRAPH2_STREAM ouvre le serveur de la
+   * fenêtre par défaut sans modifier le programme.
+   *
+   * \param [in] sAddress \c "unix:chemin", \c "tcp:port" (boucle locale
+   * uniquement) ou \c "tcp:adresse:port".
+   *
+   * \return \c true si le serveur a été ouvert.
+   *
+   * \remarks Les clients ne sont pas authentifiés et peuvent envoyer des
+   * entrées : n'écoutez sur le réseau que s'il est de confiance. Sans client
+   * connecté, le coût par image est négligeable.
+   *
+   * \see
+   * Membres : stopFrameServer(), startVideoOutput()
+   * \ingroup WndManagement
+   */
+  virtual bool startFrameServer(const CString &sAddress) = 0;
+  /*!
+   * \brief Ferme le serveur ouvert par startFrameServer().
+   *
+   * Les clients sont déconnectés. Appelée automatiquement à la fermeture de
+   * la fenêtre.
+   *
+   * \see
+   * Membre : startFrameServer()
+   * \ingroup WndManagement
+   */
+  virtual void stopFrameServer() = 0;
+  /*!
+   * \brief Renvoie le coût de la dernière image affichée.
+   *
+   * Les compteurs sont tenus en permanence, pour un coût négligeable devant
+   * celui du dessin : ils peuvent rester actifs en production, par exemple
+   * pour signaler une vue dont le nombre d'appels de dessin ou le temps
+   * d'affichage augmente.
+   * \code
+   * SFrameStats stats = libgraph->getFrameStats();
+   * if (stats.nDrawCalls > 500 || stats.dDrawMs + stats.dDisplayMs > 16)
+   *   std::cerr << "Image coûteuse" << std::endl;
+   * \endcode
+   *
+   * \return Les compteurs de l'image terminée par le dernier endPaint(), à
+   * zéro avant le premier.
+   *
+   * \remarks Avec le thread de rendu (voir enableRenderThread()), les
+   * compteurs du processeur graphique décrivent la dernière image exécutée
+   * par ce thread, qui peut avoir une ou deux images de retard sur
+   * l'application. dDrawMs ne compte alors que le temps de soumission des
+   * commandes.
+   *
+   * \see
+   * Membres : endPaint(), enableRenderThread()
+   * \ingroup WndManagement
+   */
+  virtual SFrameStats getFrameStats() = 0;
+  /*!
+   * \brief Active la mesure du temps d'exécution des images par le
+   * processeur graphique.
+   *
+   * Comparé à SFrameStats::dDrawMs, SFrameStats::dGpuMs indique qui limite
+   * une image lente : un temps GPU proche de l'intervalle entre deux images
+   * désigne le remplissage (surface dessinée, mélanges), un temps GPU
+   * faible devant le temps de dessin désigne la génération des sommets par
+   * le processeur.
+   * \code
+   * libgraph->enableGpuTimer(true);
+   * // ...
+   * SFrameStats stats = libgraph->getFrameStats();
+   * std::cerr << "CPU " << stats.dDrawMs << " ms, GPU " << stats.dGpuMs
+   *           << " ms" << std::endl;
+   * \endcode
+   *
+   * \param [in] bEnable \c true pour mesurer, \c false pour arrêter (mode
+   * par défaut).
+   *
+   * \remarks Les résultats des requêtes ne sont lus que deux images plus
+   * tard, lorsqu'ils sont disponibles, pour ne jamais attendre le
+   * processeur graphique : SFrameStats::dGpuMs décrit l'avant-dernière
+   * image exécutée, et reste nul pendant les premières images. Le moteur
+   * OpenGL natif mesure chaque lot de dessin envoyé au processeur
+   * graphique, dont il fait la somme. Le moteur SFML, qui n'envoie pas ses
+   * dessins par lots, mesure l'image de sa première commande de dessin à
+   * son affichage : l'attente entre deux images est exclue, mais pas celle
+   * des commandes suivantes du processeur, et c'est alors un majorant. La
+   * mesure demande OpenGL 3.3 ou l'extension \c GL_ARB_timer_query ; le
+   * moteur logiciel n'a rien à mesurer.
+   *
+   * \see
+   * Membre : getFrameStats()
+   * \ingroup WndManagement
+   */
+  virtual void enableGpuTimer(bool bEnable) = 0;
+  /*!
+   * \brief Renvoie les allocations sur le tas de la dernière image, par
+   * fonction de la bibliothèque.
+   *
+   * Une image dessinée en régime permanent devrait ne rien allouer : cette
+   * répartition désigne les fonctions à corriger, et permet de vérifier
+   * qu'une image n'alloue plus rien.
+   * \code
+   * std::vector<SAllocationStats> vAllocations;
+   * libgraph->getFrameAllocations(vAllocations);
+   * for (const SAllocationStats &a : vAllocations)
+   *   std::cerr << a.pszFunction << " : " << a.nAllocations << " allocations, "
+   *             << a.nBytes << " octets" << std::endl;
+   * \endcode
+   *
+   * \param [out] vAllocations Une entrée par fonction ayant alloué pendant
+   * l'image terminée par le dernier endPaint(), par nombre d'octets
+   * décroissant.
+   *
+   * \remarks Le comptage remplace l'opérateur \c new de tout le processus
+   * et n'est compilé qu'avec l'option CMake \c LIBGRAPH2_COUNT_ALLOCS ;
+   * sinon \c vAllocations est toujours vide. Seules les allocations faites
+   * pendant un appel à la bibliothèque sont comptées, y compris celles de
+   * SFML et de la bibliothèque standard, pour tout le processus. Avec le
+   * thread de rendu, les allocations de l'exécution des commandes sont
+   * attribuées à \c ExecuteCommands.
+   *
+   * \see
+   * Membres : getFrameStats(), endPaint()
+   * \ingroup WndManagement
+   */
+  virtual void
+  getFrameAllocations(std::vector<SAllocationStats> &vAllocations) = 0;
+  /*!
+   * \brief Renvoie la répartition des durées d'image depuis l'ouverture de
+   * la fenêtre.
+   *
+   * Deux durées sont mesurées pour chaque image : l'intervalle entre deux
+   * endPaint() successifs, qui révèle les saccades d'une animation, et le
+   * temps de réponse, du retour de waitForEvent() à la fin de endPaint(),
+   * qui mesure le coût du dessin d'une image. Contrairement à une moyenne
+   * d'images par seconde, les centiles et le maximum montrent les images
+   * lentes isolées.
+   * \code
+   * SFrameTimes interval, response;
+   * libgraph->getFrameTimes(interval, response);
+   * printf("p99 %.1f ms, %lu images lentes\n", interval.dP99Ms,
+   *        interval.nOverBudget);
+   * \endcode
+   *
+   * Les variables d'environnement suivantes écrivent en plus un bilan
+   * périodique, sans modifier le programme :
+   * - \c LIBGRAPH2_FRAMETIMES : \c "-" pour la sortie d'erreur, ou nom du
+   *   fichier auquel ajouter les bilans ;
+   * - \c LIBGRAPH2_FRAMETIMES_PERIOD : période en secondes (10 par défaut),
+   *   chaque bilan ne portant que sur sa période ;
+   * - \c LIBGRAPH2_FRAME_BUDGET : budget en millisecondes (16,7 par défaut).
+   *
+   * \param [out] interval  Intervalles entre deux endPaint().
+   * \param [out] response  Temps entre le retour de waitForEvent() et la fin
+   * de endPaint().
+   * \param [in]  dBudgetMs (optionnel) Durée au-delà de laquelle une image
+   * est comptée dans \c nOverBudget. Par défaut, une image à 60 Hz.
+   *
+   * \remarks Une application qui ne redessine que sur événement a des
+   * intervalles longs quand rien ne se passe : seul le temps de réponse est
+   * alors significatif.
+   *
+   * \see
+   * Membres : resetFrameTimes(), getFrameStats()
+   * \ingroup WndManagement
+   */
+  virtual void getFrameTimes(SFrameTimes &interval, SFrameTimes &response,
+                             double dBudgetMs = 1000.0 / 60) = 0;
+  /*!
+   * \brief Renvoie la répartition des latences des entrées depuis
+   * l'ouverture de la fenêtre.
+   *
+   * La latence d'un événement souris ou clavier va de sa lecture dans la
+   * file du système (evt::nTimestampUs) à la fin de l'affichage de la première
+   * image présentée après que waitForEvent() l'a rendu au programme :
+   * c'est le délai entre le geste de l'utilisateur et son effet à l'écran.
+   * Plusieurs événements traités avant un même affichage ont chacun leur
+   * latence.
+   * \code
+   * SInputLatency latency;
+   * libgraph->getInputLatency(latency);
+   * std::cerr << "latence p99 " << latency.dP99Ms << " ms" << std::endl;
+   * \endcode
+   *
+   * \param [out] latency   Latences mesurées
+   * \param [in]  dBudgetMs (optionnel) Latence au-delà de laquelle un
+   * événement est compté dans \c nOverBudget. 50 ms par défaut.
+   *
+   * \remarks La réception est l'instant où la bibliothèque lit l'événement
+   * dans la file du système de fenêtres : le temps passé dans cette file
+   * pendant le dessin de l'image précédente n'est pas compté. Avec le thread
+   * de rendu, la fin de l'affichage est mesurée par ce thread. L'affichage
+   * inclut l'attente de la synchronisation verticale, mais pas le délai
+   * propre à l'écran.
+   *
+   * \see
+   * Membres : getFrameTimes(), resetFrameTimes(), waitForEvent()
+   * \ingroup WndManagement
+   */
+  virtual void getInputLatency(SInputLatency &latency,
+                               double dBudgetMs = 50) = 0;
+  /*!
+   * \brief Remet à zéro les durées renvoyées par getFrameTimes() et les
+   * latences renvoyées par getInputLatency().
+   *
+   * Permet de mesurer une phase précise du programme, par exemple après le
+   * chargement initial.
+   *
+   * \see
+   * Membres : getFrameTimes(), getInputLatency()
+   * \ingroup WndManagement
+   */
+  virtual void resetFrameTimes() = 0;
+  /*!
+   * \brief Affiche ou masque la surimpression des performances.
+   *
+   * Un panneau en haut à gauche de la fenêtre affiche la durée moyenne et
+   * maximale des images, l'historique des 120 dernières (en rouge au-delà
+   * de 16,7 ms, ou de \c LIBGRAPH2_FRAME_BUDGET), les appels de dessin et
+   * sommets par image, la mémoire des textures et le taux de succès du
+   * cache d'images. Il est dessiné en un seul appel après l'image, avec une
+   * police intégrée, et n'entre pas dans les compteurs qu'il affiche.
+   *
+   * La touche F12 bascule aussi l'affichage (l'événement est tout de même
+   * transmis au programme), et \c LIBGRAPH2_OVERLAY=1 l'active dès
+   * l'ouverture de la fenêtre.
+   *
+   * \param [in] bShow \c true pour afficher la surimpression.
+   *
+   * \remarks La surimpression n'apparaît qu'à l'écran : ni saveFrame(), ni
+   * la sortie vidéo, ni le serveur de diffusion ne la contiennent.
+   *
+   * \see
+   * Membres : getFrameStats(), getFrameTimes()
+   * \ingroup WndManagement
+   */
+  virtual void showPerformanceOverlay(bool bShow) = 0;
 };
 #endif
 
@@ -2064,6 +2819,128 @@ LIBGRAPH2_API ILibGraph2_Adv *GetLibGraph2Adv(void);
  */
 LIBGRAPH2_API ILibGraph2 *GetLibGraph2(void);
 LIBGRAPH2_API ILibGraph2_Exp *GetLibGraph2Exp(void);
+
+/*!
+ * \brief Crée une fenêtre graphique supplémentaire.
+ *
+ * Au niveau Expert, un même programme peut ouvrir plusieurs fenêtres
+ * graphiques indépendantes. La fenêtre renvoyée par GetLibGraph2() reste la
+ * fenêtre par défaut, utilisée par les fonctions des niveaux inférieurs. Toutes
+ * les fenêtres partagent le cache d'images, les polices chargées et les
+ * ressources OpenGL : une image n'est chargée qu'une seule fois, quel que soit
+ * le nombre de fenêtres qui l'affichent.
+ *
+ * \code
+ *   ILibGraph2_Exp* pWnd1 = GetLibGraph2();
+ *   ILibGraph2_Exp* pWnd2 = CreateLibGraph2Window();
+ *   pWnd1->show();
+ *   pWnd2->show(CSize(400, 300));
+ *
+ *   evt e;
+ *   while(ILibGraph2_Exp* pWnd = waitForAnyEvent(e))
+ *   {
+ *     if(e.type == evt_type::evtClose)
+ *       pWnd->hide();
+ *     else if(e.type == evt_type::evtRefresh)
+ *     {
+ *       pWnd->beginPaint();
+ *       //Dessiner dans pWnd
+ *       pWnd->endPaint();
+ *     }
+ *   }
+ * \endcode
+ *
+ * \return Un pointeur vers la nouvelle fenêtre, à libérer avec
+ * ReleaseLibGraph2Window().
+ *
+ * \see
+ * Fonctions : ReleaseLibGraph2Window(), waitForAnyEvent()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API ILibGraph2_Exp *CreateLibGraph2Window(void);
+
+/*!
+ * \brief Libère une fenêtre graphique créée par CreateLibGraph2Window().
+ *
+ * \param [in] pWindow Fenêtre à libérer. S'il s'agit de la fenêtre par défaut,
+ * l'effet est celui de ReleaseLibGraph2().
+ *
+ * \see
+ * Fonctions : CreateLibGraph2Window(), ReleaseLibGraph2()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API void ReleaseLibGraph2Window(ILibGraph2_Exp *pWindow);
+
+/*!
+ * \brief Attend le prochain événement de l'une des fenêtres graphiques.
+ *
+ * Equivalent de ILibGraph2_Com::waitForEvent() pour l'ensemble des fenêtres
+ * du programme. Les fenêtres sont servies à tour de rôle : les événements en
+ * attente d'abord, puis un événement de rafraîchissement. Contrairement à
+ * waitForEvent(), un événement de fermeture est renvoyé comme les autres : il
+ * appartient au programme de masquer ou de libérer la fenêtre concernée.
+ *
+ * \param [out] e Structure événement contenant les informations sur
+ * l'événement reçu.
+ *
+ * \return La fenêtre ayant reçu l'événement, ou \c NULL si aucune fenêtre
+ * n'est ouverte.
+ *
+ * \see
+ * Fonctions : CreateLibGraph2Window() \n
+ * Structure : evt
+ * \ingroup EventManagement
+ */
+LIBGRAPH2_API ILibGraph2_Exp *waitForAnyEvent(evt &e);
+
+/*!
+ * \brief Description d'un moteur de rendu, pour registerBackend().
+ *
+ * Les fonctions correspondent à GetLibGraph2(), ReleaseLibGraph2(),
+ * CreateLibGraph2Window(), ReleaseLibGraph2Window() et waitForAnyEvent()
+ * lorsque ce moteur est actif.
+ *
+ * \see
+ * Fonctions : registerBackend(), selectBackend()
+ * \ingroup WndMgmt
+ */
+struct SBackendDesc {
+  //!\brief Nom du moteur, utilisé par selectBackend() et LIBGRAPH2_BACKEND
+  const char *pszName;
+  //!\brief Priorité : sans choix explicite, le moteur disponible de plus
+  //! haute priorité est utilisé
+  int nPriority;
+  //!\brief Indique si le moteur peut fonctionner (écran présent...), NULL
+  //! s'il l'est toujours
+  bool (*pfnIsAvailable)(void);
+  ILibGraph2_Exp *(*pfnGetInstance)(void);
+  void (*pfnReleaseInstance)(void);
+  ILibGraph2_Exp *(*pfnCreateWindow)(void);
+  void (*pfnReleaseWindow)(ILibGraph2_Exp *pWindow);
+  ILibGraph2_Exp *(*pfnWaitForAnyEvent)(evt &e);
+};
+
+/*!
+ * \brief Ajoute un moteur de rendu à ceux proposés par LibGraph2.
+ *
+ * Un moteur peut être compilé dans le programme, ou dans un module chargé à
+ * la demande : si le nom passé à selectBackend() (ou à LIBGRAPH2_BACKEND)
+ * n'est pas celui d'un moteur connu, LibGraph2 charge le module
+ * \c libLibGraph2_<nom>.so (ou le fichier désigné, si le nom contient un
+ * \c /) et appelle sa fonction <tt>extern "C" void
+ * LibGraph2RegisterBackends(void)</tt>, qui doit appeler registerBackend().
+ *
+ * \param [in] desc Description du moteur. Les chaînes et fonctions désignées
+ * doivent rester valables jusqu'à la fin du programme.
+ *
+ * \return \c false si un moteur de ce nom existe déjà.
+ *
+ * \see
+ * Structure : SBackendDesc \n
+ * Fonction : selectBackend()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API bool registerBackend(const SBackendDesc &desc);
 #endif
 
 #ifndef LIBGRAPH2_EXPORTS
@@ -2088,6 +2965,92 @@ LIBGRAPH2_API ILibGraph2_Exp *GetLibGraph2Exp(void);
  */
 LIBGRAPH2_API void ReleaseLibGraph2(void);
 
+/*!
+ * \brief Choisit le moteur de rendu.
+ *
+ * Le moteur est choisi une fois pour toutes, à la première ouverture de
+ * fenêtre. Sans appel à cette fonction, c'est celui désigné par la variable
+ * d'environnement \c LIBGRAPH2_BACKEND, ou à défaut le meilleur moteur
+ * disponible : \c "sfml" si un écran est présent, sinon \c "soft" (rendu
+ * logiciel). \c "null" ne dessine rien et compte les appels.
+ *
+ * Un même programme peut ainsi s'exécuter dans une fenêtre sur un poste de
+ * travail, et sans affichage sur un serveur d'intégration continue.
+ *
+ * \param [in] pszName Nom du moteur, ou chemin d'un module le contenant.
+ *
+ * \return \c false si le moteur est introuvable ou indisponible, ou si le
+ * moteur a déjà été choisi.
+ *
+ * \see
+ * Fonctions : getBackendName(), GetLibGraph2()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API bool selectBackend(const char *pszName);
+
+/*!
+ * \brief Renvoie le nom du moteur de rendu utilisé.
+ *
+ * \return Le nom du moteur, choisi s'il ne l'était pas encore, ou une chaîne
+ * vide si aucun moteur n'est disponible.
+ *
+ * \see
+ * Fonction : selectBackend()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API const char *getBackendName(void);
+
+/*!
+ * \brief Commence l'enregistrement d'une trace des fonctions de LibGraph2.
+ *
+ * Les fonctions de dessin, d'affichage et d'attente des événements, ainsi
+ * que leurs étapes internes (chargement des images et des polices, attente
+ * de la synchronisation verticale, exécution des commandes par le thread de
+ * rendu...) sont enregistrées avec leur durée, pour tous les threads et
+ * toutes les fenêtres. La trace, écrite par saveTrace(), s'ouvre dans
+ * chrome://tracing ou https://ui.perfetto.dev : une image saccadée y montre
+ * où le temps a été passé.
+ *
+ * La variable d'environnement \c LIBGRAPH2_TRACE, contenant un nom de
+ * fichier, démarre la trace au chargement de la bibliothèque et l'écrit dans
+ * ce fichier à l'appel de ReleaseLibGraph2().
+ *
+ * \remarks Chaque thread écrit dans son propre tampon, sans verrou. Sans
+ * trace active, un point de trace coûte la lecture d'un booléen.
+ *
+ * \see
+ * Fonctions : stopTrace(), saveTrace()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API void startTrace(void);
+
+/*!
+ * \brief Suspend l'enregistrement de la trace.
+ *
+ * Les événements déjà enregistrés sont conservés.
+ *
+ * \see
+ * Fonctions : startTrace(), saveTrace()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API void stopTrace(void);
+
+/*!
+ * \brief Écrit la trace au format Chrome Trace Event (JSON).
+ *
+ * Peut être appelée à tout moment, y compris pendant l'enregistrement : le
+ * fichier contient les événements terminés depuis startTrace().
+ *
+ * \param [in] pszFileName Nom du fichier à créer.
+ *
+ * \return \c false si le fichier n'a pas pu être écrit.
+ *
+ * \see
+ * Fonctions : startTrace(), stopTrace()
+ * \ingroup WndMgmt
+ */
+LIBGRAPH2_API bool saveTrace(const char *pszFileName);
+
 /*!
  * \brief Crée une couleur ARGB
  *
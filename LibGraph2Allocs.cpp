@@ -0,0 +1,195 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Allocs.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace LibGraph2 {
+
+namespace {
+
+struct SSlot {
+  std::atomic<const char *> pszName;
+  std::atomic<uint64_t> nAllocations;
+  std::atomic<uint64_t> nBytes;
+};
+
+// Initialisée à zéro avant toute allocation : aucun constructeur à appeler
+SSlot s_aSlots[CAllocCounter::SLOTS];
+
+} // namespace
+
+#ifdef LIBGRAPH2_COUNT_ALLOCS
+
+thread_local const char *CAllocScope::s_pszCurrent = NULL;
+
+void CAllocCounter::Record(size_t nBytes) {
+  const char *pszName = CAllocScope::s_pszCurrent;
+  if (!pszName)
+    return;
+  // Adressage ouvert : la case d'un nom est réservée par son premier
+  // enregistrement, puis ne change plus. Table pleine, l'allocation est
+  // perdue (plus de 128 noms de fonctions, ce qui n'arrive pas)
+  size_t nIndex = ((uintptr_t)pszName >> 3) % SLOTS;
+  for (unsigned nProbe = 0; nProbe < SLOTS; nProbe++) {
+    SSlot &slot = s_aSlots[(nIndex + nProbe) % SLOTS];
+    const char *pszSlot = slot.pszName.load(std::memory_order_acquire);
+    if (!pszSlot && slot.pszName.compare_exchange_strong(
+                        pszSlot, pszName, std::memory_order_acq_rel))
+      pszSlot = pszName;
+    if (pszSlot == pszName) {
+      slot.nAllocations.fetch_add(1, std::memory_order_relaxed);
+      slot.nBytes.fetch_add(nBytes, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+#else
+
+void CAllocCounter::Record(size_t) {}
+
+#endif
+
+void CAllocCounter::Read(SCounts aCounts[SLOTS]) {
+  for (unsigned i = 0; i < SLOTS; i++) {
+    aCounts[i].pszName = s_aSlots[i].pszName.load(std::memory_order_acquire);
+    aCounts[i].nAllocations =
+        s_aSlots[i].nAllocations.load(std::memory_order_relaxed);
+    aCounts[i].nBytes = s_aSlots[i].nBytes.load(std::memory_order_relaxed);
+  }
+}
+
+CFrameAllocations::CFrameAllocations()
+    : m_vPrevious(CAllocCounter::SLOTS), m_vCurrent(CAllocCounter::SLOTS) {
+  m_vLast.reserve(CAllocCounter::SLOTS);
+  CAllocCounter::Read(m_vPrevious.data());
+}
+
+void CFrameAllocations::EndFrame(SFrameStats &stats) {
+  CAllocCounter::Read(m_vCurrent.data());
+  m_vLast.clear();
+  stats.nAllocations = 0;
+  stats.nAllocatedBytes = 0;
+  for (unsigned i = 0; i < CAllocCounter::SLOTS; i++) {
+    const CAllocCounter::SCounts &current = m_vCurrent[i];
+    const CAllocCounter::SCounts &previous = m_vPrevious[i];
+    uint64_t nAllocations = current.nAllocations - previous.nAllocations;
+    if (!current.pszName || !nAllocations)
+      continue;
+    uint64_t nBytes = current.nBytes - previous.nBytes;
+    stats.nAllocations += (unsigned long)nAllocations;
+    stats.nAllocatedBytes += nBytes;
+    // Une même chaîne littérale peut avoir une adresse par unité de
+    // compilation : les entrées sont regroupées par nom
+    auto it = std::find_if(m_vLast.begin(), m_vLast.end(),
+                           [&](const SAllocationStats &a) {
+                             return !strcmp(a.pszFunction, current.pszName);
+                           });
+    if (it == m_vLast.end()) {
+      m_vLast.push_back({current.pszName, 0, 0});
+      it = m_vLast.end() - 1;
+    }
+    it->nAllocations += (unsigned long)nAllocations;
+    it->nBytes += nBytes;
+  }
+  std::sort(m_vLast.begin(), m_vLast.end(),
+            [](const SAllocationStats &a, const SAllocationStats &b) {
+              return a.nBytes > b.nBytes;
+            });
+  m_vPrevious.swap(m_vCurrent);
+}
+
+} // namespace LibGraph2
+
+#ifdef LIBGRAPH2_COUNT_ALLOCS
+
+// Remplacement des opérateurs d'allocation du processus. Les opérateurs
+// delete sont remplacés avec eux pour rester appariés avec malloc()
+namespace {
+
+void *Allocate(size_t nBytes) {
+  LibGraph2::CAllocCounter::Record(nBytes);
+  return malloc(nBytes ? nBytes : 1);
+}
+
+void *AllocateAligned(size_t nBytes, std::align_val_t align) {
+  LibGraph2::CAllocCounter::Record(nBytes);
+  void *p = NULL;
+  size_t nAlign = std::max((size_t)align, sizeof(void *));
+  return posix_memalign(&p, nAlign, nBytes ? nBytes : 1) ? NULL : p;
+}
+
+} // namespace
+
+void *operator new(size_t nBytes) {
+  void *p = Allocate(nBytes);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t nBytes) { return operator new(nBytes); }
+void *operator new(size_t nBytes, const std::nothrow_t &) noexcept {
+  return Allocate(nBytes);
+}
+void *operator new[](size_t nBytes, const std::nothrow_t &) noexcept {
+  return Allocate(nBytes);
+}
+void *operator new(size_t nBytes, std::align_val_t align) {
+  void *p = AllocateAligned(nBytes, align);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t nBytes, std::align_val_t align) {
+  return operator new(nBytes, align);
+}
+void *operator new(size_t nBytes, std::align_val_t align,
+                   const std::nothrow_t &) noexcept {
+  return AllocateAligned(nBytes, align);
+}
+void *operator new[](size_t nBytes, std::align_val_t align,
+                     const std::nothrow_t &) noexcept {
+  return AllocateAligned(nBytes, align);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+  free(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  free(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  free(p);
+}
+
+#endif
@@ -0,0 +1,106 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : comptage des allocations sur le tas par
+// fonction de la bibliothèque (option LIBGRAPH2_COUNT_ALLOCS).
+
+#include "LibGraph2.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LibGraph2 {
+
+/*
+ * Compteurs d'allocations du processus.
+ *
+ * Avec LIBGRAPH2_COUNT_ALLOCS, l'opérateur new est remplacé pour tout le
+ * processus : chaque allocation faite pendant une portée CAllocScope est
+ * comptée pour la fonction de la portée la plus externe du thread. Les
+ * compteurs sont rangés dans une table de taille fixe, indexée par
+ * l'adresse du nom, et mis à jour par opérations atomiques : Record()
+ * n'alloue rien et ne prend aucun verrou.
+ *
+ * Sans l'option, la table reste vide et les portées ne coûtent rien.
+ */
+class CAllocCounter {
+public:
+  enum { SLOTS = 128 };
+
+  struct SCounts {
+    const char *pszName;
+    uint64_t nAllocations;
+    uint64_t nBytes;
+  };
+
+  // Compte une allocation du thread courant (appelée par l'opérateur new)
+  static void Record(size_t nBytes);
+  // Copie les compteurs cumulés de chaque case utilisée
+  static void Read(SCounts aCounts[SLOTS]);
+};
+
+// Portée d'une fonction de la bibliothèque : les allocations du thread lui
+// sont attribuées, sauf si une portée plus externe est déjà ouverte
+class CAllocScope {
+#ifdef LIBGRAPH2_COUNT_ALLOCS
+private:
+  static thread_local const char *s_pszCurrent
+      __attribute__((tls_model("initial-exec")));
+  bool m_bOuter;
+
+  friend class CAllocCounter;
+
+public:
+  explicit CAllocScope(const char *pszName) : m_bOuter(!s_pszCurrent) {
+    if (m_bOuter)
+      s_pszCurrent = pszName;
+  }
+  ~CAllocScope() {
+    if (m_bOuter)
+      s_pszCurrent = NULL;
+  }
+#else
+public:
+  explicit CAllocScope(const char *) {}
+#endif
+  CAllocScope(const CAllocScope &) = delete;
+  CAllocScope &operator=(const CAllocScope &) = delete;
+};
+
+/*
+ * Allocations d'une image, par différence des compteurs du processus entre
+ * deux appels à EndFrame(). Les vecteurs sont alloués une fois pour toutes :
+ * EndFrame() n'alloue rien, pour ne pas se compter lui-même.
+ */
+class CFrameAllocations {
+private:
+  std::vector<CAllocCounter::SCounts> m_vPrevious;
+  std::vector<CAllocCounter::SCounts> m_vCurrent;
+  std::vector<SAllocationStats> m_vLast;
+
+public:
+  CFrameAllocations();
+
+  // Termine l'image : m_vLast reçoit ses allocations, et les totaux sont
+  // écrits dans stats
+  void EndFrame(SFrameStats &stats);
+  const std::vector<SAllocationStats> &Last() const { return m_vLast; }
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,198 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Backend.h"
+#include "libgraph2imp.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <dlfcn.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace LibGraph2 {
+
+// Adaptateur des moteurs compilés dans la bibliothèque, qui exposent tous les
+// mêmes fonctions statiques
+template <class T> struct CBuiltinBackend {
+  static ILibGraph2_Exp *GetInstance() { return T::GetInstance(); }
+  static void ReleaseInstance() { T::ReleaseInstance(); }
+  static ILibGraph2_Exp *CreateWindowInstance() {
+    return T::CreateWindowInstance();
+  }
+  static void ReleaseWindow(ILibGraph2_Exp *pWindow) {
+    // Toutes les fenêtres appartiennent au moteur actif
+    T::ReleaseWindowInstance(static_cast<T *>(pWindow));
+  }
+  static ILibGraph2_Exp *WaitForAnyEvent(evt &e) {
+    return T::WaitForAnyEvent(e);
+  }
+
+  static SBackendDesc Describe(const char *pszName, int nPriority,
+                               bool (*pfnIsAvailable)(void)) {
+    SBackendDesc desc = {pszName,         nPriority,
+                         pfnIsAvailable,  GetInstance,
+                         ReleaseInstance, CreateWindowInstance,
+                         ReleaseWindow,   WaitForAnyEvent};
+    return desc;
+  }
+};
+
+#ifdef LIBGRAPH2_USE_SFML
+// Un serveur X11 ou Wayland est nécessaire pour ouvrir une fenêtre
+static bool IsDisplayAvailable() {
+  const char *pszX11 = getenv("DISPLAY");
+  const char *pszWayland = getenv("WAYLAND_DISPLAY");
+  return (pszX11 && *pszX11) || (pszWayland && *pszWayland);
+}
+#endif
+
+// Moteurs enregistrés. Une deque ne déplace pas ses éléments : s_pActive
+// reste valable quand des moteurs sont ajoutés. Le mutex est récursif car
+// un module chargé par LoadModule() appelle registerBackend()
+static std::recursive_mutex s_registryMutex;
+static std::deque<SBackendDesc> s_vBackends;
+static bool s_bBuiltinsRegistered = false;
+static std::atomic<const SBackendDesc *> s_pActive(nullptr);
+
+static const SBackendDesc *FindBackend(const std::string &strName) {
+  for (const SBackendDesc &desc : s_vBackends)
+    if (strName == desc.pszName)
+      return &desc;
+  return NULL;
+}
+
+// Appelée avec s_registryMutex verrouillé
+static void RegisterBuiltins() {
+  if (s_bBuiltinsRegistered)
+    return;
+  s_bBuiltinsRegistered = true;
+#ifdef LIBGRAPH2_USE_SFML
+  s_vBackends.push_back(
+      CBuiltinBackend<CLibGraph2>::Describe("sfml", 100, IsDisplayAvailable));
+#endif
+#ifdef LIBGRAPH2_USE_SOFT
+  s_vBackends.push_back(
+      CBuiltinBackend<CLibGraph2Soft>::Describe("soft", 50, NULL));
+#endif
+#ifdef LIBGRAPH2_USE_OPENGL
+  // Sur demande uniquement (LIBGRAPH2_BACKEND=gl) : priorité sous "soft"
+  s_vBackends.push_back(CBuiltinBackend<CLibGraph2GL>::Describe(
+      "gl", 25, CLibGraph2GL::IsAvailable));
+#endif
+#ifdef LIBGRAPH2_USE_NULL
+  s_vBackends.push_back(
+      CBuiltinBackend<CLibGraph2Null>::Describe("null", 0, NULL));
+#endif
+}
+
+// Charge le module d'un moteur inconnu et renvoie le moteur qu'il a
+// enregistré. Le module n'est jamais déchargé. Appelée avec s_registryMutex
+// verrouillé
+static const SBackendDesc *LoadModule(const std::string &strName) {
+  bool bPath = strName.find('/') != std::string::npos;
+  std::string strFile = bPath ? strName : "libLibGraph2_" + strName + ".so";
+
+  void *hModule = dlopen(strFile.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!hModule) {
+    std::cerr << "LibGraph2 : " << dlerror() << std::endl;
+    return NULL;
+  }
+  typedef void (*PFNREGISTER)(void);
+  PFNREGISTER pfnRegister =
+      (PFNREGISTER)dlsym(hModule, "LibGraph2RegisterBackends");
+  if (!pfnRegister) {
+    std::cerr << "LibGraph2 : " << strFile
+              << " n'exporte pas LibGraph2RegisterBackends()" << std::endl;
+    dlclose(hModule);
+    return NULL;
+  }
+
+  size_t nBefore = s_vBackends.size();
+  pfnRegister();
+  if (!bPath)
+    return FindBackend(strName);
+  // Désigné par son chemin : premier moteur enregistré par le module
+  return s_vBackends.size() > nBefore ? &s_vBackends[nBefore] : NULL;
+}
+
+static bool IsAvailable(const SBackendDesc &desc) {
+  return !desc.pfnIsAvailable || desc.pfnIsAvailable();
+}
+
+// Appelée avec s_registryMutex verrouillé, avant le choix du moteur
+static bool Choose(const std::string &strName) {
+  const SBackendDesc *pDesc = FindBackend(strName);
+  if (!pDesc)
+    pDesc = LoadModule(strName);
+  if (!pDesc || !IsAvailable(*pDesc))
+    return false;
+  s_pActive = pDesc;
+  return true;
+}
+
+const SBackendDesc *GetActiveBackend() {
+  // Chemin rapide : appelée par chaque fonction globale des niveaux 0 à 2
+  if (const SBackendDesc *pActive = s_pActive.load(std::memory_order_acquire))
+    return pActive;
+
+  std::lock_guard<std::recursive_mutex> lock(s_registryMutex);
+  if (s_pActive)
+    return s_pActive;
+  RegisterBuiltins();
+
+  const char *pszName = getenv("LIBGRAPH2_BACKEND");
+  if (pszName && *pszName && !Choose(pszName))
+    std::cerr << "LibGraph2 : moteur \"" << pszName
+              << "\" indisponible, moteur par défaut utilisé" << std::endl;
+
+  if (!s_pActive) {
+    const SBackendDesc *pBest = NULL;
+    for (const SBackendDesc &desc : s_vBackends)
+      if ((!pBest || desc.nPriority > pBest->nPriority) && IsAvailable(desc))
+        pBest = &desc;
+    s_pActive = pBest;
+  }
+  return s_pActive;
+}
+
+bool registerBackend(const SBackendDesc &desc) {
+  std::lock_guard<std::recursive_mutex> lock(s_registryMutex);
+  RegisterBuiltins();
+  if (!desc.pszName || FindBackend(desc.pszName))
+    return false;
+  s_vBackends.push_back(desc);
+  return true;
+}
+
+bool selectBackend(const char *pszName) {
+  std::lock_guard<std::recursive_mutex> lock(s_registryMutex);
+  RegisterBuiltins();
+  if (const SBackendDesc *pActive = s_pActive)
+    return strcmp(pActive->pszName, pszName) == 0;
+  return Choose(pszName);
+}
+
+const char *getBackendName() {
+  const SBackendDesc *pActive = GetActiveBackend();
+  return pActive ? pActive->pszName : "";
+}
+
+} // namespace LibGraph2
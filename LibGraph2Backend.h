@@ -0,0 +1,29 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : registre des moteurs de rendu.
+
+#include "LibGraph2.h"
+
+namespace LibGraph2 {
+
+// Moteur utilisé par les fonctions globales, choisi au premier appel (voir
+// selectBackend()). NULL si aucun moteur n'est disponible
+const SBackendDesc *GetActiveBackend();
+
+} // namespace LibGraph2
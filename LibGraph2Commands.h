@@ -0,0 +1,452 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : encodage compact des commandes de dessin.
+//
+// Les commandes sont des enregistrements de taille variable alignés sur 8
+// octets : un en-tête SCmdHeader suivi d'une charge utile (structure SCmd*
+// éventuellement suivie d'un tableau). Toutes les coordonnées sont déjà
+// converties en pixels par l'émetteur, le récepteur n'a plus qu'à dessiner.
+
+#include "LibGraph2.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LibGraph2 {
+
+// Codes des commandes
+enum class cmd_op : uint16_t {
+  Wrap,       // Fin du tampon circulaire, reprendre au début
+  SetPen,     // SCmdSetPen
+  SetBrush,   // SCmdSetBrush
+  SetFont,    // SCmdSetFont + nom UTF-8
+  Clear,      // SCmdColor
+  Line,       // SCmdLine
+  Rectangle,  // SCmdRect
+  Ellipse,    // SCmdRect
+  Pie,        // SCmdPie
+  Pixel,      // SCmdPixel
+  Polyline,   // SCmdPolyline + nCount * 2 floats
+  String,     // SCmdString + nLength wchar_t
+  Bitmap,     // SCmdBitmap + nom UTF-8
+  Display,    // Aucune charge utile
+  Call,       // SCmdCall, traitée par le moteur hors DispatchCommand()
+  Quit,       // Aucune charge utile
+};
+
+struct SCmdHeader {
+  uint32_t nSize; // Taille totale de l'enregistrement (en-tête compris)
+  cmd_op op;
+  uint16_t nFlags;
+};
+static_assert(sizeof(SCmdHeader) == 8, "SCmdHeader doit faire 8 octets");
+
+// Charge utile déportée sur le tas (enregistrement trop gros pour l'anneau)
+const uint16_t CMD_FLAG_EXTERNAL = 1;
+
+struct SCmdSetPen {
+  ARGB color;
+  float fThickness;
+};
+struct SCmdSetBrush {
+  ARGB color;
+};
+struct SCmdSetFont {
+  float fSize;
+  uint32_t nStyle;
+  uint32_t nNameLength;
+};
+struct SCmdColor {
+  ARGB color;
+};
+struct SCmdLine {
+  float x1, y1, x2, y2;
+};
+struct SCmdRect {
+  float x, y, w, h;
+};
+struct SCmdPie {
+  float x, y, w, h;
+  float fStartAngle, fSweepAngle;
+};
+struct SCmdPixel {
+  float x, y;
+  ARGB color;
+};
+struct SCmdPolyline {
+  uint32_t nCount;
+  uint32_t bAutoClose;
+};
+struct SCmdString {
+  float x, y;
+  uint32_t nLength;
+};
+// Référence de l'origine d'une image
+enum class bitmap_origin : uint32_t { TopLeft, Center, Pivot };
+struct SCmdBitmap {
+  float x, y;
+  float fPivotX, fPivotY;
+  float fScale, fAngle;
+  bitmap_origin origin;
+  uint32_t nNameLength;
+};
+// Fonction exécutée par le thread de rendu (lecture de l'image courante,
+// libération de ressources OpenGL...) : l'émetteur attend que la file soit
+// vide avant de détruire la fonction ou d'utiliser son résultat
+struct SCmdCall {
+  const std::function<void()> *pFunction;
+};
+
+inline size_t CmdAlign(size_t n) { return (n + 7) & ~(size_t)7; }
+
+/*
+ * Tampon de commandes linéaire, utilisé par un seul thread à la fois.
+ * Sert d'enregistreur (voir CRecorder) et de format d'échange.
+ */
+class CCommandBuffer {
+private:
+  std::vector<uint8_t> m_vData;
+
+public:
+  void append(cmd_op op, const void *pFixed, size_t nFixed,
+              const void *pExtra = nullptr, size_t nExtra = 0) {
+    size_t nSize = CmdAlign(sizeof(SCmdHeader) + nFixed + nExtra);
+    size_t nPos = m_vData.size();
+    m_vData.resize(nPos + nSize);
+    uint8_t *p = m_vData.data() + nPos;
+    SCmdHeader hdr = {(uint32_t)nSize, op, 0};
+    memcpy(p, &hdr, sizeof hdr);
+    if (nFixed)
+      memcpy(p + sizeof hdr, pFixed, nFixed);
+    if (nExtra)
+      memcpy(p + sizeof hdr + nFixed, pExtra, nExtra);
+  }
+
+  void clear() { m_vData.clear(); }
+  bool empty() const { return m_vData.empty(); }
+  const uint8_t *data() const { return m_vData.data(); }
+  size_t size() const { return m_vData.size(); }
+
+  // Parcourt les commandes : f(op, pPayload, nPayloadSize)
+  template <typename F> void forEach(F f) const {
+    const uint8_t *p = m_vData.data();
+    const uint8_t *pEnd = p + m_vData.size();
+    while (p < pEnd) {
+      SCmdHeader hdr;
+      memcpy(&hdr, p, sizeof hdr);
+      f(hdr.op, p + sizeof hdr, hdr.nSize - sizeof hdr);
+      p += hdr.nSize;
+    }
+  }
+};
+
+/*
+ * File circulaire sans verrou à un producteur et un consommateur (SPSC).
+ *
+ * Le producteur (thread applicatif) et le consommateur (thread de rendu) ne
+ * partagent que deux compteurs atomiques. Un enregistrement est toujours
+ * contigu : s'il ne tient pas avant la fin du tampon, une commande Wrap est
+ * écrite et l'enregistrement reprend au début. Les enregistrements plus gros
+ * qu'un quart de l'anneau sont copiés sur le tas et seule leur adresse
+ * transite par l'anneau.
+ *
+ * Les mutex ne servent qu'à endormir le consommateur quand la file est vide
+ * (ou le producteur quand elle est pleine) ; ils ne sont jamais pris sur le
+ * chemin rapide.
+ */
+class CCommandRing {
+private:
+  std::vector<uint8_t> m_vData;
+  size_t m_nMask;
+
+  alignas(64) std::atomic<uint64_t> m_nHead; // Ecriture (producteur)
+  alignas(64) std::atomic<uint64_t> m_nTail; // Lecture (consommateur)
+  alignas(64) std::atomic<int> m_nSleepers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+
+  struct SExternal {
+    uint8_t *pData;
+    size_t nSize;
+  };
+
+  void wake() {
+    if (m_nSleepers.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cond.notify_all();
+    }
+  }
+
+  // Attend (côté producteur) qu'il y ait nSize octets libres
+  void waitForSpace(uint64_t nHead, size_t nSize) {
+    int nSpin = 0;
+    while (nHead + nSize - m_nTail.load(std::memory_order_acquire) >
+           m_vData.size()) {
+      if (++nSpin < 64) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_nSleepers.fetch_add(1, std::memory_order_seq_cst);
+      m_cond.wait_for(lock, std::chrono::milliseconds(1), [&] {
+        return nHead + nSize - m_nTail.load(std::memory_order_acquire) <=
+               m_vData.size();
+      });
+      m_nSleepers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+public:
+  // nCapacity doit être une puissance de 2
+  explicit CCommandRing(size_t nCapacity = 1 << 22)
+      : m_vData(nCapacity), m_nMask(nCapacity - 1), m_nHead(0), m_nTail(0),
+        m_nSleepers(0) {}
+
+  ~CCommandRing() {
+    // Libérer les charges utiles déportées non consommées
+    while (const SCmdHeader *pHdr = peek())
+      pop(pHdr);
+  }
+
+  // Producteur : publie une commande
+  void push(cmd_op op, const void *pFixed, size_t nFixed,
+            const void *pExtra = nullptr, size_t nExtra = 0) {
+    size_t nSize = CmdAlign(sizeof(SCmdHeader) + nFixed + nExtra);
+    uint16_t nFlags = 0;
+    SExternal ext = {nullptr, 0};
+    if (nSize > m_vData.size() / 4) {
+      ext.nSize = nFixed + nExtra;
+      ext.pData = new uint8_t[ext.nSize];
+      memcpy(ext.pData, pFixed, nFixed);
+      if (nExtra)
+        memcpy(ext.pData + nFixed, pExtra, nExtra);
+      pFixed = &ext;
+      nFixed = sizeof ext;
+      pExtra = nullptr;
+      nExtra = 0;
+      nSize = CmdAlign(sizeof(SCmdHeader) + sizeof ext);
+      nFlags = CMD_FLAG_EXTERNAL;
+    }
+
+    uint64_t nHead = m_nHead.load(std::memory_order_relaxed);
+    size_t nPos = nHead & m_nMask;
+    if (nPos + nSize > m_vData.size()) {
+      // Pas assez de place avant la fin : commande Wrap puis retour au début
+      size_t nPad = m_vData.size() - nPos;
+      waitForSpace(nHead, nPad + nSize);
+      SCmdHeader hdr = {(uint32_t)nPad, cmd_op::Wrap, 0};
+      memcpy(&m_vData[nPos], &hdr, sizeof hdr);
+      nHead += nPad;
+      nPos = 0;
+    } else {
+      waitForSpace(nHead, nSize);
+    }
+
+    uint8_t *p = &m_vData[nPos];
+    SCmdHeader hdr = {(uint32_t)nSize, op, nFlags};
+    memcpy(p, &hdr, sizeof hdr);
+    if (nFixed)
+      memcpy(p + sizeof hdr, pFixed, nFixed);
+    if (nExtra)
+      memcpy(p + sizeof hdr + nFixed, pExtra, nExtra);
+    m_nHead.store(nHead + nSize, std::memory_order_release);
+    wake();
+  }
+
+  // Producteur : recopie le contenu d'un tampon linéaire
+  void push(const CCommandBuffer &buf) {
+    buf.forEach([this](cmd_op op, const uint8_t *p, size_t n) {
+      push(op, p, n);
+    });
+  }
+
+  // Consommateur : commande en tête de file, ou nullptr si la file est vide
+  const SCmdHeader *peek() {
+    for (;;) {
+      uint64_t nTail = m_nTail.load(std::memory_order_relaxed);
+      if (nTail == m_nHead.load(std::memory_order_acquire))
+        return nullptr;
+      const SCmdHeader *pHdr =
+          reinterpret_cast<const SCmdHeader *>(&m_vData[nTail & m_nMask]);
+      if (pHdr->op != cmd_op::Wrap)
+        return pHdr;
+      m_nTail.store(nTail + pHdr->nSize, std::memory_order_release);
+    }
+  }
+
+  // Consommateur : charge utile de la commande (déportée ou non)
+  static const uint8_t *payload(const SCmdHeader *pHdr, size_t &nSize) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(pHdr + 1);
+    if (pHdr->nFlags & CMD_FLAG_EXTERNAL) {
+      const SExternal *pExt = reinterpret_cast<const SExternal *>(p);
+      nSize = pExt->nSize;
+      return pExt->pData;
+    }
+    nSize = pHdr->nSize - sizeof(SCmdHeader);
+    return p;
+  }
+
+  // Consommateur : libère la commande en tête de file après exécution
+  void pop(const SCmdHeader *pHdr) {
+    if (pHdr->nFlags & CMD_FLAG_EXTERNAL)
+      delete[] reinterpret_cast<const SExternal *>(pHdr + 1)->pData;
+    m_nTail.store(m_nTail.load(std::memory_order_relaxed) + pHdr->nSize,
+                  std::memory_order_release);
+    wake();
+  }
+
+  // Consommateur : attend qu'une commande soit disponible
+  void waitForData() {
+    int nSpin = 0;
+    while (m_nTail.load(std::memory_order_relaxed) ==
+           m_nHead.load(std::memory_order_acquire)) {
+      if (++nSpin < 64) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_nSleepers.fetch_add(1, std::memory_order_seq_cst);
+      m_cond.wait_for(lock, std::chrono::milliseconds(1), [this] {
+        return m_nTail.load(std::memory_order_relaxed) !=
+               m_nHead.load(std::memory_order_acquire);
+      });
+      m_nSleepers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+  // Producteur : attend que toutes les commandes publiées soient exécutées
+  void drain() { waitForSpace(m_nHead.load(std::memory_order_relaxed), m_vData.size()); }
+
+  bool empty() const {
+    return m_nTail.load(std::memory_order_acquire) ==
+           m_nHead.load(std::memory_order_acquire);
+  }
+};
+
+/*
+ * Décode une commande et appelle la méthode correspondante du visiteur.
+ * Le visiteur doit fournir les méthodes CmdSetPen(), CmdSetBrush(),
+ * CmdSetFont(), CmdClear(), CmdLine(), CmdRectangle(), CmdEllipse(),
+ * CmdPie(), CmdPixel(), CmdPolyline(), CmdString(), CmdBitmap() et
+ * CmdDisplay().
+ */
+template <typename V>
+void DispatchCommand(V &visitor, cmd_op op, const uint8_t *p, size_t nSize) {
+  (void)nSize;
+  switch (op) {
+  case cmd_op::SetPen: {
+    SCmdSetPen c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdSetPen(c.color, c.fThickness);
+    break;
+  }
+  case cmd_op::SetBrush: {
+    SCmdSetBrush c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdSetBrush(c.color);
+    break;
+  }
+  case cmd_op::SetFont: {
+    SCmdSetFont c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdSetFont(
+        std::string(reinterpret_cast<const char *>(p + sizeof c),
+                    c.nNameLength),
+        c.fSize, (font_styles)c.nStyle);
+    break;
+  }
+  case cmd_op::Clear: {
+    SCmdColor c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdClear(c.color);
+    break;
+  }
+  case cmd_op::Line: {
+    SCmdLine c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdLine(c);
+    break;
+  }
+  case cmd_op::Rectangle: {
+    SCmdRect c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdRectangle(c);
+    break;
+  }
+  case cmd_op::Ellipse: {
+    SCmdRect c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdEllipse(c);
+    break;
+  }
+  case cmd_op::Pie: {
+    SCmdPie c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdPie(c);
+    break;
+  }
+  case cmd_op::Pixel: {
+    SCmdPixel c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdPixel(c);
+    break;
+  }
+  case cmd_op::Polyline: {
+    SCmdPolyline c;
+    memcpy(&c, p, sizeof c);
+    // Les enregistrements sont alignés sur 8 octets : les floats le sont aussi
+    visitor.CmdPolyline(reinterpret_cast<const float *>(p + sizeof c),
+                        c.nCount, c.bAutoClose != 0);
+    break;
+  }
+  case cmd_op::String: {
+    SCmdString c;
+    memcpy(&c, p, sizeof c);
+    std::wstring str(c.nLength, L'\0');
+    if (c.nLength)
+      memcpy(&str[0], p + sizeof c, c.nLength * sizeof(wchar_t));
+    visitor.CmdString(str, c.x, c.y);
+    break;
+  }
+  case cmd_op::Bitmap: {
+    SCmdBitmap c;
+    memcpy(&c, p, sizeof c);
+    visitor.CmdBitmap(
+        std::string(reinterpret_cast<const char *>(p + sizeof c),
+                    c.nNameLength),
+        c);
+    break;
+  }
+  case cmd_op::Display:
+    visitor.CmdDisplay();
+    break;
+  default:
+    break;
+  }
+}
+
+} // namespace LibGraph2
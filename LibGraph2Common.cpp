@@ -20,9 +20,8 @@
 #include <iostream>
 #include <vector>
 
-#ifdef LIBGRAPH2_USE_SFML
-#include "LibGraph2impSFML.h"
-#endif
+#include "LibGraph2Backend.h"
+#include "LibGraph2Trace.h"
 
 namespace LibGraph2 {
 
@@ -55,34 +54,45 @@ std::ostream &operator<<(std::ostream &out, const std::wstring &str) {
 
 // Gestion de l'instance Singleton
 
-ILibGraph2 *GetLibGraph2(void) {
-#ifdef LIBGRAPH2_USE_SFML
-  return CLibGraph2::GetInstance();
-#else
-  return nullptr;
-#endif
-}
+ILibGraph2 *GetLibGraph2(void) { return GetLibGraph2Exp(); }
 
 ILibGraph2_Exp *GetLibGraph2Exp() {
-#ifdef LIBGRAPH2_USE_SFML
-  return static_cast<ILibGraph2_Exp *>(CLibGraph2::GetInstance());
-#else
-  return nullptr;
-#endif
+  const SBackendDesc *pBackend = GetActiveBackend();
+  return pBackend ? pBackend->pfnGetInstance() : nullptr;
 }
 
 ILibGraph2_Adv *GetLibGraph2Adv() {
-#ifdef LIBGRAPH2_USE_SFML
-  return static_cast<ILibGraph2_Adv *>(CLibGraph2::GetInstance());
-#else
-  return nullptr;
-#endif
+  // Les moteurs implémentent les deux interfaces, sans lien d'héritage entre
+  // elles
+  return dynamic_cast<ILibGraph2_Adv *>(GetLibGraph2Exp());
 }
 
 void ReleaseLibGraph2(void) {
-#ifdef LIBGRAPH2_USE_SFML
-  CLibGraph2::ReleaseInstance();
-#endif
+  if (const SBackendDesc *pBackend = GetActiveBackend()) {
+    CTraceScope trace("ReleaseLibGraph2");
+    pBackend->pfnReleaseInstance();
+  }
+  // Trace demandée par LIBGRAPH2_TRACE
+  if (const char *pszFile = CTracer::GetEnvironmentFile())
+    CTracer::Save(pszFile);
+}
+
+// Gestion des fenêtres supplémentaires (niveau Expert)
+
+ILibGraph2_Exp *CreateLibGraph2Window() {
+  const SBackendDesc *pBackend = GetActiveBackend();
+  return pBackend ? pBackend->pfnCreateWindow() : nullptr;
+}
+
+void ReleaseLibGraph2Window(ILibGraph2_Exp *pWindow) {
+  const SBackendDesc *pBackend = GetActiveBackend();
+  if (pBackend && pWindow)
+    pBackend->pfnReleaseWindow(pWindow);
+}
+
+ILibGraph2_Exp *waitForAnyEvent(evt &e) {
+  const SBackendDesc *pBackend = GetActiveBackend();
+  return pBackend ? pBackend->pfnWaitForAnyEvent(e) : nullptr;
 }
 
 // Wrappers globaux pour le Niveau 0 et compatibilité Niveau 1/2
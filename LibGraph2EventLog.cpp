@@ -0,0 +1,185 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2EventLog.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace LibGraph2 {
+
+static const char EVENTLOG_MAGIC[8] = {'L', 'G', '2', 'E', 'V', 'T', 1, 0};
+
+CEventLog::CEventLog()
+    : m_pRecordFile(nullptr), m_pReplayFile(nullptr), m_bMaxSpeed(false) {}
+
+CEventLog::~CEventLog() {
+  StopRecording();
+  StopReplay();
+}
+
+void CEventLog::WriteVarint(FILE *pFile, uint64_t n) {
+  do {
+    uint8_t byte = n & 0x7F;
+    n >>= 7;
+    if (n)
+      byte |= 0x80;
+    fputc(byte, pFile);
+  } while (n);
+}
+
+bool CEventLog::ReadVarint(FILE *pFile, uint64_t &n) {
+  n = 0;
+  for (int nShift = 0; nShift < 64; nShift += 7) {
+    int c = fgetc(pFile);
+    if (c == EOF)
+      return false;
+    n |= (uint64_t)(c & 0x7F) << nShift;
+    if (!(c & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool CEventLog::StartRecording(const string &strFileName) {
+  StopRecording();
+  m_pRecordFile = fopen(strFileName.c_str(), "wb");
+  if (!m_pRecordFile) {
+    cerr << "LibGraph2 : impossible d'enregistrer les événements dans "
+         << strFileName << endl;
+    return false;
+  }
+  fwrite(EVENTLOG_MAGIC, 1, sizeof EVENTLOG_MAGIC, m_pRecordFile);
+  m_tpLast = chrono::steady_clock::now();
+  return true;
+}
+
+void CEventLog::StopRecording() {
+  if (m_pRecordFile) {
+    fclose(m_pRecordFile);
+    m_pRecordFile = nullptr;
+  }
+}
+
+void CEventLog::Record(const evt &e) {
+  if (!m_pRecordFile)
+    return;
+
+  auto now = chrono::steady_clock::now();
+  WriteVarint(m_pRecordFile,
+              chrono::duration_cast<chrono::microseconds>(now - m_tpLast)
+                  .count());
+  m_tpLast = now;
+
+  fputc((int)e.type, m_pRecordFile);
+  switch (e.type) {
+  case evt_type::evtMouseDown:
+  case evt_type::evtMouseUp:
+  case evt_type::evtMouseMove:
+  case evt_type::evtSize:
+    WriteVarint(m_pRecordFile, e.x);
+    WriteVarint(m_pRecordFile, e.y);
+    break;
+  case evt_type::evtKeyDown:
+  case evt_type::evtKeyUp:
+    WriteVarint(m_pRecordFile, e.vkKeyCode);
+    break;
+  default:
+    break;
+  }
+}
+
+bool CEventLog::StartReplay(const string &strFileName, bool bMaxSpeed) {
+  StopReplay();
+  m_pReplayFile = fopen(strFileName.c_str(), "rb");
+  char magic[sizeof EVENTLOG_MAGIC];
+  if (!m_pReplayFile ||
+      fread(magic, 1, sizeof magic, m_pReplayFile) != sizeof magic ||
+      memcmp(magic, EVENTLOG_MAGIC, sizeof magic) != 0) {
+    cerr << "LibGraph2 : impossible de rejouer les événements de "
+         << strFileName << endl;
+    StopReplay();
+    return false;
+  }
+  m_bMaxSpeed = bMaxSpeed;
+  m_tpReplay = chrono::steady_clock::now();
+  return true;
+}
+
+void CEventLog::StopReplay() {
+  if (m_pReplayFile) {
+    fclose(m_pReplayFile);
+    m_pReplayFile = nullptr;
+  }
+}
+
+bool CEventLog::Replay(evt &e) {
+  if (!m_pReplayFile)
+    return false;
+
+  uint64_t nDelay, x = 0, y = 0, nKey = 0;
+  int nType;
+  bool bOk = ReadVarint(m_pReplayFile, nDelay) &&
+             (nType = fgetc(m_pReplayFile)) != EOF &&
+             nType <= (int)evt_type::evtClose;
+  if (bOk) {
+    switch ((evt_type)nType) {
+    case evt_type::evtMouseDown:
+    case evt_type::evtMouseUp:
+    case evt_type::evtMouseMove:
+    case evt_type::evtSize:
+      bOk = ReadVarint(m_pReplayFile, x) && ReadVarint(m_pReplayFile, y);
+      break;
+    case evt_type::evtKeyDown:
+    case evt_type::evtKeyUp:
+      bOk = ReadVarint(m_pReplayFile, nKey);
+      break;
+    default:
+      break;
+    }
+  }
+  if (!bOk) {
+    StopReplay();
+    return false;
+  }
+
+  // Les délais sont cumulés depuis le début du rejeu pour ne pas dériver
+  m_tpReplay += chrono::microseconds(nDelay);
+  if (!m_bMaxSpeed)
+    this_thread::sleep_until(m_tpReplay);
+
+  e.type = (evt_type)nType;
+  e.x = (unsigned int)x;
+  e.y = (unsigned int)y;
+  e.vkKeyCode = (unsigned int)nKey;
+  return true;
+}
+
+void CEventLog::ApplyEnvironment() {
+  if (const char *pszFile = getenv("LIBGRAPH2_REPLAY_EVENTS")) {
+    const char *pszSpeed = getenv("LIBGRAPH2_REPLAY_SPEED");
+    StartReplay(pszFile, pszSpeed && strcmp(pszSpeed, "max") == 0);
+  }
+  if (const char *pszFile = getenv("LIBGRAPH2_RECORD_EVENTS"))
+    StartRecording(pszFile);
+}
+
+} // namespace LibGraph2
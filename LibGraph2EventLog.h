@@ -0,0 +1,75 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : enregistrement et rejeu des événements.
+
+#include "LibGraph2.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace LibGraph2 {
+
+/*
+ * Journal binaire des événements renvoyés par waitForEvent().
+ *
+ * Format : un en-tête de 8 octets ("LG2EVT" + version sur 2 octets), puis un
+ * enregistrement par événement :
+ *   - délai depuis l'événement précédent en microsecondes (varint LEB128),
+ *     mesuré sur une horloge monotone ;
+ *   - type de l'événement (1 octet) ;
+ *   - x et y (varints) pour les événements souris et de redimensionnement,
+ *     ou le code de touche (varint) pour les événements clavier.
+ * Un événement de rafraîchissement occupe ainsi 2 octets.
+ */
+class CEventLog {
+private:
+  FILE *m_pRecordFile;
+  FILE *m_pReplayFile;
+  bool m_bMaxSpeed;
+  std::chrono::steady_clock::time_point m_tpLast;
+  // Instant théorique du dernier événement rejoué
+  std::chrono::steady_clock::time_point m_tpReplay;
+
+  static void WriteVarint(FILE *pFile, uint64_t n);
+  static bool ReadVarint(FILE *pFile, uint64_t &n);
+
+public:
+  CEventLog();
+  ~CEventLog();
+
+  bool StartRecording(const std::string &strFileName);
+  void StopRecording();
+  bool IsRecording() const { return m_pRecordFile != nullptr; }
+  // Ajoute l'événement au journal si l'enregistrement est actif
+  void Record(const evt &e);
+
+  // bMaxSpeed : rejouer sans attendre, sinon respecter les délais d'origine
+  bool StartReplay(const std::string &strFileName, bool bMaxSpeed);
+  void StopReplay();
+  bool IsReplaying() const { return m_pReplayFile != nullptr; }
+  // Lit l'événement suivant ; false (et fin du rejeu) à la fin du journal
+  bool Replay(evt &e);
+
+  // Applique LIBGRAPH2_RECORD_EVENTS, LIBGRAPH2_REPLAY_EVENTS et
+  // LIBGRAPH2_REPLAY_SPEED=max
+  void ApplyEnvironment();
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,189 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Font.h"
+#include "LibGraph2Probes.h"
+#include "LibGraph2Trace.h"
+#include <algorithm>
+
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+#  include FT_SYNTHESIS_H
+#endif
+
+namespace LibGraph2 {
+
+// Polices
+
+const CFont::SGlyph &CFont::GetGlyph(uint32_t nCodePoint, unsigned nSize,
+                                     font_styles nStyle) {
+  uint64_t nKey = (uint64_t)nCodePoint | ((uint64_t)(nSize & 0xFFFF) << 32) |
+                  ((uint64_t)(nStyle & (FontStyleBold | FontStyleItalic))
+                   << 48);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_glyphs.find(nKey);
+  if (it != m_glyphs.end())
+    return it->second;
+
+  SGlyph &glyph = m_glyphs[nKey];
+  glyph = m_empty;
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  FT_Set_Pixel_Sizes(m_face, 0, nSize);
+  // Italique synthétique : même inclinaison que sf::Text
+  FT_Matrix shear = {0x10000, (FT_Fixed)(0.209 * 0x10000), 0, 0x10000};
+  FT_Set_Transform(m_face, (nStyle & FontStyleItalic) ? &shear : NULL, NULL);
+  if (FT_Load_Char(m_face, nCodePoint, FT_LOAD_TARGET_NORMAL) == 0) {
+    FT_GlyphSlot slot = m_face->glyph;
+    if (nStyle & FontStyleBold)
+      FT_GlyphSlot_Embolden(slot);
+    if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) == 0) {
+      const FT_Bitmap &bmp = slot->bitmap;
+      glyph.nLeft = slot->bitmap_left;
+      glyph.nTop = slot->bitmap_top;
+      glyph.nWidth = (int)bmp.width;
+      glyph.nHeight = (int)bmp.rows;
+      glyph.fAdvance = slot->advance.x / 64.0f;
+      glyph.vCoverage.resize((size_t)bmp.width * bmp.rows);
+      for (unsigned y = 0; y < bmp.rows; y++)
+        std::copy(bmp.buffer + y * bmp.pitch,
+                  bmp.buffer + y * bmp.pitch + bmp.width,
+                  glyph.vCoverage.begin() + (size_t)y * bmp.width);
+    }
+  }
+#endif
+  return glyph;
+}
+
+float CFont::GetLineSpacing(unsigned nSize) {
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  std::lock_guard<std::mutex> lock(m_mutex);
+  FT_Set_Pixel_Sizes(m_face, 0, nSize);
+  return m_face->size->metrics.height / 64.0f;
+#else
+  return (float)nSize;
+#endif
+}
+
+// Ressources partagées
+
+CResources *CResources::s_pResources = NULL;
+int CResources::s_nRefCount = 0;
+std::mutex CResources::s_refMutex;
+
+CResources::CResources() : m_nImageBytes(0) {
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  if (FT_Init_FreeType(&m_library) != 0)
+    m_library = NULL;
+#endif
+}
+
+CResources::~CResources() {
+  // Les faces doivent être libérées avant la bibliothèque
+  m_fontRegistry.clear();
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  if (m_library)
+    FT_Done_FreeType(m_library);
+#endif
+}
+
+CResources *CResources::Acquire() {
+  std::lock_guard<std::mutex> lock(s_refMutex);
+  if (s_nRefCount++ == 0)
+    s_pResources = new CResources;
+  return s_pResources;
+}
+
+void CResources::Release() {
+  std::lock_guard<std::mutex> lock(s_refMutex);
+  if (--s_nRefCount == 0) {
+    delete s_pResources;
+    s_pResources = NULL;
+  }
+}
+
+const SImage *CResources::GetImage(const std::string &filename,
+                                   SFrameStats *pStats) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_imageCache.find(filename);
+  if (it == m_imageCache.end()) {
+    if (pStats)
+      pStats->nTextureCacheMisses++;
+    CTraceScope trace("loadImage");
+    CProbeClock probe;
+    SImage image;
+    if (!LoadImageFile(filename, image)) {
+      LIBGRAPH2_PROBE5(texture__load, filename.c_str(), 0, 0, 0,
+                       probe.ElapsedUs());
+      return NULL; // Erreur de chargement
+    }
+    unsigned long long nBytes = image.vPixels.size() * sizeof(uint32_t);
+    m_nImageBytes += nBytes;
+    LIBGRAPH2_PROBE5(texture__load, filename.c_str(), image.nWidth,
+                     image.nHeight, nBytes, probe.ElapsedUs());
+    it = m_imageCache.emplace(filename, std::move(image)).first;
+  } else if (pStats) {
+    pStats->nTextureCacheHits++;
+  }
+  return &it->second;
+}
+
+unsigned long long CResources::GetImageBytes() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nImageBytes;
+}
+
+CFont *CResources::GetFont(const std::string &filename, SFrameStats *pStats) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_fontRegistry.find(filename);
+  if (it != m_fontRegistry.end())
+    return it->second.get();
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  CTraceScope trace("loadFont");
+  CProbeClock probe;
+  FT_Face face;
+  if (!m_library || FT_New_Face(m_library, filename.c_str(), 0, &face) != 0) {
+    LIBGRAPH2_PROBE3(font__load, filename.c_str(), 0, probe.ElapsedUs());
+    return NULL;
+  }
+  FT_Select_Charmap(face, FT_ENCODING_UNICODE);
+  CFont *pFont = new CFont(face);
+  m_fontRegistry.emplace(filename, std::unique_ptr<CFont>(pFont));
+  if (pStats)
+    pStats->nFontLoads++;
+  LIBGRAPH2_PROBE3(font__load, filename.c_str(), 1, probe.ElapsedUs());
+  return pFont;
+#else
+  return NULL;
+#endif
+}
+
+CFont *CResources::FindFont(const std::string &fontName,
+                            SFrameStats *pStats) {
+  std::vector<std::string> paths = {
+      "/usr/share/fonts/truetype/" + fontName + ".ttf",
+      "/usr/share/fonts/truetype/dejavu/" + fontName + ".ttf",
+      "/usr/share/fonts/truetype/liberation/" + fontName + ".ttf",
+      "/usr/share/fonts/truetype/freefont/" + fontName + ".ttf"};
+
+  for (const auto &path : paths)
+    if (CFont *pFont = GetFont(path, pStats))
+      return pFont;
+
+  return GetFont("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", pStats);
+}
+
+} // namespace LibGraph2
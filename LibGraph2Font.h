@@ -0,0 +1,108 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : polices rastérisées par FreeType et
+// ressources partagées par les moteurs qui dessinent eux-mêmes le texte et
+// les images (moteurs logiciel et OpenGL).
+
+#include "LibGraph2.h"
+#include "LibGraph2Image.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+#  include <ft2build.h>
+#  include FT_FREETYPE_H
+#endif
+
+namespace LibGraph2 {
+
+// Police rastérisée par FreeType, avec cache des glyphes rendus
+class CFont {
+public:
+  struct SGlyph {
+    int nLeft, nTop; // Position du bitmap par rapport à la ligne de base
+    int nWidth, nHeight;
+    float fAdvance;
+    std::vector<uint8_t> vCoverage;
+  };
+
+private:
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  FT_Face m_face;
+#endif
+  std::mutex m_mutex;
+  std::unordered_map<uint64_t, SGlyph> m_glyphs;
+  SGlyph m_empty;
+
+public:
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  explicit CFont(FT_Face face) : m_face(face), m_empty() {}
+  ~CFont() { FT_Done_Face(m_face); }
+#endif
+
+  // Le glyphe renvoyé reste valide, à la même adresse, tant que la police
+  // existe
+  const SGlyph &GetGlyph(uint32_t nCodePoint, unsigned nSize,
+                         font_styles nStyle);
+  float GetLineSpacing(unsigned nSize);
+};
+
+// Ressources partagées par toutes les fenêtres du processus : images et
+// polices chargées
+class CResources {
+private:
+  static CResources *s_pResources;
+  static int s_nRefCount;
+  static std::mutex s_refMutex;
+
+  std::mutex m_mutex;
+  std::map<std::string, SImage> m_imageCache;
+  unsigned long long m_nImageBytes; // Pixels décodés du cache
+  std::map<std::string, std::unique_ptr<CFont>> m_fontRegistry;
+#ifdef LIBGRAPH2_HAVE_FREETYPE
+  FT_Library m_library;
+#endif
+
+  CResources();
+  ~CResources();
+
+public:
+  // Référence comptée, partagée par toutes les fenêtres
+  static CResources *Acquire();
+  static void Release();
+
+  // Renvoie la ressource, chargée au premier appel, ou NULL en cas d'erreur.
+  // Les accès au cache et les chargements sont comptés dans pStats
+  const SImage *GetImage(const std::string &strFileName,
+                         SFrameStats *pStats = NULL);
+  CFont *GetFont(const std::string &strFileName, SFrameStats *pStats = NULL);
+  // Cherche la police dans les mêmes répertoires que le moteur SFML, puis
+  // se rabat sur DejaVuSans
+  CFont *FindFont(const std::string &strFontName, SFrameStats *pStats = NULL);
+
+  // Mémoire occupée par les images décodées, en octets
+  unsigned long long GetImageBytes();
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,558 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _USE_MATH_DEFINES
+#include "LibGraph2Front.h"
+#include "LibGraph2Font.h"
+#include "LibGraph2Probes.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace LibGraph2 {
+
+// CLibGraph2Front
+
+CLibGraph2Front::CLibGraph2Front()
+    : m_bShown(false), m_nNormalisedSizeX(0), m_nNormalisedSizeY(0),
+      m_dScale(1.0), m_nOffsetX(0), m_nOffsetY(0), m_lastEvent(),
+      m_nFrames(0), m_nMaxFrames(0) {
+  // Nombre de rafraîchissements avant fermeture
+  if (const char *pszFrames = getenv("LIBGRAPH2_FRAMES"))
+    m_nMaxFrames = strtoul(pszFrames, NULL, 10);
+}
+
+CLibGraph2Front::~CLibGraph2Front() {
+  for (CRecorder *pRec : m_vRecorders)
+    delete pRec;
+}
+
+void CLibGraph2Front::SetNormalisedSize(const CSize &szSize, int &nWidth,
+                                        int &nHeight) {
+  nWidth = (int)szSize.m_fWidth;
+  nHeight = (int)szSize.m_fHeight;
+
+  if (szSize.m_fWidth * szSize.m_fHeight <= 1) {
+    m_nNormalisedSizeX = 0;
+    m_nNormalisedSizeY = 0;
+    nWidth = 800;
+    nHeight = 600;
+  } else {
+    m_nNormalisedSizeX = nWidth;
+    m_nNormalisedSizeY = nHeight;
+  }
+}
+
+void CLibGraph2Front::ComputeScaleAndOffset() {
+  if (m_nNormalisedSizeX == 0 || getPixelHeight() == 0) {
+    m_dScale = 1.0;
+    m_nOffsetX = 0;
+    m_nOffsetY = 0;
+    return;
+  }
+
+  double dNormalisedRatio = (double)m_nNormalisedSizeX / m_nNormalisedSizeY;
+  double dWindowRatio = (double)getPixelWidth() / getPixelHeight();
+
+  if (dNormalisedRatio < dWindowRatio) {
+    m_dScale = (double)getPixelHeight() / m_nNormalisedSizeY;
+    m_nOffsetY = 0;
+    m_nOffsetX = (int)((getPixelWidth() - m_dScale * m_nNormalisedSizeX) / 2);
+  } else {
+    m_dScale = (double)getPixelWidth() / m_nNormalisedSizeX;
+    m_nOffsetX = 0;
+    m_nOffsetY = (int)((getPixelHeight() - m_dScale * m_nNormalisedSizeY) / 2);
+  }
+}
+
+void CLibGraph2Front::ApplyEnvironment() { m_eventLog.ApplyEnvironment(); }
+
+CSize CLibGraph2Front::getSize() {
+  CSize ret;
+
+  if (m_nNormalisedSizeX != 0)
+    ret.m_fWidth = (float)m_nNormalisedSizeX;
+  else
+    ret.m_fWidth = (float)getPixelWidth();
+
+  if (m_nNormalisedSizeY != 0)
+    ret.m_fHeight = (float)m_nNormalisedSizeY;
+  else
+    ret.m_fHeight = (float)getPixelHeight();
+
+  return ret;
+}
+
+void CLibGraph2Front::showConsole() {
+  // Sur Linux, la console est le terminal standard
+}
+
+void CLibGraph2Front::hideConsole() {
+  // Sur Linux, la console est le terminal standard
+}
+
+void CLibGraph2Front::askForRefresh() {
+  // Les rafraîchissements sont générés en continu par waitForEvent
+}
+
+void CLibGraph2Front::beginPaint() {
+  LIBGRAPH2_PROBE0(frame__begin);
+  for (CRecorder *pRec : m_vRecorders)
+    pRec->SetTransform(m_dScale, m_nOffsetX, m_nOffsetY);
+}
+
+bool CLibGraph2Front::startEventRecording(const CString &sFileName) {
+  return m_eventLog.StartRecording(std::string(sFileName));
+}
+
+void CLibGraph2Front::stopEventRecording() { m_eventLog.StopRecording(); }
+
+bool CLibGraph2Front::startEventReplay(const CString &sFileName,
+                                       bool bMaxSpeed) {
+  return m_eventLog.StartReplay(std::string(sFileName), bMaxSpeed);
+}
+
+// Enregistreurs de commandes
+
+ILibGraph2Recorder *CLibGraph2Front::createRecorder() {
+  CRecorder *pRec = new CRecorder;
+  pRec->SetTransform(m_dScale, m_nOffsetX, m_nOffsetY);
+  m_vRecorders.push_back(pRec);
+  return pRec;
+}
+
+void CLibGraph2Front::releaseRecorder(ILibGraph2Recorder *pRecorder) {
+  auto it = std::find(m_vRecorders.begin(), m_vRecorders.end(), pRecorder);
+  if (it == m_vRecorders.end())
+    return;
+  delete *it;
+  m_vRecorders.erase(it);
+}
+
+// Boîtes de dialogue : aucune interaction possible sans boîte à outils
+
+bool CLibGraph2Front::guiGetFileName(CString &sFileName, bool bOpen,
+                                     const std::vector<CString> &vstrFileTypes) {
+  return false;
+}
+
+bool CLibGraph2Front::guiGetColor(ARGB &color) { return false; }
+
+bool CLibGraph2Front::guiGetPenStyle(ARGB &color, float &fWidth,
+                                     pen_DashStyles &style) {
+  return false;
+}
+
+bool CLibGraph2Front::guiGetFont(CString &strFontName, float &fPointSize,
+                                 font_styles &nStyleFlags) {
+  return false;
+}
+
+bool CLibGraph2Front::guiGetValue(CString &strVal, const CString &strTitle,
+                                  const CString &strLabel) {
+  return false;
+}
+
+bool CLibGraph2Front::guiGetValue(int &nVal, const CString &strTitle,
+                                  const CString &strLabel) {
+  return false;
+}
+
+bool CLibGraph2Front::guiGetValue(double &dVal, const CString &strTitle,
+                                  const CString &strLabel) {
+  return false;
+}
+
+msgbtn_answer CLibGraph2Front::guiMessageBox(const CString &strTitle,
+                                             const CString &strText,
+                                             msgbtn_types btns,
+                                             msgicon_types icon,
+                                             msgdefbtn_vals defbtn) {
+  // Le message est au moins visible dans les journaux
+  std::cerr << "[" << std::string(strTitle) << "] " << std::string(strText)
+            << std::endl;
+  return msgbtn_answer::MsgAnsOk;
+}
+
+// CLibGraph2Painter
+
+CLibGraph2Painter::CLibGraph2Painter()
+    : m_pResources(NULL), m_penColor(MakeARGB(255, 0, 0, 0)),
+      m_fPenThickness(1.0f), m_brushColor(0),
+      m_outlineColor(MakeARGB(255, 0, 0, 0)), m_outlineThickness(1.0f),
+      m_fillColor(0), m_penStyle(pen_DashStyles::Solid), m_pFont(NULL),
+      m_fontSize(10.0f), m_fontStyle(FontStyleRegular),
+      m_bBackBuffered(false) {
+  m_pResources = CResources::Acquire();
+
+  // Charger une police par défaut
+  std::string defaultFont = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+  if (!(m_pFont = m_pResources->GetFont(defaultFont)))
+    std::cerr << "LibGraph2 : police par défaut indisponible : " << defaultFont
+              << std::endl;
+}
+
+// Le moteur a déjà libéré ce qui dépend de son image
+CLibGraph2Painter::~CLibGraph2Painter() {
+  stopVideoOutput();
+  stopFrameServer();
+  CResources::Release();
+}
+
+void CLibGraph2Painter::ApplyEnvironment() {
+  CLibGraph2Front::ApplyEnvironment();
+  if (const char *pszStream = getenv("LIBGRAPH2_STREAM"))
+    startFrameServer(pszStream);
+}
+
+void CLibGraph2Painter::beginPaint() {
+  CTraceScope trace("beginPaint");
+  m_bBackBuffered = true;
+  CLibGraph2Front::beginPaint();
+}
+
+void CLibGraph2Painter::MergeRecorders() {
+  CTraceScope trace("MergeRecorders");
+  // Les commandes enregistrées sont exécutées ici : c'est du dessin
+  CStatsScope scope(m_stats.App().dDrawMs);
+  bool bMerged = false;
+  for (CRecorder *pRec : m_vRecorders) {
+    if (pRec->HasDrawing()) {
+      pRec->buffer().forEach([this](cmd_op op, const uint8_t *p, size_t n) {
+        DispatchCommand(*this, op, p, n);
+      });
+      bMerged = true;
+    }
+    pRec->Reset();
+  }
+
+  // Les enregistreurs ont modifié le crayon et le pinceau de la fenêtre
+  if (bMerged) {
+    CmdSetPen(m_penColor, m_fPenThickness);
+    CmdSetBrush(m_brushColor);
+    if (!m_strBrushTexture.empty())
+      CmdSetTextureBrush(m_strBrushTexture);
+  }
+}
+
+// Sortie vidéo et serveur de diffusion
+
+bool CLibGraph2Painter::startVideoOutput(const CString &sFileName,
+                                         video_format format,
+                                         unsigned nFrameRate) {
+  stopVideoOutput();
+  m_pVideo.reset(new CVideoWriter);
+  if (!m_pVideo->Open(std::string(sFileName), format, nFrameRate)) {
+    m_pVideo.reset();
+    return false;
+  }
+  return true;
+}
+
+void CLibGraph2Painter::stopVideoOutput() {
+  if (!m_pVideo)
+    return;
+  FlushCapture();
+  m_pVideo->Close();
+  m_pVideo.reset();
+}
+
+bool CLibGraph2Painter::startFrameServer(const CString &sAddress) {
+  stopFrameServer();
+  m_pServer.reset(new CFrameServer);
+  if (!m_pServer->Open(std::string(sAddress))) {
+    m_pServer.reset();
+    return false;
+  }
+  return true;
+}
+
+void CLibGraph2Painter::stopFrameServer() {
+  if (!m_pServer)
+    return;
+  FlushCapture();
+  m_pServer->Close();
+  m_pServer.reset();
+}
+
+// Fonctions de dessin
+
+void CLibGraph2Painter::setPen(ARGB color, float fWidth,
+                               pen_DashStyles style) {
+  CTraceScope trace("setPen");
+  m_penColor = color;
+  m_fPenThickness = (float)(fWidth * m_dScale);
+  m_penStyle = style;
+  // Note: les styles pointillés ne sont pas gérés, comme avec SFML
+  CmdSetPen(m_penColor, m_fPenThickness);
+}
+
+void CLibGraph2Painter::setSolidBrush(ARGB color) {
+  CTraceScope trace("setSolidBrush");
+  m_brushColor = color;
+  m_strBrushTexture.clear();
+  CmdSetBrush(color);
+}
+
+void CLibGraph2Painter::setTextureBrush(const CString &sFileName) {
+  CTraceScope trace("setTextureBrush");
+  m_strBrushTexture = std::string(sFileName);
+  CmdSetTextureBrush(m_strBrushTexture);
+}
+
+void CLibGraph2Painter::drawLine(const CPoint &ptP1, const CPoint &ptP2) {
+  CTraceScope trace("drawLine");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdLine c = {UnmapCoordinateX(ptP1.m_fX), UnmapCoordinateY(ptP1.m_fY),
+                UnmapCoordinateX(ptP2.m_fX), UnmapCoordinateY(ptP2.m_fY)};
+  CmdLine(c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::drawRectangle(const CRectangle &bounds) {
+  CTraceScope trace("drawRectangle");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdRect c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+                UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+                UnmapWidth(bounds.m_szSize.m_fWidth),
+                UnmapHeight(bounds.m_szSize.m_fHeight)};
+  CmdRectangle(c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::drawEllipse(const CRectangle &bounds) {
+  CTraceScope trace("drawEllipse");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdRect c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+                UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+                UnmapWidth(bounds.m_szSize.m_fWidth),
+                UnmapHeight(bounds.m_szSize.m_fHeight)};
+  CmdEllipse(c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::drawArc(const CRectangle &bounds, float startAngle,
+                                float sweepAngle) {
+  CTraceScope trace("drawArc");
+  if (!m_bShown)
+    return;
+
+  // Points de l'arc de drawPie(), tracés comme une ligne brisée ouverte :
+  // ni segments vers le centre, ni remplissage
+  CStatsScope scope(m_stats.App().dDrawMs);
+  const int segments = 50;
+  float x = UnmapCoordinateX(bounds.m_ptTopLeft.m_fX);
+  float y = UnmapCoordinateY(bounds.m_ptTopLeft.m_fY);
+  float radiusX = UnmapWidth(bounds.m_szSize.m_fWidth) / 2.0f;
+  float radiusY = UnmapHeight(bounds.m_szSize.m_fHeight) / 2.0f;
+  float startRad = startAngle * M_PI / 180.0f;
+  float sweepRad = sweepAngle * M_PI / 180.0f;
+  m_vScratch.resize(2 * (segments + 1));
+  for (int i = 0; i <= segments; i++) {
+    float angle = startRad + (sweepRad * i / segments);
+    m_vScratch[2 * i] = x + radiusX + radiusX * cos(angle);
+    m_vScratch[2 * i + 1] = y + radiusY + radiusY * sin(angle);
+  }
+  CmdPolyline(m_vScratch.data(), segments + 1, false);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::drawPie(const CRectangle &bounds, float startAngle,
+                                float sweepAngle) {
+  CTraceScope trace("drawPie");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdPie c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+               UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+               UnmapWidth(bounds.m_szSize.m_fWidth),
+               UnmapHeight(bounds.m_szSize.m_fHeight),
+               startAngle,
+               sweepAngle};
+  CmdPie(c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::drawPolylines(const std::vector<CPoint> &vPoints,
+                                      bool bAutoClose) {
+  CTraceScope trace("drawPolylines");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  m_vScratch.resize(vPoints.size() * 2);
+  for (size_t i = 0; i < vPoints.size(); i++) {
+    m_vScratch[2 * i] = UnmapCoordinateX(vPoints[i].m_fX);
+    m_vScratch[2 * i + 1] = UnmapCoordinateY(vPoints[i].m_fY);
+  }
+  CmdPolyline(m_vScratch.data(), (uint32_t)vPoints.size(), bAutoClose);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::setPixel(const CPoint &ptPos, ARGB color) {
+  CTraceScope trace("setPixel");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdPixel c = {UnmapCoordinateX(ptPos.m_fX), UnmapCoordinateY(ptPos.m_fY),
+                 color};
+  CmdPixel(c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::setFont(const CString &strFontName, float fPointSize,
+                                font_styles nStyleFlags) {
+  CTraceScope trace("setFont");
+  CStatsScope scope(m_stats.App().dDrawMs);
+  CmdSetFont(std::string(strFontName), (float)(fPointSize * m_dScale),
+             nStyleFlags);
+}
+
+void CLibGraph2Painter::drawString(const CString &text, const CPoint &ptPos) {
+  CTraceScope trace("drawString");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  CmdString(*text.operator->(), UnmapCoordinateX(ptPos.m_fX),
+            UnmapCoordinateY(ptPos.m_fY));
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::getStringDimension(const CString &text,
+                                           const CPoint &ptPos,
+                                           CRectangle &rectBounds) {
+  CTraceScope trace("getStringDimension");
+  if (!m_pFont)
+    return;
+
+  // Même calcul que sf::Text::getLocalBounds()
+  const std::wstring &str = *text.operator->();
+  unsigned nSize = (unsigned)m_fontSize;
+  float fLineSpacing = m_pFont->GetLineSpacing(nSize);
+  float x = 0, y = (float)nSize;
+  float fMinX = (float)nSize, fMinY = (float)nSize, fMaxX = 0, fMaxY = 0;
+  for (wchar_t ch : str) {
+    if (ch == L'\n') {
+      x = 0;
+      y += fLineSpacing;
+      continue;
+    }
+    const CFont::SGlyph &g = m_pFont->GetGlyph(ch, nSize, m_fontStyle);
+    if (g.nWidth > 0) {
+      fMinX = std::min(fMinX, x + g.nLeft);
+      fMaxX = std::max(fMaxX, x + g.nLeft + g.nWidth);
+      fMinY = std::min(fMinY, y - g.nTop);
+      fMaxY = std::max(fMaxY, y - g.nTop + g.nHeight);
+    }
+    x += g.fAdvance;
+  }
+  if (fMaxX < fMinX)
+    fMinX = fMaxX = fMinY = fMaxY = 0;
+
+  rectBounds.m_ptTopLeft.m_fX = MapCoordinateX(fMinX);
+  rectBounds.m_ptTopLeft.m_fY = MapCoordinateY(fMinY);
+  rectBounds.m_szSize.m_fWidth = MapWidth(fMaxX - fMinX);
+  rectBounds.m_szSize.m_fHeight = MapHeight(fMaxY - fMinY);
+}
+
+void CLibGraph2Painter::drawBitmap(const CString &sFileName,
+                                   const CPoint &ptPos, double dScaleFactor,
+                                   double dAngleDeg, bool bXYIsCenter) {
+  CTraceScope trace("drawBitmap");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdBitmap c = {UnmapCoordinateX(ptPos.m_fX),
+                  UnmapCoordinateY(ptPos.m_fY),
+                  0,
+                  0,
+                  (float)(dScaleFactor * m_dScale),
+                  (float)dAngleDeg,
+                  bXYIsCenter ? bitmap_origin::Center : bitmap_origin::TopLeft,
+                  0};
+  CmdBitmap(std::string(sFileName), c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+void CLibGraph2Painter::drawBitmap(const CString &sFileName,
+                                   const CPoint &ptPos,
+                                   const CPoint &ptPosPivot,
+                                   double dScaleFactor, double dAngleDeg) {
+  CTraceScope trace("drawBitmap");
+  if (!m_bShown)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdBitmap c = {UnmapCoordinateX(ptPos.m_fX),
+                  UnmapCoordinateY(ptPos.m_fY),
+                  ptPosPivot.m_fX,
+                  ptPosPivot.m_fY,
+                  (float)(dScaleFactor * m_dScale),
+                  (float)dAngleDeg,
+                  bitmap_origin::Pivot,
+                  0};
+  CmdBitmap(std::string(sFileName), c);
+  if (!m_bBackBuffered)
+    OnImmediateDraw();
+}
+
+// Exécution des commandes d'état
+
+void CLibGraph2Painter::CmdSetPen(ARGB color, float fThickness) {
+  m_outlineColor = color;
+  m_outlineThickness = fThickness;
+}
+
+void CLibGraph2Painter::CmdSetBrush(ARGB color) {
+  m_fillColor = color;
+  CmdSetTextureBrush(std::string());
+}
+
+void CLibGraph2Painter::CmdSetFont(const std::string &fontName, float fSize,
+                                   font_styles nStyle) {
+  m_fontSize = fSize;
+  m_fontStyle = nStyle;
+
+  CFont *pFont = m_pResources->FindFont(fontName, &m_stats.Render());
+  if (pFont)
+    m_pFont = pFont;
+}
+
+} // namespace LibGraph2
@@ -0,0 +1,439 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : code commun aux moteurs. Liste des
+// fenêtres (CWindowList), lectures asynchrones (SReadback), fenêtre des
+// moteurs logiciel, OpenGL et nul (CLibGraph2Front), et dessin par
+// exécution immédiate des commandes (CLibGraph2Painter).
+
+#include "LibGraph2.h"
+#include "LibGraph2Commands.h"
+#include "LibGraph2EventLog.h"
+#include "LibGraph2Overlay.h"
+#include "LibGraph2Recorder.h"
+#include "LibGraph2Stats.h"
+#include "LibGraph2Stream.h"
+#include "LibGraph2Trace.h"
+#include "LibGraph2Video.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LibGraph2 {
+
+class CResources;
+class CFont;
+
+/*
+ * Fenêtres d'un moteur : fenêtre par défaut (celle des fonctions
+ * GetLibGraph2()), fenêtres supplémentaires, et attente d'un événement sur
+ * l'ensemble.
+ *
+ * T dérive de CWindowList<T> et la déclare amie : son constructeur et son
+ * destructeur sont privés, et le destructeur est appelé avec le verrou de la
+ * liste. T fournit ApplyEnvironment(), appelée à la création de la fenêtre
+ * par défaut, ainsi que IsServed() et waitForEvent() pour WaitForAnyEvent().
+ */
+template <class T> class CWindowList {
+private:
+  // Fenêtre par défaut
+  static T *s_pInstance;
+  // Toutes les fenêtres, dans l'ordre de création
+  static std::vector<T *> s_vWindows;
+  // Protège la création et la libération des fenêtres
+  static std::mutex s_mutex;
+
+protected:
+  // Prochaine fenêtre à examiner par WaitForAnyEvent()
+  static size_t s_nNextWindow;
+
+  // Copie de la liste des fenêtres : la fenêtre servie peut en libérer
+  static std::vector<T *> GetWindows() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_vWindows;
+  }
+
+public:
+  static T *GetInstance() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_pInstance == NULL) {
+      s_pInstance = new T;
+      s_vWindows.push_back(s_pInstance);
+      // Permet d'enregistrer ou de rejouer une session sans modifier le
+      // programme
+      s_pInstance->ApplyEnvironment();
+    }
+    return s_pInstance;
+  }
+
+  static void ReleaseInstance() { ReleaseWindowInstance(s_pInstance); }
+
+  static T *CreateWindowInstance() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    T *pWindow = new T;
+    s_vWindows.push_back(pWindow);
+    return pWindow;
+  }
+
+  static void ReleaseWindowInstance(T *pWindow) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto it = std::find(s_vWindows.begin(), s_vWindows.end(), pWindow);
+    if (it == s_vWindows.end())
+      return;
+    s_vWindows.erase(it);
+    if (pWindow == s_pInstance)
+      s_pInstance = NULL;
+    delete pWindow;
+  }
+
+  // Attend un événement sur l'ensemble des fenêtres, examinées à tour de
+  // rôle. Chaque fenêtre rejoue son propre journal, comme avec
+  // waitForEvent()
+  static T *WaitForAnyEvent(evt &e) {
+    CTraceScope trace("waitForAnyEvent");
+    std::vector<T *> vWindows = GetWindows();
+    size_t nWindows = vWindows.size();
+
+    for (size_t i = 0; i < nWindows; i++) {
+      T *pWindow = vWindows[(s_nNextWindow + i) % nWindows];
+      if (pWindow->IsServed()) {
+        s_nNextWindow = (s_nNextWindow + i + 1) % nWindows;
+        pWindow->waitForEvent(e);
+        return pWindow;
+      }
+    }
+
+    return NULL;
+  }
+};
+
+template <class T> T *CWindowList<T>::s_pInstance = NULL;
+template <class T> std::vector<T *> CWindowList<T>::s_vWindows;
+template <class T> std::mutex CWindowList<T>::s_mutex;
+template <class T> size_t CWindowList<T>::s_nNextWindow = 0;
+
+/*
+ * Lecture demandée par requestReadback(), en pixels, origine en haut à
+ * gauche.
+ */
+struct SReadback {
+  int x, y, nWidth, nHeight;
+  readback_callback callback;
+  int nSlot; // Emplacement du pool, -1 tant que la lecture n'est pas lancée
+
+  SReadback() : x(0), y(0), nWidth(0), nHeight(0), nSlot(-1) {}
+  // Rectangle en pixels, arrondi vers l'extérieur
+  SReadback(float fX, float fY, float fWidth, float fHeight,
+            const readback_callback &cb)
+      : x((int)floorf(fX)), y((int)floorf(fY)), nWidth((int)ceilf(fWidth)),
+        nHeight((int)ceilf(fHeight)), callback(cb), nSlot(-1) {}
+
+  // Limite le rectangle à une image de nFrameWidth x nFrameHeight pixels.
+  // Renvoie false s'il n'en reste rien
+  bool Clip(int nFrameWidth, int nFrameHeight) {
+    int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    int x1 = std::min(x + nWidth, nFrameWidth);
+    int y1 = std::min(y + nHeight, nFrameHeight);
+    if (x1 <= x0 || y1 <= y0)
+      return false;
+    x = x0;
+    y = y0;
+    nWidth = x1 - x0;
+    nHeight = y1 - y0;
+    return true;
+  }
+};
+
+/*
+ * Partie commune des moteurs logiciel, OpenGL et nul.
+ *
+ * Coordonnées normalisées de show(), dernier événement, journal des
+ * événements, nombre de rafraîchissements (limité par LIBGRAPH2_FRAMES),
+ * durées d'image et enregistreurs de commandes. Aucune boîte de dialogue
+ * n'est disponible : elles sont annulées, et guiMessageBox() écrit le
+ * message sur la sortie d'erreur.
+ *
+ * Le moteur donne la taille de son image en pixels (getPixelWidth(),
+ * getPixelHeight()) et implémente le reste de ILibGraph2_Exp.
+ */
+class CLibGraph2Front : public ILibGraph2_Adv, public ILibGraph2_Exp {
+protected:
+  bool m_bShown;
+
+  // Système de coordonnées normalisées
+  int m_nNormalisedSizeX;
+  int m_nNormalisedSizeY;
+  double m_dScale;
+  int m_nOffsetX;
+  int m_nOffsetY;
+
+  // Dernier événement
+  evt m_lastEvent;
+
+  // Enregistrement / rejeu des événements
+  CEventLog m_eventLog;
+
+  // Durées d'image et latences renvoyées par getFrameTimes() et
+  // getInputLatency()
+  CFrameTimes m_frameTimes;
+
+  // Nombre de rafraîchissements générés, et limite (0 : aucune)
+  unsigned long m_nFrames;
+  unsigned long m_nMaxFrames;
+
+  // Enregistreurs de commandes, dans l'ordre de soumission
+  std::vector<CRecorder *> m_vRecorders;
+
+protected:
+  CLibGraph2Front(void);
+  virtual ~CLibGraph2Front(void);
+
+  // Fonctions de conversion de coordonnées
+  float MapCoordinateX(float nPixelX) {
+    return (float)((nPixelX - m_nOffsetX) / m_dScale);
+  }
+  float MapCoordinateY(float nPixelY) {
+    return (float)((nPixelY - m_nOffsetY) / m_dScale);
+  }
+  float UnmapCoordinateX(float fNormalisedX) {
+    return (float)(fNormalisedX * m_dScale + m_nOffsetX);
+  }
+  float UnmapCoordinateY(float fNormalisedY) {
+    return (float)(fNormalisedY * m_dScale + m_nOffsetY);
+  }
+  float MapWidth(float nPixelWidth) { return (float)(nPixelWidth / m_dScale); }
+  float MapHeight(float nPixelHeight) {
+    return (float)(nPixelHeight / m_dScale);
+  }
+  float UnmapWidth(float fNormalisedWidth) {
+    return (float)(fNormalisedWidth * m_dScale);
+  }
+  float UnmapHeight(float fNormalisedHeight) {
+    return (float)(fNormalisedHeight * m_dScale);
+  }
+
+  // Taille de l'image, en pixels
+  virtual int getPixelWidth() = 0;
+  virtual int getPixelHeight() = 0;
+  // Retient le système de coordonnées demandé à show() et renvoie la taille
+  // de l'image à créer (800 x 600 sans taille)
+  void SetNormalisedSize(const CSize &szSize, int &nWidth, int &nHeight);
+  void ComputeScaleAndOffset();
+
+  // Vrai si WaitForAnyEvent() doit servir la fenêtre : affichée, ou
+  // rejouant un journal
+  bool IsServed() const { return m_bShown || m_eventLog.IsReplaying(); }
+  // Applique les variables d'environnement à la fenêtre par défaut
+  virtual void ApplyEnvironment();
+
+public:
+  // Implémentation de ILibGraph2_Com
+  virtual CSize getSize();
+  virtual void showConsole();
+  virtual void hideConsole();
+  virtual void askForRefresh();
+  virtual void beginPaint();
+  virtual const evt &getLastEvent() const override { return m_lastEvent; }
+  virtual bool startEventRecording(const CString &sFileName);
+  virtual void stopEventRecording();
+  virtual bool startEventReplay(const CString &sFileName,
+                                bool bMaxSpeed = false);
+  virtual ILibGraph2Recorder *createRecorder();
+  virtual void releaseRecorder(ILibGraph2Recorder *pRecorder);
+  virtual void getFrameTimes(SFrameTimes &interval, SFrameTimes &response,
+                             double dBudgetMs = 1000.0 / 60) {
+    m_frameTimes.Get(interval, response, dBudgetMs);
+  }
+  virtual void getInputLatency(SInputLatency &latency, double dBudgetMs = 50) {
+    m_frameTimes.GetInputLatency(latency, dBudgetMs);
+  }
+  virtual void resetFrameTimes() { m_frameTimes.Reset(); }
+
+  // Boîtes de dialogue (non disponibles sans SFML)
+  virtual bool guiGetFileName(
+      CString &sFileName, bool bOpen = true,
+      const std::vector<CString> &vstrFileTypes = std::vector<CString>());
+  virtual bool guiGetColor(ARGB &color);
+  virtual bool guiGetPenStyle(ARGB &color, float &fWidth,
+                              pen_DashStyles &style);
+  virtual bool guiGetFont(CString &strFontName, float &fPointSize,
+                          font_styles &nStyleFlags);
+  virtual bool guiGetValue(CString &strVal, const CString &strTitle = L"",
+                           const CString &strLabel = L"");
+  virtual bool guiGetValue(int &nVal, const CString &strTitle = L"",
+                           const CString &strLabel = L"");
+  virtual bool guiGetValue(double &dVal, const CString &strTitle = L"",
+                           const CString &strLabel = L"");
+  virtual msgbtn_answer
+  guiMessageBox(const CString &strTitle = L"", const CString &strText = L"",
+                msgbtn_types btns = msgbtn_types::MsgBtnOK,
+                msgicon_types icon = msgicon_types::MsgIcnNone,
+                msgdefbtn_vals defbtn = msgdefbtn_vals::MsgDefBtn1);
+
+  // Fonctions de compatibilité pour pointeurs
+  virtual void drawPolylines(CPoint *pPoints, int nNbPoints,
+                             bool bAutoClose = false) {
+    // Portée externe : la copie des points est comptée pour drawPolylines
+    CTraceScope trace("drawPolylines");
+    drawPolylines(std::vector<CPoint>(pPoints, pPoints + nNbPoints),
+                  bAutoClose);
+  }
+  virtual bool guiGetFileName(CString &sFileName, bool bOpen = true,
+                              CString *pstrFileTypes = NULL,
+                              int nNbFileTypes = 0) {
+    return guiGetFileName(
+        sFileName, bOpen,
+        std::vector<CString>(pstrFileTypes, pstrFileTypes + nNbFileTypes));
+  }
+  using ILibGraph2_Exp::drawPolylines;
+};
+
+/*
+ * Partie commune des moteurs logiciel et OpenGL : les fonctions de dessin
+ * convertissent leurs arguments en pixels et exécutent aussitôt la commande
+ * correspondante (Cmd*()), comme MergeRecorders() pour les commandes des
+ * enregistreurs. Crayon, pinceau et police, sortie vidéo, serveur de
+ * diffusion, compteurs et surimpression des performances sont communs.
+ */
+class CLibGraph2Painter : public CLibGraph2Front {
+protected:
+  CResources *m_pResources;
+
+  // Crayon et pinceau courants, côté application (pour les restaurer après
+  // avoir rejoué les enregistreurs)
+  ARGB m_penColor;
+  float m_fPenThickness;
+  ARGB m_brushColor;
+  // Image du pinceau texturé (vide pour un pinceau uni)
+  std::string m_strBrushTexture;
+
+  // Attributs de dessin actuels, en pixels
+  ARGB m_outlineColor;
+  float m_outlineThickness;
+  ARGB m_fillColor;
+  pen_DashStyles m_penStyle;
+
+  // Police de caractères (appartient à CResources)
+  CFont *m_pFont;
+  float m_fontSize;
+  font_styles m_fontStyle;
+
+  bool m_bBackBuffered;
+
+  // Sortie vidéo et serveur de diffusion (NULL si inactifs)
+  std::unique_ptr<CVideoWriter> m_pVideo;
+  std::unique_ptr<CFrameServer> m_pServer;
+
+  // Compteurs renvoyés par getFrameStats()
+  CFrameStats m_stats;
+  // Surimpression des performances
+  CPerfOverlay m_overlay;
+
+  // Tampon de travail réutilisé
+  std::vector<float> m_vScratch;
+
+protected:
+  CLibGraph2Painter(void);
+  virtual ~CLibGraph2Painter(void);
+
+  // Démarre aussi le serveur de diffusion de LIBGRAPH2_STREAM
+  virtual void ApplyEnvironment();
+
+  // Rejoue les enregistreurs dans l'ordre de soumission
+  void MergeRecorders();
+  // Appelée après un dessin fait hors de beginPaint()/endPaint()
+  virtual void OnImmediateDraw() {}
+  // Appelée avant de fermer la sortie vidéo ou le serveur de diffusion,
+  // pour leur transmettre l'image encore en cours de lecture
+  virtual void FlushCapture() {}
+
+  // Exécution des commandes de dessin (coordonnées en pixels), appelées
+  // directement ou via DispatchCommand() pour les enregistreurs
+  template <typename V>
+  friend void DispatchCommand(V &visitor, cmd_op op, const uint8_t *p,
+                              size_t nSize);
+  void CmdSetPen(ARGB color, float fThickness);
+  void CmdSetBrush(ARGB color);
+  // Pinceau texturé : l'image remplace la couleur du pinceau pour le
+  // remplissage des formes, répétée depuis le coin de l'image dessinée. Un
+  // nom vide revient au pinceau uni
+  virtual void CmdSetTextureBrush(const std::string &strFileName) = 0;
+  void CmdSetFont(const std::string &strFontName, float fSize,
+                  font_styles nStyle);
+  virtual void CmdClear(ARGB color) = 0;
+  virtual void CmdLine(const SCmdLine &c) = 0;
+  virtual void CmdRectangle(const SCmdRect &c) = 0;
+  virtual void CmdEllipse(const SCmdRect &c) = 0;
+  virtual void CmdPie(const SCmdPie &c) = 0;
+  virtual void CmdPixel(const SCmdPixel &c) = 0;
+  virtual void CmdPolyline(const float *pCoords, uint32_t nCount,
+                           bool bAutoClose) = 0;
+  virtual void CmdString(const std::wstring &text, float x, float y) = 0;
+  virtual void CmdBitmap(const std::string &strFileName,
+                         const SCmdBitmap &c) = 0;
+  virtual void CmdDisplay() = 0;
+
+public:
+  virtual void beginPaint();
+  virtual bool startVideoOutput(const CString &sFileName,
+                                video_format format = video_format::Y4M,
+                                unsigned nFrameRate = 60);
+  virtual void stopVideoOutput();
+  virtual bool startFrameServer(const CString &sAddress);
+  virtual void stopFrameServer();
+  virtual SFrameStats getFrameStats() { return m_stats.Get(); }
+  virtual void getFrameAllocations(std::vector<SAllocationStats> &vAllocations) {
+    m_stats.GetAllocations(vAllocations);
+  }
+  virtual void showPerformanceOverlay(bool bShow) { m_overlay.Show(bShow); }
+
+  // Fonctions de dessin
+  virtual void setPen(ARGB color, float fWidth,
+                      pen_DashStyles style = pen_DashStyles::Solid);
+  virtual void setSolidBrush(ARGB color);
+  virtual void drawArc(const CRectangle &rectBounds, float startAngle,
+                       float sweepAngle);
+  virtual void drawEllipse(const CRectangle &rectBounds);
+  virtual void drawLine(const CPoint &ptP1, const CPoint &ptP2);
+  virtual void drawPie(const CRectangle &rectBounds, float startAngle,
+                       float sweepAngle);
+  virtual void drawRectangle(const CRectangle &rectBounds);
+  virtual void setPixel(const CPoint &ptPos, ARGB color);
+  virtual void drawPolylines(const std::vector<CPoint> &vPoints,
+                             bool bAutoClose = false);
+  using CLibGraph2Front::drawPolylines;
+
+  // Fonctions avancées
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          double dScaleFactor = 1.0, double dAngleDeg = 0,
+                          bool bXYIsCenter = false);
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          const CPoint &ptPosPivot, double dScaleFactor,
+                          double dAngleDeg);
+  virtual void setTextureBrush(const CString &sFileName);
+  virtual void setFont(const CString &strFontName, float fPointSize,
+                       font_styles nStyleFlags);
+  virtual void drawString(const CString &text, const CPoint &ptPos);
+  virtual void getStringDimension(const CString &text, const CPoint &ptPos,
+                                  CRectangle &rectBounds);
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,430 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if defined(LIBGRAPH2_USE_SFML) || defined(LIBGRAPH2_USE_OPENGL)
+#include "LibGraph2GL.h"
+#include <cstdio>
+#include <cstring>
+
+namespace LibGraph2 {
+
+// Chargement des fonctions
+
+SGLFunctions::SGLFunctions() { memset(this, 0, sizeof *this); }
+
+template <typename T>
+static bool LoadFunction(PFNGETPROCADDRESS pfnGetProc, T &pfn,
+                         const char *pszName) {
+  pfn = reinterpret_cast<T>(pfnGetProc(pszName));
+  return pfn != nullptr;
+}
+
+bool SGLFunctions::Load(PFNGETPROCADDRESS pfnGetProc) {
+  if (bLoaded)
+    return true;
+
+  const char *pszVersion = (const char *)glGetString(GL_VERSION);
+  if (!pszVersion)
+    return false; // Aucun contexte actif
+  int nMajor = 0, nMinor = 0;
+  sscanf(pszVersion, "%d.%d", &nMajor, &nMinor);
+  int nVersion = nMajor * 10 + nMinor;
+  LoadFunction(pfnGetProc, GetStringi, "glGetStringi");
+
+  bool bBuffers = LoadFunction(pfnGetProc, GenBuffers, "glGenBuffers") &&
+                  LoadFunction(pfnGetProc, DeleteBuffers, "glDeleteBuffers") &&
+                  LoadFunction(pfnGetProc, BindBuffer, "glBindBuffer") &&
+                  LoadFunction(pfnGetProc, BufferData, "glBufferData") &&
+                  LoadFunction(pfnGetProc, MapBuffer, "glMapBuffer") &&
+                  LoadFunction(pfnGetProc, UnmapBuffer, "glUnmapBuffer");
+  bPixelBuffers = bBuffers && (nVersion >= 21 ||
+                               HasExtension("GL_ARB_pixel_buffer_object"));
+  bSync = LoadFunction(pfnGetProc, FenceSync, "glFenceSync") &&
+          LoadFunction(pfnGetProc, ClientWaitSync, "glClientWaitSync") &&
+          LoadFunction(pfnGetProc, DeleteSync, "glDeleteSync") &&
+          (nVersion >= 32 || HasExtension("GL_ARB_sync"));
+
+  // Le moteur OpenGL n'utilise que le profil core : tout ou rien
+  const struct {
+    GLProc *ppfn;
+    const char *pszName;
+  } core[] = {
+      {(GLProc *)&BufferSubData, "glBufferSubData"},
+      {(GLProc *)&GenVertexArrays, "glGenVertexArrays"},
+      {(GLProc *)&DeleteVertexArrays, "glDeleteVertexArrays"},
+      {(GLProc *)&BindVertexArray, "glBindVertexArray"},
+      {(GLProc *)&EnableVertexAttribArray, "glEnableVertexAttribArray"},
+      {(GLProc *)&VertexAttribPointer, "glVertexAttribPointer"},
+      {(GLProc *)&CreateShader, "glCreateShader"},
+      {(GLProc *)&ShaderSource, "glShaderSource"},
+      {(GLProc *)&CompileShader, "glCompileShader"},
+      {(GLProc *)&GetShaderiv, "glGetShaderiv"},
+      {(GLProc *)&GetShaderInfoLog, "glGetShaderInfoLog"},
+      {(GLProc *)&DeleteShader, "glDeleteShader"},
+      {(GLProc *)&CreateProgram, "glCreateProgram"},
+      {(GLProc *)&AttachShader, "glAttachShader"},
+      {(GLProc *)&BindAttribLocation, "glBindAttribLocation"},
+      {(GLProc *)&LinkProgram, "glLinkProgram"},
+      {(GLProc *)&GetProgramiv, "glGetProgramiv"},
+      {(GLProc *)&GetProgramInfoLog, "glGetProgramInfoLog"},
+      {(GLProc *)&UseProgram, "glUseProgram"},
+      {(GLProc *)&DeleteProgram, "glDeleteProgram"},
+      {(GLProc *)&GetUniformLocation, "glGetUniformLocation"},
+      {(GLProc *)&Uniform1i, "glUniform1i"},
+      {(GLProc *)&Uniform2f, "glUniform2f"},
+      {(GLProc *)&ActiveTexture, "glActiveTexture"},
+      {(GLProc *)&BlendFuncSeparate, "glBlendFuncSeparate"},
+      {(GLProc *)&GenFramebuffers, "glGenFramebuffers"},
+      {(GLProc *)&DeleteFramebuffers, "glDeleteFramebuffers"},
+      {(GLProc *)&BindFramebuffer, "glBindFramebuffer"},
+      {(GLProc *)&FramebufferRenderbuffer, "glFramebufferRenderbuffer"},
+      {(GLProc *)&CheckFramebufferStatus, "glCheckFramebufferStatus"},
+      {(GLProc *)&BlitFramebuffer, "glBlitFramebuffer"},
+      {(GLProc *)&GenRenderbuffers, "glGenRenderbuffers"},
+      {(GLProc *)&DeleteRenderbuffers, "glDeleteRenderbuffers"},
+      {(GLProc *)&BindRenderbuffer, "glBindRenderbuffer"},
+      {(GLProc *)&RenderbufferStorage, "glRenderbufferStorage"},
+  };
+  bCore = bBuffers && bSync && nVersion >= 33;
+  for (const auto &fn : core)
+    bCore = LoadFunction(pfnGetProc, *fn.ppfn, fn.pszName) && bCore;
+
+  bBufferStorage =
+      bCore && LoadFunction(pfnGetProc, BufferStorage, "glBufferStorage") &&
+      LoadFunction(pfnGetProc, MapBufferRange, "glMapBufferRange") &&
+      (nVersion >= 44 || HasExtension("GL_ARB_buffer_storage"));
+
+  bTimerQuery =
+      LoadFunction(pfnGetProc, GenQueries, "glGenQueries") &&
+      LoadFunction(pfnGetProc, DeleteQueries, "glDeleteQueries") &&
+      LoadFunction(pfnGetProc, BeginQuery, "glBeginQuery") &&
+      LoadFunction(pfnGetProc, EndQuery, "glEndQuery") &&
+      LoadFunction(pfnGetProc, GetQueryObjectiv, "glGetQueryObjectiv") &&
+      LoadFunction(pfnGetProc, GetQueryObjectui64v,
+                   "glGetQueryObjectui64v") &&
+      (nVersion >= 33 || HasExtension("GL_ARB_timer_query"));
+
+  bLoaded = true;
+  return true;
+}
+
+bool SGLFunctions::HasExtension(const char *pszName) const {
+  // Le profil core n'accepte plus GL_EXTENSIONS dans glGetString()
+  GLint nCount = 0;
+  if (GetStringi)
+    glGetIntegerv(GL_NUM_EXTENSIONS, &nCount);
+  if (nCount > 0) {
+    for (GLint i = 0; i < nCount; i++)
+      if (strcmp((const char *)GetStringi(GL_EXTENSIONS, i), pszName) == 0)
+        return true;
+    return false;
+  }
+
+  const char *pszList = (const char *)glGetString(GL_EXTENSIONS);
+  size_t nLen = strlen(pszName);
+  for (const char *p = pszList; p && (p = strstr(p, pszName)); p += nLen)
+    if ((p == pszList || p[-1] == ' ') && (p[nLen] == ' ' || p[nLen] == 0))
+      return true;
+  return false;
+}
+
+// File de lecture asynchrone
+
+CReadbackRing::CReadbackRing() : m_pGL(NULL), m_nNext(0) {}
+
+bool CReadbackRing::Create(const SGLFunctions *pGL, size_t nSlots) {
+  Destroy();
+  if (!pGL->bPixelBuffers)
+    return false;
+
+  m_pGL = pGL;
+  m_vSlots.resize(nSlots);
+  for (SSlot &slot : m_vSlots) {
+    memset(&slot, 0, sizeof slot);
+    m_pGL->GenBuffers(1, &slot.nBuffer);
+  }
+  m_nNext = 0;
+  return true;
+}
+
+void CReadbackRing::Destroy() {
+  for (SSlot &slot : m_vSlots) {
+    if (slot.sync)
+      m_pGL->DeleteSync(slot.sync);
+    m_pGL->DeleteBuffers(1, &slot.nBuffer);
+  }
+  m_vSlots.clear();
+}
+
+int CReadbackRing::Issue(int x, int y, unsigned nWidth, unsigned nHeight) {
+  SSlot &slot = m_vSlots[m_nNext];
+  if (slot.bPending)
+    return -1;
+
+  size_t nSize = (size_t)nWidth * nHeight * 4;
+  m_pGL->BindBuffer(GL_PIXEL_PACK_BUFFER, slot.nBuffer);
+  if (slot.nCapacity < nSize) {
+    m_pGL->BufferData(GL_PIXEL_PACK_BUFFER, nSize, NULL, GL_STREAM_READ);
+    slot.nCapacity = nSize;
+  }
+  // BGRA en mémoire correspond à 0xAARRGGBB, et c'est le format natif de la
+  // plupart des framebuffers : la copie ne demande aucune conversion
+  glReadPixels(x, y, nWidth, nHeight, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+  m_pGL->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (m_pGL->bSync)
+    slot.sync = m_pGL->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  slot.nWidth = nWidth;
+  slot.nHeight = nHeight;
+  slot.bPending = true;
+  slot.nAge = 0;
+
+  int nSlot = (int)m_nNext;
+  m_nNext = (m_nNext + 1) % m_vSlots.size();
+  return nSlot;
+}
+
+bool CReadbackRing::IsReady(int nSlot) {
+  SSlot &slot = m_vSlots[nSlot];
+  if (!slot.sync)
+    return slot.nAge >= READY_AGE;
+  // Délai nul : simple interrogation. Le drapeau FLUSH garantit que la
+  // barrière finira par être atteinte même si rien d'autre n'est envoyé
+  GLenum nStatus = m_pGL->ClientWaitSync(slot.sync,
+                                         GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  return nStatus == GL_ALREADY_SIGNALED || nStatus == GL_CONDITION_SATISFIED;
+}
+
+void CReadbackRing::Tick() {
+  for (SSlot &slot : m_vSlots)
+    if (slot.bPending)
+      slot.nAge++;
+}
+
+const uint32_t *CReadbackRing::Map(int nSlot, unsigned &nWidth,
+                                   unsigned &nHeight) {
+  SSlot &slot = m_vSlots[nSlot];
+  nWidth = slot.nWidth;
+  nHeight = slot.nHeight;
+  m_pGL->BindBuffer(GL_PIXEL_PACK_BUFFER, slot.nBuffer);
+  void *p = m_pGL->MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  m_pGL->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return static_cast<const uint32_t *>(p);
+}
+
+void CReadbackRing::Unmap(int nSlot) {
+  SSlot &slot = m_vSlots[nSlot];
+  m_pGL->BindBuffer(GL_PIXEL_PACK_BUFFER, slot.nBuffer);
+  m_pGL->UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  m_pGL->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (slot.sync) {
+    m_pGL->DeleteSync(slot.sync);
+    slot.sync = NULL;
+  }
+  slot.bPending = false;
+}
+
+// Tampon de sommets en flux
+
+CStreamBuffer::CStreamBuffer()
+    : m_pGL(NULL), m_nBuffer(0), m_bPersistent(false), m_pData(NULL),
+      m_nElementSize(0), m_nCapacity(0), m_nSection(0), m_nHead(0),
+      m_nCommitted(0), m_fences() {}
+
+bool CStreamBuffer::Create(const SGLFunctions *pGL, size_t nElementSize,
+                           size_t nCapacity) {
+  Destroy();
+  if (!pGL->bCore)
+    return false;
+
+  m_pGL = pGL;
+  m_nElementSize = nElementSize;
+  m_nCapacity = nCapacity;
+  m_nSection = 0;
+  m_nHead = 0;
+  m_nCommitted = 0;
+  size_t nSize = nElementSize * nCapacity * NUM_SECTIONS;
+
+  m_pGL->GenBuffers(1, &m_nBuffer);
+  m_pGL->BindBuffer(GL_ARRAY_BUFFER, m_nBuffer);
+  if (m_pGL->bBufferStorage) {
+    const GLbitfield nFlags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    m_pGL->BufferStorage(GL_ARRAY_BUFFER, nSize, NULL, nFlags);
+    m_pData = static_cast<uint8_t *>(
+        m_pGL->MapBufferRange(GL_ARRAY_BUFFER, 0, nSize, nFlags));
+    m_bPersistent = m_pData != NULL;
+  }
+  if (!m_bPersistent) {
+    if (m_pGL->bBufferStorage) {
+      // Stockage immuable mais projection refusée : repartir de zéro
+      m_pGL->DeleteBuffers(1, &m_nBuffer);
+      m_pGL->GenBuffers(1, &m_nBuffer);
+      m_pGL->BindBuffer(GL_ARRAY_BUFFER, m_nBuffer);
+    }
+    m_pGL->BufferData(GL_ARRAY_BUFFER, nSize, NULL, GL_STREAM_DRAW);
+    m_vShadow.resize(nSize);
+    m_pData = m_vShadow.data();
+  }
+  return true;
+}
+
+void CStreamBuffer::Destroy() {
+  if (!m_nBuffer)
+    return;
+  for (GLsync &sync : m_fences) {
+    if (sync)
+      m_pGL->DeleteSync(sync);
+    sync = NULL;
+  }
+  if (m_bPersistent) {
+    m_pGL->BindBuffer(GL_ARRAY_BUFFER, m_nBuffer);
+    m_pGL->UnmapBuffer(GL_ARRAY_BUFFER);
+  }
+  m_pGL->DeleteBuffers(1, &m_nBuffer);
+  m_nBuffer = 0;
+  m_bPersistent = false;
+  m_pData = NULL;
+  m_vShadow.clear();
+}
+
+void CStreamBuffer::NextSection() {
+  if (m_bPersistent) {
+    m_fences[m_nSection] = m_pGL->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_nSection = (m_nSection + 1) % NUM_SECTIONS;
+    if (GLsync sync = m_fences[m_nSection]) {
+      // Normalement déjà franchie : le GPU a deux sections d'avance
+      while (m_pGL->ClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                   1000000000) == GL_TIMEOUT_EXPIRED)
+        ;
+      m_pGL->DeleteSync(sync);
+      m_fences[m_nSection] = NULL;
+    }
+  } else {
+    m_nSection = (m_nSection + 1) % NUM_SECTIONS;
+    if (m_nSection == 0) {
+      // Le pilote fournit un nouveau stockage plutôt que d'attendre le GPU
+      m_pGL->BindBuffer(GL_ARRAY_BUFFER, m_nBuffer);
+      m_pGL->BufferData(GL_ARRAY_BUFFER, m_vShadow.size(), NULL,
+                        GL_STREAM_DRAW);
+    }
+  }
+  m_nHead = 0;
+  m_nCommitted = 0;
+}
+
+void *CStreamBuffer::Allocate(size_t n, GLint &nFirst) {
+  size_t nIndex = m_nSection * m_nCapacity + m_nHead;
+  nFirst = (GLint)nIndex;
+  m_nHead += n;
+  return m_pData + nIndex * m_nElementSize;
+}
+
+void CStreamBuffer::Commit() {
+  if (m_bPersistent || m_nCommitted == m_nHead)
+    return;
+  size_t nOffset = (m_nSection * m_nCapacity + m_nCommitted) * m_nElementSize;
+  m_pGL->BindBuffer(GL_ARRAY_BUFFER, m_nBuffer);
+  m_pGL->BufferSubData(GL_ARRAY_BUFFER, nOffset,
+                       (m_nHead - m_nCommitted) * m_nElementSize,
+                       m_pData + nOffset);
+  m_nCommitted = m_nHead;
+}
+
+// Minutage du GPU
+
+CGpuTimer::CGpuTimer()
+    : m_pGL(NULL), m_nFrame(0), m_bInSpan(false), m_dLastMs(0) {
+  for (SFrame &frame : m_frames)
+    frame.nUsed = 0;
+}
+
+bool CGpuTimer::Create(const SGLFunctions *pGL) {
+  Destroy();
+  if (!pGL->bTimerQuery)
+    return false;
+  m_pGL = pGL;
+  return true;
+}
+
+void CGpuTimer::Destroy() {
+  if (!m_pGL)
+    return;
+  if (m_bInSpan)
+    m_pGL->EndQuery(GL_TIME_ELAPSED);
+  for (SFrame &frame : m_frames) {
+    if (!frame.vQueries.empty())
+      m_pGL->DeleteQueries((GLsizei)frame.vQueries.size(),
+                           frame.vQueries.data());
+    frame.vQueries.clear();
+    frame.nUsed = 0;
+  }
+  m_pGL = NULL;
+  m_nFrame = 0;
+  m_bInSpan = false;
+  m_dLastMs = 0;
+}
+
+void CGpuTimer::BeginSpan() {
+  if (!m_pGL || m_bInSpan)
+    return;
+  SFrame &frame = m_frames[m_nFrame];
+  if (frame.nUsed == frame.vQueries.size()) {
+    GLuint nQuery = 0;
+    m_pGL->GenQueries(1, &nQuery);
+    frame.vQueries.push_back(nQuery);
+  }
+  m_pGL->BeginQuery(GL_TIME_ELAPSED, frame.vQueries[frame.nUsed++]);
+  m_bInSpan = true;
+}
+
+void CGpuTimer::EndSpan() {
+  if (!m_bInSpan)
+    return;
+  m_pGL->EndQuery(GL_TIME_ELAPSED);
+  m_bInSpan = false;
+}
+
+void CGpuTimer::EndFrame() {
+  if (!m_pGL)
+    return;
+  m_nFrame = (m_nFrame + 1) % NUM_FRAMES;
+  SFrame &frame = m_frames[m_nFrame];
+  if (frame.nUsed == 0)
+    return;
+
+  // Les requêtes d'une même cible se terminent dans l'ordre : si la
+  // dernière est disponible, toutes le sont
+  GLint nAvailable = 0;
+  m_pGL->GetQueryObjectiv(frame.vQueries[frame.nUsed - 1],
+                          GL_QUERY_RESULT_AVAILABLE, &nAvailable);
+  if (nAvailable) {
+    GLuint64 nTotalNs = 0;
+    for (size_t i = 0; i < frame.nUsed; i++) {
+      GLuint64 nNs = 0;
+      m_pGL->GetQueryObjectui64v(frame.vQueries[i], GL_QUERY_RESULT, &nNs);
+      nTotalNs += nNs;
+    }
+    m_dLastMs = nTotalNs / 1e6;
+  }
+  frame.nUsed = 0;
+}
+
+} // namespace LibGraph2
+
+#endif // LIBGRAPH2_USE_SFML || LIBGRAPH2_USE_OPENGL
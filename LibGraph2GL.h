@@ -0,0 +1,267 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : fonctions OpenGL postérieures à la
+// version 1.1, chargées à l'exécution, lecture asynchrone de pixels,
+// tampon de sommets en flux et minutage du GPU.
+#if defined(LIBGRAPH2_USE_SFML) || defined(LIBGRAPH2_USE_OPENGL)
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LibGraph2 {
+
+// Fonction de chargement des points d'entrée du contexte actif :
+// sf::Context::getFunction() ou eglGetProcAddress()
+typedef void (*GLProc)(void);
+typedef GLProc (*PFNGETPROCADDRESS)(const char *);
+
+// Points d'entrée OpenGL utilisés par les moteurs SFML et OpenGL. Load() doit
+// être appelée avec un contexte actif ; les pointeurs sont ensuite valables
+// dans tous les contextes.
+struct SGLFunctions {
+  bool bLoaded;
+  bool bPixelBuffers;  // GL 2.1 ou ARB_pixel_buffer_object
+  bool bSync;          // GL 3.2 ou ARB_sync
+  bool bCore;          // GL 3.3 : shaders, VAO et framebuffers
+  bool bBufferStorage; // GL 4.4 ou ARB_buffer_storage
+  bool bTimerQuery;    // GL 3.3 ou ARB_timer_query
+
+  PFNGLGENBUFFERSPROC GenBuffers;
+  PFNGLDELETEBUFFERSPROC DeleteBuffers;
+  PFNGLBINDBUFFERPROC BindBuffer;
+  PFNGLBUFFERDATAPROC BufferData;
+  PFNGLMAPBUFFERPROC MapBuffer;
+  PFNGLUNMAPBUFFERPROC UnmapBuffer;
+  PFNGLFENCESYNCPROC FenceSync;
+  PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
+  PFNGLDELETESYNCPROC DeleteSync;
+
+  // GL 3.3
+  PFNGLGETSTRINGIPROC GetStringi;
+  PFNGLBUFFERSUBDATAPROC BufferSubData;
+  PFNGLGENVERTEXARRAYSPROC GenVertexArrays;
+  PFNGLDELETEVERTEXARRAYSPROC DeleteVertexArrays;
+  PFNGLBINDVERTEXARRAYPROC BindVertexArray;
+  PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+  PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+  PFNGLCREATESHADERPROC CreateShader;
+  PFNGLSHADERSOURCEPROC ShaderSource;
+  PFNGLCOMPILESHADERPROC CompileShader;
+  PFNGLGETSHADERIVPROC GetShaderiv;
+  PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+  PFNGLDELETESHADERPROC DeleteShader;
+  PFNGLCREATEPROGRAMPROC CreateProgram;
+  PFNGLATTACHSHADERPROC AttachShader;
+  PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+  PFNGLLINKPROGRAMPROC LinkProgram;
+  PFNGLGETPROGRAMIVPROC GetProgramiv;
+  PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+  PFNGLUSEPROGRAMPROC UseProgram;
+  PFNGLDELETEPROGRAMPROC DeleteProgram;
+  PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+  PFNGLUNIFORM1IPROC Uniform1i;
+  PFNGLUNIFORM2FPROC Uniform2f;
+  PFNGLACTIVETEXTUREPROC ActiveTexture;
+  PFNGLBLENDFUNCSEPARATEPROC BlendFuncSeparate;
+  PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
+  PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers;
+  PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+  PFNGLFRAMEBUFFERRENDERBUFFERPROC FramebufferRenderbuffer;
+  PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
+  PFNGLBLITFRAMEBUFFERPROC BlitFramebuffer;
+  PFNGLGENRENDERBUFFERSPROC GenRenderbuffers;
+  PFNGLDELETERENDERBUFFERSPROC DeleteRenderbuffers;
+  PFNGLBINDRENDERBUFFERPROC BindRenderbuffer;
+  PFNGLRENDERBUFFERSTORAGEPROC RenderbufferStorage;
+
+  // GL 4.4 ou ARB_buffer_storage
+  PFNGLBUFFERSTORAGEPROC BufferStorage;
+  PFNGLMAPBUFFERRANGEPROC MapBufferRange;
+
+  // GL 3.3 ou ARB_timer_query
+  PFNGLGENQUERIESPROC GenQueries;
+  PFNGLDELETEQUERIESPROC DeleteQueries;
+  PFNGLBEGINQUERYPROC BeginQuery;
+  PFNGLENDQUERYPROC EndQuery;
+  PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv;
+  PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v;
+
+  SGLFunctions();
+  bool Load(PFNGETPROCADDRESS pfnGetProc);
+  // Extension annoncée par le contexte actif
+  bool HasExtension(const char *pszName) const;
+};
+
+/*
+ * File circulaire de pixel buffer objects pour lire le framebuffer sans
+ * bloquer : Issue() lance la copie dans le GPU et rend la main
+ * immédiatement, Map() ne récupère le résultat qu'une ou deux images plus
+ * tard, quand la copie est terminée. Si le pilote le permet, une barrière
+ * (fence) indique précisément la fin de la copie ; sinon un emplacement est
+ * considéré prêt après READY_AGE appels à Tick().
+ *
+ * Toutes les fonctions doivent être appelées avec un contexte OpenGL actif.
+ */
+class CReadbackRing {
+private:
+  struct SSlot {
+    GLuint nBuffer;
+    size_t nCapacity;
+    unsigned nWidth, nHeight;
+    bool bPending;
+    GLsync sync;
+    unsigned nAge;
+  };
+
+  const SGLFunctions *m_pGL;
+  std::vector<SSlot> m_vSlots;
+  size_t m_nNext;
+
+public:
+  static const unsigned READY_AGE = 2;
+
+  CReadbackRing();
+
+  bool Create(const SGLFunctions *pGL, size_t nSlots);
+  void Destroy();
+  bool IsCreated() const { return !m_vSlots.empty(); }
+
+  // Lance la lecture d'un rectangle du framebuffer lié (origine en bas à
+  // gauche) dans l'emplacement suivant. Renvoie son index, ou -1 s'il
+  // contient encore un résultat non lu
+  int Issue(int x, int y, unsigned nWidth, unsigned nHeight);
+  // Indique, sans attendre, si la copie de l'emplacement est terminée
+  bool IsReady(int nSlot);
+  // A appeler une fois par image
+  void Tick();
+  // Pixels ARGB, dans l'ordre des lignes du framebuffer (de bas en haut).
+  // Attend la fin de la copie si besoin
+  const uint32_t *Map(int nSlot, unsigned &nWidth, unsigned &nHeight);
+  // Libère l'emplacement après Map()
+  void Unmap(int nSlot);
+};
+
+/*
+ * Tampon de sommets écrit en flux, découpé en NUM_SECTIONS sections
+ * utilisées à tour de rôle.
+ *
+ * Avec ARB_buffer_storage, le tampon est projeté en mémoire une fois pour
+ * toutes (projection persistante et cohérente) : les sommets sont écrits
+ * directement à leur place définitive, sans aucun appel OpenGL. Une barrière
+ * posée en quittant une section empêche de la réécrire avant que le GPU ait
+ * fini de la lire. Sans l'extension, les sommets sont écrits dans une copie
+ * en mémoire centrale, envoyée par glBufferSubData() à chaque Commit().
+ *
+ * La taille est comptée en éléments (sommets) de taille fixe, pour que
+ * l'index renvoyé par Allocate() serve directement à glDrawArrays().
+ */
+class CStreamBuffer {
+public:
+  static const unsigned NUM_SECTIONS = 3;
+
+private:
+  const SGLFunctions *m_pGL;
+  GLuint m_nBuffer;
+  bool m_bPersistent;
+  uint8_t *m_pData; // Projection persistante ou copie locale
+  std::vector<uint8_t> m_vShadow;
+  size_t m_nElementSize;
+  size_t m_nCapacity; // Eléments par section
+  unsigned m_nSection;
+  size_t m_nHead;      // Prochain élément libre de la section
+  size_t m_nCommitted; // Eléments déjà envoyés (copie locale seulement)
+  GLsync m_fences[NUM_SECTIONS];
+
+public:
+  CStreamBuffer();
+
+  // Crée le tampon et le lie à GL_ARRAY_BUFFER
+  bool Create(const SGLFunctions *pGL, size_t nElementSize,
+              size_t nCapacity);
+  void Destroy();
+  bool IsCreated() const { return m_nBuffer != 0; }
+  bool IsPersistent() const { return m_bPersistent; }
+  size_t GetCapacity() const { return m_nCapacity; }
+
+  // Indique si n éléments tiennent encore dans la section courante
+  bool HasRoom(size_t n) const { return m_nHead + n <= m_nCapacity; }
+  // Passe à la section suivante, en attendant si besoin que le GPU ait fini
+  // de la lire. Les dessins en attente doivent avoir été soumis
+  void NextSection();
+  // Réserve n éléments (au plus GetCapacity()) dans la section courante.
+  // Renvoie l'adresse où les écrire et, dans nFirst, l'index du premier
+  void *Allocate(size_t n, GLint &nFirst);
+  // Rend les éléments écrits visibles du GPU, avant de dessiner
+  void Commit();
+};
+
+/*
+ * Temps d'exécution des images par le GPU, mesuré par des requêtes
+ * GL_TIME_ELAPSED autour de portées (lots de dessin, ou image entière).
+ *
+ * Chacune des NUM_FRAMES dernières images a ses propres requêtes : celles
+ * d'une image ne sont relues que lorsque son emplacement revient, deux
+ * images plus tard, et seulement si le GPU a terminé. Un résultat pas
+ * encore disponible est abandonné plutôt qu'attendu, la mesure ne bloque
+ * donc jamais. Les requêtes d'une image sont créées au fil des besoins et
+ * conservées : en régime permanent, la mesure n'alloue rien.
+ *
+ * Les requêtes GL_TIME_ELAPSED ne s'imbriquent pas : les portées doivent
+ * se suivre. Toutes les fonctions doivent être appelées avec un contexte
+ * OpenGL actif ; sans Create(), elles ne font rien.
+ */
+class CGpuTimer {
+public:
+  static const unsigned NUM_FRAMES = 3;
+
+private:
+  struct SFrame {
+    std::vector<GLuint> vQueries;
+    size_t nUsed;
+  };
+
+  const SGLFunctions *m_pGL;
+  SFrame m_frames[NUM_FRAMES];
+  unsigned m_nFrame;
+  bool m_bInSpan;
+  double m_dLastMs;
+
+public:
+  CGpuTimer();
+
+  bool Create(const SGLFunctions *pGL);
+  void Destroy();
+  bool IsCreated() const { return m_pGL != NULL; }
+
+  void BeginSpan();
+  void EndSpan();
+  bool IsInSpan() const { return m_bInSpan; }
+  // Termine l'image en cours, dont les portées doivent être fermées, et
+  // relit celle dont l'emplacement est réutilisé
+  void EndFrame();
+  // Somme des portées de la dernière image relue, en millisecondes
+  double GetLastMs() const { return m_dLastMs; }
+};
+
+} // namespace LibGraph2
+
+#endif // LIBGRAPH2_USE_SFML || LIBGRAPH2_USE_OPENGL
@@ -0,0 +1,339 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Image.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef LIBGRAPH2_HAVE_PNG
+#  include <png.h>
+#endif
+
+using namespace std;
+
+namespace LibGraph2 {
+
+string ImageFileExtension(const string &strFileName) {
+  size_t nDot = strFileName.rfind('.');
+  if (nDot == string::npos)
+    return string();
+  string ext = strFileName.substr(nDot + 1);
+  transform(ext.begin(), ext.end(), ext.begin(),
+            [](unsigned char c) { return (char)tolower(c); });
+  return ext;
+}
+
+#ifdef LIBGRAPH2_HAVE_PNG
+static bool LoadPNG(const string &strFileName, SImage &image) {
+  png_image png;
+  memset(&png, 0, sizeof png);
+  png.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&png, strFileName.c_str()))
+    return false;
+
+  // BGRA en mémoire correspond à 0xAARRGGBB sur une machine petit-boutiste
+  png.format = PNG_FORMAT_BGRA;
+  image.nWidth = png.width;
+  image.nHeight = png.height;
+  image.vPixels.resize((size_t)png.width * png.height);
+  if (!png_image_finish_read(&png, NULL, image.vPixels.data(), 0, NULL)) {
+    png_image_free(&png);
+    return false;
+  }
+  return true;
+}
+#endif
+
+// Lit un entier de l'en-tête PPM, en sautant les blancs et commentaires
+static bool ReadPPMHeaderValue(FILE *f, unsigned &nValue) {
+  int c;
+  for (;;) {
+    c = fgetc(f);
+    if (c == '#') {
+      while (c != '\n' && c != EOF)
+        c = fgetc(f);
+    } else if (!isspace(c)) {
+      break;
+    }
+  }
+  if (!isdigit(c))
+    return false;
+  nValue = 0;
+  while (isdigit(c)) {
+    nValue = nValue * 10 + (c - '0');
+    c = fgetc(f);
+  }
+  return true;
+}
+
+static bool LoadPPM(const string &strFileName, SImage &image) {
+  FILE *f = fopen(strFileName.c_str(), "rb");
+  if (!f)
+    return false;
+
+  unsigned nWidth, nHeight, nMax;
+  bool bOk = fgetc(f) == 'P' && fgetc(f) == '6' &&
+             ReadPPMHeaderValue(f, nWidth) && ReadPPMHeaderValue(f, nHeight) &&
+             ReadPPMHeaderValue(f, nMax) && nMax == 255;
+  if (bOk) {
+    vector<uint8_t> vRGB((size_t)nWidth * nHeight * 3);
+    bOk = fread(vRGB.data(), 1, vRGB.size(), f) == vRGB.size();
+    if (bOk) {
+      image.nWidth = nWidth;
+      image.nHeight = nHeight;
+      image.vPixels.resize((size_t)nWidth * nHeight);
+      for (size_t i = 0; i < image.vPixels.size(); i++)
+        image.vPixels[i] = 0xFF000000u | (vRGB[3 * i] << 16) |
+                           (vRGB[3 * i + 1] << 8) | vRGB[3 * i + 2];
+    }
+  }
+  fclose(f);
+  return bOk;
+}
+
+#ifdef LIBGRAPH2_HAVE_PNG
+static bool SavePNG(const string &strFileName, unsigned nWidth,
+                    unsigned nHeight, const uint32_t *pPixels) {
+  png_image png;
+  memset(&png, 0, sizeof png);
+  png.version = PNG_IMAGE_VERSION;
+  png.width = nWidth;
+  png.height = nHeight;
+  png.format = PNG_FORMAT_BGRA;
+  return png_image_write_to_file(&png, strFileName.c_str(), 0, pPixels, 0,
+                                 NULL) != 0;
+}
+#endif
+
+static bool SavePPM(const string &strFileName, unsigned nWidth,
+                    unsigned nHeight, const uint32_t *pPixels) {
+  FILE *f = fopen(strFileName.c_str(), "wb");
+  if (!f)
+    return false;
+
+  fprintf(f, "P6\n%u %u\n255\n", nWidth, nHeight);
+  vector<uint8_t> vRow((size_t)nWidth * 3);
+  bool bOk = true;
+  for (unsigned y = 0; y < nHeight && bOk; y++) {
+    const uint32_t *p = pPixels + (size_t)y * nWidth;
+    for (unsigned x = 0; x < nWidth; x++) {
+      vRow[3 * x] = (uint8_t)(p[x] >> 16);
+      vRow[3 * x + 1] = (uint8_t)(p[x] >> 8);
+      vRow[3 * x + 2] = (uint8_t)p[x];
+    }
+    bOk = fwrite(vRow.data(), 1, vRow.size(), f) == vRow.size();
+  }
+  return fclose(f) == 0 && bOk;
+}
+
+// Format QOI (https://qoiformat.org) : sans perte, avec alpha, et bien plus
+// rapide à encoder que PNG
+static bool SaveQOI(const string &strFileName, unsigned nWidth,
+                    unsigned nHeight, const uint32_t *pPixels) {
+  const uint8_t QOI_OP_INDEX = 0x00, QOI_OP_DIFF = 0x40, QOI_OP_LUMA = 0x80,
+                QOI_OP_RUN = 0xC0, QOI_OP_RGB = 0xFE, QOI_OP_RGBA = 0xFF;
+
+  size_t nPixels = (size_t)nWidth * nHeight;
+  vector<uint8_t> vOut;
+  vOut.reserve(14 + nPixels * 2 + 8);
+  const uint8_t header[14] = {'q',
+                              'o',
+                              'i',
+                              'f',
+                              (uint8_t)(nWidth >> 24),
+                              (uint8_t)(nWidth >> 16),
+                              (uint8_t)(nWidth >> 8),
+                              (uint8_t)nWidth,
+                              (uint8_t)(nHeight >> 24),
+                              (uint8_t)(nHeight >> 16),
+                              (uint8_t)(nHeight >> 8),
+                              (uint8_t)nHeight,
+                              4,  // RGBA
+                              0}; // sRGB
+  vOut.insert(vOut.end(), header, header + sizeof header);
+
+  uint32_t index[64] = {0};
+  uint32_t prev = 0xFF000000; // ARGB
+  int nRun = 0;
+  for (size_t i = 0; i < nPixels; i++) {
+    uint32_t px = pPixels[i];
+    if (px == prev) {
+      if (++nRun == 62) {
+        vOut.push_back(QOI_OP_RUN | (nRun - 1));
+        nRun = 0;
+      }
+      continue;
+    }
+    if (nRun > 0) {
+      vOut.push_back(QOI_OP_RUN | (nRun - 1));
+      nRun = 0;
+    }
+
+    uint8_t a = (uint8_t)(px >> 24), r = (uint8_t)(px >> 16),
+            g = (uint8_t)(px >> 8), b = (uint8_t)px;
+    int nHash = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+    if (index[nHash] == px) {
+      vOut.push_back(QOI_OP_INDEX | nHash);
+    } else {
+      index[nHash] = px;
+      if (a == (uint8_t)(prev >> 24)) {
+        int8_t dr = (int8_t)(r - (uint8_t)(prev >> 16));
+        int8_t dg = (int8_t)(g - (uint8_t)(prev >> 8));
+        int8_t db = (int8_t)(b - (uint8_t)prev);
+        int8_t drg = (int8_t)(dr - dg), dbg = (int8_t)(db - dg);
+        if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+          vOut.push_back(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 |
+                         (db + 2));
+        } else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 &&
+                   dbg < 8) {
+          vOut.push_back(QOI_OP_LUMA | (dg + 32));
+          vOut.push_back((uint8_t)((drg + 8) << 4 | (dbg + 8)));
+        } else {
+          const uint8_t op[4] = {QOI_OP_RGB, r, g, b};
+          vOut.insert(vOut.end(), op, op + 4);
+        }
+      } else {
+        const uint8_t op[5] = {QOI_OP_RGBA, r, g, b, a};
+        vOut.insert(vOut.end(), op, op + 5);
+      }
+    }
+    prev = px;
+  }
+  if (nRun > 0)
+    vOut.push_back(QOI_OP_RUN | (nRun - 1));
+  const uint8_t end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+  vOut.insert(vOut.end(), end, end + sizeof end);
+
+  FILE *f = fopen(strFileName.c_str(), "wb");
+  if (!f)
+    return false;
+  bool bOk = fwrite(vOut.data(), 1, vOut.size(), f) == vOut.size();
+  return fclose(f) == 0 && bOk;
+}
+
+static bool LoadQOI(const string &strFileName, SImage &image) {
+  FILE *f = fopen(strFileName.c_str(), "rb");
+  if (!f)
+    return false;
+  vector<uint8_t> vIn;
+  uint8_t buffer[65536];
+  size_t nRead;
+  while ((nRead = fread(buffer, 1, sizeof buffer, f)) > 0)
+    vIn.insert(vIn.end(), buffer, buffer + nRead);
+  fclose(f);
+  if (vIn.size() < 14 + 8 || memcmp(vIn.data(), "qoif", 4))
+    return false;
+
+  auto ReadU32 = [&](size_t i) {
+    return (uint32_t)vIn[i] << 24 | vIn[i + 1] << 16 | vIn[i + 2] << 8 |
+           vIn[i + 3];
+  };
+  unsigned nWidth = ReadU32(4), nHeight = ReadU32(8);
+  // Refuse les tailles absurdes plutôt que d'allouer des gigaoctets
+  if (nWidth == 0 || nHeight == 0 || (uint64_t)nWidth * nHeight > (1u << 28))
+    return false;
+  size_t nPixels = (size_t)nWidth * nHeight;
+  vector<uint32_t> vPixels(nPixels);
+
+  uint32_t index[64] = {0};
+  uint8_t r = 0, g = 0, b = 0, a = 255;
+  size_t nPos = 14, nEnd = vIn.size() - 8;
+  int nRun = 0;
+  for (size_t i = 0; i < nPixels; i++) {
+    if (nRun > 0) {
+      nRun--;
+    } else if (nPos < nEnd) {
+      uint8_t op = vIn[nPos++];
+      if (op == 0xFE && nPos + 3 <= nEnd) {
+        r = vIn[nPos];
+        g = vIn[nPos + 1];
+        b = vIn[nPos + 2];
+        nPos += 3;
+      } else if (op == 0xFF && nPos + 4 <= nEnd) {
+        r = vIn[nPos];
+        g = vIn[nPos + 1];
+        b = vIn[nPos + 2];
+        a = vIn[nPos + 3];
+        nPos += 4;
+      } else if ((op & 0xC0) == 0x00) {
+        uint32_t px = index[op];
+        a = (uint8_t)(px >> 24);
+        r = (uint8_t)(px >> 16);
+        g = (uint8_t)(px >> 8);
+        b = (uint8_t)px;
+      } else if ((op & 0xC0) == 0x40) {
+        r += ((op >> 4) & 3) - 2;
+        g += ((op >> 2) & 3) - 2;
+        b += (op & 3) - 2;
+      } else if ((op & 0xC0) == 0x80 && nPos < nEnd) {
+        int dg = (op & 0x3F) - 32;
+        uint8_t next = vIn[nPos++];
+        r += dg + (next >> 4) - 8;
+        g += dg;
+        b += dg + (next & 15) - 8;
+      } else if ((op & 0xC0) == 0xC0) {
+        nRun = op & 0x3F;
+      } else {
+        return false;
+      }
+      index[(r * 3 + g * 5 + b * 7 + a * 11) % 64] =
+          (uint32_t)a << 24 | r << 16 | g << 8 | b;
+    } else {
+      return false;
+    }
+    vPixels[i] = (uint32_t)a << 24 | r << 16 | g << 8 | b;
+  }
+  image.nWidth = nWidth;
+  image.nHeight = nHeight;
+  image.vPixels.swap(vPixels);
+  return true;
+}
+
+bool SaveImageFile(const string &strFileName, unsigned nWidth,
+                   unsigned nHeight, const uint32_t *pPixels) {
+  string ext = ImageFileExtension(strFileName);
+  if (ext == "qoi")
+    return SaveQOI(strFileName, nWidth, nHeight, pPixels);
+  if (ext == "ppm")
+    return SavePPM(strFileName, nWidth, nHeight, pPixels);
+#ifdef LIBGRAPH2_HAVE_PNG
+  if (ext == "png")
+    return SavePNG(strFileName, nWidth, nHeight, pPixels);
+#endif
+  cerr << "LibGraph2 : format d'image non reconnu : " << strFileName << endl;
+  return false;
+}
+
+bool LoadImageFile(const string &strFileName, SImage &image) {
+  string ext = ImageFileExtension(strFileName);
+  if (ext == "qoi")
+    return LoadQOI(strFileName, image);
+  if (ext == "ppm")
+    return LoadPPM(strFileName, image);
+#ifdef LIBGRAPH2_HAVE_PNG
+  if (ext == "png")
+    return LoadPNG(strFileName, image);
+#endif
+  cerr << "LibGraph2 : format d'image non reconnu : " << strFileName << endl;
+  return false;
+}
+
+} // namespace LibGraph2
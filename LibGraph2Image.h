@@ -0,0 +1,47 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : lecture et écriture des images.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LibGraph2 {
+
+// Image ARGB (0xAARRGGBB), lignes contiguës
+struct SImage {
+  unsigned nWidth = 0;
+  unsigned nHeight = 0;
+  std::vector<uint32_t> vPixels;
+};
+
+// Charge une image d'après son extension : PNG (si libpng est disponible),
+// PPM binaire (P6) ou QOI. Renvoie false si le format n'est pas pris en charge ou si
+// le fichier est illisible.
+bool LoadImageFile(const std::string &strFileName, SImage &image);
+
+// Enregistre des pixels ARGB d'après l'extension du fichier : PNG (si
+// libpng est disponible), PPM binaire (P6, sans alpha) ou QOI
+bool SaveImageFile(const std::string &strFileName, unsigned nWidth,
+                   unsigned nHeight, const uint32_t *pPixels);
+
+// Extension du fichier, en minuscules
+std::string ImageFileExtension(const std::string &strFileName);
+
+} // namespace LibGraph2
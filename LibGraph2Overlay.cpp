@@ -0,0 +1,251 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "LibGraph2Overlay.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace LibGraph2 {
+
+// Police 5 x 7 des caractères 32 à 95, par colonnes de gauche à droite
+// (bit 0 : ligne du haut)
+static const uint8_t s_aFont[64][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, // ' ' !
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14}, // " #
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // $ %
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x00, 0x07, 0x00, 0x00}, // & '
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00}, // ( )
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, // , -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02}, // . /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, // 2 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, // 4 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, // 8 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00}, // : ;
+    {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, // > ?
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E}, // @ A
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, // D E
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x49, 0x49, 0x7A}, // F G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, // J K
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // L M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, // P Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31}, // R S
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, // V W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07}, // X Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, // Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, // \ ]
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40}, // ^ _
+};
+
+// Mise en page, en pixels : cases de 6 x 8 texels agrandies SCALE fois
+static const int CELL_W = 6, CELL_H = 8, SCALE = 2;
+static const int COLUMNS = 24, PADDING = 4, MARGIN = 8;
+static const int LINE_H = CELL_H * SCALE;
+static const int GRAPH_H = 48, BAR_W = 2;
+static const int PANEL_W = 2 * PADDING + COLUMNS * CELL_W * SCALE;
+static const int PANEL_H = 5 * PADDING + 4 * LINE_H + GRAPH_H;
+
+// Case pleine de l'atlas : centre de la première case de la dernière ligne
+static const float SOLID_U = CELL_W / 2.0f;
+static const float SOLID_V = 4 * CELL_H + CELL_H / 2.0f;
+
+static const ARGB BACKGROUND_COLOR = 0xC0000000;
+static const ARGB TEXT_COLOR = 0xFFFFFFFF;
+static const ARGB BAR_COLOR = 0xFF40C040;
+static const ARGB SLOW_BAR_COLOR = 0xFFE04040;
+static const ARGB BUDGET_COLOR = 0x80FFFF00;
+
+const uint8_t *CPerfOverlay::GetAtlas() {
+  static const std::vector<uint8_t> s_vAtlas = [] {
+    std::vector<uint8_t> vAtlas(ATLAS_WIDTH * ATLAS_HEIGHT);
+    for (int c = 0; c < 64; c++) {
+      int x0 = (c % 16) * CELL_W, y0 = (c / 16) * CELL_H;
+      for (int x = 0; x < 5; x++)
+        for (int y = 0; y < 7; y++)
+          if (s_aFont[c][x] & (1 << y))
+            vAtlas[(y0 + y) * ATLAS_WIDTH + x0 + x] = 255;
+    }
+    for (int y = 4 * CELL_H; y < 5 * CELL_H; y++)
+      for (int x = 0; x < CELL_W; x++)
+        vAtlas[y * ATLAS_WIDTH + x] = 255;
+    return vAtlas;
+  }();
+  return s_vAtlas.data();
+}
+
+static CPerfOverlay::SQuad SolidQuad(float x0, float y0, float x1, float y1,
+                                     ARGB color) {
+  CPerfOverlay::SQuad q = {x0, y0, x1, y1, SOLID_U, SOLID_V,
+                           SOLID_U, SOLID_V, color};
+  return q;
+}
+
+CPerfOverlay::CPerfOverlay()
+    : m_bVisible(false), m_dBudgetMs(1000.0 / 60), m_afHistory(),
+      m_nHistory(0), m_nNext(0), m_nFrames(0), m_dSumMs(0), m_dMaxMs(0),
+      m_nDrawCalls(0), m_nVertices(0), m_nCacheHits(0), m_nCacheMisses(0) {
+  if (const char *szBudget = getenv("LIBGRAPH2_FRAME_BUDGET"))
+    if (atof(szBudget) > 0)
+      m_dBudgetMs = atof(szBudget);
+  const char *szShow = getenv("LIBGRAPH2_OVERLAY");
+  Show(szShow && *szShow && *szShow != '0');
+}
+
+void CPerfOverlay::Show(bool bShow) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (bShow && !IsVisible()) {
+    // Repartir d'un historique vide : les images précédentes n'ont pas été
+    // mesurées
+    m_nHistory = m_nNext = 0;
+    m_nFrames = 0;
+    m_dSumMs = m_dMaxMs = 0;
+    m_nDrawCalls = m_nVertices = 0;
+    m_nCacheHits = m_nCacheMisses = 0;
+    m_vText.clear();
+    m_vQuads.clear();
+    m_lastText = clock::time_point();
+  }
+  m_bVisible.store(bShow, std::memory_order_relaxed);
+}
+
+void CPerfOverlay::OnEvent(const evt &e) {
+  if (e.type == evt_type::evtKeyDown && e.vkKeyCode == TOGGLE_KEY)
+    Show(!IsVisible());
+}
+
+void CPerfOverlay::AddFrame(double dFrameMs, const SFrameStats &stats) {
+  if (!IsVisible())
+    return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (dFrameMs > 0) {
+    m_afHistory[m_nNext] = (float)dFrameMs;
+    m_nNext = (m_nNext + 1) % HISTORY;
+    m_nHistory = std::min<unsigned>(m_nHistory + 1, HISTORY);
+    m_nFrames++;
+    m_dSumMs += dFrameMs;
+    m_dMaxMs = std::max(m_dMaxMs, dFrameMs);
+  }
+  m_nDrawCalls += stats.nDrawCalls;
+  m_nVertices += stats.nVertices;
+  m_nCacheHits += stats.nTextureCacheHits;
+  m_nCacheMisses += stats.nTextureCacheMisses;
+
+  clock::time_point now = clock::now();
+  if (m_vText.empty() ||
+      now - m_lastText >= std::chrono::milliseconds(TEXT_PERIOD_MS)) {
+    LayoutText(stats);
+    m_lastText = now;
+  }
+
+  // Fond, barres de l'historique (la plus récente à droite), ligne du budget
+  // à mi-hauteur, puis le texte
+  m_vQuads.clear();
+  m_vQuads.push_back(SolidQuad(MARGIN, MARGIN, MARGIN + PANEL_W,
+                               MARGIN + PANEL_H, BACKGROUND_COLOR));
+  const float fGraphX = MARGIN + PADDING;
+  const float fGraphBottom = MARGIN + 2 * PADDING + LINE_H + GRAPH_H;
+  for (unsigned i = 0; i < m_nHistory; i++) {
+    float fMs = m_afHistory[(m_nNext + HISTORY - m_nHistory + i) % HISTORY];
+    float fHeight =
+        std::min(fMs / (float)(2 * m_dBudgetMs), 1.0f) * GRAPH_H;
+    float x = fGraphX + (HISTORY - m_nHistory + i) * BAR_W;
+    m_vQuads.push_back(SolidQuad(x, fGraphBottom - std::max(fHeight, 1.0f),
+                                 x + BAR_W, fGraphBottom,
+                                 fMs > m_dBudgetMs ? SLOW_BAR_COLOR
+                                                   : BAR_COLOR));
+  }
+  m_vQuads.push_back(SolidQuad(fGraphX, fGraphBottom - GRAPH_H / 2,
+                               fGraphX + HISTORY * BAR_W,
+                               fGraphBottom - GRAPH_H / 2 + 1,
+                               BUDGET_COLOR));
+  m_vQuads.insert(m_vQuads.end(), m_vText.begin(), m_vText.end());
+}
+
+void CPerfOverlay::LayoutText(const SFrameStats &stats) {
+  char szLine[64];
+  const float x = MARGIN + PADDING;
+  float y = MARGIN + PADDING;
+  m_vText.clear();
+
+  if (m_nFrames)
+    snprintf(szLine, sizeof szLine, "IMAGE %5.1f MS MAX %5.1f",
+             m_dSumMs / m_nFrames, m_dMaxMs);
+  else
+    snprintf(szLine, sizeof szLine, "IMAGE -");
+  AddText(x, y, szLine);
+  y += LINE_H + 3 * PADDING + GRAPH_H;
+
+  // Moyennes par image sur la période
+  unsigned nFrames = std::max(m_nFrames, 1u);
+  snprintf(szLine, sizeof szLine, "APPELS %-5llu SOMMETS %llu",
+           m_nDrawCalls / nFrames, m_nVertices / nFrames);
+  AddText(x, y, szLine);
+  y += LINE_H + PADDING;
+
+  snprintf(szLine, sizeof szLine, "TEXTURES %.1f MO",
+           stats.nTextureBytes / (1024.0 * 1024.0));
+  AddText(x, y, szLine);
+  y += LINE_H + PADDING;
+
+  if (m_nCacheHits + m_nCacheMisses)
+    snprintf(szLine, sizeof szLine, "CACHE IMAGES %.0f%%",
+             100.0 * m_nCacheHits / (m_nCacheHits + m_nCacheMisses));
+  else
+    snprintf(szLine, sizeof szLine, "CACHE IMAGES -");
+  AddText(x, y, szLine);
+
+  m_nFrames = 0;
+  m_dSumMs = m_dMaxMs = 0;
+  m_nDrawCalls = m_nVertices = 0;
+  m_nCacheHits = m_nCacheMisses = 0;
+}
+
+void CPerfOverlay::AddText(float x, float y, const char *pszText) {
+  for (const char *p = pszText; *p; p++, x += CELL_W * SCALE) {
+    int c = *p;
+    if (c >= 'a' && c <= 'z')
+      c -= 'a' - 'A';
+    if (c <= ' ' || c > '_')
+      continue;
+    float u = (float)((c - ' ') % 16 * CELL_W);
+    float v = (float)((c - ' ') / 16 * CELL_H);
+    SQuad q = {x,         y,         x + CELL_W * SCALE, y + CELL_H * SCALE,
+               u,         v,         u + CELL_W,         v + CELL_H,
+               TEXT_COLOR};
+    m_vText.push_back(q);
+  }
+}
+
+bool CPerfOverlay::GetQuads(std::vector<SQuad> &vQuads) {
+  if (!IsVisible())
+    return false;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_vQuads.empty())
+    return false;
+  vQuads = m_vQuads;
+  return true;
+}
+
+} // namespace LibGraph2
@@ -0,0 +1,113 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : surimpression des performances affichée
+// par showPerformanceOverlay() ou la touche F12.
+
+#include "LibGraph2.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace LibGraph2 {
+
+/*
+ * Surimpression (HUD) des performances : durée d'image et son historique,
+ * appels de dessin, sommets, mémoire des textures et taux de succès du cache
+ * d'images.
+ *
+ * Le texte utilise une police bitmap 5 x 7 intégrée, sans chargement de
+ * police ni texture supplémentaire à chaque image : tout le HUD est une
+ * liste de quadrilatères alignés sur les axes, échantillonnant un même atlas
+ * dont une case est pleine (fonds et barres). Chaque moteur le dessine donc
+ * en un seul appel, hors des compteurs de getFrameStats(). Le texte n'est
+ * remis en page que toutes les TEXT_PERIOD_MS millisecondes, ce qui le rend
+ * lisible et laisse la mise en page hors du coût de l'image.
+ *
+ * AddFrame() est appelé par le thread applicatif, GetQuads() par le thread
+ * qui affiche (le thread de rendu du moteur SFML) : la liste est protégée
+ * par un verrou.
+ */
+class CPerfOverlay {
+public:
+  // Quadrilatère en pixels de la fenêtre, et case de l'atlas (en texels)
+  // étirée dessus. Pour les fonds, u0 == u1 et v0 == v1 désignent un texel
+  // plein
+  struct SQuad {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+    ARGB color;
+  };
+
+  // Atlas de couverture (8 bits par texel) : 64 caractères ASCII de l'espace
+  // au souligné, sur 16 colonnes de cases de 6 x 8 texels, puis une case
+  // pleine
+  static const unsigned ATLAS_WIDTH = 96;
+  static const unsigned ATLAS_HEIGHT = 40;
+  static const uint8_t *GetAtlas();
+
+  // Touche de bascule (code de touche virtuelle de F12)
+  static const unsigned TOGGLE_KEY = 123;
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  enum { HISTORY = 120, TEXT_PERIOD_MS = 500 };
+
+  std::mutex m_mutex;
+  std::atomic<bool> m_bVisible;
+  double m_dBudgetMs;
+
+  // Historique circulaire des durées d'image, en millisecondes
+  float m_afHistory[HISTORY];
+  unsigned m_nHistory, m_nNext;
+
+  // Cumuls depuis la dernière mise en page du texte
+  clock::time_point m_lastText;
+  unsigned m_nFrames;
+  double m_dSumMs, m_dMaxMs;
+  unsigned long long m_nDrawCalls, m_nVertices;
+  unsigned long m_nCacheHits, m_nCacheMisses;
+
+  std::vector<SQuad> m_vText;  // Texte mis en page
+  std::vector<SQuad> m_vQuads; // HUD complet, renvoyé par GetQuads()
+
+  void LayoutText(const SFrameStats &stats);
+  void AddText(float x, float y, const char *pszText);
+
+public:
+  CPerfOverlay();
+
+  void Show(bool bShow);
+  bool IsVisible() const { return m_bVisible.load(std::memory_order_relaxed); }
+  // Bascule l'affichage sur la touche TOGGLE_KEY (l'événement est tout de
+  // même transmis à l'application)
+  void OnEvent(const evt &e);
+
+  // Fin d'une image : durée depuis la précédente (0 si inconnue) et
+  // compteurs publiés par getFrameStats()
+  void AddFrame(double dFrameMs, const SFrameStats &stats);
+
+  // Copie le HUD dans vQuads, le fond en premier. Renvoie false s'il est
+  // masqué ou pas encore mis en page
+  bool GetQuads(std::vector<SQuad> &vQuads);
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,92 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : sondes statiques USDT (User Statically
+// Defined Tracing) pour perf, bpftrace ou SystemTap.
+
+#include <chrono>
+#include <cstdint>
+
+/*
+ * Sondes du fournisseur « libgraph2 ».
+ *
+ * Avec <sys/sdt.h> (paquet systemtap-sdt-dev), chaque sonde est une
+ * instruction nop accompagnée d'une note ELF décrivant l'emplacement de ses
+ * arguments : sans traceur attaché, elle ne coûte que le calcul de ses
+ * arguments, choisis parmi les valeurs déjà disponibles. Le traceur
+ * remplace le nop par un point d'arrêt. Sans l'en-tête, les sondes ne sont
+ * pas compilées.
+ *
+ * Sondes et arguments :
+ *   frame__begin    début de beginPaint()
+ *   frame__end      fin de endPaint() : intervalle depuis l'image
+ *                   précédente (µs, 0 pour la première)
+ *   display         image affichée : durée de l'affichage (µs)
+ *   texture__load   fichier, largeur, hauteur, octets décodés, durée (µs) ;
+ *                   largeur et hauteur nulles si le chargement échoue
+ *   font__load      fichier, succès (0 ou 1), durée (µs)
+ *   event           événement rendu par waitForEvent() : type (evt_type),
+ *                   x, y, code de touche
+ *
+ * Exemple :
+ *   bpftrace -e 'usdt:./libLibGraph2.so:libgraph2:display
+ *                { @us = hist(arg0); }'
+ */
+#ifdef LIBGRAPH2_HAVE_SDT
+#  include <sys/sdt.h>
+#  define LIBGRAPH2_PROBE0(name) DTRACE_PROBE(libgraph2, name)
+#  define LIBGRAPH2_PROBE1(name, a1) DTRACE_PROBE1(libgraph2, name, a1)
+#  define LIBGRAPH2_PROBE3(name, a1, a2, a3)                                 \
+    DTRACE_PROBE3(libgraph2, name, a1, a2, a3)
+#  define LIBGRAPH2_PROBE4(name, a1, a2, a3, a4)                             \
+    DTRACE_PROBE4(libgraph2, name, a1, a2, a3, a4)
+#  define LIBGRAPH2_PROBE5(name, a1, a2, a3, a4, a5)                         \
+    DTRACE_PROBE5(libgraph2, name, a1, a2, a3, a4, a5)
+#else
+#  define LIBGRAPH2_PROBE0(name) ((void)0)
+#  define LIBGRAPH2_PROBE1(name, a1) ((void)0)
+#  define LIBGRAPH2_PROBE3(name, a1, a2, a3) ((void)0)
+#  define LIBGRAPH2_PROBE4(name, a1, a2, a3, a4) ((void)0)
+#  define LIBGRAPH2_PROBE5(name, a1, a2, a3, a4, a5) ((void)0)
+#endif
+
+namespace LibGraph2 {
+
+// Durée passée en argument d'une sonde, en microsecondes. Sans les sondes,
+// l'horloge n'est pas lue
+class CProbeClock {
+#ifdef LIBGRAPH2_HAVE_SDT
+private:
+  typedef std::chrono::steady_clock clock;
+  clock::time_point m_start;
+
+public:
+  CProbeClock() : m_start(clock::now()) {}
+  uint64_t ElapsedUs() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               clock::now() - m_start)
+        .count();
+  }
+#else
+public:
+  CProbeClock() {}
+  uint64_t ElapsedUs() const { return 0; }
+#endif
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,438 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _USE_MATH_DEFINES
+#include "LibGraph2Raster.h"
+#include "LibGraph2Image.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#  define LIBGRAPH2_RASTER_SSE2
+#endif
+
+using namespace std;
+
+namespace LibGraph2 {
+
+// Noyaux de mélange
+
+// Division par 255 arrondie, exacte pour x <= 255 * 255
+static inline uint32_t Div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t BlendPixelScalar(uint32_t d, uint32_t s) {
+  uint32_t a = s >> 24;
+  uint32_t inv = 255 - a;
+  uint32_t b = Div255((s & 0xFF) * a + (d & 0xFF) * inv);
+  uint32_t g = Div255(((s >> 8) & 0xFF) * a + ((d >> 8) & 0xFF) * inv);
+  uint32_t r = Div255(((s >> 16) & 0xFF) * a + ((d >> 16) & 0xFF) * inv);
+  uint32_t aa = Div255(a * 255 + (d >> 24) * inv);
+  return (aa << 24) | (r << 16) | (g << 8) | b;
+}
+
+#ifdef LIBGRAPH2_RASTER_SSE2
+// Division par 255 sur 8 entiers de 16 bits
+static inline __m128i Div255x8(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+void FillSpanKernel(uint32_t *pDst, int nCount, ARGB color) {
+  uint32_t a = color >> 24;
+  if (a == 0 || nCount <= 0)
+    return;
+
+  int i = 0;
+  if (a == 255) {
+#ifdef LIBGRAPH2_RASTER_SSE2
+    __m128i c = _mm_set1_epi32((int)color);
+    for (; i + 4 <= nCount; i += 4)
+      _mm_storeu_si128((__m128i *)(pDst + i), c);
+#endif
+    for (; i < nCount; i++)
+      pDst[i] = color;
+    return;
+  }
+
+#ifdef LIBGRAPH2_RASTER_SSE2
+  // Terme source précalculé par composante (B, G, R, A en mémoire) : la
+  // couleur est pondérée par a, l'alpha par 255
+  uint16_t sb = (uint16_t)((color & 0xFF) * a);
+  uint16_t sg = (uint16_t)(((color >> 8) & 0xFF) * a);
+  uint16_t sr = (uint16_t)(((color >> 16) & 0xFF) * a);
+  uint16_t sa = (uint16_t)(a * 255);
+  __m128i src = _mm_set_epi16((short)sa, (short)sr, (short)sg, (short)sb,
+                              (short)sa, (short)sr, (short)sg, (short)sb);
+  __m128i inv = _mm_set1_epi16((short)(255 - a));
+  __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= nCount; i += 4) {
+    __m128i d = _mm_loadu_si128((const __m128i *)(pDst + i));
+    __m128i lo = _mm_unpacklo_epi8(d, zero);
+    __m128i hi = _mm_unpackhi_epi8(d, zero);
+    lo = Div255x8(_mm_add_epi16(_mm_mullo_epi16(lo, inv), src));
+    hi = Div255x8(_mm_add_epi16(_mm_mullo_epi16(hi, inv), src));
+    _mm_storeu_si128((__m128i *)(pDst + i), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < nCount; i++)
+    pDst[i] = BlendPixelScalar(pDst[i], color);
+}
+
+void BlendSpanKernel(uint32_t *pDst, const uint32_t *pSrc, int nCount) {
+  int i = 0;
+#ifdef LIBGRAPH2_RASTER_SSE2
+  __m128i zero = _mm_setzero_si128();
+  __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+  // Facteur source : alpha pour les couleurs, 255 pour l'alpha
+  __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  __m128i v255 = _mm_set1_epi16(255);
+  for (; i + 4 <= nCount; i += 4) {
+    __m128i s = _mm_loadu_si128((const __m128i *)(pSrc + i));
+    __m128i sa = _mm_and_si128(s, alphaMask);
+    int nOpaque = _mm_movemask_epi8(_mm_cmpeq_epi32(sa, alphaMask));
+    if (nOpaque == 0xFFFF) {
+      _mm_storeu_si128((__m128i *)(pDst + i), s);
+      continue;
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, zero)) == 0xFFFF)
+      continue;
+
+    __m128i d = _mm_loadu_si128((const __m128i *)(pDst + i));
+    __m128i res[2];
+    for (int h = 0; h < 2; h++) {
+      __m128i s16 = h ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+      __m128i d16 = h ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+      // Alpha de chaque pixel diffusé sur ses 4 composantes
+      __m128i a16 = _mm_shufflehi_epi16(
+          _mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)),
+          _MM_SHUFFLE(3, 3, 3, 3));
+      __m128i sf = _mm_or_si128(_mm_and_si128(a16, colorLanes), alphaLanes);
+      __m128i x = _mm_add_epi16(_mm_mullo_epi16(s16, sf),
+                                _mm_mullo_epi16(d16, _mm_sub_epi16(v255, a16)));
+      res[h] = Div255x8(x);
+    }
+    _mm_storeu_si128((__m128i *)(pDst + i), _mm_packus_epi16(res[0], res[1]));
+  }
+#endif
+  for (; i < nCount; i++) {
+    uint32_t a = pSrc[i] >> 24;
+    if (a == 255)
+      pDst[i] = pSrc[i];
+    else if (a != 0)
+      pDst[i] = BlendPixelScalar(pDst[i], pSrc[i]);
+  }
+}
+
+// Surface
+
+CSurface::CSurface() : m_nWidth(0), m_nHeight(0), m_pPixels(NULL) {
+  ResetDamage();
+}
+
+void CSurface::Resize(unsigned nWidth, unsigned nHeight) {
+  m_nWidth = nWidth;
+  m_nHeight = nHeight;
+  m_vPixels.assign((size_t)nWidth * nHeight, 0);
+  m_pPixels = m_vPixels.data();
+  DamageAll();
+}
+
+void CSurface::Attach(uint32_t *pPixels, unsigned nWidth, unsigned nHeight) {
+  m_nWidth = nWidth;
+  m_nHeight = nHeight;
+  m_pPixels = pPixels;
+  std::vector<uint32_t>().swap(m_vPixels);
+  DamageAll();
+}
+
+bool CSurface::getDamage(int &x, int &y, int &nWidth, int &nHeight) const {
+  if (m_nDamageX0 >= m_nDamageX1 || m_nDamageY0 >= m_nDamageY1)
+    return false;
+  x = m_nDamageX0;
+  y = m_nDamageY0;
+  nWidth = m_nDamageX1 - m_nDamageX0;
+  nHeight = m_nDamageY1 - m_nDamageY0;
+  return true;
+}
+
+void CSurface::ResetDamage() {
+  m_nDamageX0 = m_nDamageY0 = INT_MAX;
+  m_nDamageX1 = m_nDamageY1 = INT_MIN;
+}
+
+void CSurface::DamageAll() {
+  m_nDamageX0 = m_nDamageY0 = 0;
+  m_nDamageX1 = (int)m_nWidth;
+  m_nDamageY1 = (int)m_nHeight;
+}
+
+void CSurface::Damage(int x, int y, int nWidth, int nHeight) {
+  if (nWidth <= 0 || nHeight <= 0)
+    return;
+  AddDamage(y, x, x + nWidth);
+  AddDamage(y + nHeight - 1, x, x + nWidth);
+}
+
+void CSurface::Clear(ARGB color) {
+  // Effacer remplace les pixels, sans mélange
+  DamageAll();
+  uint32_t *p = m_pPixels;
+  size_t n = (size_t)m_nWidth * m_nHeight;
+  if (color == 0) {
+    memset(p, 0, n * sizeof(uint32_t));
+    return;
+  }
+  size_t i = 0;
+#ifdef LIBGRAPH2_RASTER_SSE2
+  __m128i c = _mm_set1_epi32((int)color);
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_si128((__m128i *)(p + i), c);
+#endif
+  for (; i < n; i++)
+    p[i] = color;
+}
+
+void CSurface::FillSpan(int y, int x0, int x1, const SFill &fill) {
+  if (y < 0 || y >= (int)m_nHeight)
+    return;
+  x0 = max(x0, 0);
+  x1 = min(x1, (int)m_nWidth);
+  if (x0 >= x1)
+    return;
+  AddDamage(y, x0, x1);
+  if (!fill.pPattern) {
+    FillSpanKernel(getRow(y) + x0, x1 - x0, fill.color);
+    return;
+  }
+
+  // Ligne de l'image répétée, puis mélange comme une image dessinée
+  const SImage &pattern = *fill.pPattern;
+  const uint32_t *pRow =
+      pattern.vPixels.data() + (size_t)(y % pattern.nHeight) * pattern.nWidth;
+  m_vPattern.resize(x1 - x0);
+  unsigned u = (unsigned)x0 % pattern.nWidth;
+  for (int x = x0; x < x1; x++) {
+    m_vPattern[x - x0] = pRow[u];
+    if (++u == pattern.nWidth)
+      u = 0;
+  }
+  BlendSpanKernel(getRow(y) + x0, m_vPattern.data(), x1 - x0);
+}
+
+void CSurface::BlendSpan(int y, int x, const uint32_t *pSrc, int nCount) {
+  if (y < 0 || y >= (int)m_nHeight)
+    return;
+  if (x < 0) {
+    pSrc -= x;
+    nCount += x;
+    x = 0;
+  }
+  nCount = min(nCount, (int)m_nWidth - x);
+  if (nCount > 0) {
+    AddDamage(y, x, x + nCount);
+    BlendSpanKernel(getRow(y) + x, pSrc, nCount);
+  }
+}
+
+void CSurface::BlendPixel(int x, int y, ARGB color) {
+  if (x < 0 || y < 0 || x >= (int)m_nWidth || y >= (int)m_nHeight)
+    return;
+  AddDamage(y, x, x + 1);
+  uint32_t &d = getRow(y)[x];
+  uint32_t a = color >> 24;
+  if (a == 255)
+    d = color;
+  else if (a != 0)
+    d = BlendPixelScalar(d, color);
+}
+
+// Remplissage par balayage avec table des arêtes actives. Chaque ligne est
+// échantillonnée en son centre (y + 0.5), et un pixel est rempli si son
+// centre est entre deux intersections (règle pair-impair).
+void CSurface::FillPolygon(const float *pXY, const int *pContourSizes,
+                           int nContours, const SFill &fill) {
+  if (!fill.IsVisible() || m_nWidth == 0 || m_nHeight == 0)
+    return;
+
+  m_vEdges.clear();
+  float fMinY = INFINITY, fMaxY = -INFINITY;
+  const float *p = pXY;
+  for (int c = 0; c < nContours; c++) {
+    int n = pContourSizes[c];
+    for (int i = 0; i < n; i++) {
+      float x0 = p[2 * i], y0 = p[2 * i + 1];
+      int j = (i + 1) % n;
+      float x1 = p[2 * j], y1 = p[2 * j + 1];
+      if (y0 == y1 || !std::isfinite(x0 + y0 + x1 + y1))
+        continue;
+      if (y0 > y1) {
+        swap(x0, x1);
+        swap(y0, y1);
+      }
+      SEdge e = {y0, y1, x0, (x1 - x0) / (y1 - y0)};
+      m_vEdges.push_back(e);
+      fMinY = min(fMinY, y0);
+      fMaxY = max(fMaxY, y1);
+    }
+    p += 2 * n;
+  }
+  if (m_vEdges.empty())
+    return;
+
+  sort(m_vEdges.begin(), m_vEdges.end(),
+       [](const SEdge &a, const SEdge &b) { return a.fYTop < b.fYTop; });
+
+  int yStart = max(0, (int)ceil(fMinY - 0.5f));
+  int yEnd = min((int)m_nHeight, (int)ceil(fMaxY - 0.5f));
+  size_t nNextEdge = 0;
+  m_vActive.clear();
+
+  for (int y = yStart; y < yEnd; y++) {
+    float yc = y + 0.5f;
+
+    // Arêtes qui commencent avant ce centre de ligne
+    while (nNextEdge < m_vEdges.size() && m_vEdges[nNextEdge].fYTop <= yc)
+      m_vActive.push_back((int)nNextEdge++);
+    // Arêtes terminées (intervalle [haut, bas[)
+    m_vActive.erase(remove_if(m_vActive.begin(), m_vActive.end(),
+                              [&](int i) { return m_vEdges[i].fYBottom <= yc; }),
+                    m_vActive.end());
+
+    m_vCrossings.clear();
+    for (int i : m_vActive) {
+      const SEdge &e = m_vEdges[i];
+      m_vCrossings.push_back(e.fXTop + (yc - e.fYTop) * e.fDxDy);
+    }
+    sort(m_vCrossings.begin(), m_vCrossings.end());
+
+    for (size_t k = 0; k + 1 < m_vCrossings.size(); k += 2) {
+      int x0 = (int)ceil(m_vCrossings[k] - 0.5f);
+      int x1 = (int)ceil(m_vCrossings[k + 1] - 0.5f);
+      FillSpan(y, x0, x1, fill);
+    }
+  }
+}
+
+void CSurface::FillRect(float x, float y, float w, float h,
+                        const SFill &fill) {
+  if (w < 0) {
+    x += w;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h;
+    h = -h;
+  }
+  int x0 = (int)ceil(x - 0.5f), x1 = (int)ceil(x + w - 0.5f);
+  int y0 = max(0, (int)ceil(y - 0.5f));
+  int y1 = min((int)m_nHeight, (int)ceil(y + h - 0.5f));
+  for (int yy = y0; yy < y1; yy++)
+    FillSpan(yy, x0, x1, fill);
+}
+
+void CSurface::StrokeRect(float x, float y, float w, float h, float fThickness,
+                          ARGB color) {
+  if (fThickness <= 0)
+    return;
+  float t = fThickness;
+  float pts[16] = {x - t, y - t,     x + w + t, y - t,     x + w + t, y + h + t,
+                   x - t, y + h + t, x,         y,         x + w,     y,
+                   x + w, y + h,     x,         y + h};
+  int sizes[2] = {4, 4};
+  FillPolygon(pts, sizes, 2, color);
+}
+
+// Ajoute un contour elliptique à m_vPoints / m_vContours, avec un nombre de
+// segments proportionnel à la taille
+void CSurface::AddEllipseContour(float cx, float cy, float rx, float ry) {
+  int n = (int)(2 * M_PI * max(fabs(rx), fabs(ry)) / 2);
+  n = min(max(n, 16), 1024);
+  for (int i = 0; i < n; i++) {
+    double a = 2 * M_PI * i / n;
+    m_vPoints.push_back((float)(cx + rx * cos(a)));
+    m_vPoints.push_back((float)(cy + ry * sin(a)));
+  }
+  m_vContours.push_back(n);
+}
+
+void CSurface::FillEllipse(float x, float y, float w, float h,
+                           const SFill &fill) {
+  // Ellipse exacte, ligne par ligne
+  float rx = fabs(w) / 2, ry = fabs(h) / 2;
+  if (rx <= 0 || ry <= 0)
+    return;
+  float cx = x + w / 2, cy = y + h / 2;
+  int y0 = max(0, (int)ceil(cy - ry - 0.5f));
+  int y1 = min((int)m_nHeight, (int)ceil(cy + ry - 0.5f));
+  for (int yy = y0; yy < y1; yy++) {
+    float dy = (yy + 0.5f - cy) / ry;
+    float d = 1 - dy * dy;
+    if (d <= 0)
+      continue;
+    float dx = rx * sqrt(d);
+    FillSpan(yy, (int)ceil(cx - dx - 0.5f), (int)ceil(cx + dx - 0.5f), fill);
+  }
+}
+
+void CSurface::StrokeEllipse(float x, float y, float w, float h,
+                             float fThickness, ARGB color) {
+  if (fThickness <= 0)
+    return;
+  float rx = fabs(w) / 2, ry = fabs(h) / 2;
+  float cx = x + w / 2, cy = y + h / 2;
+  m_vPoints.clear();
+  m_vContours.clear();
+  AddEllipseContour(cx, cy, rx + fThickness, ry + fThickness);
+  if (rx > 0 && ry > 0)
+    AddEllipseContour(cx, cy, rx, ry);
+  FillPolygon(m_vPoints.data(), m_vContours.data(), (int)m_vContours.size(),
+              color);
+}
+
+void CSurface::DrawLine(float x1, float y1, float x2, float y2,
+                        float fThickness, ARGB color) {
+  float hw = max(fThickness, 1.0f) / 2;
+  float dx = x2 - x1, dy = y2 - y1;
+  float len = sqrt(dx * dx + dy * dy);
+  float nx, ny, ex, ey;
+  if (len > 0) {
+    nx = -dy / len * hw;
+    ny = dx / len * hw;
+    ex = ey = 0;
+  } else {
+    // Segment dégénéré : un carré de la largeur du trait
+    nx = 0;
+    ny = hw;
+    ex = hw;
+    ey = 0;
+  }
+  float pts[8] = {x1 + nx - ex, y1 + ny - ey, x2 + nx + ex, y2 + ny + ey,
+                  x2 - nx + ex, y2 - ny + ey, x1 - nx - ex, y1 - ny - ey};
+  int n = 4;
+  FillPolygon(pts, &n, 1, color);
+}
+
+} // namespace LibGraph2
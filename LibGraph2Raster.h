@@ -0,0 +1,138 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : rastérisation logicielle sur une surface
+// ARGB en mémoire.
+
+#include "LibGraph2.h"
+#include <cstdint>
+#include <vector>
+
+namespace LibGraph2 {
+
+// Noyaux de remplissage, vectorisés en SSE2 lorsque c'est possible.
+// Mélange "source over" identique à sf::BlendAlpha : les composantes de
+// couleur sont pondérées par l'alpha source, l'alpha résultant vaut
+// a_src + a_dst * (1 - a_src).
+
+// Mélange une couleur constante sur nCount pixels
+void FillSpanKernel(uint32_t *pDst, int nCount, ARGB color);
+// Mélange nCount pixels source (alpha par pixel) sur nCount pixels
+void BlendSpanKernel(uint32_t *pDst, const uint32_t *pSrc, int nCount);
+
+struct SImage;
+
+// Remplissage d'une forme : une couleur, ou une image (pinceau texturé)
+// répétée depuis le coin de la surface
+struct SFill {
+  ARGB color;
+  const SImage *pPattern;
+
+  SFill(ARGB c) : color(c), pPattern(NULL) {}
+  explicit SFill(const SImage *pImage) : color(0), pPattern(pImage) {}
+  bool IsVisible() const { return pPattern || (color >> 24) != 0; }
+};
+
+/*
+ * Surface ARGB (0xAARRGGBB, lignes contiguës, sans marge) et primitives de
+ * rastérisation. Un pixel est couvert par une forme si son centre est à
+ * l'intérieur de celle-ci (pas d'anticrénelage, comme SFML par défaut).
+ */
+class CSurface {
+private:
+  unsigned m_nWidth;
+  unsigned m_nHeight;
+  // Pixels : m_vPixels, ou une mémoire externe fournie par Attach()
+  uint32_t *m_pPixels;
+  std::vector<uint32_t> m_vPixels;
+
+  // Zone modifiée depuis le dernier ResetDamage() (vide si x0 >= x1)
+  int m_nDamageX0, m_nDamageY0, m_nDamageX1, m_nDamageY1;
+
+  // Tampons de travail du remplissage de polygones
+  struct SEdge {
+    float fYTop, fYBottom;
+    float fXTop, fDxDy;
+  };
+  std::vector<SEdge> m_vEdges;
+  std::vector<int> m_vActive;
+  std::vector<float> m_vCrossings;
+  std::vector<float> m_vPoints;
+  std::vector<int> m_vContours;
+  // Pixels d'un span du pinceau texturé
+  std::vector<uint32_t> m_vPattern;
+
+  void AddEllipseContour(float cx, float cy, float rx, float ry);
+
+  // Span [x0, x1) de la ligne y, déjà découpé aux bords de la surface
+  void AddDamage(int y, int x0, int x1) {
+    m_nDamageX0 = x0 < m_nDamageX0 ? x0 : m_nDamageX0;
+    m_nDamageX1 = x1 > m_nDamageX1 ? x1 : m_nDamageX1;
+    m_nDamageY0 = y < m_nDamageY0 ? y : m_nDamageY0;
+    m_nDamageY1 = y >= m_nDamageY1 ? y + 1 : m_nDamageY1;
+  }
+
+public:
+  CSurface();
+
+  void Resize(unsigned nWidth, unsigned nHeight);
+  // Dessine directement dans pPixels (par exemple une image partagée avec
+  // le serveur X11), qui doit rester valable jusqu'au prochain Attach() ou
+  // Resize(). Le contenu de pPixels est conservé
+  void Attach(uint32_t *pPixels, unsigned nWidth, unsigned nHeight);
+  unsigned getWidth() const { return m_nWidth; }
+  unsigned getHeight() const { return m_nHeight; }
+  uint32_t *getPixels() { return m_pPixels; }
+  const uint32_t *getPixels() const { return m_pPixels; }
+  uint32_t *getRow(int y) { return m_pPixels + (size_t)y * m_nWidth; }
+
+  // Rectangle englobant les pixels modifiés depuis le dernier
+  // ResetDamage(). Renvoie false si aucun pixel ne l'a été
+  bool getDamage(int &x, int &y, int &nWidth, int &nHeight) const;
+  void ResetDamage();
+  // Marque toute la surface, ou un rectangle de celle-ci, comme modifié
+  void DamageAll();
+  void Damage(int x, int y, int nWidth, int nHeight);
+
+  void Clear(ARGB color);
+
+  // Spans horizontaux, découpés aux bords de la surface
+  void FillSpan(int y, int x0, int x1, const SFill &fill);
+  void BlendSpan(int y, int x, const uint32_t *pSrc, int nCount);
+  void BlendPixel(int x, int y, ARGB color);
+
+  // Polygone à plusieurs contours, règle pair-impair. pXY contient les
+  // sommets (x, y) de tous les contours à la suite, pContourSizes le nombre
+  // de sommets de chacun.
+  void FillPolygon(const float *pXY, const int *pContourSizes, int nContours,
+                   const SFill &fill);
+
+  // Formes de base (coordonnées en pixels). Les contours d'épaisseur
+  // fThickness sont tracés à l'extérieur de la forme, comme avec SFML.
+  void FillRect(float x, float y, float w, float h, const SFill &fill);
+  void StrokeRect(float x, float y, float w, float h, float fThickness,
+                  ARGB color);
+  void FillEllipse(float x, float y, float w, float h, const SFill &fill);
+  void StrokeEllipse(float x, float y, float w, float h, float fThickness,
+                     ARGB color);
+  // Segment d'épaisseur fThickness (au moins 1 pixel), centré sur la ligne
+  void DrawLine(float x1, float y1, float x2, float y2, float fThickness,
+                ARGB color);
+};
+
+} // namespace LibGraph2
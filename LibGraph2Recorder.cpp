@@ -0,0 +1,174 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Recorder.h"
+
+using namespace std;
+
+namespace LibGraph2 {
+
+CRecorder::CRecorder()
+    : m_bHasDrawing(false), m_penColor(MakeARGB(255, 0, 0, 0)),
+      m_fPenWidth(1.0f), m_brushColor(0), m_dScale(1.0), m_nOffsetX(0),
+      m_nOffsetY(0) {
+  RecordState();
+}
+
+// Chaque séquence enregistrée commence par l'état courant de l'enregistreur,
+// pour être indépendante de l'état de la fenêtre et des autres enregistreurs
+void CRecorder::RecordState() {
+  SCmdSetPen pen = {m_penColor, UnmapLength(m_fPenWidth)};
+  m_buffer.append(cmd_op::SetPen, &pen, sizeof pen);
+  SCmdSetBrush brush = {m_brushColor};
+  m_buffer.append(cmd_op::SetBrush, &brush, sizeof brush);
+}
+
+void CRecorder::SetTransform(double dScale, int nOffsetX, int nOffsetY) {
+  if (dScale == m_dScale && nOffsetX == m_nOffsetX && nOffsetY == m_nOffsetY)
+    return;
+  m_dScale = dScale;
+  m_nOffsetX = nOffsetX;
+  m_nOffsetY = nOffsetY;
+  // L'épaisseur du crayon dépend de l'échelle
+  SCmdSetPen pen = {m_penColor, UnmapLength(m_fPenWidth)};
+  m_buffer.append(cmd_op::SetPen, &pen, sizeof pen);
+}
+
+void CRecorder::Reset() {
+  m_buffer.clear();
+  m_bHasDrawing = false;
+  RecordState();
+}
+
+void CRecorder::discard() { Reset(); }
+
+void CRecorder::setPen(ARGB color, float fWidth, pen_DashStyles style) {
+  m_penColor = color;
+  m_fPenWidth = fWidth;
+  SCmdSetPen c = {color, UnmapLength(fWidth)};
+  m_buffer.append(cmd_op::SetPen, &c, sizeof c);
+}
+
+void CRecorder::setSolidBrush(ARGB color) {
+  m_brushColor = color;
+  SCmdSetBrush c = {color};
+  m_buffer.append(cmd_op::SetBrush, &c, sizeof c);
+}
+
+void CRecorder::RecordRect(cmd_op op, const CRectangle &bounds) {
+  SCmdRect c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+                UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+                UnmapLength(bounds.m_szSize.m_fWidth),
+                UnmapLength(bounds.m_szSize.m_fHeight)};
+  m_buffer.append(op, &c, sizeof c);
+  m_bHasDrawing = true;
+}
+
+void CRecorder::drawEllipse(const CRectangle &rectBounds) {
+  RecordRect(cmd_op::Ellipse, rectBounds);
+}
+
+void CRecorder::drawRectangle(const CRectangle &rectBounds) {
+  RecordRect(cmd_op::Rectangle, rectBounds);
+}
+
+void CRecorder::drawPie(const CRectangle &bounds, float startAngle,
+                        float sweepAngle) {
+  SCmdPie c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+               UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+               UnmapLength(bounds.m_szSize.m_fWidth),
+               UnmapLength(bounds.m_szSize.m_fHeight),
+               startAngle,
+               sweepAngle};
+  m_buffer.append(cmd_op::Pie, &c, sizeof c);
+  m_bHasDrawing = true;
+}
+
+void CRecorder::drawLine(const CPoint &ptP1, const CPoint &ptP2) {
+  SCmdLine c = {UnmapCoordinateX(ptP1.m_fX), UnmapCoordinateY(ptP1.m_fY),
+                UnmapCoordinateX(ptP2.m_fX), UnmapCoordinateY(ptP2.m_fY)};
+  m_buffer.append(cmd_op::Line, &c, sizeof c);
+  m_bHasDrawing = true;
+}
+
+void CRecorder::setPixel(const CPoint &ptPos, ARGB color) {
+  SCmdPixel c = {UnmapCoordinateX(ptPos.m_fX), UnmapCoordinateY(ptPos.m_fY),
+                 color};
+  m_buffer.append(cmd_op::Pixel, &c, sizeof c);
+  m_bHasDrawing = true;
+}
+
+void CRecorder::drawPolylines(const vector<CPoint> &vPoints, bool bAutoClose) {
+  vector<float> vCoords(vPoints.size() * 2);
+  for (size_t i = 0; i < vPoints.size(); i++) {
+    vCoords[2 * i] = UnmapCoordinateX(vPoints[i].m_fX);
+    vCoords[2 * i + 1] = UnmapCoordinateY(vPoints[i].m_fY);
+  }
+  SCmdPolyline c = {(uint32_t)vPoints.size(), bAutoClose ? 1u : 0u};
+  m_buffer.append(cmd_op::Polyline, &c, sizeof c, vCoords.data(),
+                  vCoords.size() * sizeof(float));
+  m_bHasDrawing = true;
+}
+
+void CRecorder::drawString(const CString &text, const CPoint &ptPos) {
+  const wstring &str = *text.operator->();
+  SCmdString c = {UnmapCoordinateX(ptPos.m_fX), UnmapCoordinateY(ptPos.m_fY),
+                  (uint32_t)str.size()};
+  m_buffer.append(cmd_op::String, &c, sizeof c, str.data(),
+                  str.size() * sizeof(wchar_t));
+  m_bHasDrawing = true;
+}
+
+void CRecorder::RecordBitmap(const CString &sFileName, const SCmdBitmap &c) {
+  string filename = string(sFileName);
+  SCmdBitmap cmd = c;
+  cmd.nNameLength = (uint32_t)filename.size();
+  m_buffer.append(cmd_op::Bitmap, &cmd, sizeof cmd, filename.data(),
+                  filename.size());
+  m_bHasDrawing = true;
+}
+
+void CRecorder::drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                           double dScaleFactor, double dAngleDeg,
+                           bool bXYIsCenter) {
+  SCmdBitmap c = {UnmapCoordinateX(ptPos.m_fX),
+                  UnmapCoordinateY(ptPos.m_fY),
+                  0,
+                  0,
+                  (float)(dScaleFactor * m_dScale),
+                  (float)dAngleDeg,
+                  bXYIsCenter ? bitmap_origin::Center : bitmap_origin::TopLeft,
+                  0};
+  RecordBitmap(sFileName, c);
+}
+
+void CRecorder::drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                           const CPoint &ptPosPivot, double dScaleFactor,
+                           double dAngleDeg) {
+  SCmdBitmap c = {UnmapCoordinateX(ptPos.m_fX),
+                  UnmapCoordinateY(ptPos.m_fY),
+                  ptPosPivot.m_fX,
+                  ptPosPivot.m_fY,
+                  (float)(dScaleFactor * m_dScale),
+                  (float)dAngleDeg,
+                  bitmap_origin::Pivot,
+                  0};
+  RecordBitmap(sFileName, c);
+}
+
+} // namespace LibGraph2
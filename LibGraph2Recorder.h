@@ -0,0 +1,93 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : enregistreur de commandes par thread.
+
+#include "LibGraph2.h"
+#include "LibGraph2Commands.h"
+
+namespace LibGraph2 {
+
+/*
+ * Implémentation de ILibGraph2Recorder, indépendante du moteur de rendu.
+ *
+ * Les coordonnées sont converties en pixels à l'enregistrement, avec la
+ * transformation figée par le moteur au début de la séquence beginPaint() /
+ * endPaint() (SetTransform()). Le moteur rejoue ensuite buffer() puis appelle
+ * Reset().
+ */
+class CRecorder : public ILibGraph2Recorder {
+private:
+  CCommandBuffer m_buffer;
+  bool m_bHasDrawing;
+
+  // Crayon et pinceau propres à l'enregistreur
+  ARGB m_penColor;
+  float m_fPenWidth;
+  ARGB m_brushColor;
+
+  // Transformation coordonnées normalisées -> pixels
+  double m_dScale;
+  int m_nOffsetX;
+  int m_nOffsetY;
+
+  float UnmapCoordinateX(float fX) const {
+    return (float)(fX * m_dScale + m_nOffsetX);
+  }
+  float UnmapCoordinateY(float fY) const {
+    return (float)(fY * m_dScale + m_nOffsetY);
+  }
+  float UnmapLength(float fLength) const { return (float)(fLength * m_dScale); }
+
+  void RecordState();
+  void RecordRect(cmd_op op, const CRectangle &rectBounds);
+  void RecordBitmap(const CString &sFileName, const SCmdBitmap &c);
+
+public:
+  CRecorder();
+  virtual ~CRecorder() {}
+
+  // Interface moteur (thread de dessin uniquement)
+  void SetTransform(double dScale, int nOffsetX, int nOffsetY);
+  bool HasDrawing() const { return m_bHasDrawing; }
+  const CCommandBuffer &buffer() const { return m_buffer; }
+  void Reset();
+
+  // Implémentation de ILibGraph2Recorder
+  virtual void setPen(ARGB color, float fWidth,
+                      pen_DashStyles style = pen_DashStyles::Solid);
+  virtual void setSolidBrush(ARGB color);
+  virtual void drawEllipse(const CRectangle &rectBounds);
+  virtual void drawPie(const CRectangle &rectBounds, float startAngle,
+                       float sweepAngle);
+  virtual void drawLine(const CPoint &ptP1, const CPoint &ptP2);
+  virtual void drawRectangle(const CRectangle &rectBounds);
+  virtual void setPixel(const CPoint &ptPos, ARGB color);
+  virtual void drawPolylines(const std::vector<CPoint> &vPoints,
+                             bool bAutoClose = false);
+  virtual void drawString(const CString &text, const CPoint &ptPos);
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          double dScaleFactor = 1.0, double dAngleDeg = 0,
+                          bool bXYIsCenter = false);
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          const CPoint &ptPosPivot, double dScaleFactor,
+                          double dAngleDeg);
+  virtual void discard();
+};
+
+} // namespace LibGraph2
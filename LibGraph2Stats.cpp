@@ -0,0 +1,299 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Stats.h"
+#include "LibGraph2Probes.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace LibGraph2 {
+
+thread_local CStatsScope *CStatsScope::s_pActive = NULL;
+
+void CFrameStats::EndAppFrame() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_last.nDisplays = m_app.nDisplays;
+  m_last.dDrawMs = m_app.dDrawMs;
+  m_last.dDisplayMs = m_app.dDisplayMs;
+  m_allocations.EndFrame(m_last);
+  m_app = SFrameStats();
+}
+
+void CFrameStats::EndRenderFrame() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_last.nDrawCalls = m_render.nDrawCalls;
+  m_last.nVertices = m_render.nVertices;
+  m_last.nTextureUploads = m_render.nTextureUploads;
+  m_last.nTextureCacheHits = m_render.nTextureCacheHits;
+  m_last.nTextureCacheMisses = m_render.nTextureCacheMisses;
+  m_last.nFontLoads = m_render.nFontLoads;
+  m_last.nCulled = m_render.nCulled;
+  m_last.nTextureBytes = m_render.nTextureBytes;
+  m_last.dGpuMs = m_render.dGpuMs;
+  m_render = SFrameStats();
+}
+
+SFrameStats CFrameStats::Get() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_last;
+}
+
+void CFrameStats::GetAllocations(std::vector<SAllocationStats> &vAllocations) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  vAllocations = m_allocations.Last();
+}
+
+unsigned CFrameHistogram::Index(uint64_t nUs) {
+  if (nUs < LINEAR)
+    return (unsigned)nUs;
+  // Position du bit de poids fort : la puissance de deux [2^m, 2^(m+1)[
+  // occupe les cases (m - 6) * 64 à (m - 5) * 64 - 1
+  unsigned nMsb = 63 - (unsigned)__builtin_clzll(nUs);
+  unsigned nShift = nMsb - 6;
+  unsigned nIndex = (nShift + 1) * SUB + (unsigned)(nUs >> nShift) - SUB;
+  return nIndex < BUCKETS ? nIndex : BUCKETS - 1;
+}
+
+uint64_t CFrameHistogram::LowerBound(unsigned nIndex) {
+  if (nIndex < LINEAR)
+    return nIndex;
+  unsigned nShift = nIndex / SUB - 1;
+  return (uint64_t)(nIndex - nShift * SUB) << nShift;
+}
+
+void CFrameHistogram::Record(uint64_t nUs) {
+  m_counts[Index(nUs)]++;
+  m_nTotal++;
+  if (nUs > m_nMaxUs)
+    m_nMaxUs = nUs;
+}
+
+void CFrameHistogram::Reset() {
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+  m_nTotal = 0;
+  m_nMaxUs = 0;
+}
+
+SFrameTimes CFrameHistogram::Summarize(double dBudgetMs) const {
+  SFrameTimes times = SFrameTimes();
+  times.nFrames = m_nTotal;
+  if (m_nTotal == 0)
+    return times;
+  times.dMaxMs = m_nMaxUs / 1000.0;
+
+  // Rangs (à partir de 1) des trois centiles
+  const double adQuantiles[3] = {0.50, 0.90, 0.99};
+  double *apdResults[3] = {&times.dP50Ms, &times.dP90Ms, &times.dP99Ms};
+  unsigned long anRanks[3];
+  for (int i = 0; i < 3; ++i) {
+    anRanks[i] = (unsigned long)(adQuantiles[i] * m_nTotal + 0.999999);
+    if (anRanks[i] == 0)
+      anRanks[i] = 1;
+  }
+
+  const uint64_t nBudgetUs = (uint64_t)(dBudgetMs * 1000.0);
+  unsigned long nSeen = 0;
+  int nNext = 0;
+  for (unsigned i = 0; i < BUCKETS; ++i) {
+    if (m_counts[i] == 0)
+      continue;
+    nSeen += m_counts[i];
+    // Borne supérieure de la case, sans dépasser le maximum observé
+    uint64_t nUpper = i + 1 < BUCKETS ? LowerBound(i + 1) - 1 : m_nMaxUs;
+    if (nUpper > m_nMaxUs)
+      nUpper = m_nMaxUs;
+    while (nNext < 3 && nSeen >= anRanks[nNext])
+      *apdResults[nNext++] = nUpper / 1000.0;
+    if (LowerBound(i) > nBudgetUs)
+      times.nOverBudget += m_counts[i];
+  }
+  return times;
+}
+
+CFrameTimes::CFrameTimes()
+    : m_bHasPaint(false), m_bHasEvent(false), m_nPresents(0), m_nDisplays(0),
+      m_pDump(NULL), m_dPeriod(10), m_dBudgetMs(1000.0 / 60) {
+  // Capacité suffisante pour que les images ordinaires n'allouent rien
+  m_vInputs.reserve(64);
+  m_vPresented.reserve(64);
+  const char *szDump = getenv("LIBGRAPH2_FRAMETIMES");
+  if (szDump && *szDump) {
+    if (strcmp(szDump, "-") == 0)
+      m_pDump = stderr;
+    else if (!(m_pDump = fopen(szDump, "a")))
+      fprintf(stderr, "LibGraph2 : impossible d'ouvrir %s\n", szDump);
+  }
+  if (const char *szPeriod = getenv("LIBGRAPH2_FRAMETIMES_PERIOD"))
+    if (atof(szPeriod) > 0)
+      m_dPeriod = atof(szPeriod);
+  if (const char *szBudget = getenv("LIBGRAPH2_FRAME_BUDGET"))
+    if (atof(szBudget) > 0)
+      m_dBudgetMs = atof(szBudget);
+  m_lastDump = clock::now();
+}
+
+CFrameTimes::~CFrameTimes() {
+  if (m_pDump && m_periodInterval.Total() + m_periodResponse.Total() +
+                        m_periodLatency.Total() >
+                    0)
+    Dump(clock::now());
+  if (m_pDump && m_pDump != stderr)
+    fclose(m_pDump);
+}
+
+void CFrameTimes::OnEvent(evt &e) {
+  m_lastEvent = clock::now();
+  m_bHasEvent = true;
+  // Les entrées sont datées par le moteur à leur lecture dans la file du
+  // système ; les autres (rafraîchissement, rejeu) le sont ici
+  if (e.nTimestampUs == 0)
+    e.nTimestampUs =
+        (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            m_lastEvent.time_since_epoch())
+            .count();
+  LIBGRAPH2_PROBE4(event, (int)e.type, e.x, e.y, e.vkKeyCode);
+  switch (e.type) {
+  case evt_type::evtMouseMove:
+  case evt_type::evtMouseDown:
+  case evt_type::evtMouseUp:
+  case evt_type::evtKeyDown:
+  case evt_type::evtKeyUp:
+    // Un programme qui ne dessine jamais n'accumule pas les entrées
+    if (m_vInputs.size() < MAX_PENDING_INPUTS)
+      m_vInputs.push_back(e.nTimestampUs);
+    break;
+  default:
+    break;
+  }
+}
+
+void CFrameTimes::OnPresent() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_nPresents++;
+  for (uint64_t nTimestampUs : m_vInputs)
+    m_vPresented.push_back({m_nPresents, nTimestampUs});
+  m_vInputs.clear();
+}
+
+void CFrameTimes::OnDisplayed() {
+  uint64_t nNowUs = NowUs();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_nDisplays++;
+  size_t nDone = 0;
+  while (nDone < m_vPresented.size() &&
+         m_vPresented[nDone].nPresent <= m_nDisplays) {
+    uint64_t nUs = nNowUs - m_vPresented[nDone].nTimestampUs;
+    m_latency.Record(nUs);
+    m_periodLatency.Record(nUs);
+    nDone++;
+  }
+  m_vPresented.erase(m_vPresented.begin(), m_vPresented.begin() + nDone);
+}
+
+double CFrameTimes::OnEndPaint() {
+  clock::time_point now = clock::now();
+  uint64_t nIntervalUs = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_bHasPaint) {
+      nIntervalUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                        now - m_lastPaint)
+                        .count();
+      m_interval.Record(nIntervalUs);
+      m_periodInterval.Record(nIntervalUs);
+    }
+    // Un seul temps de réponse par événement : les images suivantes d'une
+    // animation sans attente d'événement n'en ont pas
+    if (m_bHasEvent) {
+      uint64_t nUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                         now - m_lastEvent)
+                         .count();
+      m_response.Record(nUs);
+      m_periodResponse.Record(nUs);
+      m_bHasEvent = false;
+    }
+  }
+  m_lastPaint = now;
+  m_bHasPaint = true;
+  LIBGRAPH2_PROBE1(frame__end, nIntervalUs);
+
+  if (m_pDump &&
+      std::chrono::duration<double>(now - m_lastDump).count() >= m_dPeriod)
+    Dump(now);
+  return nIntervalUs / 1000.0;
+}
+
+void CFrameTimes::Dump(clock::time_point now) {
+  SFrameTimes interval = m_periodInterval.Summarize(m_dBudgetMs);
+  SFrameTimes response = m_periodResponse.Summarize(m_dBudgetMs);
+  fprintf(m_pDump,
+          "LibGraph2 images %.1f s : intervalle n=%lu p50=%.2f p90=%.2f "
+          "p99=%.2f max=%.2f ms >%.1fms=%lu ; réponse n=%lu p50=%.2f "
+          "p90=%.2f p99=%.2f max=%.2f ms >%.1fms=%lu\n",
+          std::chrono::duration<double>(now - m_lastDump).count(),
+          interval.nFrames, interval.dP50Ms, interval.dP90Ms, interval.dP99Ms,
+          interval.dMaxMs, m_dBudgetMs, interval.nOverBudget,
+          response.nFrames, response.dP50Ms, response.dP90Ms,
+          response.dP99Ms, response.dMaxMs, m_dBudgetMs,
+          response.nOverBudget);
+  {
+    // Les latences sont aussi écrites par le thread de rendu
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_periodLatency.Total() > 0) {
+      SFrameTimes latency = m_periodLatency.Summarize(m_dBudgetMs);
+      fprintf(m_pDump,
+              "LibGraph2 entrées : latence n=%lu p50=%.2f p90=%.2f "
+              "p99=%.2f max=%.2f ms\n",
+              latency.nFrames, latency.dP50Ms, latency.dP90Ms,
+              latency.dP99Ms, latency.dMaxMs);
+    }
+    m_periodLatency.Reset();
+  }
+  fflush(m_pDump);
+  m_periodInterval.Reset();
+  m_periodResponse.Reset();
+  m_lastDump = now;
+}
+
+void CFrameTimes::Get(SFrameTimes &interval, SFrameTimes &response,
+                      double dBudgetMs) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  interval = m_interval.Summarize(dBudgetMs);
+  response = m_response.Summarize(dBudgetMs);
+}
+
+void CFrameTimes::GetInputLatency(SInputLatency &latency, double dBudgetMs) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  SFrameTimes times = m_latency.Summarize(dBudgetMs);
+  latency.nEvents = times.nFrames;
+  latency.nOverBudget = times.nOverBudget;
+  latency.dP50Ms = times.dP50Ms;
+  latency.dP90Ms = times.dP90Ms;
+  latency.dP99Ms = times.dP99Ms;
+  latency.dMaxMs = times.dMaxMs;
+}
+
+void CFrameTimes::Reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_interval.Reset();
+  m_response.Reset();
+  m_latency.Reset();
+}
+
+} // namespace LibGraph2
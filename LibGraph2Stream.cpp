@@ -0,0 +1,523 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Stream.h"
+#include "LibGraph2Stats.h"
+#include "LibGraph2Trace.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifdef LIBGRAPH2_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#  define LIBGRAPH2_STREAM_SSE2
+#endif
+
+using namespace std;
+
+namespace LibGraph2 {
+
+const unsigned CFrameServer::TILE_SIZE;
+
+// Entrées en attente au-delà desquelles celles des clients sont ignorées
+static const size_t MAX_PENDING_EVENTS = 1024;
+
+// Compare deux suites de pixels, 16 par itération
+static bool SpanEqual(const uint32_t *pA, const uint32_t *pB, unsigned nCount) {
+  unsigned i = 0;
+#ifdef LIBGRAPH2_STREAM_SSE2
+  for (; i + 16 <= nCount; i += 16) {
+    __m128i eq0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(pA + i)),
+                                  _mm_loadu_si128((const __m128i *)(pB + i)));
+    __m128i eq1 =
+        _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(pA + i + 4)),
+                        _mm_loadu_si128((const __m128i *)(pB + i + 4)));
+    __m128i eq2 =
+        _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(pA + i + 8)),
+                        _mm_loadu_si128((const __m128i *)(pB + i + 8)));
+    __m128i eq3 =
+        _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(pA + i + 12)),
+                        _mm_loadu_si128((const __m128i *)(pB + i + 12)));
+    __m128i eq = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+    if (_mm_movemask_epi8(eq) != 0xFFFF)
+      return false;
+  }
+  for (; i + 4 <= nCount; i += 4) {
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(pA + i)),
+                                 _mm_loadu_si128((const __m128i *)(pB + i)));
+    if (_mm_movemask_epi8(eq) != 0xFFFF)
+      return false;
+  }
+#endif
+  for (; i < nCount; i++)
+    if (pA[i] != pB[i])
+      return false;
+  return true;
+}
+
+static void PutU16(std::vector<uint8_t> &v, unsigned n) {
+  v.push_back((uint8_t)n);
+  v.push_back((uint8_t)(n >> 8));
+}
+
+static void PutU32(std::vector<uint8_t> &v, uint32_t n) {
+  for (int i = 0; i < 4; i++)
+    v.push_back((uint8_t)(n >> (8 * i)));
+}
+
+static uint32_t GetU32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+CFrameServer::CFrameServer()
+    : m_nListenFd(-1), m_nWidth(0), m_nHeight(0), m_nTilesX(0), m_nTilesY(0),
+      m_bShadowValid(false), m_bStop(false) {
+  m_nWakeFds[0] = m_nWakeFds[1] = -1;
+}
+
+CFrameServer::~CFrameServer() { Close(); }
+
+bool CFrameServer::Open(const string &strAddress) {
+  Close();
+
+  if (strAddress.compare(0, 5, "unix:") == 0) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    string strPath = strAddress.substr(5);
+    if (strPath.empty() || strPath.size() >= sizeof addr.sun_path) {
+      cerr << "LibGraph2 : adresse de serveur de diffusion invalide : "
+           << strAddress << endl;
+      return false;
+    }
+    strcpy(addr.sun_path, strPath.c_str());
+    // Socket laissé par une exécution précédente : tout autre fichier est
+    // laissé intact
+    struct stat st;
+    if (lstat(strPath.c_str(), &st) == 0) {
+      if (!S_ISSOCK(st.st_mode)) {
+        cerr << "LibGraph2 : " << strPath
+             << " existe et n'est pas un socket, serveur de diffusion non "
+                "démarré"
+             << endl;
+        return false;
+      }
+      unlink(strPath.c_str());
+    }
+    m_nListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_nListenFd >= 0 &&
+        bind(m_nListenFd, (sockaddr *)&addr, sizeof addr) == 0)
+      m_strUnixPath = strPath;
+    else if (m_nListenFd >= 0) {
+      close(m_nListenFd);
+      m_nListenFd = -1;
+    }
+  } else if (strAddress.compare(0, 4, "tcp:") == 0) {
+    // Sans adresse explicite, seule la boucle locale est écoutée : les
+    // clients peuvent injecter des entrées
+    string strHost = "127.0.0.1", strPort = strAddress.substr(4);
+    size_t nColon = strPort.rfind(':');
+    if (nColon != string::npos) {
+      strHost = strPort.substr(0, nColon);
+      strPort = strPort.substr(nColon + 1);
+    }
+    addrinfo hints, *pResult = NULL;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(strHost.c_str(), strPort.c_str(), &hints, &pResult) == 0) {
+      for (addrinfo *p = pResult; p && m_nListenFd < 0; p = p->ai_next) {
+        m_nListenFd =
+            socket(p->ai_family, p->ai_socktype | SOCK_CLOEXEC, p->ai_protocol);
+        if (m_nListenFd < 0)
+          continue;
+        int nOne = 1;
+        setsockopt(m_nListenFd, SOL_SOCKET, SO_REUSEADDR, &nOne, sizeof nOne);
+        if (bind(m_nListenFd, p->ai_addr, p->ai_addrlen) != 0) {
+          close(m_nListenFd);
+          m_nListenFd = -1;
+        }
+      }
+      freeaddrinfo(pResult);
+    }
+  } else {
+    cerr << "LibGraph2 : adresse de serveur de diffusion invalide : "
+         << strAddress << endl;
+    return false;
+  }
+
+  if (m_nListenFd < 0 || listen(m_nListenFd, 8) != 0 ||
+      pipe2(m_nWakeFds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    cerr << "LibGraph2 : impossible d'ouvrir le serveur de diffusion "
+         << strAddress << " : "
+         << strerror(errno) << endl;
+    Close();
+    return false;
+  }
+  fcntl(m_nListenFd, F_SETFL, fcntl(m_nListenFd, F_GETFL) | O_NONBLOCK);
+
+  m_bStop = false;
+  m_bShadowValid = false;
+  m_thread = std::thread(&CFrameServer::ServerProc, this);
+  return true;
+}
+
+void CFrameServer::Close() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_bStop = true;
+    }
+    Wake();
+    m_thread.join();
+  }
+
+  for (SClient *pClient : m_vClients) {
+    close(pClient->nFd);
+    delete pClient;
+  }
+  m_vClients.clear();
+  m_qEvents.clear();
+  if (m_nListenFd >= 0)
+    close(m_nListenFd);
+  m_nListenFd = -1;
+  for (int &nFd : m_nWakeFds) {
+    if (nFd >= 0)
+      close(nFd);
+    nFd = -1;
+  }
+  if (!m_strUnixPath.empty())
+    unlink(m_strUnixPath.c_str());
+  m_strUnixPath.clear();
+  m_vShadow.clear();
+  m_bShadowValid = false;
+}
+
+void CFrameServer::Wake() {
+  if (m_nWakeFds[1] < 0)
+    return;
+  // Tube plein : le thread sera réveillé de toute façon
+  char c = 0;
+  ssize_t n = write(m_nWakeFds[1], &c, 1);
+  (void)n;
+}
+
+void CFrameServer::SubmitFrame(const uint32_t *pPixels, unsigned nWidth,
+                               unsigned nHeight, bool bBottomUp) {
+  CTraceScope trace("SubmitFrame");
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_vClients.empty() || nWidth == 0 || nHeight == 0) {
+    // Personne ne regarde : l'image suivante sera envoyée en entier
+    m_bShadowValid = false;
+    return;
+  }
+
+  auto row = [&](unsigned y) {
+    return pPixels + (size_t)(bBottomUp ? nHeight - 1 - y : y) * nWidth;
+  };
+
+  if (!m_bShadowValid || nWidth != m_nWidth || nHeight != m_nHeight) {
+    m_nWidth = nWidth;
+    m_nHeight = nHeight;
+    m_nTilesX = (nWidth + TILE_SIZE - 1) / TILE_SIZE;
+    m_nTilesY = (nHeight + TILE_SIZE - 1) / TILE_SIZE;
+    m_vShadow.resize((size_t)nWidth * nHeight);
+    for (unsigned y = 0; y < nHeight; y++)
+      memcpy(&m_vShadow[(size_t)y * nWidth], row(y), nWidth * 4);
+    for (SClient *pClient : m_vClients)
+      pClient->vDirty.assign((size_t)m_nTilesX * m_nTilesY, 1);
+    m_bShadowValid = true;
+    Wake();
+    return;
+  }
+
+  bool bChanged = false;
+  for (unsigned ty = 0; ty < m_nTilesY; ty++) {
+    unsigned y0 = ty * TILE_SIZE, y1 = std::min(y0 + TILE_SIZE, nHeight);
+    for (unsigned tx = 0; tx < m_nTilesX; tx++) {
+      unsigned x0 = tx * TILE_SIZE, w = std::min(TILE_SIZE, nWidth - x0);
+      unsigned y = y0;
+      while (y < y1 &&
+             SpanEqual(row(y) + x0, &m_vShadow[(size_t)y * nWidth + x0], w))
+        y++;
+      if (y == y1)
+        continue;
+
+      // Les lignes déjà comparées sont identiques
+      for (; y < y1; y++)
+        memcpy(&m_vShadow[(size_t)y * nWidth + x0], row(y) + x0, w * 4);
+      size_t nTile = (size_t)ty * m_nTilesX + tx;
+      for (SClient *pClient : m_vClients)
+        if (nTile < pClient->vDirty.size())
+          pClient->vDirty[nTile] = 1;
+      bChanged = true;
+    }
+  }
+  if (bChanged)
+    Wake();
+}
+
+bool CFrameServer::PollEvent(evt &e) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_qEvents.empty())
+    return false;
+  e = m_qEvents.front();
+  m_qEvents.pop_front();
+  return true;
+}
+
+// Thread du serveur
+
+void CFrameServer::ServerProc() {
+  CTracer::SetThreadName("diffusion");
+  std::vector<pollfd> vFds;
+  for (;;) {
+    // Nouvelle mise à jour pour les clients qui ont reçu la précédente
+    for (size_t i = 0; i < m_vClients.size();) {
+      SClient &client = *m_vClients[i];
+      if (client.nOutPos == client.vOut.size()) {
+        BuildUpdate(client);
+        if (!Send(client)) {
+          RemoveClient(i);
+          continue;
+        }
+      }
+      i++;
+    }
+
+    vFds.clear();
+    vFds.push_back({m_nWakeFds[0], POLLIN, 0});
+    vFds.push_back({m_nListenFd, POLLIN, 0});
+    for (SClient *pClient : m_vClients) {
+      short nEvents = POLLIN;
+      if (pClient->nOutPos < pClient->vOut.size())
+        nEvents |= POLLOUT;
+      vFds.push_back({pClient->nFd, nEvents, 0});
+    }
+    if (poll(vFds.data(), vFds.size(), -1) < 0 && errno != EINTR)
+      break;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_bStop)
+        break;
+    }
+    if (vFds[0].revents & POLLIN) {
+      char buf[64];
+      while (read(m_nWakeFds[0], buf, sizeof buf) > 0)
+        ;
+    }
+    if (vFds[1].revents & POLLIN)
+      Accept();
+
+    // Les clients acceptés ci-dessus sont à la fin, hors de vFds
+    for (size_t i = vFds.size() - 2; i-- > 0;) {
+      short nRevents = vFds[i + 2].revents;
+      SClient &client = *m_vClients[i];
+      bool bOk = !(nRevents & (POLLERR | POLLNVAL));
+      if (bOk && (nRevents & (POLLIN | POLLHUP)))
+        bOk = Receive(client);
+      if (bOk && (nRevents & POLLOUT))
+        bOk = Send(client);
+      if (!bOk)
+        RemoveClient(i);
+    }
+  }
+}
+
+void CFrameServer::Accept() {
+  for (;;) {
+    int nFd = accept4(m_nListenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (nFd < 0)
+      return;
+    int nOne = 1;
+    setsockopt(nFd, IPPROTO_TCP, TCP_NODELAY, &nOne, sizeof nOne);
+
+    SClient *pClient = new SClient;
+    pClient->nFd = nFd;
+    pClient->nOutPos = 0;
+    const char szMagic[4] = {'L', 'G', '2', 'S'};
+    pClient->vOut.assign(szMagic, szMagic + 4);
+    PutU32(pClient->vOut, 1);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Première mise à jour : toute l'image
+    if (m_bShadowValid)
+      pClient->vDirty.assign((size_t)m_nTilesX * m_nTilesY, 1);
+    m_vClients.push_back(pClient);
+  }
+}
+
+void CFrameServer::BuildUpdate(SClient &client) {
+  CTraceScope trace("BuildUpdate");
+  struct STileRect {
+    unsigned x, y, w, h;
+  };
+  std::vector<STileRect> vTiles;
+  unsigned nWidth, nHeight;
+  {
+    // Copie des tuiles sous verrou ; la compression se fait ensuite, sans
+    // bloquer SubmitFrame()
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_bShadowValid ||
+        client.vDirty.size() != (size_t)m_nTilesX * m_nTilesY)
+      return;
+    nWidth = m_nWidth;
+    nHeight = m_nHeight;
+    m_vTile.clear();
+    for (size_t nTile = 0; nTile < client.vDirty.size(); nTile++) {
+      if (!client.vDirty[nTile])
+        continue;
+      client.vDirty[nTile] = 0;
+      STileRect r;
+      r.x = (unsigned)(nTile % m_nTilesX) * TILE_SIZE;
+      r.y = (unsigned)(nTile / m_nTilesX) * TILE_SIZE;
+      r.w = std::min(TILE_SIZE, nWidth - r.x);
+      r.h = std::min(TILE_SIZE, nHeight - r.y);
+      vTiles.push_back(r);
+      for (unsigned y = r.y; y < r.y + r.h; y++) {
+        const uint32_t *p = &m_vShadow[(size_t)y * nWidth + r.x];
+        m_vTile.insert(m_vTile.end(), p, p + r.w);
+      }
+    }
+  }
+  if (vTiles.empty())
+    return;
+
+  client.vOut.clear();
+  client.nOutPos = 0;
+  PutU32(client.vOut, nWidth);
+  PutU32(client.vOut, nHeight);
+  PutU32(client.vOut, (uint32_t)vTiles.size());
+  const uint32_t *pPixels = m_vTile.data();
+  for (const STileRect &r : vTiles) {
+    size_t nRawSize = (size_t)r.w * r.h * 4;
+    PutU16(client.vOut, r.x);
+    PutU16(client.vOut, r.y);
+    PutU16(client.vOut, r.w);
+    PutU16(client.vOut, r.h);
+
+    bool bCompressed = false;
+#ifdef LIBGRAPH2_HAVE_ZLIB
+    // Niveau 1 : les aplats d'un tableau de bord se compressent très bien
+    // même au niveau le plus rapide
+    uLongf nPackedSize = compressBound(nRawSize);
+    m_vPacked.resize(nPackedSize);
+    if (compress2(m_vPacked.data(), &nPackedSize, (const Bytef *)pPixels,
+                  nRawSize, 1) == Z_OK &&
+        nPackedSize < nRawSize) {
+      client.vOut.push_back(1);
+      PutU32(client.vOut, (uint32_t)nPackedSize);
+      client.vOut.insert(client.vOut.end(), m_vPacked.begin(),
+                         m_vPacked.begin() + nPackedSize);
+      bCompressed = true;
+    }
+#endif
+    if (!bCompressed) {
+      client.vOut.push_back(0);
+      PutU32(client.vOut, (uint32_t)nRawSize);
+      const uint8_t *pBytes = (const uint8_t *)pPixels;
+      client.vOut.insert(client.vOut.end(), pBytes, pBytes + nRawSize);
+    }
+    pPixels += (size_t)r.w * r.h;
+  }
+}
+
+// Envoie ce qui peut l'être sans bloquer. Renvoie false si le client est
+// déconnecté
+bool CFrameServer::Send(SClient &client) {
+  while (client.nOutPos < client.vOut.size()) {
+    ssize_t n = send(client.nFd, client.vOut.data() + client.nOutPos,
+                     client.vOut.size() - client.nOutPos, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    client.nOutPos += n;
+  }
+  client.vOut.clear();
+  client.nOutPos = 0;
+  return true;
+}
+
+bool CFrameServer::Receive(SClient &client) {
+  uint8_t buf[1024];
+  for (;;) {
+    ssize_t n = recv(client.nFd, buf, sizeof buf, 0);
+    if (n == 0)
+      return false;
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        return false;
+      break;
+    }
+    client.vIn.insert(client.vIn.end(), buf, buf + n);
+  }
+
+  // Les entrées sont datées à leur réception, pas quand l'application les lit
+  uint64_t nTimestampUs = CFrameTimes::NowUs();
+  size_t nPos = 0;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (; nPos + 16 <= client.vIn.size(); nPos += 16) {
+    const uint8_t *p = &client.vIn[nPos];
+    uint32_t nType = GetU32(p);
+    // Seules les entrées souris et clavier sont acceptées
+    if (nType > (uint32_t)evt_type::evtKeyUp ||
+        m_qEvents.size() >= MAX_PENDING_EVENTS)
+      continue;
+    evt e;
+    e.type = (evt_type)nType;
+    e.x = GetU32(p + 4);
+    e.y = GetU32(p + 8);
+    e.vkKeyCode = GetU32(p + 12);
+    e.nTimestampUs = nTimestampUs;
+    m_qEvents.push_back(e);
+  }
+  client.vIn.erase(client.vIn.begin(), client.vIn.begin() + nPos);
+  return true;
+}
+
+void CFrameServer::RemoveClient(size_t nIndex) {
+  SClient *pClient = m_vClients[nIndex];
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vClients.erase(m_vClients.begin() + nIndex);
+  }
+  close(pClient->nFd);
+  delete pClient;
+}
+
+} // namespace LibGraph2
@@ -0,0 +1,110 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : diffusion des images affichées vers des
+// clients distants, par tuiles modifiées.
+
+#include "LibGraph2.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LibGraph2 {
+
+/*
+ * Serveur de diffusion des images affichées, sur un socket Unix ou TCP.
+ *
+ * Chaque image soumise est comparée à la précédente par tuiles de
+ * TILE_SIZE x TILE_SIZE pixels : seules les tuiles modifiées sont marquées
+ * à envoyer, pour chaque client. Le thread du serveur compresse et envoie
+ * les tuiles marquées dès que le client a reçu la mise à jour précédente :
+ * un client lent reçoit moins d'images, sans ralentir le dessin ni les
+ * autres clients. Sans client connecté, SubmitFrame() ne fait rien.
+ *
+ * Protocole (entiers petit-boutiste) :
+ * - à la connexion, le serveur envoie "LG2S" puis la version (u32, 1) ;
+ * - mise à jour : largeur, hauteur et nombre de tuiles (3 x u32), puis pour
+ *   chaque tuile x, y, largeur, hauteur (4 x u16), encodage (u8 : 0 brut,
+ *   1 zlib), taille des données (u32) et données. Les pixels décodés sont
+ *   au format ARGB (u32), ligne par ligne ;
+ * - le client envoie ses entrées en messages de 4 x u32 : type (valeur de
+ *   evt_type : souris ou clavier uniquement), x, y (en pixels de l'image)
+ *   et code de touche.
+ */
+class CFrameServer {
+public:
+  static const unsigned TILE_SIZE = 64;
+
+private:
+  struct SClient {
+    int nFd;
+    std::vector<uint8_t> vDirty; // Une entrée par tuile
+    std::vector<uint8_t> vOut;   // Reste à envoyer
+    size_t nOutPos;
+    std::vector<uint8_t> vIn; // Message d'entrée incomplet
+  };
+
+  int m_nListenFd;
+  std::string m_strUnixPath; // Socket à supprimer à la fermeture
+  int m_nWakeFds[2];         // Réveille le thread du serveur
+
+  // Partagés avec le thread du serveur
+  std::mutex m_mutex;
+  std::vector<uint32_t> m_vShadow; // Dernière image soumise
+  unsigned m_nWidth, m_nHeight;
+  unsigned m_nTilesX, m_nTilesY;
+  bool m_bShadowValid;
+  std::vector<SClient *> m_vClients;
+  std::deque<evt> m_qEvents;
+  bool m_bStop;
+  std::thread m_thread;
+
+  // Tampons du thread du serveur
+  std::vector<uint32_t> m_vTile;
+  std::vector<uint8_t> m_vPacked;
+
+  void ServerProc();
+  void Wake();
+  void Accept();
+  // Prépare dans vOut les tuiles modifiées pour ce client
+  void BuildUpdate(SClient &client);
+  bool Send(SClient &client);
+  bool Receive(SClient &client);
+  void RemoveClient(size_t nIndex);
+
+public:
+  CFrameServer();
+  ~CFrameServer();
+
+  // "unix:/chemin", "tcp:port" (boucle locale uniquement) ou
+  // "tcp:adresse:port"
+  bool Open(const std::string &strAddress);
+  void Close();
+
+  // pPixels : nWidth x nHeight pixels ARGB, lignes de bas en haut si
+  // bBottomUp (lecture OpenGL)
+  void SubmitFrame(const uint32_t *pPixels, unsigned nWidth, unsigned nHeight,
+                   bool bBottomUp);
+  // Renvoie la prochaine entrée d'un client, en pixels de l'image
+  bool PollEvent(evt &e);
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,204 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Trace.h"
+#include "LibGraph2.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+
+namespace LibGraph2 {
+
+namespace {
+
+struct STraceEvent {
+  const char *pszName;
+  uint64_t nStart; // ns
+  uint64_t nEnd;
+};
+
+// Tampon d'un thread. Seul ce thread écrit ; m_nCount publie les
+// événements écrits aux lecteurs
+class CTraceBuffer {
+public:
+  static const size_t CHUNK_SIZE = 4096;
+  // Au-delà, les événements du thread sont ignorés (environ 24 Mo)
+  static const size_t MAX_EVENTS = 1 << 20;
+
+  struct SChunk {
+    STraceEvent aEvents[CHUNK_SIZE];
+    std::atomic<SChunk *> pNext;
+    SChunk() : pNext(nullptr) {}
+  };
+
+private:
+  std::unique_ptr<SChunk> m_pFirst;
+  SChunk *m_pLast;
+  std::atomic<size_t> m_nCount;
+  std::atomic<size_t> m_nDropped;
+  std::atomic<const char *> m_pszName;
+  unsigned m_nThreadId;
+
+public:
+  explicit CTraceBuffer(unsigned nThreadId)
+      : m_pFirst(new SChunk), m_pLast(m_pFirst.get()), m_nCount(0),
+        m_nDropped(0), m_pszName(nullptr), m_nThreadId(nThreadId) {}
+  ~CTraceBuffer() {
+    SChunk *p = m_pFirst->pNext.load();
+    while (p) {
+      SChunk *pNext = p->pNext.load();
+      delete p;
+      p = pNext;
+    }
+  }
+
+  // Appelées par le thread propriétaire
+  void Push(const STraceEvent &event) {
+    size_t n = m_nCount.load(std::memory_order_relaxed);
+    if (n >= MAX_EVENTS) {
+      m_nDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (n != 0 && n % CHUNK_SIZE == 0) {
+      SChunk *pChunk = new SChunk;
+      m_pLast->pNext.store(pChunk, std::memory_order_relaxed);
+      m_pLast = pChunk;
+    }
+    m_pLast->aEvents[n % CHUNK_SIZE] = event;
+    m_nCount.store(n + 1, std::memory_order_release);
+  }
+  void SetName(const char *pszName) { m_pszName.store(pszName); }
+
+  // Appelées par n'importe quel thread
+  template <typename F> void ForEach(F f) const {
+    size_t n = m_nCount.load(std::memory_order_acquire);
+    const SChunk *pChunk = m_pFirst.get();
+    for (size_t i = 0; i < n; i++) {
+      if (i != 0 && i % CHUNK_SIZE == 0)
+        pChunk = pChunk->pNext.load(std::memory_order_relaxed);
+      f(pChunk->aEvents[i % CHUNK_SIZE]);
+    }
+  }
+  const char *GetName() const { return m_pszName.load(); }
+  size_t GetDropped() const { return m_nDropped.load(); }
+  unsigned GetThreadId() const { return m_nThreadId; }
+};
+
+std::mutex s_buffersMutex;
+std::vector<std::unique_ptr<CTraceBuffer>> s_vBuffers;
+std::atomic<uint64_t> s_nOrigin(0);
+thread_local CTraceBuffer *t_pBuffer = nullptr;
+
+CTraceBuffer *GetThreadBuffer() {
+  if (!t_pBuffer) {
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+    s_vBuffers.emplace_back(new CTraceBuffer((unsigned)s_vBuffers.size() + 1));
+    t_pBuffer = s_vBuffers.back().get();
+  }
+  return t_pBuffer;
+}
+
+} // namespace
+
+std::atomic<bool> CTracer::s_bEnabled(false);
+
+void CTracer::Start() {
+  uint64_t nZero = 0;
+  s_nOrigin.compare_exchange_strong(nZero, Now());
+  s_bEnabled.store(true);
+}
+
+void CTracer::Stop() { s_bEnabled.store(false); }
+
+const char *CTracer::GetEnvironmentFile() {
+  const char *pszFile = getenv("LIBGRAPH2_TRACE");
+  return pszFile && *pszFile ? pszFile : NULL;
+}
+
+void CTracer::Record(const char *pszName, uint64_t nStart, uint64_t nEnd) {
+  STraceEvent event = {pszName, nStart, nEnd};
+  GetThreadBuffer()->Push(event);
+}
+
+void CTracer::SetThreadName(const char *pszName) {
+  GetThreadBuffer()->SetName(pszName);
+}
+
+// LIBGRAPH2_TRACE active la trace dès le chargement de la bibliothèque
+static struct SEnvironmentStart {
+  SEnvironmentStart() {
+    if (CTracer::GetEnvironmentFile())
+      CTracer::Start();
+  }
+} s_environmentStart;
+
+bool CTracer::Save(const char *pszFileName) {
+  FILE *f = fopen(pszFileName, "w");
+  if (!f) {
+    std::cerr << "LibGraph2 : impossible d'écrire la trace " << pszFileName
+              << std::endl;
+    return false;
+  }
+
+  // Événements complets ("X"), horodatés en microsecondes depuis Start()
+  int nPid = (int)getpid();
+  uint64_t nOrigin = s_nOrigin.load();
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+             "\"args\":{\"name\":\"LibGraph2\"}}",
+          nPid);
+  std::lock_guard<std::mutex> lock(s_buffersMutex);
+  for (const auto &pBuffer : s_vBuffers) {
+    unsigned nTid = pBuffer->GetThreadId();
+    const char *pszName = pBuffer->GetName();
+    if (pszName)
+      fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                 "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+              nPid, nTid, pszName);
+    pBuffer->ForEach([&](const STraceEvent &e) {
+      if (e.nStart < nOrigin)
+        return;
+      fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"libgraph2\",\"ph\":\"X\","
+                 "\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+              e.pszName, nPid, nTid, (e.nStart - nOrigin) / 1000.0,
+              (e.nEnd - e.nStart) / 1000.0);
+    });
+    if (size_t nDropped = pBuffer->GetDropped())
+      fprintf(f, ",\n{\"name\":\"événements perdus\",\"ph\":\"i\",\"s\":\"t\","
+                 "\"pid\":%d,\"tid\":%u,\"ts\":0,\"args\":{\"count\":%zu}}",
+              nPid, nTid, nDropped);
+  }
+  fprintf(f, "\n]}\n");
+  return fclose(f) == 0;
+}
+
+// Fonctions publiques
+
+void startTrace(void) { CTracer::Start(); }
+
+void stopTrace(void) { CTracer::Stop(); }
+
+bool saveTrace(const char *pszFileName) {
+  return pszFileName && CTracer::Save(pszFileName);
+}
+
+} // namespace LibGraph2
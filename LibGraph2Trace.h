@@ -0,0 +1,89 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : points de trace des fonctions de la
+// bibliothèque, exportés au format Chrome Trace Event (chrome://tracing,
+// Perfetto).
+
+#include "LibGraph2Allocs.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace LibGraph2 {
+
+/*
+ * Enregistrement des traces du processus.
+ *
+ * Chaque thread écrit ses événements dans son propre tampon, une liste de
+ * blocs qui ne fait que s'allonger : l'écriture ne prend aucun verrou, et
+ * Save() lit les événements déjà publiés pendant que les threads continuent
+ * d'écrire. Seule la création du tampon, au premier événement d'un thread,
+ * prend le verrou de la liste des tampons.
+ *
+ * Les noms passés à CTraceScope doivent rester valables jusqu'à la fin du
+ * programme (chaînes littérales).
+ */
+class CTracer {
+private:
+  static std::atomic<bool> s_bEnabled;
+
+public:
+  static bool IsEnabled() {
+    return s_bEnabled.load(std::memory_order_relaxed);
+  }
+  static void Start();
+  static void Stop();
+  // Écrit les événements enregistrés jusqu'ici, sans les effacer
+  static bool Save(const char *pszFileName);
+  // Fichier désigné par LIBGRAPH2_TRACE, NULL si aucun
+  static const char *GetEnvironmentFile();
+
+  // Horloge des événements, en nanosecondes
+  static uint64_t Now() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+  static void Record(const char *pszName, uint64_t nStart, uint64_t nEnd);
+  // Nom du thread appelant dans la trace
+  static void SetThreadName(const char *pszName);
+};
+
+// Événement couvrant une portée, enregistré à sa fin si la trace est active
+// à son début. Inactive, une portée coûte la lecture d'un booléen. La portée
+// désigne aussi la fonction à laquelle les allocations sont attribuées
+class CTraceScope {
+private:
+  const char *m_pszName;
+  uint64_t m_nStart;
+  CAllocScope m_allocs;
+
+public:
+  explicit CTraceScope(const char *pszName)
+      : m_pszName(pszName), m_nStart(CTracer::IsEnabled() ? CTracer::Now() : 0),
+        m_allocs(pszName) {}
+  ~CTraceScope() {
+    if (m_nStart)
+      CTracer::Record(m_pszName, m_nStart, CTracer::Now());
+  }
+  CTraceScope(const CTraceScope &) = delete;
+  CTraceScope &operator=(const CTraceScope &) = delete;
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,258 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LibGraph2Video.h"
+#include "LibGraph2Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace LibGraph2 {
+
+CVideoWriter::CVideoWriter()
+    : m_nFd(-1), m_bOwnFd(false), m_format(video_format::Y4M),
+      m_nFrameRate(60), m_nWidth(0), m_nHeight(0), m_bStop(false),
+      m_bFailed(false) {}
+
+CVideoWriter::~CVideoWriter() { Close(); }
+
+bool CVideoWriter::Open(const string &strFileName, video_format format,
+                        unsigned nFrameRate) {
+  Close();
+
+  if (strFileName == "-") {
+    m_nFd = STDOUT_FILENO;
+    m_bOwnFd = false;
+  } else {
+    m_nFd = open(strFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (m_nFd < 0) {
+      cerr << "LibGraph2 : impossible d'ouvrir la sortie vidéo " << strFileName
+           << " : "
+           << strerror(errno) << endl;
+      return false;
+    }
+    m_bOwnFd = true;
+  }
+
+  m_format = format;
+  m_nFrameRate = nFrameRate ? nFrameRate : 60;
+  m_nWidth = m_nHeight = 0;
+  m_bStop = m_bFailed = false;
+  m_vFrames.assign(NUM_BUFFERS, SFrame());
+  m_qFree.clear();
+  m_qReady.clear();
+  for (size_t i = 0; i < NUM_BUFFERS; i++)
+    m_qFree.push_back(i);
+  m_thread = std::thread(&CVideoWriter::WriterProc, this);
+  return true;
+}
+
+void CVideoWriter::Close() {
+  if (m_nFd < 0)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+
+  if (m_bOwnFd)
+    close(m_nFd);
+  m_nFd = -1;
+  m_vFrames.clear();
+}
+
+void CVideoWriter::SubmitFrame(const uint32_t *pPixels, unsigned nWidth,
+                               unsigned nHeight, bool bBottomUp) {
+  size_t nIndex;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_nFd < 0 || m_bFailed)
+      return;
+    m_cv.wait(lock, [this] { return !m_qFree.empty(); });
+    nIndex = m_qFree.front();
+    m_qFree.pop_front();
+  }
+
+  // Copie hors verrou : le tampon n'appartient qu'à ce thread jusqu'à sa
+  // publication
+  SFrame &frame = m_vFrames[nIndex];
+  frame.nWidth = nWidth;
+  frame.nHeight = nHeight;
+  frame.vPixels.resize((size_t)nWidth * nHeight);
+  if (!bBottomUp) {
+    memcpy(frame.vPixels.data(), pPixels, frame.vPixels.size() * 4);
+  } else {
+    for (unsigned y = 0; y < nHeight; y++)
+      memcpy(frame.vPixels.data() + (size_t)y * nWidth,
+             pPixels + (size_t)(nHeight - 1 - y) * nWidth, nWidth * 4);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_qReady.push_back(nIndex);
+  }
+  m_cv.notify_all();
+}
+
+bool CVideoWriter::WriteAll(const void *p, size_t nSize) {
+  const uint8_t *pBytes = static_cast<const uint8_t *>(p);
+  while (nSize > 0) {
+    ssize_t n = write(m_nFd, pBytes, nSize);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    pBytes += n;
+    nSize -= n;
+  }
+  return true;
+}
+
+// Conversion BT.601 (plage limitée) ; la chrominance est moyennée sur des
+// blocs de 2x2 pixels
+void CVideoWriter::Encode(const SFrame &frame) {
+  unsigned w = m_nWidth, h = m_nHeight;
+  // Les pixels hors de l'image (taille du flux différente) sont noirs
+  auto pixel = [&frame](unsigned x, unsigned y) -> uint32_t {
+    if (x >= frame.nWidth || y >= frame.nHeight)
+      return 0xFF000000u;
+    return frame.vPixels[(size_t)y * frame.nWidth + x];
+  };
+
+  if (m_format == video_format::RawRGBA) {
+    m_vOut.resize((size_t)w * h * 4);
+    uint8_t *p = m_vOut.data();
+    for (unsigned y = 0; y < h; y++)
+      for (unsigned x = 0; x < w; x++, p += 4) {
+        uint32_t c = pixel(x, y);
+        p[0] = (uint8_t)(c >> 16);
+        p[1] = (uint8_t)(c >> 8);
+        p[2] = (uint8_t)c;
+        p[3] = (uint8_t)(c >> 24);
+      }
+    return;
+  }
+
+  static const char szFrame[] = "FRAME\n";
+  unsigned cw = (w + 1) / 2, ch = (h + 1) / 2;
+  size_t nHeader = sizeof szFrame - 1;
+  m_vOut.resize(nHeader + (size_t)w * h + 2 * (size_t)cw * ch);
+  memcpy(m_vOut.data(), szFrame, nHeader);
+  uint8_t *pY = m_vOut.data() + nHeader;
+  uint8_t *pU = pY + (size_t)w * h;
+  uint8_t *pV = pU + (size_t)cw * ch;
+
+  for (unsigned y = 0; y < h; y++)
+    for (unsigned x = 0; x < w; x++) {
+      uint32_t c = pixel(x, y);
+      int r = (c >> 16) & 0xFF, g = (c >> 8) & 0xFF, b = c & 0xFF;
+      pY[(size_t)y * w + x] =
+          (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+
+  for (unsigned cy = 0; cy < ch; cy++)
+    for (unsigned cx = 0; cx < cw; cx++) {
+      int r = 0, g = 0, b = 0, n = 0;
+      for (unsigned dy = 0; dy < 2; dy++)
+        for (unsigned dx = 0; dx < 2; dx++) {
+          unsigned x = 2 * cx + dx, y = 2 * cy + dy;
+          if (x >= w || y >= h)
+            continue;
+          uint32_t c = pixel(x, y);
+          r += (c >> 16) & 0xFF;
+          g += (c >> 8) & 0xFF;
+          b += c & 0xFF;
+          n++;
+        }
+      r /= n;
+      g /= n;
+      b /= n;
+      pU[(size_t)cy * cw + cx] =
+          (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      pV[(size_t)cy * cw + cx] =
+          (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+void CVideoWriter::WriterProc() {
+  // Si le lecteur du tube se termine, write() doit échouer avec EPIPE plutôt
+  // que de tuer le processus
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+  CTracer::SetThreadName("vidéo");
+
+  for (;;) {
+    size_t nIndex;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_bStop || !m_qReady.empty(); });
+      if (m_qReady.empty())
+        return; // Arrêt demandé et tout a été écrit
+      nIndex = m_qReady.front();
+      m_qReady.pop_front();
+    }
+
+    const SFrame &frame = m_vFrames[nIndex];
+    bool bOk = true;
+    if (m_nWidth == 0) {
+      // L'en-tête attend la taille de la première image
+      m_nWidth = frame.nWidth;
+      m_nHeight = frame.nHeight;
+      if (m_format == video_format::Y4M) {
+        char szHeader[128];
+        int n = snprintf(szHeader, sizeof szHeader,
+                         "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", m_nWidth,
+                         m_nHeight, m_nFrameRate);
+        bOk = WriteAll(szHeader, n);
+      }
+    }
+    if (bOk) {
+      CTraceScope trace("EncodeFrame");
+      Encode(frame);
+      bOk = WriteAll(m_vOut.data(), m_vOut.size());
+    }
+    int nError = bOk ? 0 : errno;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_qFree.push_back(nIndex);
+      if (!bOk && !m_bFailed) {
+        m_bFailed = true;
+        cerr << "LibGraph2 : échec de la sortie vidéo : " << strerror(nError)
+             << endl;
+      }
+    }
+    m_cv.notify_all();
+  }
+}
+
+} // namespace LibGraph2
@@ -0,0 +1,95 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : écriture des images affichées dans un flux
+// vidéo brut.
+
+#include "LibGraph2.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LibGraph2 {
+
+/*
+ * Flux vidéo Y4M ou RGBA brut, écrit par un thread dédié.
+ *
+ * SubmitFrame() ne fait que copier l'image dans l'un des tampons libres : la
+ * conversion de couleurs et l'écriture, potentiellement bloquante (tube vers
+ * un encodeur), ont lieu dans le thread d'écriture. Aucune image n'est
+ * perdue : si l'écriture prend du retard sur les NUM_BUFFERS tampons,
+ * SubmitFrame() attend.
+ *
+ * La taille du flux est celle de la première image ; les suivantes sont
+ * rognées ou complétées en noir si la fenêtre change de taille.
+ */
+class CVideoWriter {
+private:
+  struct SFrame {
+    std::vector<uint32_t> vPixels; // ARGB, de haut en bas
+    unsigned nWidth, nHeight;
+  };
+
+  int m_nFd;
+  bool m_bOwnFd;
+  video_format m_format;
+  unsigned m_nFrameRate;
+
+  // Taille du flux, fixée par la première image
+  unsigned m_nWidth, m_nHeight;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<SFrame> m_vFrames;
+  std::deque<size_t> m_qFree;  // Tampons disponibles
+  std::deque<size_t> m_qReady; // Tampons à écrire, dans l'ordre
+  bool m_bStop;
+  bool m_bFailed;
+  std::thread m_thread;
+
+  // Tampon de sortie du thread d'écriture
+  std::vector<uint8_t> m_vOut;
+
+  void WriterProc();
+  bool WriteAll(const void *p, size_t nSize);
+  void Encode(const SFrame &frame);
+
+public:
+  static const size_t NUM_BUFFERS = 3;
+
+  CVideoWriter();
+  ~CVideoWriter();
+
+  // "-" désigne la sortie standard ; /dev/fd/N permet de passer un
+  // descripteur déjà ouvert
+  bool Open(const std::string &strFileName, video_format format,
+            unsigned nFrameRate);
+  // Écrit les images en attente puis ferme le flux
+  void Close();
+
+  // pPixels : nWidth x nHeight pixels ARGB, lignes de bas en haut si
+  // bBottomUp (lecture OpenGL)
+  void SubmitFrame(const uint32_t *pPixels, unsigned nWidth, unsigned nHeight,
+                   bool bBottomUp);
+};
+
+} // namespace LibGraph2
@@ -0,0 +1,494 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef LIBGRAPH2_HAVE_X11
+#include "LibGraph2X11.h"
+#include "LibGraph2Stats.h"
+#include "LibGraph2Trace.h"
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <cstdlib>
+#include <cstring>
+#ifdef LIBGRAPH2_HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
+namespace LibGraph2 {
+
+// Traducteur X11 KeySym -> Windows Virtual Key / ASCII, mêmes codes que le
+// moteur SFML
+static unsigned int MapKeySymToWinVK(KeySym key) {
+  // Lettres A-Z -> ASCII 65-90
+  if (key >= XK_a && key <= XK_z)
+    return 'A' + (unsigned)(key - XK_a);
+  if (key >= XK_A && key <= XK_Z)
+    return 'A' + (unsigned)(key - XK_A);
+
+  // Chiffres 0-9 (haut du clavier) -> ASCII 48-57
+  if (key >= XK_0 && key <= XK_9)
+    return '0' + (unsigned)(key - XK_0);
+
+  // Pavé numérique 0-9 -> codes VK 96-105
+  if (key >= XK_KP_0 && key <= XK_KP_9)
+    return 96 + (unsigned)(key - XK_KP_0);
+
+  // Touches de fonction F1-F12 -> codes VK 112-123
+  if (key >= XK_F1 && key <= XK_F12)
+    return 112 + (unsigned)(key - XK_F1);
+
+  switch (key) {
+  // Ponctuation et symboles ASCII
+  case XK_space:
+    return 32;
+  case XK_comma:
+    return 44;
+  case XK_period:
+    return 46;
+  case XK_slash:
+    return 47;
+  case XK_semicolon:
+    return 59;
+  case XK_equal:
+    return 61;
+  case XK_minus:
+    return 45;
+  case XK_bracketleft:
+    return 91;
+  case XK_bracketright:
+    return 93;
+  case XK_backslash:
+    return 92;
+  case XK_apostrophe:
+    return 39;
+  case XK_grave:
+    return 126;
+
+  // Pavé numérique (Opérateurs ASCII)
+  case XK_KP_Add:
+    return 43;
+  case XK_KP_Subtract:
+    return 45;
+  case XK_KP_Multiply:
+    return 42;
+  case XK_KP_Divide:
+    return 47;
+
+  // Touches de contrôle (Codes Windows Virtual Key / ASCII)
+  case XK_Escape:
+    return 27;
+  case XK_Return:
+  case XK_KP_Enter:
+    return 13;
+  case XK_BackSpace:
+    return 8;
+  case XK_Tab:
+    return 9;
+
+  case XK_Shift_L:
+  case XK_Shift_R:
+    return 16; // VK_SHIFT
+  case XK_Control_L:
+  case XK_Control_R:
+    return 17; // VK_CONTROL
+  case XK_Alt_L:
+  case XK_Alt_R:
+    return 18; // VK_MENU (ALT)
+  case XK_Pause:
+    return 19;
+
+  case XK_Left:
+    return 37;
+  case XK_Up:
+    return 38;
+  case XK_Right:
+    return 39;
+  case XK_Down:
+    return 40;
+
+  case XK_Insert:
+    return 45;
+  case XK_Delete:
+    return 46;
+  case XK_Page_Up:
+    return 33;
+  case XK_Page_Down:
+    return 34;
+  case XK_End:
+    return 35;
+  case XK_Home:
+    return 36;
+
+  default:
+    return 0;
+  }
+}
+
+CX11Window::CX11Window()
+    : m_pDisplay(NULL), m_nWindow(0), m_nColormap(0), m_nWmDelete(0),
+      m_nWidth(0), m_nHeight(0), m_bOpen(false), m_bExposed(false) {}
+
+CX11Window::~CX11Window() { Close(); }
+
+bool CX11Window::Connect() {
+  if (!m_pDisplay)
+    m_pDisplay = XOpenDisplay(NULL);
+  return m_pDisplay != NULL;
+}
+
+bool CX11Window::Create(unsigned nWidth, unsigned nHeight, bool bFullScreen,
+                        const char *pszTitle, unsigned long nVisualID) {
+  if (!Connect())
+    return false;
+  if (m_nWindow) {
+    XDestroyWindow(m_pDisplay, m_nWindow);
+    m_nWindow = 0;
+  }
+  if (m_nColormap) {
+    XFreeColormap(m_pDisplay, m_nColormap);
+    m_nColormap = 0;
+  }
+
+  int nScreen = DefaultScreen(m_pDisplay);
+  ::Window root = RootWindow(m_pDisplay, nScreen);
+  Visual *pVisual = DefaultVisual(m_pDisplay, nScreen);
+  int nDepth = DefaultDepth(m_pDisplay, nScreen);
+  if (nVisualID) {
+    XVisualInfo tmpl;
+    tmpl.visualid = nVisualID;
+    int nCount = 0;
+    if (XVisualInfo *pInfo =
+            XGetVisualInfo(m_pDisplay, VisualIDMask, &tmpl, &nCount)) {
+      pVisual = pInfo->visual;
+      nDepth = pInfo->depth;
+      XFree(pInfo);
+    }
+  }
+
+  XSetWindowAttributes attr;
+  memset(&attr, 0, sizeof attr);
+  m_nColormap = XCreateColormap(m_pDisplay, root, pVisual, AllocNone);
+  attr.colormap = m_nColormap;
+  attr.background_pixel = WhitePixel(m_pDisplay, nScreen);
+  attr.event_mask = KeyPressMask | KeyReleaseMask | ButtonPressMask |
+                    ButtonReleaseMask | PointerMotionMask |
+                    StructureNotifyMask | ExposureMask;
+  m_nWindow = XCreateWindow(m_pDisplay, root, 0, 0, nWidth, nHeight, 0,
+                            nDepth, InputOutput, pVisual,
+                            CWColormap | CWBackPixel | CWEventMask, &attr);
+  if (!m_nWindow)
+    return false;
+
+  XStoreName(m_pDisplay, m_nWindow, pszTitle);
+  // Fermeture par le gestionnaire de fenêtres : message plutôt que
+  // déconnexion brutale
+  Atom wmDelete = XInternAtom(m_pDisplay, "WM_DELETE_WINDOW", False);
+  XSetWMProtocols(m_pDisplay, m_nWindow, &wmDelete, 1);
+  m_nWmDelete = wmDelete;
+
+  if (bFullScreen) {
+    Atom state = XInternAtom(m_pDisplay, "_NET_WM_STATE", False);
+    Atom fullscreen =
+        XInternAtom(m_pDisplay, "_NET_WM_STATE_FULLSCREEN", False);
+    XChangeProperty(m_pDisplay, m_nWindow, state, XA_ATOM, 32,
+                    PropModeReplace, (unsigned char *)&fullscreen, 1);
+  }
+
+  XMapWindow(m_pDisplay, m_nWindow);
+  XFlush(m_pDisplay);
+  m_nWidth = nWidth;
+  m_nHeight = nHeight;
+  m_bOpen = true;
+  return true;
+}
+
+void CX11Window::Close() {
+  if (!m_pDisplay)
+    return;
+  if (m_nWindow)
+    XDestroyWindow(m_pDisplay, m_nWindow);
+  if (m_nColormap)
+    XFreeColormap(m_pDisplay, m_nColormap);
+  XCloseDisplay(m_pDisplay);
+  m_pDisplay = NULL;
+  m_nWindow = 0;
+  m_nColormap = 0;
+  m_bOpen = false;
+}
+
+void CX11Window::SetSize(unsigned nWidth, unsigned nHeight) {
+  if (!m_nWindow)
+    return;
+  XResizeWindow(m_pDisplay, m_nWindow, nWidth, nHeight);
+  XFlush(m_pDisplay);
+}
+
+void CX11Window::SetVisible(bool bVisible) {
+  if (!m_nWindow)
+    return;
+  if (bVisible)
+    XMapWindow(m_pDisplay, m_nWindow);
+  else
+    XUnmapWindow(m_pDisplay, m_nWindow);
+  XFlush(m_pDisplay);
+}
+
+void CX11Window::Flush() {
+  if (m_pDisplay)
+    XFlush(m_pDisplay);
+}
+
+bool CX11Window::TakeExposed() {
+  bool bExposed = m_bExposed;
+  m_bExposed = false;
+  return bExposed;
+}
+
+bool CX11Window::PollEvent(evt &e) {
+  if (!m_nWindow)
+    return false;
+
+  while (XPending(m_pDisplay)) {
+    XEvent event;
+    XNextEvent(m_pDisplay, &event);
+    // Date de lecture dans la file : XEvent::time est l'horloge du serveur
+    // X, sans rapport avec celle de la bibliothèque
+    e.nTimestampUs = CFrameTimes::NowUs();
+    switch (event.type) {
+    case MotionNotify:
+      e.type = evt_type::evtMouseMove;
+      e.x = event.xmotion.x;
+      e.y = event.xmotion.y;
+      return true;
+
+    case ButtonPress:
+    case ButtonRelease:
+      // Les boutons 4 à 7 correspondent à la molette
+      if (event.xbutton.button > Button3)
+        break;
+      e.type = event.type == ButtonPress ? evt_type::evtMouseDown
+                                         : evt_type::evtMouseUp;
+      e.x = event.xbutton.x;
+      e.y = event.xbutton.y;
+      return true;
+
+    case KeyPress:
+    case KeyRelease:
+      e.type = event.type == KeyPress ? evt_type::evtKeyDown
+                                      : evt_type::evtKeyUp;
+      e.vkKeyCode = MapKeySymToWinVK(XLookupKeysym(&event.xkey, 0));
+      return true;
+
+    case ConfigureNotify:
+      if ((unsigned)event.xconfigure.width == m_nWidth &&
+          (unsigned)event.xconfigure.height == m_nHeight)
+        break; // Simple déplacement
+      m_nWidth = event.xconfigure.width;
+      m_nHeight = event.xconfigure.height;
+      e.type = evt_type::evtSize;
+      e.x = m_nWidth;
+      e.y = m_nHeight;
+      return true;
+
+    case Expose:
+      m_bExposed = true;
+      break;
+
+    case ClientMessage:
+      if ((unsigned long)event.xclient.data.l[0] != m_nWmDelete)
+        break;
+      m_bOpen = false;
+      e.type = evt_type::evtClose;
+      return true;
+
+    default:
+      break;
+    }
+  }
+  // Aucune entrée : l'événement qui suivra sera daté par OnEvent()
+  e.nTimestampUs = 0;
+  return false;
+}
+
+// Image présentée
+
+#ifdef LIBGRAPH2_HAVE_XSHM
+struct CX11Image::SSegment {
+  XShmSegmentInfo info;
+};
+
+// XShmAttach échoue de façon asynchrone (serveur distant, segment
+// inaccessible) : l'erreur est interceptée pendant l'attachement
+static bool s_bAttachFailed = false;
+static int AttachErrorHandler(Display *, XErrorEvent *) {
+  s_bAttachFailed = true;
+  return 0;
+}
+#else
+struct CX11Image::SSegment {};
+#endif
+
+CX11Image::CX11Image()
+    : m_pWindow(NULL), m_pImage(NULL), m_pGC(NULL), m_pSegment(NULL),
+      m_bPending(false) {}
+
+CX11Image::~CX11Image() { Destroy(); }
+
+bool CX11Image::Create(CX11Window &window, unsigned nWidth,
+                       unsigned nHeight) {
+  Destroy();
+  Display *pDisplay = window.GetDisplay();
+  if (!pDisplay || !window.GetWindow() || nWidth == 0 || nHeight == 0)
+    return false;
+
+  // Les pixels de la surface sont copiés tels quels : le visual doit avoir
+  // le même format (l'octet de poids fort est ignoré par le serveur)
+  XWindowAttributes attr;
+  XGetWindowAttributes(pDisplay, window.GetWindow(), &attr);
+  if (attr.depth != 24 && attr.depth != 32)
+    return false;
+  if (attr.visual->red_mask != 0xFF0000 ||
+      attr.visual->green_mask != 0x00FF00 ||
+      attr.visual->blue_mask != 0x0000FF)
+    return false;
+
+  m_pWindow = &window;
+  m_pGC = XCreateGC(pDisplay, window.GetWindow(), 0, NULL);
+
+#ifdef LIBGRAPH2_HAVE_XSHM
+  if (XShmQueryExtension(pDisplay)) {
+    m_pSegment = new SSegment;
+    XShmSegmentInfo &info = m_pSegment->info;
+    memset(&info, 0, sizeof info);
+    m_pImage = XShmCreateImage(pDisplay, attr.visual, attr.depth, ZPixmap,
+                               NULL, &info, nWidth, nHeight);
+    if (m_pImage && m_pImage->bits_per_pixel == 32 &&
+        m_pImage->bytes_per_line == (int)nWidth * 4) {
+      info.shmid = shmget(IPC_PRIVATE, (size_t)m_pImage->bytes_per_line *
+                                           m_pImage->height,
+                          IPC_CREAT | 0600);
+      if (info.shmid != -1) {
+        info.shmaddr = m_pImage->data = (char *)shmat(info.shmid, NULL, 0);
+        info.readOnly = False;
+        if (info.shmaddr != (char *)-1) {
+          s_bAttachFailed = false;
+          XErrorHandler pOldHandler = XSetErrorHandler(AttachErrorHandler);
+          XShmAttach(pDisplay, &info);
+          XSync(pDisplay, False);
+          XSetErrorHandler(pOldHandler);
+          // Le segment sera libéré dès que les deux processus s'en seront
+          // détachés, même après un plantage
+          shmctl(info.shmid, IPC_RMID, NULL);
+          if (!s_bAttachFailed)
+            return true;
+          shmdt(info.shmaddr);
+        }
+        m_pImage->data = NULL;
+      }
+    }
+    if (m_pImage)
+      XDestroyImage(m_pImage);
+    m_pImage = NULL;
+    delete m_pSegment;
+    m_pSegment = NULL;
+  }
+#endif
+
+  // Sans mémoire partagée : image côté client, envoyée par XPutImage
+  char *pData = (char *)malloc((size_t)nWidth * nHeight * 4);
+  if (pData)
+    m_pImage = XCreateImage(pDisplay, attr.visual, attr.depth, ZPixmap, 0,
+                            pData, nWidth, nHeight, 32, nWidth * 4);
+  if (!m_pImage || m_pImage->bits_per_pixel != 32) {
+    if (m_pImage)
+      XDestroyImage(m_pImage); // Libère aussi pData
+    else
+      free(pData);
+    m_pImage = NULL;
+    Destroy();
+    return false;
+  }
+  return true;
+}
+
+void CX11Image::Destroy() {
+  if (!m_pWindow)
+    return;
+  Display *pDisplay = m_pWindow->GetDisplay();
+  if (m_pImage) {
+#ifdef LIBGRAPH2_HAVE_XSHM
+    if (m_pSegment) {
+      // Le serveur doit se détacher avant que le segment disparaisse
+      XShmDetach(pDisplay, &m_pSegment->info);
+      XSync(pDisplay, False);
+      shmdt(m_pSegment->info.shmaddr);
+      m_pImage->data = NULL;
+    }
+#endif
+    XDestroyImage(m_pImage);
+    m_pImage = NULL;
+  }
+  delete m_pSegment;
+  m_pSegment = NULL;
+  if (m_pGC)
+    XFreeGC(pDisplay, m_pGC);
+  m_pGC = NULL;
+  m_pWindow = NULL;
+  m_bPending = false;
+}
+
+uint32_t *CX11Image::getPixels() {
+  return m_pImage ? (uint32_t *)m_pImage->data : NULL;
+}
+
+void CX11Image::Put(int x, int y, unsigned nWidth, unsigned nHeight) {
+  if (!m_pImage)
+    return;
+  Display *pDisplay = m_pWindow->GetDisplay();
+#ifdef LIBGRAPH2_HAVE_XSHM
+  if (m_pSegment) {
+    XShmPutImage(pDisplay, m_pWindow->GetWindow(), m_pGC, m_pImage, x, y, x,
+                 y, nWidth, nHeight, False);
+    XFlush(pDisplay);
+    m_bPending = true;
+    return;
+  }
+#endif
+  // XPutImage copie les pixels dans la connexion : l'image est libre dès le
+  // retour
+  XPutImage(pDisplay, m_pWindow->GetWindow(), m_pGC, m_pImage, x, y, x, y,
+            nWidth, nHeight);
+  XFlush(pDisplay);
+}
+
+void CX11Image::Wait() {
+  if (!m_bPending)
+    return;
+  CTraceScope trace("XSync");
+  // Le serveur a fini de lire le segment quand il a traité la requête :
+  // un aller-retour suffit, sans événement de fin
+  XSync(m_pWindow->GetDisplay(), False);
+  m_bPending = false;
+}
+
+} // namespace LibGraph2
+
+#endif // LIBGRAPH2_HAVE_X11
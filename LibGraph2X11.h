@@ -0,0 +1,124 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+// En-tête interne (non installé) : fenêtre X11 minimale, pour les moteurs
+// qui présentent eux-mêmes leurs images. Xlib n'est incluse que par
+// LibGraph2X11.cpp : ses macros (None, Bool, Status...) ne doivent pas
+// atteindre le reste de la bibliothèque.
+#ifdef LIBGRAPH2_HAVE_X11
+
+#include "LibGraph2.h"
+#include <cstdint>
+
+struct _XDisplay;
+struct _XGC;
+struct _XImage;
+
+namespace LibGraph2 {
+
+/*
+ * Fenêtre X11 et traduction de ses événements en evt.
+ *
+ * Connect() ouvre la connexion au serveur, Create() crée la fenêtre : entre
+ * les deux, le moteur peut choisir le visual (par exemple celui d'une
+ * configuration EGL). Les coordonnées des événements sont en pixels ; c'est
+ * au moteur de les convertir en coordonnées normalisées.
+ */
+class CX11Window {
+private:
+  _XDisplay *m_pDisplay;
+  unsigned long m_nWindow;
+  unsigned long m_nColormap;
+  unsigned long m_nWmDelete;
+  unsigned m_nWidth, m_nHeight;
+  bool m_bOpen;
+  bool m_bExposed;
+
+public:
+  CX11Window();
+  ~CX11Window();
+
+  // Ouvre la connexion au serveur désigné par DISPLAY
+  bool Connect();
+  // Crée et affiche la fenêtre. nVisualID vaut 0 pour le visual par défaut
+  bool Create(unsigned nWidth, unsigned nHeight, bool bFullScreen,
+              const char *pszTitle, unsigned long nVisualID = 0);
+  // Détruit la fenêtre, puis ferme la connexion
+  void Close();
+
+  // Fausse tant que la fenêtre n'a pas été fermée par l'utilisateur
+  bool IsOpen() const { return m_bOpen; }
+  _XDisplay *GetDisplay() const { return m_pDisplay; }
+  unsigned long GetWindow() const { return m_nWindow; }
+  unsigned getWidth() const { return m_nWidth; }
+  unsigned getHeight() const { return m_nHeight; }
+
+  void SetSize(unsigned nWidth, unsigned nHeight);
+  void SetVisible(bool bVisible);
+  // Traduit le prochain événement utile, sans attendre. Renvoie false si la
+  // file est vide
+  bool PollEvent(evt &e);
+  // Force l'envoi des requêtes en attente au serveur
+  void Flush();
+  // Vrai si une partie de la fenêtre a été découverte depuis le dernier
+  // appel : son contenu doit être renvoyé en entier
+  bool TakeExposed();
+};
+
+/*
+ * Image ARGB présentée dans une CX11Window.
+ *
+ * Avec l'extension MIT-SHM, les pixels sont dans un segment de mémoire
+ * partagée avec le serveur : le moteur dessine directement dedans et Put()
+ * n'envoie qu'une requête, sans copie des pixels dans la connexion. Sans
+ * elle (serveur distant), les pixels sont transmis par XPutImage.
+ *
+ * Le serveur lit l'image pendant le traitement de la requête : Wait() doit
+ * être appelée avant de modifier des pixels déjà envoyés.
+ */
+class CX11Image {
+private:
+  struct SSegment;
+
+  CX11Window *m_pWindow;
+  _XImage *m_pImage;
+  _XGC *m_pGC;
+  SSegment *m_pSegment; // NULL sans MIT-SHM
+  bool m_bPending;
+
+public:
+  CX11Image();
+  ~CX11Image();
+
+  // Crée l'image pour la fenêtre (qui doit survivre à l'image). Échoue si
+  // le visual de la fenêtre n'a pas des pixels 32 bits 0x00RRGGBB
+  bool Create(CX11Window &window, unsigned nWidth, unsigned nHeight);
+  void Destroy();
+
+  bool IsShared() const { return m_pSegment != NULL; }
+  uint32_t *getPixels();
+  // Envoie le rectangle (x, y, nWidth, nHeight) de l'image à la même
+  // position dans la fenêtre
+  void Put(int x, int y, unsigned nWidth, unsigned nHeight);
+  // Attend que le serveur ait lu l'image envoyée par Put()
+  void Wait();
+};
+
+} // namespace LibGraph2
+
+#endif // LIBGRAPH2_HAVE_X11
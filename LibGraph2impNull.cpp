@@ -0,0 +1,678 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef LIBGRAPH2_USE_NULL
+#include "LibGraph2impNull.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Nom des fonctions et de l'argument mesuré (NULL si aucun), dans l'ordre de
+// null_call
+static const struct {
+  const char *pszName;
+  const char *pszArgument;
+} s_aCallInfo[NullCallCount] = {
+    {"show", NULL},
+    {"showOffscreen", NULL},
+    {"hide", NULL},
+    {"getSize", NULL},
+    {"askForRefresh", NULL},
+    {"beginPaint", NULL},
+    {"endPaint", NULL},
+    {"waitForEvent", NULL},
+    {"setPen", "épaisseur"},
+    {"setSolidBrush", NULL},
+    {"setTextureBrush", NULL},
+    {"setFont", "taille"},
+    {"drawLine", "longueur"},
+    {"drawRectangle", "surface"},
+    {"drawEllipse", "surface"},
+    {"drawArc", "surface"},
+    {"drawPie", "surface"},
+    {"drawPolylines", "points"},
+    {"setPixel", NULL},
+    {"drawString", "caractères"},
+    {"getStringDimension", "caractères"},
+    {"drawBitmap", "échelle"},
+    {"createRecorder", NULL},
+    {"releaseRecorder", NULL},
+    {"saveFrame", NULL},
+    {"getFramePixels", NULL},
+    {"startVideoOutput", NULL},
+    {"requestReadback", "surface"},
+    {"startFrameServer", NULL},
+    {"getFrameStats", NULL},
+    {"enableGpuTimer", NULL},
+    {"getFrameAllocations", NULL},
+    {"getFrameTimes", NULL},
+    {"getInputLatency", NULL},
+    {"resetFrameTimes", NULL},
+    {"showPerformanceOverlay", NULL},
+    {"gui*", NULL},
+};
+
+// Constructeur
+CLibGraph2Null::CLibGraph2Null()
+    : m_nWidth(0), m_nHeight(0), m_fontSize(10.0f), m_frameInterval(0) {
+  for (SNullCallStats &stats : m_aStats)
+    stats = SNullCallStats{0, 0, 0, 0.0, HUGE_VAL, -HUGE_VAL};
+
+  // Rythme des rafraîchissements
+  if (const char *pszRate = getenv("LIBGRAPH2_NULL_FPS")) {
+    double dRate = strtod(pszRate, NULL);
+    if (dRate > 0)
+      m_frameInterval = std::chrono::duration_cast<
+          std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / dRate));
+  }
+  m_tpShow = m_tpNextFrame = std::chrono::steady_clock::now();
+}
+
+// Destructeur
+// Appelé avec le verrou de la liste des fenêtres
+CLibGraph2Null::~CLibGraph2Null() {
+  uint64_t nCalls = 0;
+  for (const SNullCallStats &stats : m_aStats)
+    nCalls += stats.nCalls;
+  if (nCalls == 0)
+    return;
+
+  if (const char *pszReport = getenv("LIBGRAPH2_NULL_REPORT")) {
+    // Ajout en fin de fichier : une section par fenêtre
+    std::ofstream file(pszReport, std::ios::app);
+    if (file) {
+      WriteReport(file);
+      return;
+    }
+  }
+  WriteReport(std::cerr);
+}
+
+// Statistiques
+
+const char *CLibGraph2Null::getCallName(null_call nCall) {
+  return s_aCallInfo[nCall].pszName;
+}
+
+void CLibGraph2Null::Count(null_call nCall) { m_aStats[nCall].nCalls++; }
+
+void CLibGraph2Null::Count(null_call nCall, double dArg) {
+  SNullCallStats &stats = m_aStats[nCall];
+  stats.nCalls++;
+  stats.nSamples++;
+  stats.dSum += dArg;
+  stats.dMin = std::min(stats.dMin, dArg);
+  stats.dMax = std::max(stats.dMax, dArg);
+}
+
+bool CLibGraph2Null::Invalid(null_call nCall) {
+  m_aStats[nCall].nCalls++;
+  m_aStats[nCall].nInvalid++;
+  return false;
+}
+
+bool CLibGraph2Null::CheckPoint(null_call nCall, const CPoint &pt) {
+  if (!std::isfinite(pt.m_fX) || !std::isfinite(pt.m_fY))
+    return Invalid(nCall);
+  return true;
+}
+
+bool CLibGraph2Null::CheckRect(null_call nCall, const CRectangle &rect) {
+  const CSize &sz = rect.m_szSize;
+  if (!std::isfinite(sz.m_fWidth) || !std::isfinite(sz.m_fHeight) ||
+      sz.m_fWidth < 0 || sz.m_fHeight < 0)
+    return Invalid(nCall);
+  return CheckPoint(nCall, rect.m_ptTopLeft);
+}
+
+void CLibGraph2Null::WriteReport(std::ostream &out) const {
+  double dSeconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - m_tpShow)
+                        .count();
+  char szLine[160];
+  snprintf(szLine, sizeof szLine,
+           "LibGraph2, moteur nul : %lu images en %.3f s\n", m_nFrames,
+           dSeconds);
+  out << szLine;
+  snprintf(szLine, sizeof szLine, "%-20s %12s %10s %12s %12s %12s  %s\n",
+           "fonction", "appels", "invalides", "min", "moyenne", "max",
+           "argument (px)");
+  out << szLine;
+
+  for (int i = 0; i < NullCallCount; i++) {
+    const SNullCallStats &stats = m_aStats[i];
+    if (stats.nCalls == 0)
+      continue;
+    if (stats.nSamples == 0)
+      snprintf(szLine, sizeof szLine, "%-20s %12llu %10llu\n",
+               s_aCallInfo[i].pszName, (unsigned long long)stats.nCalls,
+               (unsigned long long)stats.nInvalid);
+    else
+      snprintf(szLine, sizeof szLine,
+               "%-20s %12llu %10llu %12.1f %12.1f %12.1f  %s\n",
+               s_aCallInfo[i].pszName, (unsigned long long)stats.nCalls,
+               (unsigned long long)stats.nInvalid, stats.dMin,
+               stats.dSum / stats.nSamples, stats.dMax,
+               s_aCallInfo[i].pszArgument);
+    out << szLine;
+  }
+  out.flush();
+}
+
+// Implémentation des fonctions publiques
+
+// Commun à show() et showOffscreen(). Renvoie false si la taille est invalide
+bool CLibGraph2Null::Open(const CSize &szWndSize) {
+  if (!std::isfinite(szWndSize.m_fWidth) ||
+      !std::isfinite(szWndSize.m_fHeight) || szWndSize.m_fWidth < 0 ||
+      szWndSize.m_fHeight < 0)
+    return false;
+
+  SetNormalisedSize(szWndSize, m_nWidth, m_nHeight);
+  m_bShown = true;
+  m_nFrames = 0;
+  m_tpShow = m_tpNextFrame = std::chrono::steady_clock::now();
+
+  ComputeScaleAndOffset();
+  return true;
+}
+
+void CLibGraph2Null::show(const CSize &szWndSize, bool bFullScreen) {
+  if (Open(szWndSize))
+    Count(NullShow);
+  else
+    Invalid(NullShow);
+}
+
+void CLibGraph2Null::showOffscreen(const CSize &szSize, unsigned long nFrames) {
+  if (!Open(szSize)) {
+    Invalid(NullShowOffscreen);
+    return;
+  }
+  Count(NullShowOffscreen);
+  // Sans nombre d'images, celui de LIBGRAPH2_FRAMES est conservé
+  if (nFrames != 0)
+    m_nMaxFrames = nFrames;
+}
+
+void CLibGraph2Null::hide() { Count(NullHide); }
+
+CSize CLibGraph2Null::getSize() {
+  Count(NullGetSize);
+  return CLibGraph2Front::getSize();
+}
+
+void CLibGraph2Null::askForRefresh() { Count(NullAskForRefresh); }
+
+void CLibGraph2Null::beginPaint() {
+  Count(NullBeginPaint);
+  CLibGraph2Front::beginPaint();
+}
+
+void CLibGraph2Null::endPaint() {
+  Count(NullEndPaint);
+  if (m_bShown) {
+    MergeRecorders();
+    // Rien n'est affiché : l'image est terminée dès endPaint()
+    m_frameTimes.OnPresent();
+    m_frameTimes.OnDisplayed();
+    m_frameTimes.OnEndPaint();
+  }
+}
+
+// Image : aucune n'est produite
+
+bool CLibGraph2Null::saveFrame(const CString &sFileName) {
+  Count(NullSaveFrame);
+  return false;
+}
+
+bool CLibGraph2Null::getFramePixels(std::vector<ARGB> &vPixels,
+                                    unsigned &nWidth, unsigned &nHeight) {
+  Count(NullGetFramePixels);
+  return false;
+}
+
+bool CLibGraph2Null::startVideoOutput(const CString &sFileName,
+                                      video_format format,
+                                      unsigned nFrameRate) {
+  if (nFrameRate == 0)
+    return Invalid(NullStartVideoOutput);
+  Count(NullStartVideoOutput);
+  return false;
+}
+
+void CLibGraph2Null::requestReadback(const CRectangle &rect,
+                                     const readback_callback &callback) {
+  if (CheckRect(NullRequestReadback, rect))
+    Count(NullRequestReadback, UnmapWidth(rect.m_szSize.m_fWidth) *
+                                   UnmapWidth(rect.m_szSize.m_fHeight));
+  callback(NULL, 0, 0);
+}
+
+bool CLibGraph2Null::startFrameServer(const CString &sAddress) {
+  Count(NullStartFrameServer);
+  return false;
+}
+
+// Rien n'est dessiné : tous les compteurs restent à zéro
+SFrameStats CLibGraph2Null::getFrameStats() {
+  Count(NullGetFrameStats);
+  return SFrameStats();
+}
+
+void CLibGraph2Null::enableGpuTimer(bool bEnable) {
+  Count(NullEnableGpuTimer);
+}
+
+void CLibGraph2Null::getFrameAllocations(
+    std::vector<SAllocationStats> &vAllocations) {
+  Count(NullGetFrameAllocations);
+  vAllocations.clear();
+}
+
+void CLibGraph2Null::getFrameTimes(SFrameTimes &interval,
+                                   SFrameTimes &response, double dBudgetMs) {
+  Count(NullGetFrameTimes);
+  CLibGraph2Front::getFrameTimes(interval, response, dBudgetMs);
+}
+
+void CLibGraph2Null::getInputLatency(SInputLatency &latency,
+                                     double dBudgetMs) {
+  Count(NullGetInputLatency);
+  CLibGraph2Front::getInputLatency(latency, dBudgetMs);
+}
+
+void CLibGraph2Null::resetFrameTimes() {
+  Count(NullResetFrameTimes);
+  CLibGraph2Front::resetFrameTimes();
+}
+
+// Aucune fenêtre : la surimpression n'est jamais affichée
+void CLibGraph2Null::showPerformanceOverlay(bool bShow) {
+  Count(NullShowPerformanceOverlay);
+}
+
+// Enregistreurs de commandes
+
+ILibGraph2Recorder *CLibGraph2Null::createRecorder() {
+  Count(NullCreateRecorder);
+  return CLibGraph2Front::createRecorder();
+}
+
+void CLibGraph2Null::releaseRecorder(ILibGraph2Recorder *pRecorder) {
+  auto it = std::find(m_vRecorders.begin(), m_vRecorders.end(), pRecorder);
+  if (it == m_vRecorders.end()) {
+    Invalid(NullReleaseRecorder);
+    return;
+  }
+  Count(NullReleaseRecorder);
+  CLibGraph2Front::releaseRecorder(pRecorder);
+}
+
+void CLibGraph2Null::MergeRecorders() {
+  for (CRecorder *pRec : m_vRecorders) {
+    if (pRec->HasDrawing())
+      pRec->buffer().forEach([this](cmd_op op, const uint8_t *p, size_t n) {
+        DispatchCommand(*this, op, p, n);
+      });
+    pRec->Reset();
+  }
+}
+
+// Fonctions de dessin
+
+void CLibGraph2Null::setPen(ARGB color, float fWidth, pen_DashStyles style) {
+  if (!std::isfinite(fWidth) || fWidth < 0) {
+    Invalid(NullSetPen);
+    return;
+  }
+  Count(NullSetPen, UnmapWidth(fWidth));
+}
+
+void CLibGraph2Null::setSolidBrush(ARGB color) { Count(NullSetSolidBrush); }
+
+void CLibGraph2Null::setTextureBrush(const CString &sFileName) {
+  if (sFileName->empty()) {
+    Invalid(NullSetTextureBrush);
+    return;
+  }
+  Count(NullSetTextureBrush);
+}
+
+void CLibGraph2Null::setFont(const CString &strFontName, float fPointSize,
+                             font_styles nStyleFlags) {
+  if (strFontName->empty() || !std::isfinite(fPointSize) || fPointSize <= 0) {
+    Invalid(NullSetFont);
+    return;
+  }
+  m_fontSize = UnmapWidth(fPointSize);
+  Count(NullSetFont, m_fontSize);
+}
+
+void CLibGraph2Null::drawLine(const CPoint &ptP1, const CPoint &ptP2) {
+  if (!m_bShown) {
+    Invalid(NullDrawLine);
+    return;
+  }
+  if (CheckPoint(NullDrawLine, ptP1) && CheckPoint(NullDrawLine, ptP2))
+    Count(NullDrawLine, UnmapWidth(hypotf(ptP2.m_fX - ptP1.m_fX,
+                                          ptP2.m_fY - ptP1.m_fY)));
+}
+
+void CLibGraph2Null::drawRectangle(const CRectangle &bounds) {
+  if (!m_bShown) {
+    Invalid(NullDrawRectangle);
+    return;
+  }
+  if (CheckRect(NullDrawRectangle, bounds))
+    Count(NullDrawRectangle, UnmapWidth(bounds.m_szSize.m_fWidth) *
+                                 UnmapWidth(bounds.m_szSize.m_fHeight));
+}
+
+void CLibGraph2Null::drawEllipse(const CRectangle &bounds) {
+  if (!m_bShown) {
+    Invalid(NullDrawEllipse);
+    return;
+  }
+  if (CheckRect(NullDrawEllipse, bounds))
+    Count(NullDrawEllipse, UnmapWidth(bounds.m_szSize.m_fWidth) *
+                               UnmapWidth(bounds.m_szSize.m_fHeight));
+}
+
+void CLibGraph2Null::drawArc(const CRectangle &bounds, float startAngle,
+                             float sweepAngle) {
+  if (!m_bShown || !std::isfinite(startAngle) || !std::isfinite(sweepAngle)) {
+    Invalid(NullDrawArc);
+    return;
+  }
+  if (CheckRect(NullDrawArc, bounds))
+    Count(NullDrawArc, UnmapWidth(bounds.m_szSize.m_fWidth) *
+                           UnmapWidth(bounds.m_szSize.m_fHeight));
+}
+
+void CLibGraph2Null::drawPie(const CRectangle &bounds, float startAngle,
+                             float sweepAngle) {
+  if (!m_bShown || !std::isfinite(startAngle) || !std::isfinite(sweepAngle)) {
+    Invalid(NullDrawPie);
+    return;
+  }
+  if (CheckRect(NullDrawPie, bounds))
+    Count(NullDrawPie, UnmapWidth(bounds.m_szSize.m_fWidth) *
+                           UnmapWidth(bounds.m_szSize.m_fHeight));
+}
+
+void CLibGraph2Null::drawPolylines(const vector<CPoint> &vPoints,
+                                   bool bAutoClose) {
+  if (!m_bShown || vPoints.empty()) {
+    Invalid(NullDrawPolylines);
+    return;
+  }
+  for (const CPoint &pt : vPoints)
+    if (!std::isfinite(pt.m_fX) || !std::isfinite(pt.m_fY)) {
+      Invalid(NullDrawPolylines);
+      return;
+    }
+  Count(NullDrawPolylines, (double)vPoints.size());
+}
+
+void CLibGraph2Null::setPixel(const CPoint &ptPos, ARGB color) {
+  if (!m_bShown) {
+    Invalid(NullSetPixel);
+    return;
+  }
+  if (CheckPoint(NullSetPixel, ptPos))
+    Count(NullSetPixel);
+}
+
+void CLibGraph2Null::drawString(const CString &text, const CPoint &ptPos) {
+  if (!m_bShown) {
+    Invalid(NullDrawString);
+    return;
+  }
+  if (CheckPoint(NullDrawString, ptPos))
+    Count(NullDrawString, (double)text->length());
+}
+
+// Sans police chargée, la taille du texte est estimée : chaque caractère
+// occupe 0,6 fois la taille de la police en largeur
+void CLibGraph2Null::getStringDimension(const CString &text,
+                                        const CPoint &ptPos,
+                                        CRectangle &rectBounds) {
+  Count(NullGetStringDimension, (double)text->length());
+  rectBounds.m_ptTopLeft = CPoint(0, 0);
+  rectBounds.m_szSize.m_fWidth =
+      (float)(0.6 * m_fontSize * text->length() / m_dScale);
+  rectBounds.m_szSize.m_fHeight = (float)(m_fontSize / m_dScale);
+}
+
+void CLibGraph2Null::drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                                double dScaleFactor, double dAngleDeg,
+                                bool bXYIsCenter) {
+  if (!m_bShown || sFileName->empty() || !std::isfinite(dScaleFactor) ||
+      dScaleFactor <= 0 || !std::isfinite(dAngleDeg)) {
+    Invalid(NullDrawBitmap);
+    return;
+  }
+  if (CheckPoint(NullDrawBitmap, ptPos))
+    Count(NullDrawBitmap, dScaleFactor * m_dScale);
+}
+
+void CLibGraph2Null::drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                                const CPoint &ptPosPivot, double dScaleFactor,
+                                double dAngleDeg) {
+  if (!m_bShown || sFileName->empty() || !std::isfinite(dScaleFactor) ||
+      dScaleFactor <= 0 || !std::isfinite(dAngleDeg)) {
+    Invalid(NullDrawBitmap);
+    return;
+  }
+  if (CheckPoint(NullDrawBitmap, ptPos) &&
+      CheckPoint(NullDrawBitmap, ptPosPivot))
+    Count(NullDrawBitmap, dScaleFactor * m_dScale);
+}
+
+// Commandes des enregistreurs, déjà en pixels
+
+void CLibGraph2Null::CmdSetPen(ARGB color, float fThickness) {
+  if (!std::isfinite(fThickness) || fThickness < 0)
+    Invalid(NullSetPen);
+  else
+    Count(NullSetPen, fThickness);
+}
+
+void CLibGraph2Null::CmdSetBrush(ARGB color) { Count(NullSetSolidBrush); }
+
+void CLibGraph2Null::CmdSetFont(const std::string &strFontName, float fSize,
+                                font_styles nStyle) {
+  Count(NullSetFont, fSize);
+}
+
+void CLibGraph2Null::CmdLine(const SCmdLine &c) {
+  if (!std::isfinite(c.x1) || !std::isfinite(c.y1) || !std::isfinite(c.x2) ||
+      !std::isfinite(c.y2))
+    Invalid(NullDrawLine);
+  else
+    Count(NullDrawLine, hypotf(c.x2 - c.x1, c.y2 - c.y1));
+}
+
+void CLibGraph2Null::CmdRectangle(const SCmdRect &c) {
+  if (!std::isfinite(c.x) || !std::isfinite(c.y) || !(c.w >= 0) ||
+      !(c.h >= 0))
+    Invalid(NullDrawRectangle);
+  else
+    Count(NullDrawRectangle, c.w * c.h);
+}
+
+void CLibGraph2Null::CmdEllipse(const SCmdRect &c) {
+  if (!std::isfinite(c.x) || !std::isfinite(c.y) || !(c.w >= 0) ||
+      !(c.h >= 0))
+    Invalid(NullDrawEllipse);
+  else
+    Count(NullDrawEllipse, c.w * c.h);
+}
+
+void CLibGraph2Null::CmdPie(const SCmdPie &c) {
+  if (!std::isfinite(c.x) || !std::isfinite(c.y) || !(c.w >= 0) ||
+      !(c.h >= 0))
+    Invalid(NullDrawPie);
+  else
+    Count(NullDrawPie, c.w * c.h);
+}
+
+void CLibGraph2Null::CmdPixel(const SCmdPixel &c) {
+  if (!std::isfinite(c.x) || !std::isfinite(c.y))
+    Invalid(NullSetPixel);
+  else
+    Count(NullSetPixel);
+}
+
+void CLibGraph2Null::CmdPolyline(const float *pCoords, uint32_t nCount,
+                                 bool bAutoClose) {
+  for (uint32_t i = 0; i < 2 * nCount; i++)
+    if (!std::isfinite(pCoords[i])) {
+      Invalid(NullDrawPolylines);
+      return;
+    }
+  Count(NullDrawPolylines, nCount);
+}
+
+void CLibGraph2Null::CmdString(const std::wstring &text, float x, float y) {
+  Count(NullDrawString, (double)text.length());
+}
+
+void CLibGraph2Null::CmdBitmap(const std::string &filename,
+                               const SCmdBitmap &c) {
+  Count(NullDrawBitmap, c.fScale);
+}
+
+// Gestion des événements
+
+bool CLibGraph2Null::waitForEvent(evt &e) {
+  Count(NullWaitForEvent);
+  CFrameTimes::CEventScope frameTimes(m_frameTimes, e);
+  if (m_eventLog.IsReplaying())
+    return ReplayEvent(e);
+
+  if (!m_bShown)
+    return false;
+
+  NextEvent(e);
+  m_eventLog.Record(e);
+  return e.type != evt_type::evtClose;
+}
+
+void CLibGraph2Null::NextEvent(evt &e) {
+  if (m_nMaxFrames != 0 && m_nFrames >= m_nMaxFrames) {
+    e.type = evt_type::evtClose;
+    m_bShown = false;
+    m_lastEvent = e;
+    return;
+  }
+
+  if (m_frameInterval.count() > 0) {
+    auto tpNow = std::chrono::steady_clock::now();
+    if (tpNow < m_tpNextFrame)
+      std::this_thread::sleep_until(m_tpNextFrame);
+    else if (tpNow - m_tpNextFrame > m_frameInterval)
+      m_tpNextFrame = tpNow; // En retard : pas de rafale pour rattraper
+    m_tpNextFrame += m_frameInterval;
+  }
+  e.type = evt_type::evtRefresh;
+  m_nFrames++;
+  m_lastEvent = e;
+}
+
+bool CLibGraph2Null::ReplayEvent(evt &e) {
+  if (!m_eventLog.Replay(e)) {
+    e.type = evt_type::evtClose;
+  } else if (e.type == evt_type::evtRefresh) {
+    m_nFrames++;
+  } else if (e.type == evt_type::evtSize && m_bShown) {
+    m_nWidth = (int)e.x;
+    m_nHeight = (int)e.y;
+    ComputeScaleAndOffset();
+  }
+
+  // Fin du journal ou fermeture enregistrée : la fenêtre n'est plus servie
+  // par WaitForAnyEvent()
+  if (e.type == evt_type::evtClose)
+    m_bShown = false;
+  m_lastEvent = e;
+  return e.type != evt_type::evtClose;
+}
+
+// Boîtes de dialogue : toujours annulées
+
+bool CLibGraph2Null::guiGetFileName(CString &sFileName, bool bOpen,
+                                    const vector<CString> &vstrFileTypes) {
+  Count(NullGui);
+  return false;
+}
+
+bool CLibGraph2Null::guiGetColor(ARGB &color) {
+  Count(NullGui);
+  return false;
+}
+
+bool CLibGraph2Null::guiGetPenStyle(ARGB &color, float &fWidth,
+                                    pen_DashStyles &style) {
+  Count(NullGui);
+  return false;
+}
+
+bool CLibGraph2Null::guiGetFont(CString &strFontName, float &fPointSize,
+                                font_styles &nStyleFlags) {
+  Count(NullGui);
+  return false;
+}
+
+bool CLibGraph2Null::guiGetValue(CString &strVal, const CString &strTitle,
+                                 const CString &strLabel) {
+  Count(NullGui);
+  return false;
+}
+
+bool CLibGraph2Null::guiGetValue(int &nVal, const CString &strTitle,
+                                 const CString &strLabel) {
+  Count(NullGui);
+  return false;
+}
+
+bool CLibGraph2Null::guiGetValue(double &dVal, const CString &strTitle,
+                                 const CString &strLabel) {
+  Count(NullGui);
+  return false;
+}
+
+msgbtn_answer CLibGraph2Null::guiMessageBox(const CString &strTitle,
+                                            const CString &strText,
+                                            msgbtn_types btns,
+                                            msgicon_types icon,
+                                            msgdefbtn_vals defbtn) {
+  Count(NullGui);
+  return msgbtn_answer::MsgAnsOk;
+}
+
+#endif // LIBGRAPH2_USE_NULL
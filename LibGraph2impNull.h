@@ -0,0 +1,267 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#ifdef LIBGRAPH2_USE_NULL
+
+#include "LibGraph2Front.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace LibGraph2;
+
+// Fonctions comptées par le moteur nul
+enum null_call {
+  NullShow,
+  NullShowOffscreen,
+  NullHide,
+  NullGetSize,
+  NullAskForRefresh,
+  NullBeginPaint,
+  NullEndPaint,
+  NullWaitForEvent,
+  NullSetPen,
+  NullSetSolidBrush,
+  NullSetTextureBrush,
+  NullSetFont,
+  NullDrawLine,
+  NullDrawRectangle,
+  NullDrawEllipse,
+  NullDrawArc,
+  NullDrawPie,
+  NullDrawPolylines,
+  NullSetPixel,
+  NullDrawString,
+  NullGetStringDimension,
+  NullDrawBitmap,
+  NullCreateRecorder,
+  NullReleaseRecorder,
+  NullSaveFrame,
+  NullGetFramePixels,
+  NullStartVideoOutput,
+  NullRequestReadback,
+  NullStartFrameServer,
+  NullGetFrameStats,
+  NullEnableGpuTimer,
+  NullGetFrameAllocations,
+  NullGetFrameTimes,
+  NullGetInputLatency,
+  NullResetFrameTimes,
+  NullShowPerformanceOverlay,
+  NullGui,
+  NullCallCount
+};
+
+// Statistiques d'une fonction. L'argument mesuré dépend de la fonction
+// (longueur, surface, nombre de points...) et est exprimé en pixels
+struct SNullCallStats {
+  uint64_t nCalls;
+  uint64_t nInvalid; // Appels aux arguments invalides, ou avant show()
+  uint64_t nSamples;
+  double dSum, dMin, dMax;
+};
+
+/*
+ * Moteur nul : accepte tous les appels de ILibGraph2_Exp, vérifie leurs
+ * arguments et les compte, sans rien dessiner.
+ *
+ * Permet de distinguer le coût propre d'une application de celui de
+ * LibGraph2, et de rejouer rapidement une charge applicative dans des tests
+ * de performance (avec LIBGRAPH2_REPLAY_EVENTS). waitForEvent() génère des
+ * rafraîchissements au rythme de LIBGRAPH2_NULL_FPS images par seconde
+ * (par défaut, aussi vite que possible), dans la limite de LIBGRAPH2_FRAMES.
+ * Le bilan des appels est écrit à la fermeture de la fenêtre, sur la sortie
+ * d'erreur ou dans le fichier LIBGRAPH2_NULL_REPORT.
+ *
+ * Les fonctions qui produisent une image (saveFrame(), getFramePixels(),
+ * startVideoOutput()...) échouent, puisqu'il n'y en a pas.
+ */
+class CLibGraph2Null final : public CLibGraph2Front,
+                             public CWindowList<CLibGraph2Null> {
+private:
+  friend class CWindowList<CLibGraph2Null>;
+
+  // Taille de l'image simulée, en pixels
+  int m_nWidth, m_nHeight;
+  float m_fontSize;
+
+  // Rythme des rafraîchissements (durée nulle : aucune attente)
+  std::chrono::steady_clock::duration m_frameInterval;
+  std::chrono::steady_clock::time_point m_tpNextFrame;
+  std::chrono::steady_clock::time_point m_tpShow;
+
+  SNullCallStats m_aStats[NullCallCount];
+
+private:
+  CLibGraph2Null(void);
+  ~CLibGraph2Null(void);
+
+  int getPixelWidth() override { return m_nWidth; }
+  int getPixelHeight() override { return m_nHeight; }
+  bool Open(const CSize &szWndSize);
+
+  // Compte un appel, avec la valeur de son argument principal
+  void Count(null_call nCall);
+  void Count(null_call nCall, double dArg);
+  // Compte un appel invalide. Renvoie toujours false
+  bool Invalid(null_call nCall);
+  // Vérifications communes aux fonctions de dessin
+  bool CheckPoint(null_call nCall, const CPoint &pt);
+  bool CheckRect(null_call nCall, const CRectangle &rect);
+
+  // Génère l'événement suivant (rafraîchissement ou fermeture)
+  void NextEvent(evt &e);
+  // Renvoie l'événement suivant du journal rejoué
+  bool ReplayEvent(evt &e);
+
+  // Compte les commandes des enregistreurs, comme des appels directs
+  void MergeRecorders();
+
+  template <typename V>
+  friend void LibGraph2::DispatchCommand(V &visitor, cmd_op op,
+                                         const uint8_t *p, size_t nSize);
+  void CmdSetPen(ARGB color, float fThickness);
+  void CmdSetBrush(ARGB color);
+  void CmdSetFont(const std::string &strFontName, float fSize,
+                  font_styles nStyle);
+  void CmdClear(ARGB color) {}
+  void CmdLine(const SCmdLine &c);
+  void CmdRectangle(const SCmdRect &c);
+  void CmdEllipse(const SCmdRect &c);
+  void CmdPie(const SCmdPie &c);
+  void CmdPixel(const SCmdPixel &c);
+  void CmdPolyline(const float *pCoords, uint32_t nCount, bool bAutoClose);
+  void CmdString(const std::wstring &text, float x, float y);
+  void CmdBitmap(const std::string &strFileName, const SCmdBitmap &c);
+  void CmdDisplay() {}
+
+public:
+  // Statistiques
+  const SNullCallStats &getStats(null_call nCall) const {
+    return m_aStats[nCall];
+  }
+  static const char *getCallName(null_call nCall);
+  void WriteReport(std::ostream &out) const;
+
+  // Implémentation de ILibGraph2_Com
+  virtual void show(const CSize &szWndSize = CSize(), bool bFullScreen = false);
+  virtual void hide();
+  virtual CSize getSize();
+  virtual void askForRefresh();
+  virtual void beginPaint();
+  virtual void endPaint();
+  virtual void enableRenderThread(bool bEnable) {}
+  virtual ILibGraph2Recorder *createRecorder();
+  virtual void releaseRecorder(ILibGraph2Recorder *pRecorder);
+  virtual void showOffscreen(const CSize &szSize = CSize(),
+                             unsigned long nFrames = 0);
+  virtual bool saveFrame(const CString &sFileName);
+  virtual bool getFramePixels(std::vector<ARGB> &vPixels, unsigned &nWidth,
+                              unsigned &nHeight);
+  virtual bool startVideoOutput(const CString &sFileName,
+                                video_format format = video_format::Y4M,
+                                unsigned nFrameRate = 60);
+  virtual void stopVideoOutput() {}
+  virtual void requestReadback(const CRectangle &rect,
+                               const readback_callback &callback);
+  virtual bool startFrameServer(const CString &sAddress);
+  virtual void stopFrameServer() {}
+  virtual SFrameStats getFrameStats();
+  virtual void enableGpuTimer(bool bEnable);
+  virtual void getFrameAllocations(std::vector<SAllocationStats> &vAllocations);
+  virtual void getFrameTimes(SFrameTimes &interval, SFrameTimes &response,
+                             double dBudgetMs = 1000.0 / 60);
+  virtual void getInputLatency(SInputLatency &latency, double dBudgetMs = 50);
+  virtual void resetFrameTimes();
+  virtual void showPerformanceOverlay(bool bShow);
+
+  // Fonctions de dessin
+  virtual void setPen(ARGB color, float fWidth,
+                      pen_DashStyles style = pen_DashStyles::Solid);
+  virtual void setSolidBrush(ARGB color);
+  virtual void drawArc(const CRectangle &rectBounds, float startAngle,
+                       float sweepAngle);
+  virtual void drawEllipse(const CRectangle &rectBounds);
+  virtual void drawLine(const CPoint &ptP1, const CPoint &ptP2);
+  virtual void drawPie(const CRectangle &rectBounds, float startAngle,
+                       float sweepAngle);
+  virtual void drawRectangle(const CRectangle &rectBounds);
+  virtual void setPixel(const CPoint &ptPos, ARGB color);
+  virtual void drawPolylines(const std::vector<CPoint> &vPoints,
+                             bool bAutoClose = false);
+
+  // Fonctions avancées
+  virtual bool waitForEvent(evt &e);
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          double dScaleFactor = 1.0, double dAngleDeg = 0,
+                          bool bXYIsCenter = false);
+  virtual void drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                          const CPoint &ptPosPivot, double dScaleFactor,
+                          double dAngleDeg);
+  virtual void setTextureBrush(const CString &sFileName);
+  virtual void setFont(const CString &strFontName, float fPointSize,
+                       font_styles nStyleFlags);
+  virtual void drawString(const CString &text, const CPoint &ptPos);
+  virtual void getStringDimension(const CString &text, const CPoint &ptPos,
+                                  CRectangle &rectBounds);
+
+  // Boîtes de dialogue : toujours annulées
+  virtual bool guiGetFileName(
+      CString &sFileName, bool bOpen = true,
+      const std::vector<CString> &vstrFileTypes = std::vector<CString>());
+  virtual bool guiGetColor(ARGB &color);
+  virtual bool guiGetPenStyle(ARGB &color, float &fWidth,
+                              pen_DashStyles &style);
+  virtual bool guiGetFont(CString &strFontName, float &fPointSize,
+                          font_styles &nStyleFlags);
+  virtual bool guiGetValue(CString &strVal, const CString &strTitle = L"",
+                           const CString &strLabel = L"");
+  virtual bool guiGetValue(int &nVal, const CString &strTitle = L"",
+                           const CString &strLabel = L"");
+  virtual bool guiGetValue(double &dVal, const CString &strTitle = L"",
+                           const CString &strLabel = L"");
+  virtual msgbtn_answer
+  guiMessageBox(const CString &strTitle = L"", const CString &strText = L"",
+                msgbtn_types btns = msgbtn_types::MsgBtnOK,
+                msgicon_types icon = msgicon_types::MsgIcnNone,
+                msgdefbtn_vals defbtn = msgdefbtn_vals::MsgDefBtn1);
+
+  // Fonctions de compatibilité pour pointeurs
+  virtual void drawPolylines(CPoint *pPoints, int nNbPoints,
+                             bool bAutoClose = false) {
+    if (nNbPoints < 0 || (!pPoints && nNbPoints > 0)) {
+      Invalid(NullDrawPolylines);
+      return;
+    }
+    drawPolylines(std::vector<CPoint>(pPoints, pPoints + nNbPoints),
+                  bAutoClose);
+  }
+  virtual bool guiGetFileName(CString &sFileName, bool bOpen = true,
+                              CString *pstrFileTypes = NULL,
+                              int nNbFileTypes = 0) {
+    if (nNbFileTypes < 0 || (!pstrFileTypes && nNbFileTypes > 0))
+      return Invalid(NullGui);
+    return guiGetFileName(
+        sFileName, bOpen,
+        std::vector<CString>(pstrFileTypes, pstrFileTypes + nNbFileTypes));
+  }
+};
+
+#endif // LIBGRAPH2_USE_NULL
@@ -19,10 +19,16 @@
 #ifdef LIBGRAPH2_USE_SFML
 #define _USE_MATH_DEFINES
 #include "LibGraph2impSFML.h"
+#include "LibGraph2Image.h"
+#include "LibGraph2Probes.h"
+#include <SFML/Window/Context.hpp>
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 
 // Note: tinyfiledialogs sera ajouté plus tard
 // #include "tinyfiledialogs.h"
@@ -30,67 +36,280 @@
 using namespace std;
 using namespace LibGraph2;
 
-// Pointeur vers l'unique instance (singleton)
-CLibGraph2 *CLibGraph2::s_pInstance = NULL;
+// Ressources partagées
 
-// Fonction statique de récupération de l'instance
-CLibGraph2 *CLibGraph2::GetInstance() {
-  if (s_pInstance == NULL)
-    s_pInstance = new CLibGraph2;
-  return s_pInstance;
+CSharedResources *CSharedResources::s_pResources = NULL;
+int CSharedResources::s_nRefCount = 0;
+
+// Appelée avec le verrou de la liste des fenêtres (CWindowList)
+CSharedResources *CSharedResources::Acquire() {
+  if (s_nRefCount++ == 0)
+    s_pResources = new CSharedResources;
+  return s_pResources;
+}
+
+// Appelée avec le verrou de la liste des fenêtres (CWindowList)
+void CSharedResources::Release() {
+  if (--s_nRefCount == 0) {
+    delete s_pResources;
+    s_pResources = NULL;
+  }
+}
+
+const sf::Texture *CSharedResources::GetTexture(const std::string &filename,
+                                                SFrameStats *pStats) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_textureCache.find(filename);
+  if (it == m_textureCache.end()) {
+    if (pStats)
+      pStats->nTextureCacheMisses++;
+    CTraceScope trace("loadTexture");
+    CProbeClock probe;
+    // Chargée directement dans le cache : copier une sf::Texture la
+    // renverrait au GPU une seconde fois
+    it = m_textureCache.emplace(filename, sf::Texture()).first;
+    sf::Texture &texture = it->second;
+    if (!texture.loadFromFile(filename)) {
+      m_textureCache.erase(it);
+      LIBGRAPH2_PROBE5(texture__load, filename.c_str(), 0, 0, 0,
+                       probe.ElapsedUs());
+      return NULL; // Erreur de chargement
+    }
+    if (pStats)
+      pStats->nTextureUploads++;
+    unsigned long long nBytes =
+        4ull * texture.getSize().x * texture.getSize().y;
+    m_nTextureBytes += nBytes;
+    LIBGRAPH2_PROBE5(texture__load, filename.c_str(), texture.getSize().x,
+                     texture.getSize().y, nBytes, probe.ElapsedUs());
+  } else if (pStats) {
+    pStats->nTextureCacheHits++;
+  }
+  return &it->second;
 }
 
-// Fonction statique de libération de l'instance
-void CLibGraph2::ReleaseInstance() {
-  delete s_pInstance;
-  s_pInstance = NULL;
+unsigned long long CSharedResources::GetTextureBytes() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nTextureBytes;
+}
+
+const sf::Font *CSharedResources::GetFont(const std::string &filename,
+                                          SFrameStats *pStats) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_fontRegistry.find(filename);
+  if (it == m_fontRegistry.end()) {
+    CTraceScope trace("loadFont");
+    CProbeClock probe;
+    sf::Font font;
+    bool bLoaded = font.loadFromFile(filename);
+    LIBGRAPH2_PROBE3(font__load, filename.c_str(), bLoaded ? 1 : 0,
+                     probe.ElapsedUs());
+    if (!bLoaded)
+      return NULL;
+    if (pStats)
+      pStats->nFontLoads++;
+    it = m_fontRegistry.emplace(filename, font).first;
+  }
+  return &it->second;
+}
+
+// Cible de rendu hors écran
+
+CBackBuffer::CBackBuffer()
+    : m_nWidth(0), m_nHeight(0), m_nCapacityX(0), m_nCapacityY(0),
+      m_bShrinkPending(false) {}
+
+bool CBackBuffer::Allocate(unsigned nCapacityX, unsigned nCapacityY) {
+  if (!m_texture.create(nCapacityX, nCapacityY)) {
+    m_nCapacityX = m_nCapacityY = 0;
+    return false;
+  }
+  m_nCapacityX = nCapacityX;
+  m_nCapacityY = nCapacityY;
+  return true;
+}
+
+bool CBackBuffer::Reserve(unsigned nWidth, unsigned nHeight) {
+  unsigned nBucketX = RoundUp(nWidth);
+  unsigned nBucketY = RoundUp(nHeight);
+  // Une nouvelle texture a la vue par défaut
+  bool bAllocated = false;
+
+  if (nBucketX > m_nCapacityX || nBucketY > m_nCapacityY) {
+    // Agrandissement immédiat, sans réduire l'autre dimension
+    m_bShrinkPending = false;
+    if (!Allocate(std::max(nBucketX, m_nCapacityX),
+                  std::max(nBucketY, m_nCapacityY)))
+      return false;
+    bAllocated = true;
+  } else if (nBucketX < m_nCapacityX || nBucketY < m_nCapacityY) {
+    // Réduction différée : la taille doit rester stable un certain temps
+    auto now = std::chrono::steady_clock::now();
+    if (!m_bShrinkPending) {
+      m_bShrinkPending = true;
+      m_tpShrinkRequest = now;
+    } else if (now - m_tpShrinkRequest >
+               std::chrono::milliseconds(SHRINK_DELAY_MS)) {
+      m_bShrinkPending = false;
+      if (!Allocate(nBucketX, nBucketY))
+        return false;
+      bAllocated = true;
+    }
+  } else {
+    m_bShrinkPending = false;
+  }
+
+  if (!bAllocated && nWidth == m_nWidth && nHeight == m_nHeight)
+    return true;
+  m_nWidth = nWidth;
+  m_nHeight = nHeight;
+
+  // Seule la zone utile, en haut à gauche de la texture, est adressée
+  sf::View view(sf::FloatRect(0, 0, (float)nWidth, (float)nHeight));
+  view.setViewport(sf::FloatRect(0, 0, (float)nWidth / m_nCapacityX,
+                                 (float)nHeight / m_nCapacityY));
+  m_texture.setView(view);
+  return true;
+}
+
+void CBackBuffer::Release() {
+  if (!IsAllocated())
+    return;
+  // SFML ne permet pas de libérer une RenderTexture sans la détruire : on la
+  // ramène à une taille minimale
+  m_texture.create(1, 1);
+  m_nWidth = m_nHeight = m_nCapacityX = m_nCapacityY = 0;
+  m_bShrinkPending = false;
+}
+
+// Permet d'enregistrer ou de rejouer une session sans modifier le programme
+void CLibGraph2::ApplyEnvironment() {
+  m_eventLog.ApplyEnvironment();
+  if (const char *pszStream = getenv("LIBGRAPH2_STREAM"))
+    startFrameServer(pszStream);
+}
+
+// Attend un événement sur l'ensemble des fenêtres. Les fenêtres sont
+// examinées à tour de rôle pour qu'aucune ne soit affamée : d'abord les
+// journaux rejoués et les événements en attente (fenêtre et serveur
+// d'images), puis un rafraîchissement.
+CLibGraph2 *CLibGraph2::WaitForAnyEvent(evt &e) {
+  CTraceScope trace("waitForAnyEvent");
+  std::vector<CLibGraph2 *> vWindows = GetWindows();
+  size_t nWindows = vWindows.size();
+  // Seules les entrées lues ci-dessous sont datées avant OnEvent()
+  e.nTimestampUs = 0;
+
+  for (size_t i = 0; i < nWindows; i++) {
+    CLibGraph2 *pWindow = vWindows[(s_nNextWindow + i) % nWindows];
+    if (pWindow->m_eventLog.IsReplaying()) {
+      // Le journal remplace les entrées réelles, comme avec waitForEvent()
+      s_nNextWindow = (s_nNextWindow + i + 1) % nWindows;
+      pWindow->waitForEvent(e);
+      return pWindow;
+    }
+    // Entrées de la fenêtre puis des clients du serveur d'images
+    if ((pWindow->m_pWindow && pWindow->PollEvent(e)) ||
+        pWindow->PollServerEvent(e)) {
+      pWindow->m_eventLog.Record(e);
+      pWindow->m_overlay.OnEvent(e);
+      pWindow->m_frameTimes.OnEvent(e);
+      return pWindow;
+    }
+  }
+
+  for (size_t i = 0; i < nWindows; i++) {
+    CLibGraph2 *pWindow = vWindows[(s_nNextWindow + i) % nWindows];
+    if (pWindow->IsOffscreen() ||
+        (pWindow->m_pWindow && pWindow->m_pWindow->isOpen())) {
+      s_nNextWindow = (s_nNextWindow + i + 1) % nWindows;
+      pWindow->RefreshEvent(e);
+      pWindow->m_eventLog.Record(e);
+      pWindow->m_overlay.OnEvent(e);
+      pWindow->m_frameTimes.OnEvent(e);
+      return pWindow;
+    }
+  }
+
+  return NULL;
 }
 
 // Constructeur
 CLibGraph2::CLibGraph2()
-    : m_pWindow(NULL), m_outlineColor(sf::Color::Black),
+    : m_pResources(NULL), m_pWindow(NULL), m_pTarget(NULL),
+      m_penColor(MakeARGB(255, 0, 0, 0)),
+      m_fPenThickness(1.0f), m_brushColor(0),
+      m_outlineColor(sf::Color::Black),
       m_outlineThickness(1.0f), m_fillColor(sf::Color::Transparent),
-      m_penStyle(pen_DashStyles::Solid), m_fontSize(10.0f),
+      m_penStyle(pen_DashStyles::Solid), m_pFont(NULL), m_fontSize(10.0f),
       m_fontStyle(FontStyleRegular), m_nNormalisedSizeX(0),
       m_nNormalisedSizeY(0), m_dScale(1.0), m_nOffsetX(0), m_nOffsetY(0),
-      m_bBackBuffered(false) {
+      m_bBackBuffered(false), m_nFrames(0), m_nMaxFrames(0), m_nVideoSlot(-1),
+      m_nFramesInFlight(0), m_bGpuTimer(false) {
+  m_pResources = CSharedResources::Acquire();
+  m_endRenderFrame = [this] {
+    m_stats.Render().nTextureBytes = m_pResources->GetTextureBytes();
+    m_stats.Render().dGpuMs = m_gpuTimer.GetLastMs();
+    m_stats.EndRenderFrame();
+  };
+  m_trimBackBuffer = [this] {
+    if (m_backBuffer.IsAllocated())
+      m_backBuffer.Reserve(m_backBuffer.getWidth(), m_backBuffer.getHeight());
+  };
+
   // Charger une police par défaut
   std::string defaultFont = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
   FILE *f = fopen(defaultFont.c_str(), "r");
   if (f) {
     fclose(f);
-    if (!m_font.loadFromFile(defaultFont))
-      std::cerr << "Warning: SFML failed to load existing font: " << defaultFont
-                << std::endl;
+    if (!(m_pFont = m_pResources->GetFont(defaultFont)))
+      std::cerr << "LibGraph2 : SFML n'a pas pu charger la police "
+                << defaultFont << std::endl;
   } else {
-    std::cerr << "Warning: Default font not found at " << defaultFont
+    std::cerr << "LibGraph2 : police par défaut introuvable : " << defaultFont
               << std::endl;
   }
 
   // Initialiser les couleurs par défaut
   setPen(MakeARGB(255, 0, 0, 0), 1.0f);
   setSolidBrush(0);
+
+  // Nombre de rafraîchissements avant fermeture
+  if (const char *pszFrames = getenv("LIBGRAPH2_FRAMES"))
+    m_nMaxFrames = strtoul(pszFrames, NULL, 10);
 }
 
 // Destructeur
+// Appelé avec le verrou de la liste des fenêtres
 CLibGraph2::~CLibGraph2() {
-  s_pInstance = NULL;
+  stopVideoOutput();
+  stopFrameServer();
+  if (m_pTarget)
+    RunOnRenderThread([this] { FlushReadbacks(); });
+  StopRenderThread();
+  for (CRecorder *pRec : m_vRecorders)
+    delete pRec;
   if (m_pWindow) {
     m_pWindow->close();
     delete m_pWindow;
   }
+  CSharedResources::Release();
 }
 
 // Fonctions privées
 int CLibGraph2::getPixelWidth() {
   if (m_pWindow)
     return m_pWindow->getSize().x;
+  if (IsOffscreen())
+    return m_backBuffer.getWidth();
   return 0;
 }
 
 int CLibGraph2::getPixelHeight() {
   if (m_pWindow)
     return m_pWindow->getSize().y;
+  if (IsOffscreen())
+    return m_backBuffer.getHeight();
   return 0;
 }
 
@@ -120,34 +339,88 @@ bool CLibGraph2::NeedToFill() { return m_fillColor.a > 0; }
 
 // Implémentation des fonctions publiques
 
-void CLibGraph2::show(const CSize &szWndSize, bool bFullScreen) {
-  int width = (int)szWndSize.m_fWidth;
-  int height = (int)szWndSize.m_fHeight;
+void CLibGraph2::SetNormalisedSize(const CSize &szWndSize, int &nWidth,
+                                   int &nHeight) {
+  nWidth = (int)szWndSize.m_fWidth;
+  nHeight = (int)szWndSize.m_fHeight;
 
   if (szWndSize.m_fWidth * szWndSize.m_fHeight <= 1) {
     m_nNormalisedSizeX = 0;
     m_nNormalisedSizeY = 0;
-    width = 800;
-    height = 600;
+    nWidth = 800;
+    nHeight = 600;
   } else {
-    m_nNormalisedSizeX = width;
-    m_nNormalisedSizeY = height;
+    m_nNormalisedSizeX = nWidth;
+    m_nNormalisedSizeY = nHeight;
   }
+}
+
+void CLibGraph2::show(const CSize &szWndSize, bool bFullScreen) {
+  CTraceScope trace("show");
+  int width, height;
+  SetNormalisedSize(szWndSize, width, height);
 
   sf::Uint32 style = bFullScreen ? sf::Style::Fullscreen : sf::Style::Default;
 
+  // Le thread de rendu ne doit pas survivre à la fenêtre qu'il utilise
+  bool bThreaded = IsThreaded();
+  StopRenderThread();
+
   if (m_pWindow) {
     delete m_pWindow;
   }
 
   m_pWindow =
       new sf::RenderWindow(sf::VideoMode(width, height), LG_WINDOWTITLE, style);
-  m_pWindow->setVerticalSyncEnabled(true);
+  // LIBGRAPH2_VSYNC=0 désactive la synchronisation verticale (bancs
+  // d'essai)
+  const char *szVSync = getenv("LIBGRAPH2_VSYNC");
+  m_pWindow->setVerticalSyncEnabled(!szVSync || strcmp(szVSync, "0") != 0);
+  m_pTarget = m_pWindow;
+  // Le backbuffer ne sert plus s'il était utilisé hors écran
+  m_backBuffer.Release();
+  m_nFrames = 0;
 
   ComputeScaleAndOffset();
+
+  if (bThreaded)
+    StartRenderThread();
+}
+
+void CLibGraph2::showOffscreen(const CSize &szSize, unsigned long nFrames) {
+  CTraceScope trace("showOffscreen");
+  int width, height;
+  SetNormalisedSize(szSize, width, height);
+
+  bool bThreaded = IsThreaded();
+  StopRenderThread();
+
+  if (m_pWindow) {
+    delete m_pWindow;
+    m_pWindow = NULL;
+  }
+
+  // Le backbuffer devient la cible du dessin, sans synchronisation verticale
+  m_pTarget = NULL;
+  if (!m_backBuffer.Reserve(width, height)) {
+    std::cerr << "LibGraph2 : impossible de créer la cible hors écran"
+              << std::endl;
+    return;
+  }
+  m_pTarget = &m_backBuffer.getTarget();
+  m_nFrames = 0;
+  // Sans nombre d'images, celui de LIBGRAPH2_FRAMES est conservé
+  if (nFrames != 0)
+    m_nMaxFrames = nFrames;
+
+  ComputeScaleAndOffset();
+
+  if (bThreaded)
+    StartRenderThread();
 }
 
 void CLibGraph2::hide() {
+  CTraceScope trace("hide");
   if (m_pWindow)
     m_pWindow->setVisible(false);
 }
@@ -183,26 +456,255 @@ void CLibGraph2::askForRefresh() {
   // Sera géré dans waitForEvent
 }
 
-void CLibGraph2::beginPaint() { m_bBackBuffered = true; }
+void CLibGraph2::beginPaint() {
+  CTraceScope trace("beginPaint");
+  LIBGRAPH2_PROBE0(frame__begin);
+  m_bBackBuffered = true;
+  // Laisse expirer le délai de réduction du backbuffer une fois la taille
+  // stabilisée, dans le thread qui le possède, sans attendre celui-ci
+  if (IsThreaded()) {
+    SCmdCall c = {&m_trimBackBuffer};
+    m_pRing->push(cmd_op::Call, &c, sizeof c);
+  } else {
+    m_trimBackBuffer();
+  }
+  // La transformation est figée pour toute la séquence de dessin : les
+  // enregistreurs peuvent la lire sans verrou depuis leurs threads
+  for (CRecorder *pRec : m_vRecorders)
+    pRec->SetTransform(m_dScale, m_nOffsetX, m_nOffsetY);
+}
 
 void CLibGraph2::endPaint() {
+  CTraceScope trace("endPaint");
   m_bBackBuffered = false;
-  if (m_pWindow)
-    m_pWindow->display();
+  if (m_pTarget) {
+    {
+      CStatsScope scope(m_stats.App().dDisplayMs);
+      MergeRecorders();
+      Present();
+    }
+    EndFrameStats();
+    m_overlay.AddFrame(m_frameTimes.OnEndPaint(), m_stats.Get());
+  }
+}
+
+// Enregistreurs de commandes
+
+ILibGraph2Recorder *CLibGraph2::createRecorder() {
+  CRecorder *pRec = new CRecorder;
+  pRec->SetTransform(m_dScale, m_nOffsetX, m_nOffsetY);
+  m_vRecorders.push_back(pRec);
+  return pRec;
+}
+
+void CLibGraph2::releaseRecorder(ILibGraph2Recorder *pRecorder) {
+  auto it = std::find(m_vRecorders.begin(), m_vRecorders.end(), pRecorder);
+  if (it == m_vRecorders.end())
+    return;
+  delete *it;
+  m_vRecorders.erase(it);
+}
+
+void CLibGraph2::MergeRecorders() {
+  CTraceScope trace("MergeRecorders");
+  // Les commandes enregistrées sont exécutées ou soumises ici : c'est du
+  // dessin
+  CStatsScope scope(m_stats.App().dDrawMs);
+  bool bMerged = false;
+  for (CRecorder *pRec : m_vRecorders) {
+    if (pRec->HasDrawing()) {
+      if (IsThreaded())
+        m_pRing->push(pRec->buffer());
+      else
+        pRec->buffer().forEach([this](cmd_op op, const uint8_t *p, size_t n) {
+          DispatchCommand(*this, op, p, n);
+        });
+      bMerged = true;
+    }
+    pRec->Reset();
+  }
+
+  // Les enregistreurs ont modifié le crayon et le pinceau de la fenêtre
+  if (bMerged) {
+    SCmdSetPen pen = {m_penColor, m_fPenThickness};
+    SCmdSetBrush brush = {m_brushColor};
+    if (IsThreaded()) {
+      m_pRing->push(cmd_op::SetPen, &pen, sizeof pen);
+      m_pRing->push(cmd_op::SetBrush, &brush, sizeof brush);
+    } else {
+      CmdSetPen(pen.color, pen.fThickness);
+      CmdSetBrush(brush.color);
+    }
+  }
+}
+
+// Mode threadé
+
+void CLibGraph2::enableRenderThread(bool bEnable) {
+  if (bEnable == IsThreaded())
+    return;
+  if (bEnable)
+    StartRenderThread();
+  else
+    StopRenderThread();
+}
+
+void CLibGraph2::StartRenderThread() {
+  if (!m_pTarget || IsThreaded())
+    return;
+
+  // Le contexte OpenGL de la cible ne peut être actif que dans un seul
+  // thread : on le libère ici pour que le thread de rendu l'active
+  m_pTarget->setActive(false);
+  m_nFramesInFlight = 0;
+  m_pRing.reset(new CCommandRing);
+  m_renderThread = std::thread(&CLibGraph2::RenderThreadProc, this);
+}
+
+void CLibGraph2::StopRenderThread() {
+  if (!IsThreaded())
+    return;
+
+  m_pRing->push(cmd_op::Quit, nullptr, 0);
+  m_renderThread.join();
+  m_pRing.reset();
+  if (m_pTarget)
+    m_pTarget->setActive(true);
+}
+
+void CLibGraph2::RenderThreadProc() {
+  CTracer::SetThreadName("rendu");
+  m_pTarget->setActive(true);
+  for (;;) {
+    m_pRing->waitForData();
+    CTraceScope trace("ExecuteCommands");
+    while (const SCmdHeader *pHdr = m_pRing->peek()) {
+      if (pHdr->op == cmd_op::Quit) {
+        m_pRing->pop(pHdr);
+        m_pTarget->setActive(false);
+        return;
+      }
+      size_t nSize;
+      const uint8_t *p = CCommandRing::payload(pHdr, nSize);
+      if (pHdr->op == cmd_op::Call)
+        (*reinterpret_cast<const SCmdCall *>(p)->pFunction)();
+      else
+        DispatchCommand(*this, pHdr->op, p, nSize);
+      m_pRing->pop(pHdr);
+    }
+  }
+}
+
+// Exécute f avec le contexte OpenGL de la cible : dans le thread de rendu,
+// après les commandes déjà publiées, en mode threadé ; directement sinon
+void CLibGraph2::RunOnRenderThread(const std::function<void()> &f) {
+  if (!IsThreaded()) {
+    f();
+    return;
+  }
+  SCmdCall c = {&f};
+  m_pRing->push(cmd_op::Call, &c, sizeof c);
+  m_pRing->drain();
+}
+
+// Attend que le thread de rendu ait exécuté toutes les commandes publiées,
+// avant d'accéder depuis le thread applicatif à un état qu'il possède
+void CLibGraph2::SyncRenderThread() {
+  if (IsThreaded())
+    m_pRing->drain();
+}
+
+void CLibGraph2::Clear(ARGB color) {
+  SCmdColor c = {color};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Clear, &c, sizeof c);
+  else
+    CmdClear(color);
+}
+
+void CLibGraph2::Present() {
+  CTraceScope trace("Present");
+  CStatsScope scope(m_stats.App().dDisplayMs);
+  m_stats.App().nDisplays++;
+  m_frameTimes.OnPresent();
+  if (!IsThreaded()) {
+    CmdDisplay();
+    return;
+  }
+
+  // Ne bloquer que si le thread de rendu a trop d'images de retard, jusqu'à
+  // ce que CmdDisplay() en termine une
+  {
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    m_nFramesInFlight++;
+  }
+  m_pRing->push(cmd_op::Display, nullptr, 0);
+  std::unique_lock<std::mutex> lock(m_frameMutex);
+  if (m_nFramesInFlight > MAX_FRAMES_IN_FLIGHT) {
+    CTraceScope trace("waitForRenderThread");
+    m_frameCond.wait(lock, [this] {
+      return m_nFramesInFlight <= MAX_FRAMES_IN_FLIGHT;
+    });
+  }
+}
+
+void CLibGraph2::EndFrameStats() {
+  if (IsThreaded()) {
+    SCmdCall c = {&m_endRenderFrame};
+    m_pRing->push(cmd_op::Call, &c, sizeof c);
+  } else {
+    m_endRenderFrame();
+  }
+  m_stats.EndAppFrame();
+}
+
+bool CLibGraph2::Cull(bool bVisible, float fMinX, float fMinY, float fMaxX,
+                      float fMaxY, float fMargin) {
+  // Zone visible de la cible, dans les coordonnées de dessin
+  const sf::View &view = m_pTarget->getView();
+  float fLeft = view.getCenter().x - view.getSize().x / 2;
+  float fTop = view.getCenter().y - view.getSize().y / 2;
+  if (bVisible &&
+      !IsOutsideTarget(fMinX - fLeft, fMinY - fTop, fMaxX - fLeft,
+                       fMaxY - fTop, fMargin, (unsigned)view.getSize().x,
+                       (unsigned)view.getSize().y))
+    return false;
+  m_stats.Render().nCulled++;
+  return true;
+}
+
+// Comme sf::Shape::draw() : un éventail pour l'intérieur, une bande pour le
+// contour s'il a une épaisseur
+void CLibGraph2::CountShape(const sf::Shape &shape) {
+  unsigned long nPoints = shape.getPointCount();
+  CountDraw(nPoints + 2);
+  if (m_outlineThickness != 0)
+    CountDraw(2 * (nPoints + 1));
 }
 
 // Fonctions de dessin
 
 void CLibGraph2::setPen(ARGB color, float fWidth, pen_DashStyles style) {
-  m_outlineColor =
-      sf::Color(GetR(color), GetG(color), GetB(color), GetA(color));
-  m_outlineThickness = fWidth * m_dScale;
+  CTraceScope trace("setPen");
+  SCmdSetPen c = {color, (float)(fWidth * m_dScale)};
+  m_penColor = c.color;
+  m_fPenThickness = c.fThickness;
   m_penStyle = style;
   // Note: SFML ne supporte pas nativement les styles pointillés
+  if (IsThreaded())
+    m_pRing->push(cmd_op::SetPen, &c, sizeof c);
+  else
+    CmdSetPen(c.color, c.fThickness);
 }
 
 void CLibGraph2::setSolidBrush(ARGB color) {
-  m_fillColor = sf::Color(GetR(color), GetG(color), GetB(color), GetA(color));
+  CTraceScope trace("setSolidBrush");
+  SCmdSetBrush c = {color};
+  m_brushColor = color;
+  if (IsThreaded())
+    m_pRing->push(cmd_op::SetBrush, &c, sizeof c);
+  else
+    CmdSetBrush(color);
 }
 
 void CLibGraph2::setTextureBrush(const CString &sFileName) {
@@ -211,68 +713,58 @@ void CLibGraph2::setTextureBrush(const CString &sFileName) {
 }
 
 void CLibGraph2::drawLine(const CPoint &ptP1, const CPoint &ptP2) {
-  if (!m_pWindow)
+  CTraceScope trace("drawLine");
+  if (!m_pTarget)
     return;
 
-  sf::VertexArray line(sf::Lines, 2);
-
-  line[0].position =
-      sf::Vector2f(UnmapCoordinateX(ptP1.m_fX), UnmapCoordinateY(ptP1.m_fY));
-  line[0].color = m_outlineColor;
-
-  line[1].position =
-      sf::Vector2f(UnmapCoordinateX(ptP2.m_fX), UnmapCoordinateY(ptP2.m_fY));
-  line[1].color = m_outlineColor;
-
-  m_pWindow->draw(line);
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdLine c = {UnmapCoordinateX(ptP1.m_fX), UnmapCoordinateY(ptP1.m_fY),
+                UnmapCoordinateX(ptP2.m_fX), UnmapCoordinateY(ptP2.m_fY)};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Line, &c, sizeof c);
+  else
+    CmdLine(c);
 
   if (!m_bBackBuffered)
-    m_pWindow->display();
+    Present();
 }
 
 void CLibGraph2::drawRectangle(const CRectangle &bounds) {
-  if (!m_pWindow)
+  CTraceScope trace("drawRectangle");
+  if (!m_pTarget)
     return;
 
-  sf::RectangleShape rect;
-
-  rect.setSize(sf::Vector2f(UnmapWidth(bounds.m_szSize.m_fWidth),
-                            UnmapHeight(bounds.m_szSize.m_fHeight)));
-  rect.setPosition(UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
-                   UnmapCoordinateY(bounds.m_ptTopLeft.m_fY));
-
-  rect.setFillColor(m_fillColor);
-  rect.setOutlineColor(m_outlineColor);
-  rect.setOutlineThickness(m_outlineThickness);
-
-  m_pWindow->draw(rect);
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdRect c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+                UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+                UnmapWidth(bounds.m_szSize.m_fWidth),
+                UnmapHeight(bounds.m_szSize.m_fHeight)};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Rectangle, &c, sizeof c);
+  else
+    CmdRectangle(c);
 
   if (!m_bBackBuffered)
-    m_pWindow->display();
+    Present();
 }
 
 void CLibGraph2::drawEllipse(const CRectangle &bounds) {
-  if (!m_pWindow)
+  CTraceScope trace("drawEllipse");
+  if (!m_pTarget)
     return;
 
-  sf::CircleShape ellipse;
-
-  float radiusX = UnmapWidth(bounds.m_szSize.m_fWidth) / 2.0f;
-  float radiusY = UnmapHeight(bounds.m_szSize.m_fHeight) / 2.0f;
-
-  ellipse.setRadius(radiusX);
-  ellipse.setScale(1.0f, radiusY / radiusX);
-  ellipse.setPosition(UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
-                      UnmapCoordinateY(bounds.m_ptTopLeft.m_fY));
-
-  ellipse.setFillColor(m_fillColor);
-  ellipse.setOutlineColor(m_outlineColor);
-  ellipse.setOutlineThickness(m_outlineThickness);
-
-  m_pWindow->draw(ellipse);
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdRect c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+                UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+                UnmapWidth(bounds.m_szSize.m_fWidth),
+                UnmapHeight(bounds.m_szSize.m_fHeight)};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Ellipse, &c, sizeof c);
+  else
+    CmdEllipse(c);
 
   if (!m_bBackBuffered)
-    m_pWindow->display();
+    Present();
 }
 
 void CLibGraph2::drawArc(const CRectangle &rectBounds, float startAngle,
@@ -281,144 +773,371 @@ void CLibGraph2::drawArc(const CRectangle &rectBounds, float startAngle,
   // Similaire à drawPie mais sans remplissage et sans lignes vers le centre
 }
 
-void CLibGraph2::drawPie(const CRectangle &rectBounds, float startAngle,
+void CLibGraph2::drawPie(const CRectangle &bounds, float startAngle,
                          float sweepAngle) {
-  drawPieInternal(rectBounds, startAngle, sweepAngle);
+  CTraceScope trace("drawPie");
+  if (!m_pTarget)
+    return;
 
-  if (!m_bBackBuffered && m_pWindow)
-    m_pWindow->display();
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdPie c = {UnmapCoordinateX(bounds.m_ptTopLeft.m_fX),
+               UnmapCoordinateY(bounds.m_ptTopLeft.m_fY),
+               UnmapWidth(bounds.m_szSize.m_fWidth),
+               UnmapHeight(bounds.m_szSize.m_fHeight),
+               startAngle,
+               sweepAngle};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Pie, &c, sizeof c);
+  else
+    CmdPie(c);
+
+  if (!m_bBackBuffered)
+    Present();
 }
 
-void CLibGraph2::drawPieInternal(const CRectangle &bounds, float startAngle,
-                                 float sweepAngle) {
-  if (!m_pWindow)
+void CLibGraph2::drawPolylines(const vector<CPoint> &vPoints, bool bAutoClose) {
+  CTraceScope trace("drawPolylines");
+  if (!m_pTarget)
     return;
 
-  const int segments = 50;
-  sf::VertexArray pie(sf::TriangleFan, segments + 2);
+  CStatsScope scope(m_stats.App().dDrawMs);
+  m_vScratch.resize(vPoints.size() * 2);
+  for (size_t i = 0; i < vPoints.size(); i++) {
+    m_vScratch[2 * i] = UnmapCoordinateX(vPoints[i].m_fX);
+    m_vScratch[2 * i + 1] = UnmapCoordinateY(vPoints[i].m_fY);
+  }
 
-  float centerX = UnmapCoordinateX(bounds.m_ptTopLeft.m_fX +
-                                   bounds.m_szSize.m_fWidth / 2.0f);
-  float centerY = UnmapCoordinateY(bounds.m_ptTopLeft.m_fY +
-                                   bounds.m_szSize.m_fHeight / 2.0f);
-  float radiusX = UnmapWidth(bounds.m_szSize.m_fWidth) / 2.0f;
-  float radiusY = UnmapHeight(bounds.m_szSize.m_fHeight) / 2.0f;
+  if (IsThreaded()) {
+    SCmdPolyline c = {(uint32_t)vPoints.size(), bAutoClose ? 1u : 0u};
+    m_pRing->push(cmd_op::Polyline, &c, sizeof c, m_vScratch.data(),
+                  m_vScratch.size() * sizeof(float));
+  } else {
+    CmdPolyline(m_vScratch.data(), (uint32_t)vPoints.size(), bAutoClose);
+  }
 
-  // Premier point = centre
-  pie[0].position = sf::Vector2f(centerX, centerY);
-  pie[0].color = m_fillColor;
+  if (!m_bBackBuffered)
+    Present();
+}
 
-  // Points sur l'arc
-  float startRad = startAngle * M_PI / 180.0f;
-  float sweepRad = sweepAngle * M_PI / 180.0f;
+void CLibGraph2::setPixel(const CPoint &ptPos, ARGB color) {
+  CTraceScope trace("setPixel");
+  if (!m_pTarget)
+    return;
 
-  for (int i = 0; i <= segments; i++) {
-    float angle = startRad + (sweepRad * i / segments);
-    float x = centerX + radiusX * cos(angle);
-    float y = centerY + radiusY * sin(angle);
+  CStatsScope scope(m_stats.App().dDrawMs);
+  SCmdPixel c = {UnmapCoordinateX(ptPos.m_fX), UnmapCoordinateY(ptPos.m_fY),
+                 color};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Pixel, &c, sizeof c);
+  else
+    CmdPixel(c);
 
-    pie[i + 1].position = sf::Vector2f(x, y);
-    pie[i + 1].color = m_fillColor;
-  }
+  if (!m_bBackBuffered)
+    Present();
+}
 
-  m_pWindow->draw(pie);
+void CLibGraph2::setFont(const CString &strFontName, float fPointSize,
+                         font_styles nStyleFlags) {
+  CTraceScope trace("setFont");
+  CStatsScope scope(m_stats.App().dDrawMs);
+  std::string fontName = std::string(strFontName);
+  SCmdSetFont c = {(float)(fPointSize * m_dScale), (uint32_t)nStyleFlags,
+                   (uint32_t)fontName.size()};
+  // En mode threadé, le chargement depuis le disque se fait dans le thread de
+  // rendu
+  if (IsThreaded())
+    m_pRing->push(cmd_op::SetFont, &c, sizeof c, fontName.data(),
+                  fontName.size());
+  else
+    CmdSetFont(fontName, c.fSize, nStyleFlags);
 }
 
-void CLibGraph2::drawPolylines(const vector<CPoint> &vPoints, bool bAutoClose) {
-  if (!m_pWindow)
+void CLibGraph2::drawString(const CString &text, const CPoint &ptPos) {
+  CTraceScope trace("drawString");
+  if (!m_pTarget)
     return;
 
-  if (bAutoClose) {
-    // Polygone fermé
-    sf::ConvexShape polygon;
-    polygon.setPointCount(vPoints.size());
+  CStatsScope scope(m_stats.App().dDrawMs);
+  const std::wstring &str = *text.operator->();
+  float x = UnmapCoordinateX(ptPos.m_fX);
+  float y = UnmapCoordinateY(ptPos.m_fY);
+  if (IsThreaded()) {
+    SCmdString c = {x, y, (uint32_t)str.size()};
+    m_pRing->push(cmd_op::String, &c, sizeof c, str.data(),
+                  str.size() * sizeof(wchar_t));
+  } else {
+    CmdString(str, x, y);
+  }
 
-    for (size_t i = 0; i < vPoints.size(); i++) {
-      polygon.setPoint(i, sf::Vector2f(UnmapCoordinateX(vPoints[i].m_fX),
-                                       UnmapCoordinateY(vPoints[i].m_fY)));
-    }
+  if (!m_bBackBuffered)
+    Present();
+}
 
-    polygon.setFillColor(m_fillColor);
-    polygon.setOutlineColor(m_outlineColor);
-    polygon.setOutlineThickness(m_outlineThickness);
+void CLibGraph2::getStringDimension(const CString &text, const CPoint &ptPos,
+                                    CRectangle &rectBounds) {
+  CTraceScope trace("getStringDimension");
+  // La police appartient au thread de rendu en mode threadé
+  SyncRenderThread();
+  if (!m_pFont)
+    return;
 
-    m_pWindow->draw(polygon);
-  } else {
-    // Ligne brisée
-    sf::VertexArray lines(sf::LineStrip, vPoints.size());
+  sf::Text sfText;
+  sfText.setFont(*m_pFont);
+  sfText.setString(std::wstring(text));
+  sfText.setCharacterSize(static_cast<unsigned int>(m_fontSize));
 
-    for (size_t i = 0; i < vPoints.size(); i++) {
-      lines[i].position = sf::Vector2f(UnmapCoordinateX(vPoints[i].m_fX),
-                                       UnmapCoordinateY(vPoints[i].m_fY));
-      lines[i].color = m_outlineColor;
-    }
+  sf::FloatRect bounds = sfText.getLocalBounds();
 
-    m_pWindow->draw(lines);
-  }
+  rectBounds.m_ptTopLeft.m_fX = MapCoordinateX(bounds.left);
+  rectBounds.m_ptTopLeft.m_fY = MapCoordinateY(bounds.top);
+  rectBounds.m_szSize.m_fWidth = MapWidth(bounds.width);
+  rectBounds.m_szSize.m_fHeight = MapHeight(bounds.height);
+}
+
+void CLibGraph2::drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                            double dScaleFactor, double dAngleDeg,
+                            bool bXYIsCenter) {
+  CTraceScope trace("drawBitmap");
+  if (!m_pTarget)
+    return;
+
+  CStatsScope scope(m_stats.App().dDrawMs);
+  std::string filename = std::string(sFileName);
+  SCmdBitmap c = {UnmapCoordinateX(ptPos.m_fX),
+                  UnmapCoordinateY(ptPos.m_fY),
+                  0,
+                  0,
+                  (float)(dScaleFactor * m_dScale),
+                  (float)dAngleDeg,
+                  bXYIsCenter ? bitmap_origin::Center : bitmap_origin::TopLeft,
+                  (uint32_t)filename.size()};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Bitmap, &c, sizeof c, filename.data(),
+                  filename.size());
+  else
+    CmdBitmap(filename, c);
 
   if (!m_bBackBuffered)
-    m_pWindow->display();
+    Present();
 }
 
-void CLibGraph2::setPixel(const CPoint &ptPos, ARGB color) {
-  if (!m_pWindow)
+void CLibGraph2::drawBitmap(const CString &sFileName, const CPoint &ptPos,
+                            const CPoint &ptPosPivot, double dScaleFactor,
+                            double dAngleDeg) {
+  CTraceScope trace("drawBitmap");
+  if (!m_pTarget)
     return;
 
-  sf::RectangleShape pixel;
-  pixel.setSize(sf::Vector2f(1, 1));
-  pixel.setPosition(UnmapCoordinateX(ptPos.m_fX), UnmapCoordinateY(ptPos.m_fY));
-  pixel.setFillColor(
-      sf::Color(GetR(color), GetG(color), GetB(color), GetA(color)));
-
-  m_pWindow->draw(pixel);
+  CStatsScope scope(m_stats.App().dDrawMs);
+  std::string filename = std::string(sFileName);
+  SCmdBitmap c = {UnmapCoordinateX(ptPos.m_fX),
+                  UnmapCoordinateY(ptPos.m_fY),
+                  ptPosPivot.m_fX,
+                  ptPosPivot.m_fY,
+                  (float)(dScaleFactor * m_dScale),
+                  (float)dAngleDeg,
+                  bitmap_origin::Pivot,
+                  (uint32_t)filename.size()};
+  if (IsThreaded())
+    m_pRing->push(cmd_op::Bitmap, &c, sizeof c, filename.data(),
+                  filename.size());
+  else
+    CmdBitmap(filename, c);
 
   if (!m_bBackBuffered)
-    m_pWindow->display();
+    Present();
 }
 
-void CLibGraph2::setFont(const CString &strFontName, float fPointSize,
-                         font_styles nStyleFlags) {
-  m_fontSize = fPointSize * m_dScale;
-  m_fontStyle = nStyleFlags;
+// Exécution des commandes (thread de rendu en mode threadé)
+
+void CLibGraph2::CmdSetPen(ARGB color, float fThickness) {
+  m_outlineColor =
+      sf::Color(GetR(color), GetG(color), GetB(color), GetA(color));
+  m_outlineThickness = fThickness;
+}
+
+void CLibGraph2::CmdSetBrush(ARGB color) {
+  m_fillColor = sf::Color(GetR(color), GetG(color), GetB(color), GetA(color));
+}
+
+void CLibGraph2::CmdSetFont(const std::string &fontName, float fSize,
+                            font_styles nStyle) {
+  m_fontSize = fSize;
+  m_fontStyle = nStyle;
 
   // Essayer de charger la police depuis le système
-  std::string fontName = std::string(strFontName);
   std::vector<std::string> paths = {
       "/usr/share/fonts/truetype/" + fontName + ".ttf",
       "/usr/share/fonts/truetype/dejavu/" + fontName + ".ttf",
       "/usr/share/fonts/truetype/liberation/" + fontName + ".ttf",
       "/usr/share/fonts/truetype/freefont/" + fontName + ".ttf"};
 
-  bool loaded = false;
+  const sf::Font *pFont = NULL;
   for (const auto &path : paths) {
     FILE *f = fopen(path.c_str(), "r");
     if (f) {
       fclose(f);
-      if (m_font.loadFromFile(path)) {
-        loaded = true;
+      if ((pFont = m_pResources->GetFont(path, &m_stats.Render())))
         break;
-      }
     }
   }
 
-  if (!loaded) {
+  if (!pFont) {
     // Fallback silencieux vers DejaVuSans si déjà chargé ou tenter le chemin
     // dur
-    m_font.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+    pFont = m_pResources->GetFont(
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", &m_stats.Render());
   }
+  if (pFont)
+    m_pFont = pFont;
 }
 
-void CLibGraph2::drawString(const CString &text, const CPoint &ptPos) {
-  if (!m_pWindow)
+void CLibGraph2::CmdClear(ARGB color) {
+  if (m_gpuTimer.IsCreated() && !m_gpuTimer.IsInSpan())
+    BeginGpuSpan();
+  m_pTarget->clear(
+      sf::Color(GetR(color), GetG(color), GetB(color), GetA(color)));
+}
+
+void CLibGraph2::CmdLine(const SCmdLine &c) {
+  if (Cull(m_outlineColor.a != 0, std::min(c.x1, c.x2), std::min(c.y1, c.y2),
+           std::max(c.x1, c.x2), std::max(c.y1, c.y2), 1))
+    return;
+  CountDraw(2);
+  sf::Vertex line[2] = {sf::Vertex(sf::Vector2f(c.x1, c.y1), m_outlineColor),
+                        sf::Vertex(sf::Vector2f(c.x2, c.y2), m_outlineColor)};
+  m_pTarget->draw(line, 2, sf::Lines);
+}
+
+void CLibGraph2::CmdRectangle(const SCmdRect &c) {
+  sf::RectangleShape rect;
+
+  rect.setSize(sf::Vector2f(c.w, c.h));
+  rect.setPosition(c.x, c.y);
+
+  rect.setFillColor(m_fillColor);
+  rect.setOutlineColor(m_outlineColor);
+  rect.setOutlineThickness(m_outlineThickness);
+
+  if (Cull(IsShapeVisible(), rect.getGlobalBounds()))
+    return;
+  CountShape(rect);
+  m_pTarget->draw(rect);
+}
+
+void CLibGraph2::CmdEllipse(const SCmdRect &c) {
+  sf::CircleShape ellipse;
+
+  float radiusX = c.w / 2.0f;
+  float radiusY = c.h / 2.0f;
+
+  ellipse.setRadius(radiusX);
+  ellipse.setScale(1.0f, radiusY / radiusX);
+  ellipse.setPosition(c.x, c.y);
+
+  ellipse.setFillColor(m_fillColor);
+  ellipse.setOutlineColor(m_outlineColor);
+  ellipse.setOutlineThickness(m_outlineThickness);
+
+  if (Cull(IsShapeVisible(), ellipse.getGlobalBounds()))
+    return;
+  CountShape(ellipse);
+  m_pTarget->draw(ellipse);
+}
+
+void CLibGraph2::CmdPie(const SCmdPie &c) {
+  const int segments = 50;
+  if (Cull(m_fillColor.a != 0, std::min(c.x, c.x + c.w),
+           std::min(c.y, c.y + c.h), std::max(c.x, c.x + c.w),
+           std::max(c.y, c.y + c.h), 0))
+    return;
+  sf::Vertex pie[segments + 2];
+
+  float centerX = c.x + c.w / 2.0f;
+  float centerY = c.y + c.h / 2.0f;
+  float radiusX = c.w / 2.0f;
+  float radiusY = c.h / 2.0f;
+
+  // Premier point = centre
+  pie[0] = sf::Vertex(sf::Vector2f(centerX, centerY), m_fillColor);
+
+  // Points sur l'arc
+  float startRad = c.fStartAngle * M_PI / 180.0f;
+  float sweepRad = c.fSweepAngle * M_PI / 180.0f;
+
+  for (int i = 0; i <= segments; i++) {
+    float angle = startRad + (sweepRad * i / segments);
+    float x = centerX + radiusX * cos(angle);
+    float y = centerY + radiusY * sin(angle);
+
+    pie[i + 1] = sf::Vertex(sf::Vector2f(x, y), m_fillColor);
+  }
+
+  CountDraw(segments + 2);
+  m_pTarget->draw(pie, segments + 2, sf::TriangleFan);
+}
+
+void CLibGraph2::CmdPolyline(const float *pCoords, uint32_t nCount,
+                             bool bAutoClose) {
+  if (bAutoClose) {
+    // Polygone fermé
+    sf::ConvexShape polygon;
+    polygon.setPointCount(nCount);
+
+    for (uint32_t i = 0; i < nCount; i++)
+      polygon.setPoint(i, sf::Vector2f(pCoords[2 * i], pCoords[2 * i + 1]));
+
+    polygon.setFillColor(m_fillColor);
+    polygon.setOutlineColor(m_outlineColor);
+    polygon.setOutlineThickness(m_outlineThickness);
+
+    if (Cull(IsShapeVisible(), polygon.getGlobalBounds()))
+      return;
+    CountShape(polygon);
+    m_pTarget->draw(polygon);
+  } else {
+    // Ligne brisée
+    sf::VertexArray lines(sf::LineStrip, nCount);
+
+    for (uint32_t i = 0; i < nCount; i++) {
+      lines[i].position = sf::Vector2f(pCoords[2 * i], pCoords[2 * i + 1]);
+      lines[i].color = m_outlineColor;
+    }
+
+    if (Cull(m_outlineColor.a != 0, lines.getBounds(), 1))
+      return;
+    CountDraw(nCount);
+    m_pTarget->draw(lines);
+  }
+}
+
+void CLibGraph2::CmdPixel(const SCmdPixel &c) {
+  sf::RectangleShape pixel;
+  pixel.setSize(sf::Vector2f(1, 1));
+  pixel.setPosition(c.x, c.y);
+  pixel.setFillColor(sf::Color(GetR(c.color), GetG(c.color), GetB(c.color),
+                               GetA(c.color)));
+
+  if (Cull(GetA(c.color) != 0, c.x, c.y, c.x + 1, c.y + 1, 0))
+    return;
+  CountDraw(6);
+  m_pTarget->draw(pixel);
+}
+
+void CLibGraph2::CmdString(const std::wstring &text, float x, float y) {
+  if (!m_pFont)
+    return;
+  // Le texte s'étend à droite et en dessous de la position, à l'italique
+  // près
+  if (Cull(m_fillColor.a != 0, x, y, INFINITY, INFINITY, m_fontSize))
     return;
 
   sf::Text sfText;
-  sfText.setFont(m_font);
-  sfText.setString(std::wstring(text));
+  sfText.setFont(*m_pFont);
+  sfText.setString(text);
   sfText.setCharacterSize(static_cast<unsigned int>(m_fontSize));
   sfText.setFillColor(m_fillColor);
-  sfText.setPosition(UnmapCoordinateX(ptPos.m_fX),
-                     UnmapCoordinateY(ptPos.m_fY));
+  sfText.setPosition(x, y);
 
   // Appliquer le style
   sf::Uint32 style = sf::Text::Regular;
@@ -428,93 +1147,440 @@ void CLibGraph2::drawString(const CString &text, const CPoint &ptPos) {
     style |= sf::Text::Italic;
   sfText.setStyle(style);
 
-  m_pWindow->draw(sfText);
+  // Deux triangles par caractère
+  CountDraw(6 * text.size());
+  m_pTarget->draw(sfText);
+}
 
-  if (!m_bBackBuffered)
+void CLibGraph2::CmdBitmap(const std::string &filename, const SCmdBitmap &c) {
+  // Charger ou récupérer la texture du cache partagé
+  const sf::Texture *pTexture =
+      m_pResources->GetTexture(filename, &m_stats.Render());
+  if (!pTexture)
+    return; // Erreur de chargement
+
+  sf::Sprite sprite;
+  sprite.setTexture(*pTexture);
+
+  // Transformations
+  if (c.origin == bitmap_origin::Center) {
+    sf::FloatRect bounds = sprite.getLocalBounds();
+    sprite.setOrigin(bounds.width / 2.0f, bounds.height / 2.0f);
+  } else if (c.origin == bitmap_origin::Pivot) {
+    sprite.setOrigin(c.fPivotX, c.fPivotY);
+  }
+
+  sprite.setPosition(c.x, c.y);
+  sprite.setScale(c.fScale, c.fScale);
+  sprite.setRotation(c.fAngle);
+
+  if (Cull(true, sprite.getGlobalBounds()))
+    return;
+  CountDraw(4);
+  m_pTarget->draw(sprite);
+}
+
+void CLibGraph2::CmdDisplay() {
+  CTraceScope trace("CmdDisplay");
+  if (m_pVideo || m_pServer)
+    CaptureVideoFrame();
+  ServiceReadbacks();
+  if (m_gpuTimer.IsCreated()) {
+    // La requête a été lancée dans le contexte de la cible : un chargement
+    // de texture a pu en activer un autre
+    m_pTarget->setActive(true);
+    m_gpuTimer.EndSpan();
+    m_gpuTimer.EndFrame();
+  }
+  if (m_pWindow)
+    DrawOverlay();
+  CTraceScope swap("swapBuffers");
+  CProbeClock probe;
+  if (m_pWindow)
     m_pWindow->display();
+  else
+    m_backBuffer.getTarget().display();
+  LIBGRAPH2_PROBE1(display, probe.ElapsedUs());
+  // La mesure de l'image suivante commence à sa première commande : l'attente
+  // de l'application entre deux images n'en fait pas partie
+  UpdateGpuTimer();
+  m_frameTimes.OnDisplayed();
+  if (IsThreaded()) {
+    {
+      std::lock_guard<std::mutex> lock(m_frameMutex);
+      m_nFramesInFlight--;
+    }
+    m_frameCond.notify_one();
+  }
 }
 
-void CLibGraph2::getStringDimension(const CString &text, const CPoint &ptPos,
-                                    CRectangle &rectBounds) {
-  sf::Text sfText;
-  sfText.setFont(m_font);
-  sfText.setString(std::wstring(text));
-  sfText.setCharacterSize(static_cast<unsigned int>(m_fontSize));
+// Dessinée après les captures, juste avant l'échange des tampons : elle
+// n'apparaît que dans la fenêtre
+void CLibGraph2::DrawOverlay() {
+  if (!m_overlay.GetQuads(m_vOverlayQuads))
+    return;
+  CTraceScope trace("DrawOverlay");
+  if (m_overlayTexture.getSize().x == 0) {
+    // Glyphes blancs, la couverture dans l'alpha
+    const unsigned nTexels =
+        CPerfOverlay::ATLAS_WIDTH * CPerfOverlay::ATLAS_HEIGHT;
+    const uint8_t *pAtlas = CPerfOverlay::GetAtlas();
+    std::vector<sf::Uint8> vRGBA(4 * nTexels, 255);
+    for (unsigned i = 0; i < nTexels; i++)
+      vRGBA[4 * i + 3] = pAtlas[i];
+    if (!m_overlayTexture.create(CPerfOverlay::ATLAS_WIDTH,
+                                 CPerfOverlay::ATLAS_HEIGHT))
+      return;
+    m_overlayTexture.update(vRGBA.data());
+  }
 
-  sf::FloatRect bounds = sfText.getLocalBounds();
+  // Un seul lot de triangles, qui n'entre pas dans les compteurs affichés
+  m_overlayVertices.setPrimitiveType(sf::Triangles);
+  m_overlayVertices.clear();
+  for (const CPerfOverlay::SQuad &q : m_vOverlayQuads) {
+    sf::Color color(GetR(q.color), GetG(q.color), GetB(q.color),
+                    GetA(q.color));
+    sf::Vertex a(sf::Vector2f(q.x0, q.y0), color, sf::Vector2f(q.u0, q.v0));
+    sf::Vertex b(sf::Vector2f(q.x1, q.y0), color, sf::Vector2f(q.u1, q.v0));
+    sf::Vertex c(sf::Vector2f(q.x1, q.y1), color, sf::Vector2f(q.u1, q.v1));
+    sf::Vertex d(sf::Vector2f(q.x0, q.y1), color, sf::Vector2f(q.u0, q.v1));
+    m_overlayVertices.append(a);
+    m_overlayVertices.append(b);
+    m_overlayVertices.append(c);
+    m_overlayVertices.append(a);
+    m_overlayVertices.append(c);
+    m_overlayVertices.append(d);
+  }
 
-  rectBounds.m_ptTopLeft.m_fX = MapCoordinateX(bounds.left);
-  rectBounds.m_ptTopLeft.m_fY = MapCoordinateY(bounds.top);
-  rectBounds.m_szSize.m_fWidth = MapWidth(bounds.width);
-  rectBounds.m_szSize.m_fHeight = MapHeight(bounds.height);
+  // En pixels de la fenêtre, quelle que soit la vue courante
+  sf::View view = m_pWindow->getView();
+  m_pWindow->setView(m_pWindow->getDefaultView());
+  m_pWindow->draw(m_overlayVertices, sf::RenderStates(&m_overlayTexture));
+  m_pWindow->setView(view);
 }
 
-void CLibGraph2::drawBitmap(const CString &sFileName, const CPoint &ptPos,
-                            double dScaleFactor, double dAngleDeg,
-                            bool bXYIsCenter) {
-  if (!m_pWindow)
+void CLibGraph2::CmdCapture(sf::Image *pImage) {
+  unsigned nWidth = getPixelWidth(), nHeight = getPixelHeight();
+  if (m_pWindow) {
+    sf::Texture texture;
+    if (texture.create(nWidth, nHeight)) {
+      texture.update(*m_pWindow);
+      *pImage = texture.copyToImage();
+    }
+  } else {
+    // Seule la zone utile, en haut à gauche de la texture, est copiée
+    sf::Image full = m_backBuffer.getTarget().getTexture().copyToImage();
+    pImage->create(nWidth, nHeight);
+    pImage->copy(full, 0, 0, m_backBuffer.getRect());
+  }
+}
+
+// Lecture de l'image courante
+
+bool CLibGraph2::CaptureFrame(sf::Image &image) {
+  if (!m_pTarget)
+    return false;
+
+  RunOnRenderThread([&] { CmdCapture(&image); });
+  return image.getSize().x != 0;
+}
+
+// Points d'entrée OpenGL du contexte SFML actif
+static GLProc GetGLFunction(const char *pszName) {
+  return reinterpret_cast<GLProc>(sf::Context::getFunction(pszName));
+}
+
+// Sortie vidéo
+
+void CLibGraph2::CaptureVideoFrame() {
+  CTraceScope trace("CaptureVideoFrame");
+  unsigned nWidth = getPixelWidth(), nHeight = getPixelHeight();
+  if (nWidth == 0 || nHeight == 0)
     return;
+  // La zone utile du backbuffer est en haut de la texture, donc en haut du
+  // repère OpenGL dont l'origine est en bas à gauche
+  int y = m_pWindow ? 0 : (int)(m_backBuffer.getCapacityHeight() - nHeight);
 
-  std::string filename = std::string(sFileName);
+  m_pTarget->setActive(true);
+  if (!m_gl.Load(GetGLFunction))
+    return;
+  if (!m_videoReadback.IsCreated() && m_gl.bPixelBuffers)
+    m_videoReadback.Create(&m_gl, 2);
+
+  if (!m_videoReadback.IsCreated()) {
+    // Pas de PBO : lecture synchrone
+    m_vVideoPixels.resize((size_t)nWidth * nHeight);
+    glReadPixels(0, y, nWidth, nHeight, GL_BGRA, GL_UNSIGNED_BYTE,
+                 m_vVideoPixels.data());
+    SubmitCapturedFrame(m_vVideoPixels.data(), nWidth, nHeight);
+    return;
+  }
 
-  // Charger ou récupérer la texture du cache
-  if (m_textureCache.find(filename) == m_textureCache.end()) {
-    sf::Texture texture;
-    if (!texture.loadFromFile(filename))
-      return; // Erreur de chargement
-    m_textureCache[filename] = texture;
+  // Lance la lecture de cette image, puis transmet la précédente, dont la
+  // copie a eu le temps de se terminer pendant l'image écoulée
+  int nPrevious = m_nVideoSlot;
+  m_nVideoSlot = m_videoReadback.Issue(0, y, nWidth, nHeight);
+  if (nPrevious >= 0) {
+    unsigned nPrevWidth, nPrevHeight;
+    if (const uint32_t *p =
+            m_videoReadback.Map(nPrevious, nPrevWidth, nPrevHeight))
+      SubmitCapturedFrame(p, nPrevWidth, nPrevHeight);
+    m_videoReadback.Unmap(nPrevious);
   }
+}
 
-  sf::Sprite sprite;
-  sprite.setTexture(m_textureCache[filename]);
+// Lignes de bas en haut (repère OpenGL)
+void CLibGraph2::SubmitCapturedFrame(const uint32_t *pPixels, unsigned nWidth,
+                                     unsigned nHeight) {
+  if (m_pVideo)
+    m_pVideo->SubmitFrame(pPixels, nWidth, nHeight, true);
+  if (m_pServer)
+    m_pServer->SubmitFrame(pPixels, nWidth, nHeight, true);
+}
 
-  // Transformations
-  if (bXYIsCenter) {
-    sf::FloatRect bounds = sprite.getLocalBounds();
-    sprite.setOrigin(bounds.width / 2.0f, bounds.height / 2.0f);
+// Transmet la dernière image en attente et libère les PBO
+void CLibGraph2::FlushVideoFrame() {
+  if (!m_videoReadback.IsCreated())
+    return;
+  m_pTarget->setActive(true);
+  if (m_nVideoSlot >= 0) {
+    unsigned nWidth, nHeight;
+    if (const uint32_t *p = m_videoReadback.Map(m_nVideoSlot, nWidth, nHeight))
+      SubmitCapturedFrame(p, nWidth, nHeight);
+    m_videoReadback.Unmap(m_nVideoSlot);
+    m_nVideoSlot = -1;
   }
+  m_videoReadback.Destroy();
+}
 
-  sprite.setPosition(UnmapCoordinateX(ptPos.m_fX),
-                     UnmapCoordinateY(ptPos.m_fY));
-  sprite.setScale(dScaleFactor * m_dScale, dScaleFactor * m_dScale);
-  sprite.setRotation(dAngleDeg);
+bool CLibGraph2::startVideoOutput(const CString &sFileName,
+                                  video_format format, unsigned nFrameRate) {
+  stopVideoOutput();
 
-  m_pWindow->draw(sprite);
+  std::unique_ptr<CVideoWriter> pVideo(new CVideoWriter);
+  if (!pVideo->Open(std::string(sFileName), format, nFrameRate))
+    return false;
 
-  if (!m_bBackBuffered)
-    m_pWindow->display();
+  // m_pVideo est lu par le thread de rendu
+  SyncRenderThread();
+  m_pVideo = std::move(pVideo);
+  return true;
 }
 
-void CLibGraph2::drawBitmap(const CString &sFileName, const CPoint &ptPos,
-                            const CPoint &ptPosPivot, double dScaleFactor,
-                            double dAngleDeg) {
-  if (!m_pWindow)
+void CLibGraph2::stopVideoOutput() {
+  if (!m_pVideo)
     return;
 
-  std::string filename = std::string(sFileName);
+  if (m_pTarget)
+    RunOnRenderThread([this] { FlushVideoFrame(); });
+  m_pVideo->Close();
+  m_pVideo.reset();
+}
 
-  if (m_textureCache.find(filename) == m_textureCache.end()) {
-    sf::Texture texture;
-    if (!texture.loadFromFile(filename))
-      return;
-    m_textureCache[filename] = texture;
+bool CLibGraph2::startFrameServer(const CString &sAddress) {
+  stopFrameServer();
+
+  std::unique_ptr<CFrameServer> pServer(new CFrameServer);
+  if (!pServer->Open(std::string(sAddress)))
+    return false;
+
+  // m_pServer est lu par le thread de rendu
+  SyncRenderThread();
+  m_pServer = std::move(pServer);
+  return true;
+}
+
+void CLibGraph2::stopFrameServer() {
+  if (!m_pServer)
+    return;
+
+  if (m_pTarget)
+    RunOnRenderThread([this] { FlushVideoFrame(); });
+  m_pServer->Close();
+  m_pServer.reset();
+}
+
+// Lecture asynchrone
+
+void CLibGraph2::requestReadback(const CRectangle &rect,
+                                 const readback_callback &callback) {
+  CTraceScope trace("requestReadback");
+  if (!m_pTarget) {
+    callback(NULL, 0, 0);
+    return;
   }
 
-  sf::Sprite sprite;
-  sprite.setTexture(m_textureCache[filename]);
+  SReadback rb(UnmapCoordinateX(rect.m_ptTopLeft.m_fX),
+               UnmapCoordinateY(rect.m_ptTopLeft.m_fY),
+               UnmapWidth(rect.m_szSize.m_fWidth),
+               UnmapHeight(rect.m_szSize.m_fHeight), callback);
 
-  sprite.setOrigin(ptPosPivot.m_fX, ptPosPivot.m_fY);
-  sprite.setPosition(UnmapCoordinateX(ptPos.m_fX),
-                     UnmapCoordinateY(ptPos.m_fY));
-  sprite.setScale(dScaleFactor * m_dScale, dScaleFactor * m_dScale);
-  sprite.setRotation(dAngleDeg);
+  std::lock_guard<std::mutex> lock(m_readbackMutex);
+  m_vReadbackRequests.push_back(std::move(rb));
+}
 
-  m_pWindow->draw(sprite);
+// Appelée à chaque affichage : termine les lectures dont la copie est
+// achevée, puis lance les nouvelles sur l'image qui va être affichée
+void CLibGraph2::ServiceReadbacks() {
+  CTraceScope trace("ServiceReadbacks");
+  std::vector<SReadback> vNew;
+  {
+    std::lock_guard<std::mutex> lock(m_readbackMutex);
+    vNew.swap(m_vReadbackRequests);
+  }
+  if (vNew.empty() && m_vReadbacks.empty())
+    return;
 
-  if (!m_bBackBuffered)
-    m_pWindow->display();
+  m_pTarget->setActive(true);
+  m_gl.Load(GetGLFunction);
+
+  if (m_readbackPool.IsCreated()) {
+    m_readbackPool.Tick();
+    size_t n = 0;
+    for (size_t i = 0; i < m_vReadbacks.size(); i++) {
+      if (m_readbackPool.IsReady(m_vReadbacks[i].nSlot))
+        CompleteReadback(m_vReadbacks[i]);
+      else if (i != n)
+        m_vReadbacks[n++] = std::move(m_vReadbacks[i]);
+      else
+        n++;
+    }
+    m_vReadbacks.resize(n);
+  } else if (m_gl.bPixelBuffers) {
+    m_readbackPool.Create(&m_gl, READBACK_POOL_SIZE);
+  }
+
+  int nFrameWidth = getPixelWidth(), nFrameHeight = getPixelHeight();
+  // Hauteur du framebuffer, dont l'origine OpenGL est en bas à gauche
+  int nTargetHeight =
+      m_pWindow ? nFrameHeight : (int)m_backBuffer.getCapacityHeight();
+
+  for (size_t i = 0; i < vNew.size(); i++) {
+    SReadback &rb = vNew[i];
+    if (!rb.Clip(nFrameWidth, nFrameHeight)) {
+      rb.callback(NULL, 0, 0);
+      continue;
+    }
+    // Première ligne lue, depuis le bas du framebuffer
+    int nBottom = nTargetHeight - (rb.y + rb.nHeight);
+
+    if (!m_readbackPool.IsCreated()) {
+      // Pas de PBO : lecture synchrone
+      std::vector<uint32_t> vPixels((size_t)rb.nWidth * rb.nHeight);
+      glReadPixels(rb.x, nBottom, rb.nWidth, rb.nHeight, GL_BGRA,
+                   GL_UNSIGNED_BYTE, vPixels.data());
+      DeliverReadback(rb, vPixels.data());
+      continue;
+    }
+
+    rb.nSlot = m_readbackPool.Issue(rb.x, nBottom, rb.nWidth, rb.nHeight);
+    if (rb.nSlot < 0) {
+      // Toutes les lectures du pool sont en cours : les demandes restantes
+      // porteront sur une image suivante
+      std::lock_guard<std::mutex> lock(m_readbackMutex);
+      m_vReadbackRequests.insert(m_vReadbackRequests.begin(),
+                                 std::make_move_iterator(vNew.begin() + i),
+                                 std::make_move_iterator(vNew.end()));
+      break;
+    }
+    m_vReadbacks.push_back(std::move(rb));
+  }
+}
+
+void CLibGraph2::CompleteReadback(SReadback &rb) {
+  unsigned nWidth, nHeight;
+  if (const uint32_t *p = m_readbackPool.Map(rb.nSlot, nWidth, nHeight))
+    DeliverReadback(rb, p);
+  else
+    rb.callback(NULL, 0, 0);
+  m_readbackPool.Unmap(rb.nSlot);
+}
+
+// Remet les lignes lues par OpenGL dans l'ordre de haut en bas
+void CLibGraph2::DeliverReadback(SReadback &rb, const uint32_t *pBottomUp) {
+  size_t nRow = (size_t)rb.nWidth;
+  m_vReadbackPixels.resize(nRow * rb.nHeight);
+  for (int y = 0; y < rb.nHeight; y++)
+    memcpy(&m_vReadbackPixels[y * nRow],
+           pBottomUp + (rb.nHeight - 1 - y) * nRow, nRow * sizeof(uint32_t));
+  rb.callback(m_vReadbackPixels.data(), rb.nWidth, rb.nHeight);
 }
 
+// Termine les lectures en attente (en attendant le GPU) et libère le pool
+void CLibGraph2::FlushReadbacks() {
+  m_pTarget->setActive(true);
+  for (SReadback &rb : m_vReadbacks)
+    CompleteReadback(rb);
+  m_vReadbacks.clear();
+  m_readbackPool.Destroy();
+  m_gpuTimer.Destroy();
+
+  std::lock_guard<std::mutex> lock(m_readbackMutex);
+  for (SReadback &rb : m_vReadbackRequests)
+    rb.callback(NULL, 0, 0);
+  m_vReadbackRequests.clear();
+}
+
+// Crée ou détruit le minutage demandé par enableGpuTimer(). Sans requêtes de
+// minutage, la création échoue à chaque image pour le coût d'un test
+void CLibGraph2::UpdateGpuTimer() {
+  bool bEnable = m_bGpuTimer;
+  if (bEnable == m_gpuTimer.IsCreated())
+    return;
+  m_pTarget->setActive(true);
+  if (!bEnable)
+    m_gpuTimer.Destroy();
+  else if (m_gl.Load(GetGLFunction))
+    m_gpuTimer.Create(&m_gl);
+}
+
+void CLibGraph2::BeginGpuSpan() {
+  // Un chargement de texture a pu activer un autre contexte que celui de la
+  // cible, où la requête doit être lancée
+  m_pTarget->setActive(true);
+  m_gpuTimer.BeginSpan();
+}
+
+// Conversion des pixels RGBA de SFML en ARGB
+static void ImageToARGB(const sf::Image &image, std::vector<ARGB> &vPixels) {
+  const sf::Uint8 *p = image.getPixelsPtr();
+  vPixels.resize((size_t)image.getSize().x * image.getSize().y);
+  for (size_t i = 0; i < vPixels.size(); i++, p += 4)
+    vPixels[i] = MakeARGB(p[3], p[0], p[1], p[2]);
+}
+
+bool CLibGraph2::saveFrame(const CString &sFileName) {
+  CTraceScope trace("saveFrame");
+  sf::Image image;
+  if (!CaptureFrame(image))
+    return false;
+
+  // SFML n'écrit ni PPM ni QOI
+  std::string filename = std::string(sFileName);
+  std::string ext = ImageFileExtension(filename);
+  if (ext == "ppm" || ext == "qoi") {
+    std::vector<ARGB> vPixels;
+    ImageToARGB(image, vPixels);
+    return SaveImageFile(filename, image.getSize().x, image.getSize().y,
+                         vPixels.data());
+  }
+  return image.saveToFile(filename);
+}
+
+bool CLibGraph2::getFramePixels(std::vector<ARGB> &vPixels, unsigned &nWidth,
+                                unsigned &nHeight) {
+  CTraceScope trace("getFramePixels");
+  sf::Image image;
+  if (!CaptureFrame(image))
+    return false;
+
+  nWidth = image.getSize().x;
+  nHeight = image.getSize().y;
+  ImageToARGB(image, vPixels);
+  return true;
+}
+
+
 // Gestion des événements
 
 // Traducteur SFML Key -> Windows Virtual Key / ASCII
@@ -531,6 +1597,10 @@ static unsigned int MapSFMLKeyToWinVK(sf::Keyboard::Key key) {
   if (key >= sf::Keyboard::Numpad0 && key <= sf::Keyboard::Numpad9)
     return 96 + (key - sf::Keyboard::Numpad0);
 
+  // Touches de fonction F1-F12 -> codes VK 112-123
+  if (key >= sf::Keyboard::F1 && key <= sf::Keyboard::F12)
+    return 112 + (key - sf::Keyboard::F1);
+
   // Symboles et touches spéciales selon la table ASCII et les Virtual Keys
   switch (key) {
   // Ponctuation et symboles ASCII
@@ -618,12 +1688,96 @@ static unsigned int MapSFMLKeyToWinVK(sf::Keyboard::Key key) {
 }
 
 bool CLibGraph2::waitForEvent(evt &e) {
-  if (!m_pWindow)
+  CTraceScope trace("waitForEvent");
+  CFrameTimes::CEventScope frameTimes(m_frameTimes, e);
+  if (m_eventLog.IsReplaying())
+    return ReplayEvent(e);
+
+  if (!m_pTarget)
     return false;
 
+  bool bRet;
+  if ((m_pWindow && PollEvent(e)) || PollServerEvent(e)) {
+    bRet = e.type != evt_type::evtClose;
+  } else if (IsOffscreen() || m_pWindow->isOpen()) {
+    // Générer un événement de rafraîchissement
+    RefreshEvent(e);
+    bRet = e.type != evt_type::evtClose;
+  } else {
+    return false;
+  }
+
+  m_eventLog.Record(e);
+  m_overlay.OnEvent(e);
+  return bRet;
+}
+
+bool CLibGraph2::ReplayEvent(evt &e) {
+  // La fenêtre reste réactive mais les entrées réelles sont ignorées
+  sf::Event event;
+  while (m_pWindow && m_pWindow->pollEvent(event))
+    ;
+
+  if (!m_eventLog.Replay(e)) {
+    e.type = evt_type::evtClose;
+    m_lastEvent = e;
+    return false;
+  }
+
+  if (m_pTarget) {
+    if (e.type == evt_type::evtRefresh) {
+      Clear(MakeARGB(255, 255, 255, 255));
+    } else if (e.type == evt_type::evtSize) {
+      if (m_pWindow)
+        m_pWindow->setSize(sf::Vector2u(e.x, e.y));
+      OnResize(e.x, e.y);
+    }
+  }
+
+  m_lastEvent = e;
+  return e.type != evt_type::evtClose;
+}
+
+void CLibGraph2::OnResize(unsigned nWidth, unsigned nHeight) {
+  // Le backbuffer suit la fenêtre, par paliers. Hors écran, il donne la
+  // taille utilisée par ComputeScaleAndOffset() : le thread de rendu doit
+  // l'avoir redimensionné avant ce calcul
+  RunOnRenderThread([&] {
+    if (m_backBuffer.IsAllocated())
+      m_backBuffer.Reserve(nWidth, nHeight);
+  });
+  ComputeScaleAndOffset();
+}
+
+bool CLibGraph2::startEventRecording(const CString &sFileName) {
+  return m_eventLog.StartRecording(std::string(sFileName));
+}
+
+void CLibGraph2::stopEventRecording() { m_eventLog.StopRecording(); }
+
+bool CLibGraph2::startEventReplay(const CString &sFileName, bool bMaxSpeed) {
+  return m_eventLog.StartReplay(std::string(sFileName), bMaxSpeed);
+}
+
+bool CLibGraph2::PollServerEvent(evt &e) {
+  if (!m_pServer || !m_pServer->PollEvent(e))
+    return false;
+  if (e.type == evt_type::evtMouseMove || e.type == evt_type::evtMouseDown ||
+      e.type == evt_type::evtMouseUp) {
+    e.x = (unsigned int)MapCoordinateX((float)e.x);
+    e.y = (unsigned int)MapCoordinateY((float)e.y);
+  }
+  m_lastEvent = e;
+  return true;
+}
+
+bool CLibGraph2::PollEvent(evt &e) {
   sf::Event event;
 
   while (m_pWindow->pollEvent(event)) {
+    // Date de lecture dans la file du système, avant le traitement de
+    // l'application
+    e.nTimestampUs = CFrameTimes::NowUs();
     switch (event.type) {
     case sf::Event::MouseMoved:
       e.type = evt_type::evtMouseMove;
@@ -664,29 +1818,36 @@ bool CLibGraph2::waitForEvent(evt &e) {
       e.type = evt_type::evtSize;
       e.x = event.size.width;
       e.y = event.size.height;
-      ComputeScaleAndOffset();
+      OnResize(event.size.width, event.size.height);
       m_lastEvent = e;
       return true;
 
     case sf::Event::Closed:
       e.type = evt_type::evtClose;
       m_lastEvent = e;
-      return false;
+      return true;
 
     default:
       break;
     }
   }
 
-  // Générer un événement de rafraîchissement
-  if (m_pWindow->isOpen()) {
-    m_pWindow->clear(sf::Color::White);
+  // Aucune entrée : l'événement qui suivra sera daté par OnEvent()
+  e.nTimestampUs = 0;
+  return false;
+}
+
+void CLibGraph2::RefreshEvent(evt &e) {
+  // La fermeture suit la dernière image demandée (LIBGRAPH2_FRAMES ou
+  // showOffscreen())
+  if (m_nMaxFrames != 0 && m_nFrames >= m_nMaxFrames) {
+    e.type = evt_type::evtClose;
+  } else {
+    Clear(MakeARGB(255, 255, 255, 255));
     e.type = evt_type::evtRefresh;
-    m_lastEvent = e;
-    return true;
+    m_nFrames++;
   }
-
-  return false;
+  m_lastEvent = e;
 }
 
 // Boîtes de dialogue - Implémentations temporaires
@@ -695,48 +1856,55 @@ bool CLibGraph2::waitForEvent(evt &e) {
 bool CLibGraph2::guiGetFileName(CString &sFileName, bool bOpen,
                                 const vector<CString> &vstrFileTypes) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetFileName not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetFileName n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
 bool CLibGraph2::guiGetColor(ARGB &color) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetColor not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetColor n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
 bool CLibGraph2::guiGetPenStyle(ARGB &color, float &fWidth,
                                 pen_DashStyles &style) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetPenStyle not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetPenStyle n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
 bool CLibGraph2::guiGetFont(CString &strFontName, float &fPointSize,
                             font_styles &nStyleFlags) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetFont not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetFont n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
 bool CLibGraph2::guiGetValue(CString &strVal, const CString &strTitle,
                              const CString &strLabel) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetValue not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetValue n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
 bool CLibGraph2::guiGetValue(int &nVal, const CString &strTitle,
                              const CString &strLabel) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetValue(int) not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetValue(int) n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
 bool CLibGraph2::guiGetValue(double &dVal, const CString &strTitle,
                              const CString &strLabel) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiGetValue(double) not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiGetValue(double) n'est pas encore implémentée"
+            << std::endl;
   return false;
 }
 
@@ -745,7 +1913,8 @@ msgbtn_answer CLibGraph2::guiMessageBox(const CString &strTitle,
                                         msgbtn_types btns, msgicon_types icon,
                                         msgdefbtn_vals defbtn) {
   // TODO: Implémenter avec tinyfiledialogs
-  std::cerr << "guiMessageBox not yet implemented" << std::endl;
+  std::cerr << "LibGraph2 : guiMessageBox n'est pas encore implémentée"
+            << std::endl;
   return msgbtn_answer::MsgAnsOk;
 }
 
@@ -18,37 +18,131 @@
 #pragma once
 #ifdef LIBGRAPH2_USE_SFML
 
-#include "LibGraph2.h"
+#include "LibGraph2Front.h"
+#include "LibGraph2GL.h"
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cmath>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define LG_WINDOWTITLE "LibGraph 2"
 
 using namespace LibGraph2;
 
-class CLibGraph2 : public ILibGraph2_Adv, public ILibGraph2_Exp {
+// Ressources partagées par toutes les fenêtres du processus : cache de
+// textures et polices chargées. Les contextes OpenGL de SFML étant partagés,
+// une texture chargée pour une fenêtre est utilisable dans toutes les autres.
+// L'accès est protégé par un mutex car chaque fenêtre peut avoir son propre
+// thread de rendu.
+class CSharedResources {
 private:
-  static CLibGraph2 *s_pInstance;
+  static CSharedResources *s_pResources;
+  static int s_nRefCount;
 
-  // Fenêtre SFML
+  std::mutex m_mutex;
+  std::map<std::string, sf::Texture> m_textureCache;
+  std::map<std::string, sf::Font> m_fontRegistry;
+  unsigned long long m_nTextureBytes; // Textures du cache, en RGBA
+
+  CSharedResources() : m_nTextureBytes(0) {}
+
+public:
+  // Référence comptée, partagée par toutes les fenêtres
+  static CSharedResources *Acquire();
+  static void Release();
+
+  // Renvoie la ressource, chargée au premier appel, ou NULL en cas d'erreur.
+  // Les accès au cache et les chargements sont comptés dans pStats
+  const sf::Texture *GetTexture(const std::string &strFileName,
+                                SFrameStats *pStats = NULL);
+  const sf::Font *GetFont(const std::string &strFileName,
+                          SFrameStats *pStats = NULL);
+
+  // Mémoire occupée par les textures des images, en octets
+  unsigned long long GetTextureBytes();
+};
+
+// Cible de rendu hors écran redimensionnable.
+// La texture est allouée par paliers de BUCKET_SIZE pixels : pendant un
+// redimensionnement interactif, la plupart des événements Resized tombent
+// dans le palier courant et ne coûtent qu'un changement de vue. L'agrandissement
+// est immédiat, la réduction n'a lieu que si la taille demandée est restée
+// dans un palier inférieur pendant SHRINK_DELAY_MS.
+class CBackBuffer {
+private:
+  sf::RenderTexture m_texture;
+  unsigned m_nWidth, m_nHeight;         // Taille utile
+  unsigned m_nCapacityX, m_nCapacityY;  // Taille allouée
+  bool m_bShrinkPending;
+  std::chrono::steady_clock::time_point m_tpShrinkRequest;
+
+  static unsigned RoundUp(unsigned n) {
+    return n == 0 ? BUCKET_SIZE
+                  : (n + BUCKET_SIZE - 1) / BUCKET_SIZE * BUCKET_SIZE;
+  }
+  bool Allocate(unsigned nCapacityX, unsigned nCapacityY);
+
+public:
+  static const unsigned BUCKET_SIZE = 256;
+  static const int SHRINK_DELAY_MS = 2000;
+
+  CBackBuffer();
+
+  // Garantit une zone utile de nWidth x nHeight pixels. La vue n'est
+  // changée que si la zone utile ou la texture ont changé. Renvoie false si
+  // l'allocation a échoué
+  bool Reserve(unsigned nWidth, unsigned nHeight);
+  void Release();
+
+  bool IsAllocated() const { return m_nCapacityX != 0; }
+  unsigned getWidth() const { return m_nWidth; }
+  unsigned getHeight() const { return m_nHeight; }
+  unsigned getCapacityHeight() const { return m_nCapacityY; }
+  // Zone utile de la texture
+  sf::IntRect getRect() const {
+    return sf::IntRect(0, 0, (int)m_nWidth, (int)m_nHeight);
+  }
+  sf::RenderTexture &getTarget() { return m_texture; }
+};
+
+class CLibGraph2 final : public ILibGraph2_Adv,
+                         public ILibGraph2_Exp,
+                         public CWindowList<CLibGraph2> {
+private:
+  friend class CWindowList<CLibGraph2>;
+
+  CSharedResources *m_pResources;
+
+  // Fenêtre SFML (NULL en mode hors écran)
   sf::RenderWindow *m_pWindow;
+  // Cible du dessin : la fenêtre, ou le backbuffer en mode hors écran
+  sf::RenderTarget *m_pTarget;
 
-  // Attributs de dessin actuels
+  // Crayon et pinceau courants, côté application (pour les restaurer après
+  // avoir rejoué les enregistreurs)
+  ARGB m_penColor;
+  float m_fPenThickness;
+  ARGB m_brushColor;
+
+  // Attributs de dessin actuels, côté rendu
   sf::Color m_outlineColor;
   float m_outlineThickness;
   sf::Color m_fillColor;
   pen_DashStyles m_penStyle;
 
-  // Police de caractères
-  sf::Font m_font;
+  // Police de caractères (appartient à CSharedResources)
+  const sf::Font *m_pFont;
   float m_fontSize;
   font_styles m_fontStyle;
 
-  // Cache d'images
-  std::map<std::string, sf::Texture> m_textureCache;
-
   // Système de coordonnées normalisées
   int m_nNormalisedSizeX;
   int m_nNormalisedSizeY;
@@ -56,13 +150,79 @@ private:
   int m_nOffsetX;
   int m_nOffsetY;
 
-  // Backbuffer
+  // Backbuffer, possédé par le thread de rendu en mode threadé.
+  // m_trimBackBuffer, publiée à beginPaint(), laisse expirer son délai
+  // de réduction
   bool m_bBackBuffered;
-  sf::RenderTexture m_backBuffer;
+  CBackBuffer m_backBuffer;
+  std::function<void()> m_trimBackBuffer;
 
   // Dernier événement
   evt m_lastEvent;
 
+  // Rafraîchissements générés, et limite (0 : aucune)
+  unsigned long m_nFrames;
+  unsigned long m_nMaxFrames;
+
+  // Enregistrement / rejeu des événements
+  CEventLog m_eventLog;
+
+  // Sortie vidéo : chaque image est lue de façon asynchrone et transmise au
+  // flux une image plus tard, quand la copie par le GPU est terminée
+  // (m_nVideoSlot : lecture en attente, -1 si aucune). Le serveur de
+  // diffusion reçoit les mêmes images
+  std::unique_ptr<CVideoWriter> m_pVideo;
+  std::unique_ptr<CFrameServer> m_pServer;
+  SGLFunctions m_gl;
+  CReadbackRing m_videoReadback;
+  int m_nVideoSlot;
+  std::vector<uint32_t> m_vVideoPixels; // Lecture synchrone, sans PBO
+
+  // Lectures asynchrones (requestReadback()) : demandes de l'application,
+  // protégées par m_readbackMutex, puis lectures lancées par le rendu et en
+  // attente dans m_readbackPool
+  static const size_t READBACK_POOL_SIZE = 4;
+  std::mutex m_readbackMutex;
+  std::vector<SReadback> m_vReadbackRequests;
+  std::vector<SReadback> m_vReadbacks;
+  CReadbackRing m_readbackPool;
+  std::vector<uint32_t> m_vReadbackPixels;
+
+  // Thread de rendu (mode threadé) : file de commandes et images en
+  // attente, décomptées par CmdDisplay() qui réveille Present()
+  std::unique_ptr<CCommandRing> m_pRing;
+  std::thread m_renderThread;
+  std::mutex m_frameMutex;
+  std::condition_variable m_frameCond;
+  int m_nFramesInFlight;
+  static const int MAX_FRAMES_IN_FLIGHT = 2;
+
+  // Enregistreurs de commandes, dans l'ordre de soumission
+  std::vector<CRecorder *> m_vRecorders;
+
+  // Compteurs renvoyés par getFrameStats(), et publication de ceux du
+  // thread de rendu, exécutée par celui-ci après les commandes de l'image
+  CFrameStats m_stats;
+  std::function<void()> m_endRenderFrame;
+  // Minutage des images par le GPU, de la première commande exécutée à
+  // l'affichage : demandé par enableGpuTimer(), créé ou détruit par le
+  // thread qui affiche
+  std::atomic<bool> m_bGpuTimer;
+  CGpuTimer m_gpuTimer;
+  // Durées d'image et latences renvoyées par getFrameTimes() et
+  // getInputLatency()
+  CFrameTimes m_frameTimes;
+
+  // Surimpression des performances, dessinée par le thread qui affiche.
+  // L'atlas est créé au premier affichage
+  CPerfOverlay m_overlay;
+  sf::Texture m_overlayTexture;
+  sf::VertexArray m_overlayVertices;
+  std::vector<CPerfOverlay::SQuad> m_vOverlayQuads;
+
+  // Tampon de travail réutilisé pour les coordonnées des polylignes
+  std::vector<float> m_vScratch;
+
 private:
   CLibGraph2(void);
   ~CLibGraph2(void);
@@ -91,18 +251,113 @@ private:
     return (float)(fNormalisedHeight * m_dScale);
   }
 
+  // Traduit le prochain événement SFML en attente, false si aucun
+  bool PollEvent(evt &e);
+  // Prochaine entrée d'un client du serveur de diffusion, false si aucune
+  bool PollServerEvent(evt &e);
+  // Génère un événement de rafraîchissement
+  void RefreshEvent(evt &e);
+  // Renvoie l'événement suivant du journal rejoué
+  bool ReplayEvent(evt &e);
+  // Prise en compte d'une nouvelle taille de fenêtre
+  void OnResize(unsigned nWidth, unsigned nHeight);
+
+  bool IsOffscreen() const { return m_pWindow == NULL && m_pTarget != NULL; }
+
+  // Fixe le système de coordonnées normalisées et renvoie la taille en pixels
+  void SetNormalisedSize(const CSize &szWndSize, int &nWidth, int &nHeight);
+
   int getPixelWidth();
   int getPixelHeight();
   void ComputeScaleAndOffset();
   bool NeedToFill();
 
-  // Fonction de dessin de pie (complexe)
-  void drawPieInternal(const CRectangle &bounds, float startAngle,
-                       float sweepAngle);
+  // Mode threadé
+  bool IsThreaded() const { return m_pRing != nullptr; }
+  void StartRenderThread();
+  void StopRenderThread();
+  void RenderThreadProc();
+  void SyncRenderThread();
+  void RunOnRenderThread(const std::function<void()> &f);
+
+  // Rejoue les enregistreurs dans l'ordre de soumission
+  void MergeRecorders();
+
+  // Effacement et affichage, directs ou via le thread de rendu
+  void Clear(ARGB color);
+  void Present();
+  // Publie les compteurs de l'image terminée par endPaint()
+  void EndFrameStats();
+
+  // Vrai si la primitive est invisible ou si sa boîte englobante, élargie
+  // de fMargin, est hors de la vue de la cible : elle est alors comptée
+  // comme éliminée
+  bool Cull(bool bVisible, float fMinX, float fMinY, float fMaxX, float fMaxY,
+            float fMargin);
+  bool Cull(bool bVisible, const sf::FloatRect &bounds, float fMargin = 0) {
+    return Cull(bVisible, bounds.left, bounds.top, bounds.left + bounds.width,
+                bounds.top + bounds.height, fMargin);
+  }
+  // Compte les appels de dessin et les sommets soumis à SFML, dont le
+  // premier de l'image ouvre la mesure du GPU
+  void CountDraw(unsigned long nVertices) {
+    m_stats.Render().nDrawCalls++;
+    m_stats.Render().nVertices += nVertices;
+    if (m_gpuTimer.IsCreated() && !m_gpuTimer.IsInSpan())
+      BeginGpuSpan();
+  }
+  void CountShape(const sf::Shape &shape);
+  // Vrai si le remplissage ou le contour courant est visible
+  bool IsShapeVisible() const {
+    return m_fillColor.a != 0 ||
+           (m_outlineColor.a != 0 && m_outlineThickness != 0);
+  }
+  // Lecture de l'image affichée, directe ou via le thread de rendu
+  bool CaptureFrame(sf::Image &image);
+
+  // Exécution des commandes de dessin (coordonnées en pixels). Appelées
+  // directement en mode synchrone, ou par le thread de rendu via
+  // DispatchCommand() en mode threadé.
+  template <typename V>
+  friend void LibGraph2::DispatchCommand(V &visitor, cmd_op op,
+                                         const uint8_t *p, size_t nSize);
+  void CmdSetPen(ARGB color, float fThickness);
+  void CmdSetBrush(ARGB color);
+  void CmdSetFont(const std::string &strFontName, float fSize,
+                  font_styles nStyle);
+  void CmdClear(ARGB color);
+  void CmdLine(const SCmdLine &c);
+  void CmdRectangle(const SCmdRect &c);
+  void CmdEllipse(const SCmdRect &c);
+  void CmdPie(const SCmdPie &c);
+  void CmdPixel(const SCmdPixel &c);
+  void CmdPolyline(const float *pCoords, uint32_t nCount, bool bAutoClose);
+  void CmdString(const std::wstring &text, float x, float y);
+  void CmdBitmap(const std::string &strFileName, const SCmdBitmap &c);
+  void CmdDisplay();
+  void DrawOverlay();
+  void CmdCapture(sf::Image *pImage);
+  // Sortie vidéo, dans le thread de rendu
+  void CaptureVideoFrame();
+  void FlushVideoFrame();
+  void SubmitCapturedFrame(const uint32_t *pPixels, unsigned nWidth,
+                           unsigned nHeight);
+  // Lectures asynchrones, dans le thread de rendu
+  void ServiceReadbacks();
+  void CompleteReadback(SReadback &rb);
+  void DeliverReadback(SReadback &rb, const uint32_t *pBottomUp);
+  void FlushReadbacks();
+  // Minutage par le GPU, dans le thread de rendu
+  void UpdateGpuTimer();
+  void BeginGpuSpan();
+
+  // Applique les variables d'environnement à la fenêtre par défaut
+  void ApplyEnvironment();
 
 public:
-  static CLibGraph2 *GetInstance();
-  static void ReleaseInstance();
+  // Remplace celle de CWindowList : les entrées des fenêtres sont servies
+  // avant les rafraîchissements
+  static CLibGraph2 *WaitForAnyEvent(evt &e);
 
   // Implémentation de ILibGraph2_Com
   virtual void show(const CSize &szWndSize = CSize(), bool bFullScreen = false);
@@ -114,6 +369,40 @@ public:
   virtual void beginPaint();
   virtual void endPaint();
   virtual const evt &getLastEvent() const override { return m_lastEvent; }
+  virtual void enableRenderThread(bool bEnable);
+  virtual bool startEventRecording(const CString &sFileName);
+  virtual void stopEventRecording();
+  virtual bool startEventReplay(const CString &sFileName,
+                                bool bMaxSpeed = false);
+  virtual ILibGraph2Recorder *createRecorder();
+  virtual void releaseRecorder(ILibGraph2Recorder *pRecorder);
+  virtual void showOffscreen(const CSize &szSize = CSize(),
+                             unsigned long nFrames = 0);
+  virtual bool saveFrame(const CString &sFileName);
+  virtual bool getFramePixels(std::vector<ARGB> &vPixels, unsigned &nWidth,
+                              unsigned &nHeight);
+  virtual bool startVideoOutput(const CString &sFileName,
+                                video_format format = video_format::Y4M,
+                                unsigned nFrameRate = 60);
+  virtual void stopVideoOutput();
+  virtual void requestReadback(const CRectangle &rect,
+                               const readback_callback &callback);
+  virtual bool startFrameServer(const CString &sAddress);
+  virtual void stopFrameServer();
+  virtual SFrameStats getFrameStats() { return m_stats.Get(); }
+  virtual void enableGpuTimer(bool bEnable) { m_bGpuTimer = bEnable; }
+  virtual void getFrameAllocations(std::vector<SAllocationStats> &vAllocations) {
+    m_stats.GetAllocations(vAllocations);
+  }
+  virtual void getFrameTimes(SFrameTimes &interval, SFrameTimes &response,
+                             double dBudgetMs = 1000.0 / 60) {
+    m_frameTimes.Get(interval, response, dBudgetMs);
+  }
+  virtual void getInputLatency(SInputLatency &latency, double dBudgetMs = 50) {
+    m_frameTimes.GetInputLatency(latency, dBudgetMs);
+  }
+  virtual void resetFrameTimes() { m_frameTimes.Reset(); }
+  virtual void showPerformanceOverlay(bool bShow) { m_overlay.Show(bShow); }
 
   // Fonctions de dessin
   virtual void setPen(ARGB color, float fWidth,
@@ -169,6 +458,8 @@ public:
   // Fonctions de compatibilité pour pointeurs
   virtual void drawPolylines(CPoint *pPoints, int nNbPoints,
                              bool bAutoClose = false) {
+    // Portée externe : la copie des points est comptée pour drawPolylines
+    CTraceScope trace("drawPolylines");
     drawPolylines(std::vector<CPoint>(pPoints, pPoints + nNbPoints),
                   bAutoClose);
   }
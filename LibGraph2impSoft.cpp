@@ -0,0 +1,725 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef LIBGRAPH2_USE_SOFT
+#define _USE_MATH_DEFINES
+#include "LibGraph2impSoft.h"
+#include "LibGraph2Font.h"
+#include "LibGraph2Image.h"
+#include "LibGraph2Probes.h"
+#ifdef LIBGRAPH2_HAVE_X11
+#include "LibGraph2X11.h"
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+using namespace LibGraph2;
+
+#define LG_WINDOWTITLE "LibGraph 2"
+
+// Constructeur
+CLibGraph2Soft::CLibGraph2Soft()
+    : m_pBrushImage(NULL), m_pWindow(NULL), m_pImage(NULL), m_nOverlayX(0),
+      m_nOverlayY(0),
+      m_nOverlayWidth(0), m_nOverlayHeight(0) {}
+
+// Destructeur
+// Appelé avec le verrou de la liste des fenêtres
+CLibGraph2Soft::~CLibGraph2Soft() {
+  for (SReadback &rb : m_vReadbacks)
+    rb.callback(NULL, 0, 0);
+  CloseWindow();
+}
+
+// Fonctions privées
+
+void CLibGraph2Soft::Open(const CSize &szSize, bool bWindowed,
+                          bool bFullScreen) {
+  int width, height;
+  SetNormalisedSize(szSize, width, height);
+
+  // Sans écran, le plein écran n'a pas de sens : la taille demandée est
+  // conservée
+  CloseWindow();
+  if (!bWindowed || !OpenWindow(width, height, bFullScreen))
+    m_surface.Resize(width, height);
+  m_bShown = true;
+  m_nFrames = 0;
+
+  ComputeScaleAndOffset();
+}
+
+bool CLibGraph2Soft::OpenWindow(unsigned nWidth, unsigned nHeight,
+                                bool bFullScreen) {
+#ifdef LIBGRAPH2_HAVE_X11
+  m_pWindow = new CX11Window;
+  if (!m_pWindow->Connect()) {
+    // Pas de serveur : dessin hors écran, comme avant
+    CloseWindow();
+    return false;
+  }
+  m_pImage = new CX11Image;
+  if (!m_pWindow->Create(nWidth, nHeight, bFullScreen, LG_WINDOWTITLE) ||
+      !m_pImage->Create(*m_pWindow, nWidth, nHeight)) {
+    std::cerr << "LibGraph2 : image X11 indisponible, dessin hors écran"
+              << std::endl;
+    CloseWindow();
+    return false;
+  }
+  if (!m_pImage->IsShared())
+    std::cerr << "LibGraph2 : MIT-SHM indisponible, images copiées vers le "
+                 "serveur X11"
+              << std::endl;
+  m_surface.Attach(m_pImage->getPixels(), nWidth, nHeight);
+  m_surface.Clear(0);
+  return true;
+#else
+  return false;
+#endif
+}
+
+// La surface ne doit plus être utilisée avant un nouveau Resize() ou
+// Attach()
+void CLibGraph2Soft::CloseWindow() {
+#ifdef LIBGRAPH2_HAVE_X11
+  delete m_pImage;
+  m_pImage = NULL;
+  delete m_pWindow;
+  m_pWindow = NULL;
+#endif
+}
+
+void CLibGraph2Soft::Present(bool bEndOfFrame) {
+  CTraceScope trace("Present");
+  CProbeClock probe;
+  bool bDisplayed = bEndOfFrame;
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pImage) {
+    if (m_pWindow->TakeExposed())
+      m_surface.DamageAll();
+    int x, y, nWidth, nHeight;
+    if (m_surface.getDamage(x, y, nWidth, nHeight)) {
+      m_pImage->Put(x, y, nWidth, nHeight);
+      bDisplayed = true;
+    }
+    m_surface.ResetDamage();
+  }
+#endif
+  if (bDisplayed) {
+    LIBGRAPH2_PROBE1(display, probe.ElapsedUs());
+    m_frameTimes.OnPresent();
+    m_frameTimes.OnDisplayed();
+  }
+}
+
+bool CLibGraph2Soft::DrawOverlay() {
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pImage && m_overlay.GetQuads(m_vOverlayQuads)) {
+    CTraceScope trace("DrawOverlay");
+    // Le fond, en premier, couvre tout le reste
+    const CPerfOverlay::SQuad &bg = m_vOverlayQuads[0];
+    int x0 = std::max((int)bg.x0, 0), y0 = std::max((int)bg.y0, 0);
+    int x1 = std::min((int)bg.x1, getPixelWidth());
+    int y1 = std::min((int)bg.y1, getPixelHeight());
+    if (x0 >= x1 || y0 >= y1)
+      return false;
+    m_nOverlayX = x0;
+    m_nOverlayY = y0;
+    m_nOverlayWidth = x1 - x0;
+    m_nOverlayHeight = y1 - y0;
+    m_vUnderOverlay.resize((size_t)m_nOverlayWidth * m_nOverlayHeight);
+    for (int y = 0; y < m_nOverlayHeight; y++)
+      memcpy(&m_vUnderOverlay[(size_t)y * m_nOverlayWidth],
+             m_surface.getRow(y0 + y) + x0, m_nOverlayWidth * sizeof(uint32_t));
+
+    // Échantillonnage au plus proche voisin de l'atlas
+    const uint8_t *pAtlas = CPerfOverlay::GetAtlas();
+    for (const CPerfOverlay::SQuad &q : m_vOverlayQuads) {
+      int qx0 = std::max((int)q.x0, x0), qx1 = std::min((int)q.x1, x1);
+      int qy0 = std::max((int)q.y0, y0), qy1 = std::min((int)q.y1, y1);
+      if (q.u0 == q.u1) {
+        for (int y = qy0; y < qy1; y++)
+          m_surface.FillSpan(y, qx0, qx1, q.color);
+        continue;
+      }
+      float fDu = (q.u1 - q.u0) / (q.x1 - q.x0);
+      float fDv = (q.v1 - q.v0) / (q.y1 - q.y0);
+      for (int y = qy0; y < qy1; y++) {
+        const uint8_t *pRow =
+            pAtlas + (int)(q.v0 + (y - q.y0 + 0.5f) * fDv) *
+                         CPerfOverlay::ATLAS_WIDTH;
+        for (int x = qx0; x < qx1; x++) {
+          unsigned nCoverage = pRow[(int)(q.u0 + (x - q.x0 + 0.5f) * fDu)];
+          if (nCoverage)
+            m_surface.BlendPixel(
+                x, y,
+                (q.color & 0xFFFFFF) |
+                    ((GetA(q.color) * nCoverage / 255) << 24));
+        }
+      }
+    }
+    return true;
+  }
+#endif
+  // Masquée : la fenêtre doit être redessinée là où elle était
+  if (m_nOverlayWidth) {
+    m_surface.Damage(m_nOverlayX, m_nOverlayY, m_nOverlayWidth,
+                     m_nOverlayHeight);
+    m_nOverlayWidth = 0;
+  }
+  return false;
+}
+
+void CLibGraph2Soft::RestoreOverlay() {
+  for (int y = 0; y < m_nOverlayHeight; y++)
+    memcpy(m_surface.getRow(m_nOverlayY + y) + m_nOverlayX,
+           &m_vUnderOverlay[(size_t)y * m_nOverlayWidth],
+           m_nOverlayWidth * sizeof(uint32_t));
+}
+
+void CLibGraph2Soft::OnResize(unsigned nWidth, unsigned nHeight) {
+  if (nWidth == 0 || nHeight == 0)
+    return;
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pImage) {
+    // Nouvelle image partagée : l'ancienne est détachée du serveur
+    if (m_pImage->Create(*m_pWindow, nWidth, nHeight)) {
+      m_surface.Attach(m_pImage->getPixels(), nWidth, nHeight);
+      m_surface.Clear(0);
+    } else {
+      std::cerr << "LibGraph2 : image X11 indisponible, dessin hors écran"
+                << std::endl;
+      CloseWindow();
+      m_surface.Resize(nWidth, nHeight);
+    }
+    ComputeScaleAndOffset();
+    return;
+  }
+#endif
+  m_surface.Resize(nWidth, nHeight);
+  ComputeScaleAndOffset();
+}
+
+// Implémentation des fonctions publiques
+
+void CLibGraph2Soft::show(const CSize &szWndSize, bool bFullScreen) {
+  CTraceScope trace("show");
+  Open(szWndSize, true, bFullScreen);
+}
+
+// Seule la limite du nombre d'images, et l'absence de fenêtre, diffèrent de
+// show(). Sans nombre d'images, celui de LIBGRAPH2_FRAMES est conservé
+void CLibGraph2Soft::showOffscreen(const CSize &szSize, unsigned long nFrames) {
+  CTraceScope trace("showOffscreen");
+  Open(szSize, false, false);
+  if (nFrames != 0)
+    m_nMaxFrames = nFrames;
+}
+
+bool CLibGraph2Soft::saveFrame(const CString &sFileName) {
+  CTraceScope trace("saveFrame");
+  if (m_surface.getWidth() == 0)
+    return false;
+  return SaveImageFile(std::string(sFileName), m_surface.getWidth(),
+                       m_surface.getHeight(), m_surface.getPixels());
+}
+
+bool CLibGraph2Soft::getFramePixels(std::vector<ARGB> &vPixels,
+                                    unsigned &nWidth, unsigned &nHeight) {
+  CTraceScope trace("getFramePixels");
+  nWidth = m_surface.getWidth();
+  nHeight = m_surface.getHeight();
+  vPixels.assign(m_surface.getPixels(),
+                 m_surface.getPixels() + (size_t)nWidth * nHeight);
+  return nWidth != 0;
+}
+
+// L'image est déjà en mémoire : la lecture est faite à la fin de l'image
+// courante, sans délai supplémentaire
+void CLibGraph2Soft::requestReadback(const CRectangle &rect,
+                                     const readback_callback &callback) {
+  CTraceScope trace("requestReadback");
+  if (!m_bShown) {
+    callback(NULL, 0, 0);
+    return;
+  }
+
+  m_vReadbacks.emplace_back(UnmapCoordinateX(rect.m_ptTopLeft.m_fX),
+                            UnmapCoordinateY(rect.m_ptTopLeft.m_fY),
+                            UnmapWidth(rect.m_szSize.m_fWidth),
+                            UnmapHeight(rect.m_szSize.m_fHeight), callback);
+}
+
+void CLibGraph2Soft::ServiceReadbacks() {
+  std::vector<SReadback> vReadbacks;
+  vReadbacks.swap(m_vReadbacks);
+
+  int nWidth = (int)m_surface.getWidth(), nHeight = (int)m_surface.getHeight();
+  for (SReadback &rb : vReadbacks) {
+    if (!rb.Clip(nWidth, nHeight)) {
+      rb.callback(NULL, 0, 0);
+      continue;
+    }
+
+    if (rb.nWidth == nWidth) {
+      // Lignes entières : contiguës dans la surface
+      rb.callback(m_surface.getRow(rb.y), rb.nWidth, rb.nHeight);
+      continue;
+    }
+    m_vSpan.resize((size_t)rb.nWidth * rb.nHeight);
+    for (int y = 0; y < rb.nHeight; y++)
+      std::copy(m_surface.getRow(rb.y + y) + rb.x,
+                m_surface.getRow(rb.y + y) + rb.x + rb.nWidth,
+                &m_vSpan[(size_t)y * rb.nWidth]);
+    rb.callback(m_vSpan.data(), rb.nWidth, rb.nHeight);
+  }
+}
+
+void CLibGraph2Soft::hide() {
+  CTraceScope trace("hide");
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pWindow)
+    m_pWindow->SetVisible(false);
+#endif
+}
+
+void CLibGraph2Soft::endPaint() {
+  CTraceScope trace("endPaint");
+  m_bBackBuffered = false;
+  if (!m_bShown)
+    return;
+  {
+    CStatsScope scope(m_stats.App().dDisplayMs);
+    m_stats.App().nDisplays++;
+    MergeRecorders();
+    bool bOverlay = DrawOverlay();
+    Present(true);
+    if (bOverlay)
+      RestoreOverlay();
+    if (m_pVideo)
+      m_pVideo->SubmitFrame(m_surface.getPixels(), m_surface.getWidth(),
+                            m_surface.getHeight(), false);
+    if (m_pServer)
+      m_pServer->SubmitFrame(m_surface.getPixels(), m_surface.getWidth(),
+                             m_surface.getHeight(), false);
+    if (!m_vReadbacks.empty())
+      ServiceReadbacks();
+  }
+  m_stats.Render().nTextureBytes = m_pResources->GetImageBytes();
+  m_stats.EndRenderFrame();
+  m_stats.EndAppFrame();
+  m_overlay.AddFrame(m_frameTimes.OnEndPaint(), m_stats.Get());
+}
+
+void CLibGraph2Soft::enableRenderThread(bool bEnable) {
+  // Le rendu logiciel se fait toujours dans le thread appelant : la
+  // rastérisation est l'essentiel du coût et la déporter ne ferait que
+  // recopier les commandes
+}
+
+// Rastérisation des commandes
+
+void CLibGraph2Soft::CmdSetTextureBrush(const std::string &filename) {
+  // Une image illisible laisse le pinceau uni
+  m_pBrushImage = NULL;
+  if (filename.empty())
+    return;
+  const SImage *pImage = m_pResources->GetImage(filename, &m_stats.Render());
+  if (pImage && pImage->nWidth != 0 && pImage->nHeight != 0)
+    m_pBrushImage = pImage;
+}
+
+void CLibGraph2Soft::CmdClear(ARGB color) {
+#ifdef LIBGRAPH2_HAVE_X11
+  // Le serveur lit peut-être encore l'image précédente. Les autres
+  // primitives n'attendent pas : au pire, une image partiellement
+  // présentée est aussitôt complétée par la présentation suivante
+  if (m_pImage)
+    m_pImage->Wait();
+#endif
+  m_surface.Clear(color);
+}
+
+bool CLibGraph2Soft::Cull(bool bVisible, float fMinX, float fMinY,
+                          float fMaxX, float fMaxY, float fMargin) {
+  if (bVisible && !IsOutsideTarget(fMinX, fMinY, fMaxX, fMaxY, fMargin,
+                                   m_surface.getWidth(),
+                                   m_surface.getHeight()))
+    return false;
+  m_stats.Render().nCulled++;
+  return true;
+}
+
+void CLibGraph2Soft::CmdLine(const SCmdLine &c) {
+  if (Cull((m_outlineColor >> 24) != 0, std::min(c.x1, c.x2),
+           std::min(c.y1, c.y2), std::max(c.x1, c.x2), std::max(c.y1, c.y2),
+           1))
+    return;
+  CountDraw(2);
+  // Comme sf::Lines, le trait fait toujours un pixel d'épaisseur
+  m_surface.DrawLine(c.x1, c.y1, c.x2, c.y2, 1.0f, m_outlineColor);
+}
+
+void CLibGraph2Soft::CmdRectangle(const SCmdRect &c) {
+  if (Cull(IsShapeVisible(), std::min(c.x, c.x + c.w), std::min(c.y, c.y + c.h),
+           std::max(c.x, c.x + c.w), std::max(c.y, c.y + c.h),
+           std::max(m_outlineThickness, 0.0f)))
+    return;
+  CountDraw(4);
+  m_surface.FillRect(c.x, c.y, c.w, c.h, GetFill());
+  m_surface.StrokeRect(c.x, c.y, c.w, c.h, m_outlineThickness, m_outlineColor);
+}
+
+void CLibGraph2Soft::CmdEllipse(const SCmdRect &c) {
+  if (Cull(IsShapeVisible(), std::min(c.x, c.x + c.w), std::min(c.y, c.y + c.h),
+           std::max(c.x, c.x + c.w), std::max(c.y, c.y + c.h),
+           std::max(m_outlineThickness, 0.0f)))
+    return;
+  // Ellipse exacte : les points de contrôle sont ceux de la boîte
+  CountDraw(4);
+  m_surface.FillEllipse(c.x, c.y, c.w, c.h, GetFill());
+  m_surface.StrokeEllipse(c.x, c.y, c.w, c.h, m_outlineThickness,
+                          m_outlineColor);
+}
+
+void CLibGraph2Soft::CmdPie(const SCmdPie &c) {
+  const int segments = 50;
+
+  float centerX = c.x + c.w / 2.0f;
+  float centerY = c.y + c.h / 2.0f;
+  float radiusX = c.w / 2.0f;
+  float radiusY = c.h / 2.0f;
+  float startRad = c.fStartAngle * M_PI / 180.0f;
+  float sweepRad = c.fSweepAngle * M_PI / 180.0f;
+
+  if (Cull(GetFill().IsVisible(), std::min(c.x, c.x + c.w),
+           std::min(c.y, c.y + c.h), std::max(c.x, c.x + c.w),
+           std::max(c.y, c.y + c.h), 0))
+    return;
+  CountDraw(segments + 2);
+
+  // Centre puis points de l'arc
+  m_vScratch.resize(2 * (segments + 2));
+  m_vScratch[0] = centerX;
+  m_vScratch[1] = centerY;
+  for (int i = 0; i <= segments; i++) {
+    float angle = startRad + (sweepRad * i / segments);
+    m_vScratch[2 * i + 2] = centerX + radiusX * cos(angle);
+    m_vScratch[2 * i + 3] = centerY + radiusY * sin(angle);
+  }
+
+  int nCount = segments + 2;
+  m_surface.FillPolygon(m_vScratch.data(), &nCount, 1, GetFill());
+}
+
+void CLibGraph2Soft::CmdPolyline(const float *pCoords, uint32_t nCount,
+                                 bool bAutoClose) {
+  if (nCount == 0)
+    return;
+  float fMinX = pCoords[0], fMaxX = pCoords[0];
+  float fMinY = pCoords[1], fMaxY = pCoords[1];
+  for (uint32_t i = 1; i < nCount; i++) {
+    fMinX = std::min(fMinX, pCoords[2 * i]);
+    fMaxX = std::max(fMaxX, pCoords[2 * i]);
+    fMinY = std::min(fMinY, pCoords[2 * i + 1]);
+    fMaxY = std::max(fMaxY, pCoords[2 * i + 1]);
+  }
+  bool bVisible =
+      bAutoClose ? IsShapeVisible() : (m_outlineColor >> 24) != 0;
+  float fMargin = bAutoClose ? std::max(m_outlineThickness, 0.0f) : 1;
+  if (Cull(bVisible, fMinX, fMinY, fMaxX, fMaxY, fMargin))
+    return;
+  CountDraw(nCount);
+
+  if (bAutoClose) {
+    int n = (int)nCount;
+    m_surface.FillPolygon(pCoords, &n, 1, GetFill());
+    StrokePolygon(pCoords, nCount);
+  } else {
+    for (uint32_t i = 1; i < nCount; i++)
+      m_surface.DrawLine(pCoords[2 * i - 2], pCoords[2 * i - 1], pCoords[2 * i],
+                         pCoords[2 * i + 1], 1.0f, m_outlineColor);
+  }
+}
+
+// Contour extérieur calculé comme sf::Shape : chaque sommet est décalé le
+// long de la bissectrice des normales de ses deux arêtes
+void CLibGraph2Soft::StrokePolygon(const float *pCoords, uint32_t nCount) {
+  if (m_outlineThickness <= 0 || nCount < 3 || (m_outlineColor >> 24) == 0)
+    return;
+
+  float cx = 0, cy = 0;
+  for (uint32_t i = 0; i < nCount; i++) {
+    cx += pCoords[2 * i];
+    cy += pCoords[2 * i + 1];
+  }
+  cx /= nCount;
+  cy /= nCount;
+
+  std::vector<float> vOutline(4 * nCount);
+  for (uint32_t i = 0; i < nCount; i++) {
+    uint32_t iPrev = (i + nCount - 1) % nCount, iNext = (i + 1) % nCount;
+    float px = pCoords[2 * i], py = pCoords[2 * i + 1];
+    float n[2][2];
+    const uint32_t ends[2][2] = {{iPrev, i}, {i, iNext}};
+    for (int k = 0; k < 2; k++) {
+      float dx = pCoords[2 * ends[k][1]] - pCoords[2 * ends[k][0]];
+      float dy = pCoords[2 * ends[k][1] + 1] - pCoords[2 * ends[k][0] + 1];
+      float len = std::sqrt(dx * dx + dy * dy);
+      n[k][0] = len > 0 ? -dy / len : 0;
+      n[k][1] = len > 0 ? dx / len : 0;
+      // Normale orientée vers l'extérieur
+      if (n[k][0] * (cx - px) + n[k][1] * (cy - py) > 0) {
+        n[k][0] = -n[k][0];
+        n[k][1] = -n[k][1];
+      }
+    }
+    float factor = 1 + n[0][0] * n[1][0] + n[0][1] * n[1][1];
+    if (factor < 1e-3f)
+      factor = 1e-3f;
+    vOutline[2 * i] = px + (n[0][0] + n[1][0]) / factor * m_outlineThickness;
+    vOutline[2 * i + 1] =
+        py + (n[0][1] + n[1][1]) / factor * m_outlineThickness;
+  }
+  // Second contour : le polygone lui-même, pour ne garder que l'anneau
+  std::copy(pCoords, pCoords + 2 * nCount, vOutline.begin() + 2 * nCount);
+  int sizes[2] = {(int)nCount, (int)nCount};
+  m_surface.FillPolygon(vOutline.data(), sizes, 2, m_outlineColor);
+}
+
+void CLibGraph2Soft::CmdPixel(const SCmdPixel &c) {
+  if (Cull((c.color >> 24) != 0, c.x, c.y, c.x + 1, c.y + 1, 0))
+    return;
+  CountDraw(4);
+  m_surface.FillRect(c.x, c.y, 1, 1, c.color);
+}
+
+void CLibGraph2Soft::CmdString(const std::wstring &text, float x, float y) {
+  if (!m_pFont)
+    return;
+  // Le texte s'étend à droite et en dessous de la position, à l'italique
+  // près
+  if (Cull((m_fillColor >> 24) != 0, x, y, INFINITY, INFINITY, m_fontSize))
+    return;
+  CountDraw(4 * text.size());
+
+  unsigned nSize = (unsigned)m_fontSize;
+  uint32_t nAlpha = m_fillColor >> 24;
+  uint32_t nRGB = m_fillColor & 0x00FFFFFF;
+  float fLineSpacing = m_pFont->GetLineSpacing(nSize);
+
+  // La ligne de base est à une hauteur de caractère sous la position,
+  // comme avec sf::Text
+  float penX = x, baseline = y + nSize;
+  for (wchar_t ch : text) {
+    if (ch == L'\n') {
+      penX = x;
+      baseline += fLineSpacing;
+      continue;
+    }
+    const CFont::SGlyph &g = m_pFont->GetGlyph(ch, nSize, m_fontStyle);
+    int gx = (int)std::floor(penX + 0.5f) + g.nLeft;
+    int gy = (int)std::floor(baseline + 0.5f) - g.nTop;
+    m_vSpan.resize(g.nWidth);
+    for (int row = 0; row < g.nHeight; row++) {
+      const uint8_t *pCov = g.vCoverage.data() + (size_t)row * g.nWidth;
+      for (int i = 0; i < g.nWidth; i++) {
+        uint32_t a = (pCov[i] * nAlpha + 127) / 255;
+        m_vSpan[i] = (a << 24) | nRGB;
+      }
+      m_surface.BlendSpan(gy + row, gx, m_vSpan.data(), g.nWidth);
+    }
+    penX += g.fAdvance;
+  }
+}
+
+void CLibGraph2Soft::CmdBitmap(const std::string &filename,
+                               const SCmdBitmap &c) {
+  // Charger ou récupérer l'image du cache partagé
+  const SImage *pImage = m_pResources->GetImage(filename, &m_stats.Render());
+  if (!pImage || pImage->nWidth == 0 || c.fScale == 0)
+    return;
+
+  float ox = 0, oy = 0;
+  if (c.origin == bitmap_origin::Center) {
+    ox = pImage->nWidth / 2.0f;
+    oy = pImage->nHeight / 2.0f;
+  } else if (c.origin == bitmap_origin::Pivot) {
+    ox = c.fPivotX;
+    oy = c.fPivotY;
+  }
+
+  int nImgW = (int)pImage->nWidth, nImgH = (int)pImage->nHeight;
+  double rad = c.fAngle * M_PI / 180.0;
+  double cs = std::cos(rad), sn = std::sin(rad);
+
+  // Boîte englobante de l'image transformée
+  double fMinX = INFINITY, fMinY = INFINITY, fMaxX = -INFINITY,
+         fMaxY = -INFINITY;
+  const float corners[4][2] = {
+      {0, 0}, {(float)nImgW, 0}, {0, (float)nImgH}, {(float)nImgW, (float)nImgH}};
+  for (const auto &pt : corners) {
+    double lx = (pt[0] - ox) * c.fScale, ly = (pt[1] - oy) * c.fScale;
+    double X = c.x + lx * cs - ly * sn, Y = c.y + lx * sn + ly * cs;
+    fMinX = std::min(fMinX, X);
+    fMaxX = std::max(fMaxX, X);
+    fMinY = std::min(fMinY, Y);
+    fMaxY = std::max(fMaxY, Y);
+  }
+  if (Cull(true, (float)fMinX, (float)fMinY, (float)fMaxX, (float)fMaxY, 1))
+    return;
+  CountDraw(4);
+
+  if (c.fAngle == 0 && c.fScale == 1) {
+    // Translation seule : les lignes de l'image sont mélangées telles quelles
+    int x0 = (int)std::floor(c.x - ox + 0.5f);
+    int y0 = (int)std::floor(c.y - oy + 0.5f);
+    for (int v = 0; v < nImgH; v++)
+      m_surface.BlendSpan(y0 + v, x0, pImage->vPixels.data() + (size_t)v * nImgW,
+                          nImgW);
+    return;
+  }
+
+  // Transformation inverse (plus proche voisin, comme une texture SFML non
+  // lissée) : src = origine + R(-angle) * (dst - position) / échelle
+  double du_dx = cs / c.fScale, dv_dx = -sn / c.fScale;
+  double du_dy = sn / c.fScale, dv_dy = cs / c.fScale;
+
+  int x0 = std::max(0, (int)std::floor(fMinX));
+  int x1 = std::min(getPixelWidth(), (int)std::ceil(fMaxX));
+  int y0 = std::max(0, (int)std::floor(fMinY));
+  int y1 = std::min(getPixelHeight(), (int)std::ceil(fMaxY));
+  if (x0 >= x1)
+    return;
+
+  m_vSpan.resize(x1 - x0);
+  for (int y = y0; y < y1; y++) {
+    double dx = x0 + 0.5 - c.x, dy = y + 0.5 - c.y;
+    double u = ox + dx * du_dx + dy * du_dy;
+    double v = oy + dx * dv_dx + dy * dv_dy;
+    for (int x = x0; x < x1; x++, u += du_dx, v += dv_dx) {
+      int iu = (int)std::floor(u), iv = (int)std::floor(v);
+      m_vSpan[x - x0] = (iu >= 0 && iv >= 0 && iu < nImgW && iv < nImgH)
+                            ? pImage->vPixels[(size_t)iv * nImgW + iu]
+                            : 0;
+    }
+    m_surface.BlendSpan(y, x0, m_vSpan.data(), x1 - x0);
+  }
+}
+
+// Événements
+
+bool CLibGraph2Soft::waitForEvent(evt &e) {
+  CTraceScope trace("waitForEvent");
+  CFrameTimes::CEventScope frameTimes(m_frameTimes, e);
+  if (m_eventLog.IsReplaying())
+    return ReplayEvent(e);
+
+  if (!m_bShown)
+    return false;
+
+  GetEvent(e);
+  m_eventLog.Record(e);
+  m_overlay.OnEvent(e);
+  return e.type != evt_type::evtClose;
+}
+
+void CLibGraph2Soft::GetEvent(evt &e) {
+  // Ce qui a été dessiné hors de beginPaint()/endPaint() devient visible
+  Present();
+  if (!PollEvent(e))
+    NextEvent(e);
+}
+
+bool CLibGraph2Soft::PollEvent(evt &e) {
+  bool bFound = false;
+#ifdef LIBGRAPH2_HAVE_X11
+  bFound = m_pWindow && m_pWindow->PollEvent(e);
+#endif
+  // Les entrées des clients sont, comme celles de la fenêtre, en pixels
+  if (!bFound && !(m_pServer && m_pServer->PollEvent(e)))
+    return false;
+
+  switch (e.type) {
+  case evt_type::evtMouseMove:
+  case evt_type::evtMouseDown:
+  case evt_type::evtMouseUp:
+    e.x = (unsigned int)MapCoordinateX((float)e.x);
+    e.y = (unsigned int)MapCoordinateY((float)e.y);
+    break;
+  case evt_type::evtSize:
+    OnResize(e.x, e.y);
+    break;
+  case evt_type::evtClose:
+    m_bShown = false;
+    break;
+  default:
+    break;
+  }
+  m_lastEvent = e;
+  return true;
+}
+
+void CLibGraph2Soft::NextEvent(evt &e) {
+  if (m_nMaxFrames != 0 && m_nFrames >= m_nMaxFrames) {
+    e.type = evt_type::evtClose;
+    m_bShown = false;
+  } else {
+    CmdClear(MakeARGB(255, 255, 255, 255));
+    e.type = evt_type::evtRefresh;
+    m_nFrames++;
+  }
+  m_lastEvent = e;
+}
+
+bool CLibGraph2Soft::ReplayEvent(evt &e) {
+#ifdef LIBGRAPH2_HAVE_X11
+  // La fenêtre reste réactive mais les entrées réelles sont ignorées
+  Present();
+  evt ignored;
+  while (m_pWindow && m_pWindow->PollEvent(ignored))
+    ;
+#endif
+
+  if (!m_eventLog.Replay(e)) {
+    e.type = evt_type::evtClose;
+  } else if (m_bShown) {
+    if (e.type == evt_type::evtRefresh) {
+      CmdClear(MakeARGB(255, 255, 255, 255));
+    } else if (e.type == evt_type::evtSize) {
+#ifdef LIBGRAPH2_HAVE_X11
+      if (m_pWindow)
+        m_pWindow->SetSize(e.x, e.y);
+#endif
+      OnResize(e.x, e.y);
+    }
+  }
+
+  // Fin du journal ou fermeture enregistrée : comme une fermeture réelle,
+  // la fenêtre n'est plus servie par WaitForAnyEvent()
+  if (e.type == evt_type::evtClose)
+    m_bShown = false;
+  m_lastEvent = e;
+  return e.type != evt_type::evtClose;
+}
+
+#endif // LIBGRAPH2_USE_SOFT
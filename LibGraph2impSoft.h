@@ -0,0 +1,169 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#ifdef LIBGRAPH2_USE_SOFT
+
+#include "LibGraph2Front.h"
+#include "LibGraph2Raster.h"
+#include <string>
+#include <vector>
+
+using namespace LibGraph2;
+
+namespace LibGraph2 {
+class CX11Window;
+class CX11Image;
+} // namespace LibGraph2
+
+/*
+ * Moteur de rendu logiciel, sans contexte OpenGL.
+ *
+ * Le dessin est rastérisé par le processeur dans une surface ARGB en mémoire
+ * (CSurface), de la taille passée à show(). Hors écran, aucune entrée
+ * utilisateur n'existe : waitForEvent() génère des rafraîchissements aussi
+ * vite que le programme les traite, ou rejoue un journal d'événements
+ * (CEventLog). La variable d'environnement LIBGRAPH2_FRAMES limite le nombre
+ * de rafraîchissements, après quoi un événement evtClose est envoyé.
+ *
+ * Si un serveur X11 est disponible, show() ouvre une fenêtre : la surface
+ * est alors une image partagée avec le serveur (MIT-SHM), et seule la zone
+ * modifiée depuis la présentation précédente lui est envoyée.
+ */
+class CLibGraph2Soft final : public CLibGraph2Painter,
+                             public CWindowList<CLibGraph2Soft> {
+private:
+  friend class CWindowList<CLibGraph2Soft>;
+
+  // Image rendue
+  CSurface m_surface;
+  // Image du pinceau texturé (appartient à CResources), NULL pour un
+  // pinceau uni
+  const SImage *m_pBrushImage;
+
+  // Fenêtre X11 et image dans laquelle la surface dessine (NULL hors écran)
+  CX11Window *m_pWindow;
+  CX11Image *m_pImage;
+
+  // Lectures demandées par requestReadback(), servies à endPaint()
+  std::vector<SReadback> m_vReadbacks;
+
+  // Pixels recouverts par la surimpression des performances, rétablis après
+  // l'affichage (zone vide si elle n'est pas affichée)
+  std::vector<CPerfOverlay::SQuad> m_vOverlayQuads;
+  std::vector<uint32_t> m_vUnderOverlay;
+  int m_nOverlayX, m_nOverlayY, m_nOverlayWidth, m_nOverlayHeight;
+
+  // Tampon de travail réutilisé
+  std::vector<uint32_t> m_vSpan;
+
+private:
+  CLibGraph2Soft(void);
+  ~CLibGraph2Soft(void);
+
+  // Crée la surface, dans une fenêtre si bWindowed et si un serveur X11
+  // est disponible
+  void Open(const CSize &szSize, bool bWindowed, bool bFullScreen);
+  bool OpenWindow(unsigned nWidth, unsigned nHeight, bool bFullScreen);
+  void CloseWindow();
+  // Envoie à la fenêtre la zone modifiée depuis la présentation précédente.
+  // bEndOfFrame, pour endPaint(), termine les latences des entrées même si
+  // rien n'a changé ; sinon seul un dessin immédiat affiché les termine
+  void Present(bool bEndOfFrame = false);
+  // Dessine la surimpression dans la surface avant Present(), puis
+  // RestoreOverlay() rétablit les pixels recouverts : elle n'apparaît que
+  // dans la fenêtre. Renvoie false si elle n'a pas été dessinée
+  bool DrawOverlay();
+  void RestoreOverlay();
+  void OnResize(unsigned nWidth, unsigned nHeight);
+
+  // Événement suivant : entrée de la fenêtre, sinon rafraîchissement
+  void GetEvent(evt &e);
+  // Traduit le prochain événement de la fenêtre ou d'un client du serveur
+  // de diffusion. Renvoie false s'il n'y en a aucun
+  bool PollEvent(evt &e);
+  // Génère l'événement suivant (rafraîchissement ou fermeture)
+  void NextEvent(evt &e);
+  // Renvoie l'événement suivant du journal rejoué
+  bool ReplayEvent(evt &e);
+
+  int getPixelWidth() override { return (int)m_surface.getWidth(); }
+  int getPixelHeight() override { return (int)m_surface.getHeight(); }
+
+  // Sert les lectures demandées par requestReadback()
+  void ServiceReadbacks();
+
+  // Contour d'un polygone, à l'extérieur de celui-ci comme avec SFML
+  void StrokePolygon(const float *pCoords, uint32_t nCount);
+
+  // Vrai si la primitive est invisible ou si sa boîte englobante, élargie
+  // de fMargin, est hors de l'image : elle est alors comptée comme éliminée
+  bool Cull(bool bVisible, float fMinX, float fMinY, float fMaxX, float fMaxY,
+            float fMargin);
+  // Compte une primitive rastérisée, de nVertices points de contrôle
+  void CountDraw(unsigned long nVertices) {
+    m_stats.Render().nDrawCalls++;
+    m_stats.Render().nVertices += nVertices;
+  }
+  // Remplissage courant : couleur ou image du pinceau
+  SFill GetFill() const {
+    return m_pBrushImage ? SFill(m_pBrushImage) : SFill(m_fillColor);
+  }
+  // Vrai si le remplissage ou le contour courant est visible
+  bool IsShapeVisible() const {
+    return GetFill().IsVisible() ||
+           ((m_outlineColor >> 24) != 0 && m_outlineThickness > 0);
+  }
+
+  // Rastérisation des commandes de dessin (coordonnées en pixels)
+  void CmdSetTextureBrush(const std::string &strFileName) override;
+  void CmdClear(ARGB color) override;
+  void CmdLine(const SCmdLine &c) override;
+  void CmdRectangle(const SCmdRect &c) override;
+  void CmdEllipse(const SCmdRect &c) override;
+  void CmdPie(const SCmdPie &c) override;
+  void CmdPixel(const SCmdPixel &c) override;
+  void CmdPolyline(const float *pCoords, uint32_t nCount,
+                   bool bAutoClose) override;
+  void CmdString(const std::wstring &text, float x, float y) override;
+  void CmdBitmap(const std::string &strFileName, const SCmdBitmap &c) override;
+  void CmdDisplay() override { Present(); }
+
+public:
+  // Image rendue, en pixels ARGB
+  const CSurface &getSurface() const { return m_surface; }
+
+  // Implémentation de ILibGraph2_Com
+  virtual void show(const CSize &szWndSize = CSize(), bool bFullScreen = false);
+  virtual void hide();
+  virtual void endPaint();
+  virtual void enableRenderThread(bool bEnable);
+  virtual void showOffscreen(const CSize &szSize = CSize(),
+                             unsigned long nFrames = 0);
+  virtual bool saveFrame(const CString &sFileName);
+  virtual void requestReadback(const CRectangle &rect,
+                               const readback_callback &callback);
+  // Aucun processeur graphique : dGpuMs reste nul
+  virtual void enableGpuTimer(bool bEnable) {}
+  virtual bool getFramePixels(std::vector<ARGB> &vPixels, unsigned &nWidth,
+                              unsigned &nHeight);
+
+  // Fonctions avancées
+  virtual bool waitForEvent(evt &e);
+};
+
+#endif // LIBGRAPH2_USE_SOFT
@@ -0,0 +1,307 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+// Banc d'essai des primitives de LibGraph2.
+//
+// Chaque primitive est mesurée à plusieurs tailles et nombres d'appels, en
+// mode immédiat (appels hors de beginPaint()/endPaint()) et en mode image
+// (N appels entre beginPaint() et endPaint()). Une ligne JSON par mesure est
+// écrite sur la sortie standard (ou dans --output), un résumé lisible sur la
+// sortie d'erreur :
+//
+//   LIBGRAPH2_BACKEND=sfml ./bench_libgraph2 --min-time 0.5 > sfml.jsonl
+//
+// La taille dépend de la primitive : longueur du segment, côté de la boîte
+// englobante des formes, nombre de sommets des polylignes (dans une boîte de
+// 256 pixels), corps du texte en points, et taille en pixels de l'image
+// dessinée (image de 64 x 64 pixels mise à l'échelle).
+//
+// La synchronisation verticale est désactivée (LIBGRAPH2_VSYNC=0, sauf si la
+// variable est déjà définie) : les mesures ne sont pas limitées au rythme de
+// l'écran. Le dessin a lieu hors écran, sauf avec --window. Les mesures n'ont
+// de sens qu'avec une bibliothèque optimisée (-DCMAKE_BUILD_TYPE=Release).
+
+#define LIBGRAPH2_LEVEL 4
+#include <LibGraph2.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace LibGraph2;
+
+namespace {
+
+const unsigned WINDOW_WIDTH = 1024;
+const unsigned WINDOW_HEIGHT = 768;
+const unsigned IMAGE_SIZE = 64;
+
+// Positions pseudo-aléatoires reproductibles, tirées une fois pour toutes :
+// le tirage ne doit pas être mesuré
+struct SPositions {
+  std::vector<CPoint> vPoints;
+
+  SPositions() {
+    uint32_t nSeed = 12345;
+    vPoints.resize(10000);
+    for (CPoint &pt : vPoints) {
+      nSeed = nSeed * 1664525u + 1013904223u;
+      pt.m_fX = (float)((nSeed >> 8) % WINDOW_WIDTH);
+      nSeed = nSeed * 1664525u + 1013904223u;
+      pt.m_fY = (float)((nSeed >> 8) % WINDOW_HEIGHT);
+    }
+  }
+  // Coin de la primitive i, pour qu'une primitive de taille fSize reste en
+  // grande partie dans la fenêtre
+  CPoint At(size_t i, float fSize) const {
+    const CPoint &pt = vPoints[i % vPoints.size()];
+    float fMaxX = WINDOW_WIDTH > fSize ? WINDOW_WIDTH - fSize : 0;
+    float fMaxY = WINDOW_HEIGHT > fSize ? WINDOW_HEIGHT - fSize : 0;
+    return CPoint(pt.m_fX * fMaxX / WINDOW_WIDTH,
+                  pt.m_fY * fMaxY / WINDOW_HEIGHT);
+  }
+};
+
+struct SContext {
+  ILibGraph2_Exp *pLib;
+  SPositions positions;
+  std::string strImage;
+  std::vector<CPoint> vPolyline; // Polyligne de la taille en cours
+};
+
+typedef void (*draw_fn)(SContext &ctx, float fSize, size_t i);
+
+void DrawLine(SContext &ctx, float fSize, size_t i) {
+  CPoint pt = ctx.positions.At(i, fSize);
+  ctx.pLib->drawLine(pt, CPoint(pt.m_fX + fSize, pt.m_fY + fSize / 2));
+}
+
+void DrawRectangle(SContext &ctx, float fSize, size_t i) {
+  ctx.pLib->drawRectangle(
+      CRectangle(ctx.positions.At(i, fSize), CSize(fSize, fSize)));
+}
+
+void DrawEllipse(SContext &ctx, float fSize, size_t i) {
+  ctx.pLib->drawEllipse(
+      CRectangle(ctx.positions.At(i, fSize), CSize(fSize, fSize)));
+}
+
+void DrawPie(SContext &ctx, float fSize, size_t i) {
+  ctx.pLib->drawPie(
+      CRectangle(ctx.positions.At(i, fSize), CSize(fSize, fSize)), 30, 270);
+}
+
+void DrawPolylines(SContext &ctx, float fSize, size_t i) {
+  CPoint pt = ctx.positions.At(i, 256);
+  std::vector<CPoint> &v = ctx.vPolyline;
+  if (v.size() != (size_t)fSize) {
+    // Dents de scie dans une boîte de 256 pixels
+    v.resize((size_t)fSize);
+    for (size_t j = 0; j < v.size(); j++)
+      v[j] = CPoint(256.0f * j / v.size(), (j % 2) ? 256.0f : 0.0f);
+  }
+  std::vector<CPoint> vMoved(v);
+  for (CPoint &p : vMoved) {
+    p.m_fX += pt.m_fX;
+    p.m_fY += pt.m_fY;
+  }
+  ctx.pLib->drawPolylines(vMoved);
+}
+
+void SetPixel(SContext &ctx, float fSize, size_t i) {
+  ctx.pLib->setPixel(ctx.positions.At(i, 1), MakeARGB(255, 0, 128, 255));
+}
+
+void DrawString(SContext &ctx, float fSize, size_t i) {
+  ctx.pLib->drawString("LibGraph2 0123456789",
+                       ctx.positions.At(i, fSize * 10));
+}
+
+void DrawBitmap(SContext &ctx, float fSize, size_t i) {
+  ctx.pLib->drawBitmap(ctx.strImage.c_str(), ctx.positions.At(i, fSize),
+                       fSize / IMAGE_SIZE);
+}
+
+struct SPrimitive {
+  const char *pszName;
+  draw_fn pfnDraw;
+  float afSizes[3];
+  int nSizes;
+};
+
+const SPrimitive s_aPrimitives[] = {
+    {"drawLine", DrawLine, {4, 64, 512}, 3},
+    {"drawRectangle", DrawRectangle, {4, 64, 512}, 3},
+    {"drawEllipse", DrawEllipse, {4, 64, 512}, 3},
+    {"drawPie", DrawPie, {4, 64, 512}, 3},
+    {"drawPolylines", DrawPolylines, {4, 64, 512}, 3},
+    {"setPixel", SetPixel, {1}, 1},
+    {"drawString", DrawString, {8, 24, 96}, 3},
+    {"drawBitmap", DrawBitmap, {16, 64, 256}, 3},
+};
+
+struct SOptions {
+  double dMinTime = 0.2;
+  const char *pszFilter = NULL;
+  const char *pszOutput = NULL;
+  bool bWindow = false;
+};
+
+void Usage(const char *pszProgram) {
+  fprintf(stderr,
+          "Usage : %s [--min-time secondes] [--filter texte] "
+          "[--output fichier] [--window]\n",
+          pszProgram);
+}
+
+// Crée l'image dessinée par drawBitmap() avec la bibliothèque elle-même :
+// PNG si possible, sinon PPM (moteurs logiciel et OpenGL)
+std::string CreateImage() {
+  ILibGraph2_Exp *pImage = CreateLibGraph2Window();
+  pImage->showOffscreen(CSize((float)IMAGE_SIZE, (float)IMAGE_SIZE));
+  pImage->beginPaint();
+  pImage->setPen(MakeARGB(0, 0, 0, 0), 0);
+  for (unsigned y = 0; y < IMAGE_SIZE; y += 8)
+    for (unsigned x = 0; x < IMAGE_SIZE; x += 8) {
+      pImage->setSolidBrush(MakeARGB(255, x * 4, y * 4, 128));
+      pImage->drawRectangle(CRectangle(CPoint((float)x, (float)y), CSize(8, 8)));
+    }
+  pImage->endPaint();
+  std::string strImage;
+  for (const char *pszExt : {".png", ".ppm"}) {
+    std::string strName = std::string("/tmp/bench_libgraph2") + pszExt;
+    if (pImage->saveFrame(strName.c_str())) {
+      strImage = strName;
+      break;
+    }
+  }
+  ReleaseLibGraph2Window(pImage);
+  return strImage;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  SOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+      options.dMinTime = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+      options.pszFilter = argv[++i];
+    else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+      options.pszOutput = argv[++i];
+    else if (!strcmp(argv[i], "--window"))
+      options.bWindow = true;
+    else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  FILE *pOut = options.pszOutput ? fopen(options.pszOutput, "w") : stdout;
+  if (!pOut) {
+    perror(options.pszOutput);
+    return 1;
+  }
+  setenv("LIBGRAPH2_VSYNC", "0", 0);
+#ifndef __OPTIMIZE__
+  fprintf(stderr, "Attention : compilé sans optimisation, utiliser "
+                  "-DCMAKE_BUILD_TYPE=Release\n");
+#endif
+
+  SContext ctx;
+  ctx.pLib = GetLibGraph2Exp();
+  ctx.strImage = CreateImage();
+  CSize szWindow((float)WINDOW_WIDTH, (float)WINDOW_HEIGHT);
+  if (options.bWindow)
+    ctx.pLib->show(szWindow);
+  else
+    ctx.pLib->showOffscreen(szWindow);
+  ctx.pLib->setPen(MakeARGB(255, 0, 0, 0), 1);
+  ctx.pLib->setSolidBrush(MakeARGB(255, 255, 128, 0));
+  const char *pszBackend = getBackendName();
+
+  typedef std::chrono::steady_clock clock;
+  for (const SPrimitive &prim : s_aPrimitives) {
+    for (int bBatched = 0; bBatched < 2; bBatched++) {
+      const char *pszMode = bBatched ? "frame" : "immediate";
+      std::string strCase = std::string(prim.pszName) + "/" + pszMode;
+      if (options.pszFilter && !strstr(strCase.c_str(), options.pszFilter))
+        continue;
+      // Le mode immédiat affiche à chaque appel : 10000 appels par mesure
+      // ne changeraient que la durée du banc
+      const size_t anCounts[] = {1, 100, 10000};
+      const int nCounts = bBatched ? 3 : 2;
+      for (int s = 0; s < prim.nSizes; s++) {
+        float fSize = prim.afSizes[s];
+        if (!strcmp(prim.pszName, "drawString"))
+          ctx.pLib->setFont("Arial", fSize, FontStyleRegular);
+        for (int c = 0; c < nCounts; c++) {
+          size_t nCount = anCounts[c];
+          // 10000 appels mesurent le coût par appel des petites primitives ;
+          // au-delà, le remplissage domine et 100 appels suffisent
+          if (nCount > 100 && s > 0)
+            continue;
+
+          // Une image d'échauffement (chargement de l'image, des glyphes...)
+          // puis des images jusqu'à la durée minimale
+          SFrameStats last = SFrameStats();
+          unsigned long nFrames = 0;
+          double dElapsed = 0;
+          for (int bWarm = 1; bWarm >= 0; bWarm--) {
+            clock::time_point start = clock::now();
+            do {
+              if (bBatched)
+                ctx.pLib->beginPaint();
+              for (size_t i = 0; i < nCount; i++)
+                prim.pfnDraw(ctx, fSize, i);
+              if (bBatched)
+                ctx.pLib->endPaint();
+              if (!bWarm)
+                nFrames++;
+              dElapsed =
+                  std::chrono::duration<double>(clock::now() - start).count();
+            } while (!bWarm && dElapsed < options.dMinTime);
+          }
+          if (bBatched)
+            last = ctx.pLib->getFrameStats();
+
+          double dCalls = (double)nFrames * nCount;
+          fprintf(pOut,
+                  "{\"backend\":\"%s\",\"primitive\":\"%s\",\"mode\":\"%s\","
+                  "\"size\":%g,\"count\":%zu,\"frames\":%lu,"
+                  "\"ns_per_call\":%.1f,\"calls_per_s\":%.0f,"
+                  "\"frame_ms\":%.4f,\"draw_calls\":%lu,\"vertices\":%lu}\n",
+                  pszBackend, prim.pszName, pszMode, fSize, nCount, nFrames,
+                  dElapsed * 1e9 / dCalls, dCalls / dElapsed,
+                  dElapsed * 1e3 / nFrames, last.nDrawCalls, last.nVertices);
+          fflush(pOut);
+          fprintf(stderr, "%-14s %-9s taille %-4g x%-5zu %10.1f ns/appel\n",
+                  prim.pszName, pszMode, fSize, nCount,
+                  dElapsed * 1e9 / dCalls);
+        }
+      }
+    }
+  }
+
+  ReleaseLibGraph2();
+  if (pOut != stdout)
+    fclose(pOut);
+  return 0;
+}
@@ -0,0 +1,514 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+// Tests de non-régression des moteurs : images de référence et performances.
+//
+// Chaque scène scriptée est dessinée hors écran, puis :
+//
+//   - l'image obtenue est comparée à l'image de référence du moteur
+//     (golden/<moteur>/<scène>.qoi) par une différence perceptuelle : écart
+//     de couleur dans l'espace YIQ, avec une tolérance pour les pixels de
+//     bord décalés d'un pixel par l'anticrénelage. Le test échoue si trop de
+//     pixels diffèrent ; l'image obtenue et une carte des différences sont
+//     alors écrites dans --output-dir ;
+//
+//   - la durée médiane d'une image est comparée à celle de la mesure de
+//     référence, enregistrée localement (--perf-baseline). Le test échoue si
+//     la scène est ralentie de plus de --max-slowdown.
+//
+// Une réécriture d'un moteur (regroupement des appels, tessellation...) est
+// ainsi vérifiée en une commande, pour la justesse comme pour la vitesse :
+//
+//   LIBGRAPH2_BACKEND=soft ./lg2_golden            # vérifie
+//   LIBGRAPH2_BACKEND=gl ./lg2_golden --update-images   # nouvelles références
+//
+// Ce qui ne peut pas être vérifié est un échec : image illisible, image de
+// référence absente (l'image obtenue est écrite dans --output-dir), durée de
+// référence absente. Seules les options --update-images et
+// --update-baseline écrivent les références ; --create-baseline n'écrit
+// que les durées absentes, pour une première exécution dans un dossier de
+// construction neuf. Les images de référence dépendent du moteur et, pour
+// le texte, des polices installées : seules celles du moteur logiciel sont
+// fournies. Avec --render-thread, les scènes sont dessinées par le thread de
+// rendu du moteur, qui doit produire les mêmes images.
+
+#define LIBGRAPH2_LEVEL 4
+#include <LibGraph2.h>
+#include "LibGraph2Image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace LibGraph2;
+
+#ifndef LIBGRAPH2_GOLDEN_DIR
+#define LIBGRAPH2_GOLDEN_DIR "golden"
+#endif
+
+namespace {
+
+const unsigned WIDTH = 320;
+const unsigned HEIGHT = 240;
+
+struct SOptions {
+  std::string strGoldenDir = LIBGRAPH2_GOLDEN_DIR;
+  std::string strOutputDir = "lg2_golden_out";
+  std::string strPerfBaseline;
+  const char *pszScene = NULL;
+  unsigned nFrames = 60;
+  // Écart YIQ toléré par pixel, de 0 (identique) à 1 (noir contre blanc)
+  double dThreshold = 0.1;
+  // Proportion de pixels différents tolérée
+  double dMaxDiff = 0.001;
+  // Ralentissement toléré, et écart absolu en deçà duquel il est ignoré
+  double dMaxSlowdown = 0.25;
+  double dMinSlowdownMs = 0.05;
+  bool bUpdateImages = false;
+  bool bUpdateBaseline = false;
+  bool bCreateBaseline = false;
+  // Dessin par le thread de rendu (enableRenderThread())
+  bool bRenderThread = false;
+};
+
+// Les scènes dessinent la même image à chaque appel : seules les primitives
+// et leurs propriétés varient de l'une à l'autre
+typedef void (*scene_function)(ILibGraph2_Exp *pLib,
+                               const std::string &strBitmap);
+
+void Clear(ILibGraph2_Exp *pLib, ARGB color) {
+  pLib->setPen(MakeARGB(0, 0, 0, 0), 0);
+  pLib->setSolidBrush(color);
+  pLib->drawRectangle(CRectangle(CPoint(0, 0), CSize(WIDTH, HEIGHT)));
+}
+
+void SceneShapes(ILibGraph2_Exp *pLib, const std::string &) {
+  Clear(pLib, MakeARGB(255, 255, 255, 255));
+  pLib->setPen(MakeARGB(255, 0, 0, 0), 1);
+  pLib->setSolidBrush(MakeARGB(255, 220, 40, 40));
+  pLib->drawRectangle(CRectangle(CPoint(10, 10), CSize(80, 50)));
+  pLib->setPen(MakeARGB(255, 0, 0, 160), 4);
+  pLib->setSolidBrush(MakeARGB(255, 40, 200, 60));
+  pLib->drawEllipse(CRectangle(CPoint(110, 10), CSize(90, 60)));
+  pLib->setPen(MakeARGB(255, 80, 80, 80), 2);
+  pLib->setSolidBrush(MakeARGB(255, 250, 200, 0));
+  pLib->drawPie(CRectangle(CPoint(220, 10), CSize(80, 80)), 30, 270);
+  pLib->drawArc(CRectangle(CPoint(10, 100), CSize(100, 60)), 0, 200);
+  // Transparence : formes superposées
+  pLib->setPen(MakeARGB(0, 0, 0, 0), 0);
+  for (int i = 0; i < 4; i++) {
+    pLib->setSolidBrush(MakeARGB(128, i & 1 ? 255 : 0, i & 2 ? 255 : 0, 200));
+    pLib->drawEllipse(
+        CRectangle(CPoint(130.0f + 30 * i, 110.0f + 10 * i), CSize(70, 70)));
+  }
+  // Coordonnées fractionnaires et formes minuscules
+  pLib->setSolidBrush(MakeARGB(255, 0, 0, 0));
+  for (int i = 0; i < 20; i++)
+    pLib->drawRectangle(
+        CRectangle(CPoint(10.0f + i * 7.25f, 200.5f), CSize(0.5f + i * 0.25f, 3)));
+}
+
+void SceneLines(ILibGraph2_Exp *pLib, const std::string &) {
+  Clear(pLib, MakeARGB(255, 255, 255, 255));
+  // Éventail d'épaisseurs et d'angles
+  for (int i = 0; i < 16; i++) {
+    float fAngle = i * 3.14159265f / 16;
+    pLib->setPen(MakeARGB(255, 16 * i, 0, 255 - 16 * i), 1.0f + i / 2.0f);
+    pLib->drawLine(CPoint(80, 120), CPoint(80 + 70 * std::cos(fAngle),
+                                          120 - 70 * std::sin(fAngle)));
+  }
+  const pen_DashStyles aStyles[] = {pen_DashStyles::Solid, pen_DashStyles::Dash,
+                                    pen_DashStyles::Dot, pen_DashStyles::DashDot,
+                                    pen_DashStyles::DashDotDot};
+  for (int i = 0; i < 5; i++) {
+    pLib->setPen(MakeARGB(255, 0, 0, 0), 2, aStyles[i]);
+    pLib->drawLine(CPoint(170, 20.0f + 12 * i), CPoint(310, 20.0f + 12 * i));
+  }
+  // Polylignes ouverte (sinusoïde) et fermée (étoile)
+  std::vector<CPoint> vWave, vStar;
+  for (int i = 0; i <= 70; i++)
+    vWave.push_back(CPoint(170.0f + 2 * i, 110 + 15 * std::sin(i * 0.3f)));
+  for (int i = 0; i < 10; i++) {
+    float fRadius = i & 1 ? 15.0f : 40.0f, fAngle = i * 3.14159265f / 5;
+    vStar.push_back(CPoint(240 + fRadius * std::sin(fAngle),
+                           185 - fRadius * std::cos(fAngle)));
+  }
+  pLib->setPen(MakeARGB(255, 200, 0, 0), 3);
+  pLib->drawPolylines(vWave, false);
+  pLib->setPen(MakeARGB(255, 0, 120, 0), 2);
+  pLib->drawPolylines(vStar, true);
+}
+
+void SceneText(ILibGraph2_Exp *pLib, const std::string &) {
+  Clear(pLib, MakeARGB(255, 255, 255, 255));
+  pLib->setSolidBrush(MakeARGB(255, 0, 0, 0));
+  const float aSizes[] = {8, 12, 20, 32};
+  float fY = 10;
+  for (float fSize : aSizes) {
+    pLib->setFont("Arial", fSize, FontStyleRegular);
+    pLib->drawString("LibGraph2 0123 éàç", CPoint(10, fY));
+    fY += fSize * 1.6f;
+  }
+  pLib->setSolidBrush(MakeARGB(160, 0, 0, 255));
+  pLib->setFont("Arial", 16, FontStyleBold);
+  pLib->drawString("Gras et transparent", CPoint(10, fY));
+}
+
+void SceneBitmaps(ILibGraph2_Exp *pLib, const std::string &strBitmap) {
+  Clear(pLib, MakeARGB(255, 240, 240, 240));
+  const char *pszBitmap = strBitmap.c_str();
+  pLib->drawBitmap(pszBitmap, CPoint(10, 10));
+  pLib->drawBitmap(pszBitmap, CPoint(60, 10), 2.0);
+  pLib->drawBitmap(pszBitmap, CPoint(150, 10), 0.5);
+  pLib->drawBitmap(pszBitmap, CPoint(230, 50), 1.5, 30, true);
+  pLib->drawBitmap(pszBitmap, CPoint(60, 150), CPoint(16, 16), 1.0, -45);
+  // Remplissage par texture
+  pLib->setPen(MakeARGB(255, 0, 0, 0), 1);
+  pLib->setTextureBrush(pszBitmap);
+  pLib->drawEllipse(CRectangle(CPoint(170, 130), CSize(130, 90)));
+}
+
+// Beaucoup de petites primitives aux propriétés alternées : le cas que les
+// regroupements d'appels doivent préserver, ordre de superposition compris
+void SceneBatch(ILibGraph2_Exp *pLib, const std::string &) {
+  Clear(pLib, MakeARGB(255, 255, 255, 255));
+  uint32_t nState = 12345;
+  for (int i = 0; i < 2000; i++) {
+    nState = nState * 1664525 + 1013904223;
+    float x = (float)(nState >> 8 & 511) * (WIDTH - 12) / 512;
+    float y = (float)(nState >> 17 & 511) * (HEIGHT - 12) / 512;
+    pLib->setSolidBrush(MakeARGB(200, nState & 255, 255 - (nState & 255),
+                                 (nState >> 4) & 255));
+    if (i % 3 == 0) {
+      pLib->setPen(MakeARGB(255, 0, 0, 0), 1);
+      pLib->drawEllipse(CRectangle(CPoint(x, y), CSize(10, 10)));
+    } else if (i % 3 == 1) {
+      pLib->setPen(MakeARGB(0, 0, 0, 0), 0);
+      pLib->drawRectangle(CRectangle(CPoint(x, y), CSize(8, 6)));
+    } else {
+      pLib->setPen(MakeARGB(255, nState & 255, 0, 0), 2);
+      pLib->drawLine(CPoint(x, y), CPoint(x + 10, y + 5));
+    }
+  }
+}
+
+struct SScene {
+  const char *pszName;
+  scene_function function;
+};
+
+const SScene s_aScenes[] = {
+    {"shapes", SceneShapes}, {"lines", SceneLines}, {"text", SceneText},
+    {"bitmaps", SceneBitmaps}, {"batch", SceneBatch}};
+
+// Image 32x32 utilisée par la scène bitmaps : dégradé, bord et diagonale
+bool WriteTestBitmap(const std::string &strFileName) {
+  std::vector<uint32_t> vPixels(32 * 32);
+  for (unsigned y = 0; y < 32; y++)
+    for (unsigned x = 0; x < 32; x++) {
+      uint32_t px = 0xFF000000u | (x * 8) << 16 | (y * 8) << 8 | 128;
+      if (x == 0 || y == 0 || x == 31 || y == 31 || x == y)
+        px = 0xFF000000u;
+      vPixels[y * 32 + x] = px;
+    }
+  return SaveImageFile(strFileName, 32, 32, vPixels.data());
+}
+
+// Couleur d'un pixel composée sur fond blanc, dans l'espace YIQ
+void ToYIQ(uint32_t px, double &y, double &i, double &q) {
+  double a = (px >> 24) / 255.0;
+  double r = 255 + ((px >> 16 & 255) - 255) * a;
+  double g = 255 + ((px >> 8 & 255) - 255) * a;
+  double b = 255 + ((px & 255) - 255) * a;
+  y = r * 0.29889531 + g * 0.58662247 + b * 0.11448223;
+  i = r * 0.59597799 - g * 0.27417610 - b * 0.32180189;
+  q = r * 0.21147017 - g * 0.52261711 + b * 0.31114694;
+}
+
+// Écart perceptuel au carré, pondéré comme la sensibilité de l'œil ; 35215
+// pour noir contre blanc
+double ColorDelta(uint32_t a, uint32_t b) {
+  if (a == b)
+    return 0;
+  double y1, i1, q1, y2, i2, q2;
+  ToYIQ(a, y1, i1, q1);
+  ToYIQ(b, y2, i2, q2);
+  return 0.5053 * (y1 - y2) * (y1 - y2) + 0.299 * (i1 - i2) * (i1 - i2) +
+         0.1957 * (q1 - q2) * (q1 - q2);
+}
+
+// Vrai si un voisin (3x3) de (x, y) dans l'image vPixels a la couleur px
+bool HasCloseNeighbour(const std::vector<uint32_t> &vPixels, unsigned x,
+                       unsigned y, uint32_t px, double dMaxDelta) {
+  for (unsigned ny = y ? y - 1 : 0; ny <= std::min(y + 1, HEIGHT - 1); ny++)
+    for (unsigned nx = x ? x - 1 : 0; nx <= std::min(x + 1, WIDTH - 1); nx++)
+      if (ColorDelta(vPixels[ny * WIDTH + nx], px) <= dMaxDelta)
+        return true;
+  return false;
+}
+
+struct SImageDiff {
+  unsigned nDifferent = 0;  // pixels rejetés
+  unsigned nTolerated = 0;  // différences attribuées à l'anticrénelage
+  std::vector<uint32_t> vMap; // carte des différences
+};
+
+// Compare deux images de WIDTH x HEIGHT. Un pixel trop différent est toléré
+// si chaque image a, à un pixel près, la couleur de l'autre : un bord
+// déplacé d'un pixel ou anticrénelé différemment n'est pas une régression
+SImageDiff CompareImages(const std::vector<uint32_t> &vActual,
+                         const std::vector<uint32_t> &vGolden,
+                         double dThreshold) {
+  const double dMaxDelta = 35215 * dThreshold * dThreshold;
+  SImageDiff diff;
+  diff.vMap.resize(vGolden.size());
+  for (unsigned y = 0; y < HEIGHT; y++)
+    for (unsigned x = 0; x < WIDTH; x++) {
+      size_t i = y * WIDTH + x;
+      uint32_t &map = diff.vMap[i];
+      if (ColorDelta(vActual[i], vGolden[i]) <= dMaxDelta) {
+        // Référence en gris clair
+        double fY, fI, fQ;
+        ToYIQ(vGolden[i], fY, fI, fQ);
+        uint32_t c = (uint32_t)(191 + fY / 4);
+        map = 0xFF000000u | c << 16 | c << 8 | c;
+      } else if (HasCloseNeighbour(vGolden, x, y, vActual[i], dMaxDelta) &&
+                 HasCloseNeighbour(vActual, x, y, vGolden[i], dMaxDelta)) {
+        diff.nTolerated++;
+        map = 0xFFFFC000u;
+      } else {
+        diff.nDifferent++;
+        map = 0xFFFF0000u;
+      }
+    }
+  return diff;
+}
+
+// Durées de référence : une ligne « scène durée_ms » par scène
+std::map<std::string, double> LoadBaseline(const std::string &strFileName) {
+  std::map<std::string, double> baseline;
+  FILE *f = fopen(strFileName.c_str(), "r");
+  if (!f)
+    return baseline;
+  char szScene[64];
+  double dMs;
+  while (fscanf(f, "%63s %lf", szScene, &dMs) == 2)
+    baseline[szScene] = dMs;
+  fclose(f);
+  return baseline;
+}
+
+bool SaveBaseline(const std::string &strFileName,
+                  const std::map<std::string, double> &baseline) {
+  FILE *f = fopen(strFileName.c_str(), "w");
+  if (!f)
+    return false;
+  for (const auto &scene : baseline)
+    fprintf(f, "%s %.4f\n", scene.first.c_str(), scene.second);
+  return fclose(f) == 0;
+}
+
+void Usage(const char *pszProgram) {
+  fprintf(stderr,
+          "Usage : %s [--scene nom] [--golden dossier] [--output-dir dossier]\n"
+          "  [--perf-baseline fichier] [--frames n] [--threshold x] "
+          "[--max-diff x]\n"
+          "  [--max-slowdown x] [--update-images] [--update-baseline]\n"
+          "  [--create-baseline] [--render-thread]\n"
+          "Scènes : shapes, lines, text, bitmaps, batch\n",
+          pszProgram);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  SOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--scene") && i + 1 < argc)
+      options.pszScene = argv[++i];
+    else if (!strcmp(argv[i], "--golden") && i + 1 < argc)
+      options.strGoldenDir = argv[++i];
+    else if (!strcmp(argv[i], "--output-dir") && i + 1 < argc)
+      options.strOutputDir = argv[++i];
+    else if (!strcmp(argv[i], "--perf-baseline") && i + 1 < argc)
+      options.strPerfBaseline = argv[++i];
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+      options.nFrames = (unsigned)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--threshold") && i + 1 < argc)
+      options.dThreshold = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--max-diff") && i + 1 < argc)
+      options.dMaxDiff = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--max-slowdown") && i + 1 < argc)
+      options.dMaxSlowdown = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--update-images"))
+      options.bUpdateImages = true;
+    else if (!strcmp(argv[i], "--update-baseline"))
+      options.bUpdateBaseline = true;
+    else if (!strcmp(argv[i], "--create-baseline"))
+      options.bCreateBaseline = true;
+    else if (!strcmp(argv[i], "--render-thread"))
+      options.bRenderThread = true;
+    else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.nFrames == 0) {
+    Usage(argv[0]);
+    return 2;
+  }
+  setenv("LIBGRAPH2_VSYNC", "0", 0);
+  mkdir(options.strOutputDir.c_str(), 0777);
+  std::string strBitmap = options.strOutputDir + "/bitmap.qoi";
+  if (!WriteTestBitmap(strBitmap)) {
+    fprintf(stderr, "Impossible d'écrire %s\n", strBitmap.c_str());
+    return 1;
+  }
+
+  ILibGraph2_Exp *pLib = GetLibGraph2Exp();
+  pLib->showOffscreen(CSize(WIDTH, HEIGHT));
+  if (options.bRenderThread)
+    pLib->enableRenderThread(true);
+  const std::string strBackend = getBackendName();
+  const std::string strGoldenDir = options.strGoldenDir + "/" + strBackend;
+  if (options.strPerfBaseline.empty())
+    options.strPerfBaseline = "lg2_golden_" + strBackend + ".perf";
+  std::map<std::string, double> baseline = LoadBaseline(options.strPerfBaseline);
+  bool bSaveBaseline = false;
+  unsigned nFailures = 0;
+  bool bFound = false;
+
+  for (const SScene &scene : s_aScenes) {
+    if (options.pszScene && strcmp(options.pszScene, scene.pszName))
+      continue;
+    bFound = true;
+
+    // Images d'échauffement (chargement des images et polices), puis mesure
+    for (int i = 0; i < 3; i++) {
+      pLib->beginPaint();
+      scene.function(pLib, strBitmap);
+      pLib->endPaint();
+    }
+    pLib->resetFrameTimes();
+    for (unsigned i = 0; i < options.nFrames; i++) {
+      pLib->beginPaint();
+      scene.function(pLib, strBitmap);
+      pLib->endPaint();
+    }
+    SFrameTimes interval, response;
+    pLib->getFrameTimes(interval, response);
+
+    bool bFailed = false;
+    std::string strImage;
+    std::vector<ARGB> vActual;
+    unsigned nWidth = 0, nHeight = 0;
+    std::string strGolden = strGoldenDir + "/" + scene.pszName + ".qoi";
+    std::string strPrefix =
+        options.strOutputDir + "/" + strBackend + "_" + scene.pszName;
+    SImage golden;
+    if (!pLib->getFramePixels(vActual, nWidth, nHeight) || nWidth != WIDTH ||
+        nHeight != HEIGHT) {
+      bFailed = true;
+      strImage = "ÉCHEC image : lecture de l'image impossible";
+    } else if (options.bUpdateImages) {
+      mkdir(options.strGoldenDir.c_str(), 0777);
+      mkdir(strGoldenDir.c_str(), 0777);
+      if (SaveImageFile(strGolden, WIDTH, HEIGHT, vActual.data())) {
+        strImage = "nouvelle référence " + strGolden;
+      } else {
+        bFailed = true;
+        strImage = "ÉCHEC image : impossible d'écrire " + strGolden;
+      }
+    } else if (!LoadImageFile(strGolden, golden)) {
+      // L'image obtenue peut être examinée, puis acceptée par
+      // --update-images
+      bFailed = true;
+      SaveImageFile(strPrefix + ".actual.qoi", WIDTH, HEIGHT, vActual.data());
+      strImage = "ÉCHEC image : pas de référence " + strGolden + " (voir " +
+                 strPrefix + ".actual.qoi)";
+    } else if (golden.nWidth != WIDTH || golden.nHeight != HEIGHT) {
+      bFailed = true;
+      strImage = "ÉCHEC image : référence de taille différente";
+    } else {
+      SImageDiff diff =
+          CompareImages(vActual, golden.vPixels, options.dThreshold);
+      char szImage[128];
+      if (diff.nDifferent > options.dMaxDiff * WIDTH * HEIGHT) {
+        bFailed = true;
+        SaveImageFile(strPrefix + ".actual.qoi", WIDTH, HEIGHT,
+                      vActual.data());
+        SaveImageFile(strPrefix + ".diff.qoi", WIDTH, HEIGHT,
+                      diff.vMap.data());
+        snprintf(szImage, sizeof szImage,
+                 "ÉCHEC image : %u pixels différents (voir %s.diff.qoi)",
+                 diff.nDifferent, strPrefix.c_str());
+      } else {
+        snprintf(szImage, sizeof szImage,
+                 "image OK (%u pixels différents, %u tolérés)",
+                 diff.nDifferent, diff.nTolerated);
+      }
+      strImage = szImage;
+    }
+
+    char szPerf[128];
+    double dMs = interval.dP50Ms;
+    auto itBaseline = baseline.find(scene.pszName);
+    if (options.bUpdateBaseline ||
+        (options.bCreateBaseline && itBaseline == baseline.end())) {
+      baseline[scene.pszName] = dMs;
+      bSaveBaseline = true;
+      snprintf(szPerf, sizeof szPerf, "%.3f ms (nouvelle référence)", dMs);
+    } else if (itBaseline == baseline.end()) {
+      bFailed = true;
+      snprintf(szPerf, sizeof szPerf,
+               "ÉCHEC durée : %.3f ms, pas de référence dans %s", dMs,
+               options.strPerfBaseline.c_str());
+    } else {
+      double dRef = itBaseline->second;
+      double dChange = dRef > 0 ? dMs / dRef - 1 : 0;
+      bool bSlower = dChange > options.dMaxSlowdown &&
+                     dMs - dRef > options.dMinSlowdownMs;
+      snprintf(szPerf, sizeof szPerf, "%s%.3f ms (référence %.3f, %+.0f%%)",
+               bSlower ? "ÉCHEC durée : " : "", dMs, dRef, dChange * 100);
+      bFailed |= bSlower;
+    }
+    printf("%-8s %-8s %s ; %s\n", strBackend.c_str(), scene.pszName,
+           strImage.c_str(), szPerf);
+    if (bFailed)
+      nFailures++;
+  }
+
+  ReleaseLibGraph2();
+  if (!bFound) {
+    Usage(argv[0]);
+    return 2;
+  }
+  if (bSaveBaseline && !SaveBaseline(options.strPerfBaseline, baseline)) {
+    fprintf(stderr, "Impossible d'écrire %s\n",
+            options.strPerfBaseline.c_str());
+    nFailures++;
+  }
+  if (nFailures)
+    printf("%u scène(s) en échec\n", nFailures);
+  return nFailures ? 1 : 0;
+}
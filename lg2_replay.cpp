@@ -0,0 +1,306 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+// Test du rejeu des événements avec plusieurs fenêtres (waitForAnyEvent()).
+//
+//   - deux journaux écrits par le test (souris, clavier, redimensionnement,
+//     rafraîchissements) sont rejoués à vitesse maximale dans deux fenêtres :
+//     chacune doit recevoir exactement les événements de son journal, à tour
+//     de rôle avec l'autre, puis un événement de fermeture ;
+//
+//   - deux fenêtres hors écran limitées à quelques images enregistrent leurs
+//     événements, puis deux nouvelles fenêtres rejouent ces journaux : les
+//     suites d'événements doivent être identiques.
+//
+// Le moteur est celui de LIBGRAPH2_BACKEND ; les journaux sont écrits dans le
+// dossier courant. Avec --render-thread, chaque fenêtre dessine par son
+// thread de rendu (enableRenderThread()).
+
+#define LIBGRAPH2_LEVEL 4
+#include <LibGraph2.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace LibGraph2;
+
+namespace {
+
+bool s_bRenderThread = false;
+
+// Format de CEventLog : en-tête, puis délai (varint), type et arguments
+const char EVENTLOG_MAGIC[8] = {'L', 'G', '2', 'E', 'V', 'T', 1, 0};
+
+void WriteVarint(FILE *pFile, uint64_t n) {
+  do {
+    uint8_t byte = n & 0x7F;
+    n >>= 7;
+    if (n)
+      byte |= 0x80;
+    fputc(byte, pFile);
+  } while (n);
+}
+
+bool WriteLog(const std::string &strFileName, const std::vector<evt> &vEvents) {
+  FILE *pFile = fopen(strFileName.c_str(), "wb");
+  if (!pFile)
+    return false;
+  fwrite(EVENTLOG_MAGIC, 1, sizeof EVENTLOG_MAGIC, pFile);
+  for (const evt &e : vEvents) {
+    WriteVarint(pFile, 0);
+    fputc((int)e.type, pFile);
+    switch (e.type) {
+    case evt_type::evtMouseDown:
+    case evt_type::evtMouseUp:
+    case evt_type::evtMouseMove:
+    case evt_type::evtSize:
+      WriteVarint(pFile, e.x);
+      WriteVarint(pFile, e.y);
+      break;
+    case evt_type::evtKeyDown:
+    case evt_type::evtKeyUp:
+      WriteVarint(pFile, e.vkKeyCode);
+      break;
+    default:
+      break;
+    }
+  }
+  return fclose(pFile) == 0;
+}
+
+evt MakeEvent(evt_type type, unsigned x = 0, unsigned y = 0,
+              unsigned nKey = 0) {
+  evt e = {};
+  e.type = type;
+  e.x = x;
+  e.y = y;
+  e.vkKeyCode = nKey;
+  return e;
+}
+
+// Compare les champs significatifs de chaque type d'événement
+bool SameEvent(const evt &a, const evt &b) {
+  if (a.type != b.type)
+    return false;
+  switch (a.type) {
+  case evt_type::evtMouseDown:
+  case evt_type::evtMouseUp:
+  case evt_type::evtMouseMove:
+  case evt_type::evtSize:
+    return a.x == b.x && a.y == b.y;
+  case evt_type::evtKeyDown:
+  case evt_type::evtKeyUp:
+    return a.vkKeyCode == b.vkKeyCode;
+  default:
+    return true;
+  }
+}
+
+const char *EventName(evt_type type) {
+  static const char *s_apszNames[] = {"MouseDown", "MouseUp", "MouseMove",
+                                      "KeyDown",   "KeyUp",   "Refresh",
+                                      "Size",      "Close"};
+  return s_apszNames[(int)type];
+}
+
+// Affiche la fenêtre hors écran, avec le thread de rendu si demandé
+void ShowOffscreen(ILibGraph2_Exp *pWindow, unsigned long nMaxFrames = 0) {
+  pWindow->showOffscreen(CSize(), nMaxFrames);
+  if (s_bRenderThread)
+    pWindow->enableRenderThread(true);
+}
+
+// Fenêtre du test et événements qu'elle a reçus
+struct SWindow {
+  const char *pszName;
+  ILibGraph2_Exp *pWindow;
+  std::vector<evt> vEvents;
+  // Taille après le dernier redimensionnement reçu
+  CSize szAfterResize;
+};
+
+// Sert les fenêtres jusqu'à leur fermeture. Chaque fenêtre est libérée dès
+// son événement de fermeture, comme le demande waitForAnyEvent(). Renvoie
+// false si les fenêtres n'ont pas été servies à tour de rôle
+bool RunWindows(std::vector<SWindow> &vWindows) {
+  size_t nOpen = vWindows.size();
+  SWindow *pPrevious = NULL;
+  bool bAlternate = true;
+  evt e;
+  while (ILibGraph2_Exp *pWindow = waitForAnyEvent(e)) {
+    SWindow *pCurrent = NULL;
+    for (SWindow &window : vWindows)
+      if (window.pWindow == pWindow)
+        pCurrent = &window;
+    if (!pCurrent) {
+      fprintf(stderr, "ÉCHEC : événement d'une fenêtre inconnue\n");
+      return false;
+    }
+    if (pCurrent == pPrevious && nOpen > 1)
+      bAlternate = false;
+    pPrevious = pCurrent;
+
+    pCurrent->vEvents.push_back(e);
+    if (e.type == evt_type::evtRefresh) {
+      pWindow->beginPaint();
+      pWindow->setSolidBrush(MakeARGB(255, 0, 128, 255));
+      pWindow->drawRectangle(CRectangle(CPoint(10, 10), CSize(20, 20)));
+      pWindow->endPaint();
+    } else if (e.type == evt_type::evtSize) {
+      pCurrent->szAfterResize = pWindow->getSize();
+    } else if (e.type == evt_type::evtClose) {
+      ReleaseLibGraph2Window(pWindow);
+      pCurrent->pWindow = NULL;
+      nOpen--;
+    }
+  }
+  return bAlternate;
+}
+
+// Compare les événements reçus par une fenêtre à ceux attendus
+bool CheckEvents(const SWindow &window, const std::vector<evt> &vExpected) {
+  bool bOk = window.vEvents.size() == vExpected.size();
+  for (size_t i = 0; bOk && i < vExpected.size(); i++)
+    bOk = SameEvent(window.vEvents[i], vExpected[i]);
+  if (bOk)
+    return true;
+
+  fprintf(stderr, "ÉCHEC : fenêtre %s, événements reçus :", window.pszName);
+  for (const evt &e : window.vEvents)
+    fprintf(stderr, " %s", EventName(e.type));
+  fprintf(stderr, "\n        attendus :");
+  for (const evt &e : vExpected)
+    fprintf(stderr, " %s", EventName(e.type));
+  fprintf(stderr, "\n");
+  return false;
+}
+
+// Journaux écrits par le test, rejoués dans deux fenêtres
+bool TestReplay() {
+  const std::vector<evt> vLogA = {
+      MakeEvent(evt_type::evtMouseMove, 10, 20),
+      MakeEvent(evt_type::evtKeyDown, 0, 0, 'A'),
+      MakeEvent(evt_type::evtRefresh),
+      MakeEvent(evt_type::evtSize, 100, 80),
+      MakeEvent(evt_type::evtKeyUp, 0, 0, 'A'),
+      MakeEvent(evt_type::evtRefresh)};
+  const std::vector<evt> vLogB = {MakeEvent(evt_type::evtMouseDown, 5, 6),
+                                  MakeEvent(evt_type::evtMouseUp, 5, 6),
+                                  MakeEvent(evt_type::evtRefresh),
+                                  MakeEvent(evt_type::evtClose)};
+  if (!WriteLog("lg2_replay_a.evt", vLogA) ||
+      !WriteLog("lg2_replay_b.evt", vLogB)) {
+    fprintf(stderr, "ÉCHEC : impossible d'écrire les journaux\n");
+    return false;
+  }
+
+  std::vector<SWindow> vWindows = {{"A", GetLibGraph2Exp(), {}, CSize()},
+                                   {"B", CreateLibGraph2Window(), {}, CSize()}};
+  for (SWindow &window : vWindows) {
+    ShowOffscreen(window.pWindow);
+    std::string strLog = std::string("lg2_replay_") +
+                         (window.pszName[0] == 'A' ? "a" : "b") + ".evt";
+    if (!window.pWindow->startEventReplay(strLog.c_str(), true)) {
+      fprintf(stderr, "ÉCHEC : rejeu de %s impossible\n", strLog.c_str());
+      return false;
+    }
+  }
+
+  bool bOk = RunWindows(vWindows);
+  if (!bOk)
+    fprintf(stderr, "ÉCHEC : les fenêtres n'ont pas été servies à tour de "
+                    "rôle\n");
+  // La fin du journal A ferme la fenêtre ; celui de B contient sa fermeture
+  std::vector<evt> vExpectedA = vLogA;
+  vExpectedA.push_back(MakeEvent(evt_type::evtClose));
+  bOk = CheckEvents(vWindows[0], vExpectedA) && bOk;
+  bOk = CheckEvents(vWindows[1], vLogB) && bOk;
+
+  // Le redimensionnement rejoué s'applique à la fenêtre
+  const CSize &sz = vWindows[0].szAfterResize;
+  if (sz.m_fWidth != 100 || sz.m_fHeight != 80) {
+    fprintf(stderr, "ÉCHEC : taille %gx%g après le redimensionnement "
+                    "rejoué, 100x80 attendu\n",
+            sz.m_fWidth, sz.m_fHeight);
+    bOk = false;
+  }
+  printf("%s rejeu de journaux dans deux fenêtres\n", bOk ? "OK   " : "ÉCHEC");
+  return bOk;
+}
+
+// Enregistrement de deux fenêtres, puis rejeu dans deux nouvelles fenêtres
+bool TestRecordReplay() {
+  const unsigned long anFrames[2] = {3, 5};
+  const char *apszLogs[2] = {"lg2_record_a.evt", "lg2_record_b.evt"};
+
+  std::vector<SWindow> vRecorded = {
+      {"A", GetLibGraph2Exp(), {}, CSize()},
+      {"B", CreateLibGraph2Window(), {}, CSize()}};
+  for (int i = 0; i < 2; i++) {
+    ShowOffscreen(vRecorded[i].pWindow, anFrames[i]);
+    if (!vRecorded[i].pWindow->startEventRecording(apszLogs[i])) {
+      fprintf(stderr, "ÉCHEC : enregistrement dans %s impossible\n",
+              apszLogs[i]);
+      return false;
+    }
+  }
+  // La libération des fenêtres termine les journaux
+  RunWindows(vRecorded);
+
+  std::vector<SWindow> vReplayed = {
+      {"A rejouée", GetLibGraph2Exp(), {}, CSize()},
+      {"B rejouée", CreateLibGraph2Window(), {}, CSize()}};
+  for (int i = 0; i < 2; i++) {
+    ShowOffscreen(vReplayed[i].pWindow);
+    if (!vReplayed[i].pWindow->startEventReplay(apszLogs[i], true)) {
+      fprintf(stderr, "ÉCHEC : rejeu de %s impossible\n", apszLogs[i]);
+      return false;
+    }
+  }
+  RunWindows(vReplayed);
+
+  bool bOk = true;
+  for (int i = 0; i < 2; i++) {
+    // Rafraîchissements demandés, puis fermeture
+    std::vector<evt> vExpected(anFrames[i], MakeEvent(evt_type::evtRefresh));
+    vExpected.push_back(MakeEvent(evt_type::evtClose));
+    bOk = CheckEvents(vRecorded[i], vExpected) && bOk;
+    bOk = CheckEvents(vReplayed[i], vRecorded[i].vEvents) && bOk;
+  }
+  printf("%s enregistrement puis rejeu de deux fenêtres\n",
+         bOk ? "OK   " : "ÉCHEC");
+  return bOk;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--render-thread")) {
+      fprintf(stderr, "Usage : %s [--render-thread]\n", argv[0]);
+      return 2;
+    }
+    s_bRenderThread = true;
+  }
+  printf("Moteur : %s\n", getBackendName());
+  bool bOk = TestReplay();
+  bOk = TestRecordReplay() && bOk;
+  return bOk ? 0 : 1;
+}
@@ -0,0 +1,515 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+// Banc d'essai de scènes complètes de LibGraph2.
+//
+// Contrairement à bench_libgraph2, qui mesure chaque primitive isolément,
+// chaque scène reproduit une charge réelle, dessinée par l'API publique :
+//
+//   particles  50 000 particules en mouvement (petits rectangles)
+//   dashboard  tableau de bord de 10 000 étiquettes mises à jour
+//   tilemap    carte de 2000 x 2000 tuiles (images) qui défile
+//   lineplot   courbe de 1 000 000 de points qui défile
+//   paint      rejeu des traits d'un programme de dessin, sans effacement
+//
+// Les scènes sont tirées d'une graine (--seed) : deux exécutions dessinent
+// exactement les mêmes images, ce qui permet de comparer deux versions de la
+// bibliothèque. --scale multiplie la taille de toutes les charges. Une ligne
+// JSON par scène est écrite sur la sortie standard (ou dans --output) :
+// primitives par seconde, images par seconde et centiles de la durée
+// d'image (getFrameTimes()) :
+//
+//   LIBGRAPH2_BACKEND=gl ./lg2_scenebench --frames 200 > gl.jsonl
+//
+// Comme pour bench_libgraph2, la synchronisation verticale est désactivée
+// et les mesures supposent une bibliothèque optimisée.
+
+#define LIBGRAPH2_LEVEL 4
+#include <LibGraph2.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace LibGraph2;
+
+namespace {
+
+const float WINDOW_WIDTH = 1280;
+const float WINDOW_HEIGHT = 720;
+
+// Générateur reproductible (xorshift), indépendant de la bibliothèque
+// standard pour que les scènes soient identiques sur toutes les plateformes
+class CRandom {
+private:
+  uint64_t m_nState;
+
+public:
+  explicit CRandom(uint64_t nSeed) : m_nState(nSeed * 2654435761u + 1) {}
+  uint32_t Next() {
+    m_nState ^= m_nState << 13;
+    m_nState ^= m_nState >> 7;
+    m_nState ^= m_nState << 17;
+    return (uint32_t)(m_nState >> 16);
+  }
+  // Réel dans [0, 1[
+  float Unit() { return (Next() & 0xFFFFFF) / 16777216.0f; }
+  float Range(float fMin, float fMax) { return fMin + Unit() * (fMax - fMin); }
+};
+
+// Une scène prépare ses données dans Setup() (non mesuré), puis dessine une
+// image par appel à Draw() entre beginPaint() et endPaint(). Draw() renvoie
+// le nombre de primitives dessinées (de points pour les courbes)
+class CScene {
+public:
+  virtual ~CScene() {}
+  virtual const char *Name() const = 0;
+  virtual void Setup(ILibGraph2_Exp *pLib, CRandom &random, double dScale) = 0;
+  virtual unsigned long Draw(ILibGraph2_Exp *pLib, unsigned nFrame) = 0;
+  // Faux si la scène est terminée avant le nombre d'images demandé
+  virtual bool HasMoreFrames(unsigned nFrame) const { return true; }
+};
+
+void ClearWindow(ILibGraph2_Exp *pLib, ARGB color) {
+  pLib->setPen(MakeARGB(0, 0, 0, 0), 0);
+  pLib->setSolidBrush(color);
+  pLib->drawRectangle(
+      CRectangle(CPoint(0, 0), CSize(WINDOW_WIDTH, WINDOW_HEIGHT)));
+}
+
+// Particules rebondissant sur les bords, regroupées par couleur comme le
+// ferait un programme soucieux de limiter les changements de pinceau
+class CParticles : public CScene {
+private:
+  struct SParticle {
+    float x, y, vx, vy;
+  };
+  static const int COLORS = 8;
+  std::vector<SParticle> m_avParticles[COLORS];
+  ARGB m_aColors[COLORS];
+
+public:
+  const char *Name() const { return "particles"; }
+
+  void Setup(ILibGraph2_Exp *pLib, CRandom &random, double dScale) {
+    size_t nCount = (size_t)(50000 * dScale);
+    for (int c = 0; c < COLORS; c++) {
+      m_aColors[c] = MakeARGB(200, random.Next() & 255, random.Next() & 255,
+                              random.Next() & 255);
+      m_avParticles[c].clear();
+    }
+    for (size_t i = 0; i < nCount; i++) {
+      SParticle p = {random.Range(0, WINDOW_WIDTH),
+                     random.Range(0, WINDOW_HEIGHT), random.Range(-3, 3),
+                     random.Range(-3, 3)};
+      m_avParticles[random.Next() % COLORS].push_back(p);
+    }
+  }
+
+  unsigned long Draw(ILibGraph2_Exp *pLib, unsigned nFrame) {
+    unsigned long nPrimitives = 1;
+    ClearWindow(pLib, MakeARGB(255, 10, 10, 30));
+    for (int c = 0; c < COLORS; c++) {
+      pLib->setSolidBrush(m_aColors[c]);
+      for (SParticle &p : m_avParticles[c]) {
+        p.x += p.vx;
+        p.y += p.vy;
+        if (p.x < 0 || p.x >= WINDOW_WIDTH)
+          p.vx = -p.vx;
+        if (p.y < 0 || p.y >= WINDOW_HEIGHT)
+          p.vy = -p.vy;
+        pLib->drawRectangle(CRectangle(CPoint(p.x, p.y), CSize(2, 2)));
+      }
+      nPrimitives += m_avParticles[c].size();
+    }
+    return nPrimitives;
+  }
+};
+
+// Étiquettes « nom valeur » dont la valeur change à chaque image
+class CDashboard : public CScene {
+private:
+  struct SLabel {
+    CPoint pt;
+    char szName[8];
+    float fValue, fSpeed;
+  };
+  std::vector<SLabel> m_vLabels;
+
+public:
+  const char *Name() const { return "dashboard"; }
+
+  void Setup(ILibGraph2_Exp *pLib, CRandom &random, double dScale) {
+    size_t nCount = (size_t)(10000 * dScale);
+    // Grille aussi carrée que possible, cellules d'au moins 64 x 12 pixels
+    // (les étiquettes se chevauchent au-delà de 1200 environ)
+    size_t nColumns = std::max<size_t>(1, (size_t)std::sqrt(nCount * 5.0));
+    size_t nRows = (nCount + nColumns - 1) / nColumns;
+    m_vLabels.resize(nCount);
+    for (size_t i = 0; i < nCount; i++) {
+      SLabel &l = m_vLabels[i];
+      l.pt = CPoint(WINDOW_WIDTH * (i % nColumns) / nColumns,
+                    WINDOW_HEIGHT * (i / nColumns) / nRows);
+      snprintf(l.szName, sizeof l.szName, "%c%c%03u",
+               'A' + random.Next() % 26, 'A' + random.Next() % 26,
+               random.Next() % 1000);
+      l.fValue = random.Range(0, 100);
+      l.fSpeed = random.Range(-1, 1);
+    }
+    pLib->setFont("Arial", 8, FontStyleRegular);
+  }
+
+  unsigned long Draw(ILibGraph2_Exp *pLib, unsigned nFrame) {
+    char szText[32];
+    ClearWindow(pLib, MakeARGB(255, 255, 255, 255));
+    pLib->setSolidBrush(MakeARGB(255, 0, 0, 0));
+    for (SLabel &l : m_vLabels) {
+      l.fValue += l.fSpeed;
+      if (l.fValue < 0 || l.fValue > 100)
+        l.fSpeed = -l.fSpeed;
+      snprintf(szText, sizeof szText, "%s %5.1f", l.szName, l.fValue);
+      pLib->drawString(szText, l.pt);
+    }
+    return m_vLabels.size() + 1;
+  }
+};
+
+// Carte de tuiles qui défile en diagonale ; seules les tuiles visibles sont
+// dessinées
+class CTilemap : public CScene {
+private:
+  static const int TILE = 32;
+  static const int TILE_KINDS = 4;
+  size_t m_nSize;
+  std::vector<uint8_t> m_vTiles;
+  std::vector<std::string> m_vImages;
+
+public:
+  const char *Name() const { return "tilemap"; }
+
+  void Setup(ILibGraph2_Exp *pLib, CRandom &random, double dScale) {
+    m_nSize = std::max<size_t>(64, (size_t)(2000 * std::sqrt(dScale)));
+    m_vTiles.resize(m_nSize * m_nSize);
+    for (uint8_t &t : m_vTiles)
+      t = (uint8_t)(random.Next() % TILE_KINDS);
+
+    // Tuiles écrites directement en PPM : leur contenu ne dépend pas du
+    // moteur mesuré (saveFrame() n'existe pas avec le moteur nul)
+    m_vImages.clear();
+    for (int k = 0; k < TILE_KINDS; k++) {
+      char szName[64];
+      snprintf(szName, sizeof szName, "/tmp/lg2_scenebench_tile%d.ppm", k);
+      FILE *pFile = fopen(szName, "wb");
+      if (!pFile)
+        continue;
+      fprintf(pFile, "P6\n%d %d\n255\n", TILE, TILE);
+      for (int y = 0; y < TILE; y++)
+        for (int x = 0; x < TILE; x++) {
+          // Bord noir et disque central plus clair
+          int dx = 2 * x + 1 - TILE, dy = 2 * y + 1 - TILE;
+          bool bBorder = x == 0 || y == 0 || x == TILE - 1 || y == TILE - 1;
+          bool bDisc = dx * dx + dy * dy < TILE * TILE / 4;
+          unsigned char aRGB[3] = {(unsigned char)(60 * k + 40),
+                                   (unsigned char)(200 - 40 * k),
+                                   (unsigned char)(80 + 50 * k)};
+          for (unsigned char &c : aRGB)
+            c = bBorder ? 0 : bDisc ? (unsigned char)(255 - (255 - c) / 2) : c;
+          fwrite(aRGB, 1, 3, pFile);
+        }
+      if (fclose(pFile) == 0)
+        m_vImages.push_back(szName);
+    }
+  }
+
+  unsigned long Draw(ILibGraph2_Exp *pLib, unsigned nFrame) {
+    if (m_vImages.size() != TILE_KINDS)
+      return 0;
+    // Position de la vue en pixels, qui revient au début en fin de carte
+    const size_t nMapPixels = m_nSize * TILE;
+    size_t nScrollX = (size_t)nFrame * 7 % (nMapPixels - (size_t)WINDOW_WIDTH);
+    size_t nScrollY =
+        (size_t)nFrame * 3 % (nMapPixels - (size_t)WINDOW_HEIGHT);
+    size_t nFirstX = nScrollX / TILE, nFirstY = nScrollY / TILE;
+    unsigned long nPrimitives = 0;
+    for (size_t ty = nFirstY;
+         ty < m_nSize && ty * TILE < nScrollY + WINDOW_HEIGHT; ty++)
+      for (size_t tx = nFirstX;
+           tx < m_nSize && tx * TILE < nScrollX + WINDOW_WIDTH; tx++) {
+        CPoint pt((float)(tx * TILE) - nScrollX,
+                  (float)(ty * TILE) - nScrollY);
+        pLib->drawBitmap(m_vImages[m_vTiles[ty * m_nSize + tx]].c_str(), pt);
+        nPrimitives++;
+      }
+    return nPrimitives;
+  }
+};
+
+// Marche aléatoire d'un million de points, dont la fenêtre affichée avance
+// de 1000 points par image
+class CLinePlot : public CScene {
+private:
+  static const size_t STEP = 1000;
+  size_t m_nVisible;
+  std::vector<float> m_vValues;
+  std::vector<CPoint> m_vPoints;
+
+public:
+  const char *Name() const { return "lineplot"; }
+
+  void Setup(ILibGraph2_Exp *pLib, CRandom &random, double dScale) {
+    m_nVisible = std::max<size_t>(2, (size_t)(1000000 * dScale));
+    // Assez de valeurs pour 1000 images sans revenir au début
+    m_vValues.resize(m_nVisible + 1000 * STEP);
+    float fValue = 0;
+    for (float &v : m_vValues) {
+      fValue += random.Range(-1, 1);
+      v = fValue;
+    }
+    m_vPoints.resize(m_nVisible);
+  }
+
+  unsigned long Draw(ILibGraph2_Exp *pLib, unsigned nFrame) {
+    size_t nFirst = (size_t)nFrame % 1000 * STEP;
+    const float *pValues = &m_vValues[nFirst];
+    float fMin = *std::min_element(pValues, pValues + m_nVisible);
+    float fMax = *std::max_element(pValues, pValues + m_nVisible);
+    float fScaleY = (WINDOW_HEIGHT - 20) / std::max(fMax - fMin, 1.0f);
+    for (size_t i = 0; i < m_nVisible; i++)
+      m_vPoints[i] = CPoint(WINDOW_WIDTH * i / m_nVisible,
+                            10 + (fMax - pValues[i]) * fScaleY);
+    ClearWindow(pLib, MakeARGB(255, 255, 255, 255));
+    pLib->setPen(MakeARGB(255, 0, 90, 200), 1);
+    pLib->drawPolylines(m_vPoints);
+    // Le débit de cette scène se compte en points tracés
+    return m_nVisible;
+  }
+};
+
+// Traits d'un programme de dessin : chaque image ajoute les segments
+// suivants au dessin existant (pas d'effacement), avec un tampon rond à
+// chaque point comme une brosse
+class CPaint : public CScene {
+private:
+  static const size_t SEGMENTS_PER_FRAME = 50;
+  struct SStroke {
+    ARGB color;
+    float fWidth;
+    std::vector<CPoint> vPoints;
+  };
+  std::vector<SStroke> m_vStrokes;
+  size_t m_nStroke, m_nPoint;
+
+public:
+  const char *Name() const { return "paint"; }
+
+  void Setup(ILibGraph2_Exp *pLib, CRandom &random, double dScale) {
+    size_t nStrokes = std::max<size_t>(1, (size_t)(200 * dScale));
+    m_vStrokes.resize(nStrokes);
+    for (SStroke &s : m_vStrokes) {
+      s.color = MakeARGB(255, random.Next() & 255, random.Next() & 255,
+                         random.Next() & 255);
+      s.fWidth = random.Range(2, 16);
+      // Trait lisse : la direction tourne peu à chaque point
+      float x = random.Range(0, WINDOW_WIDTH), y = random.Range(0, WINDOW_HEIGHT);
+      float fAngle = random.Range(0, 6.2832f);
+      s.vPoints.resize(100);
+      for (CPoint &pt : s.vPoints) {
+        fAngle += random.Range(-0.3f, 0.3f);
+        x = std::min(std::max(x + 6 * std::cos(fAngle), 0.0f), WINDOW_WIDTH);
+        y = std::min(std::max(y + 6 * std::sin(fAngle), 0.0f), WINDOW_HEIGHT);
+        pt = CPoint(x, y);
+      }
+    }
+    m_nStroke = 0;
+    m_nPoint = 1;
+  }
+
+  bool HasMoreFrames(unsigned nFrame) const {
+    return m_nStroke < m_vStrokes.size();
+  }
+
+  unsigned long Draw(ILibGraph2_Exp *pLib, unsigned nFrame) {
+    unsigned long nPrimitives = 0;
+    if (nFrame == 0) {
+      ClearWindow(pLib, MakeARGB(255, 255, 255, 255));
+      nPrimitives++;
+    }
+    for (size_t n = 0; n < SEGMENTS_PER_FRAME && m_nStroke < m_vStrokes.size();
+         n++) {
+      const SStroke &s = m_vStrokes[m_nStroke];
+      const CPoint &a = s.vPoints[m_nPoint - 1], &b = s.vPoints[m_nPoint];
+      pLib->setPen(s.color, s.fWidth);
+      pLib->drawLine(a, b);
+      pLib->setPen(MakeARGB(0, 0, 0, 0), 0);
+      pLib->setSolidBrush(s.color);
+      pLib->drawEllipse(CRectangle(
+          CPoint(b.m_fX - s.fWidth / 2, b.m_fY - s.fWidth / 2),
+          CSize(s.fWidth, s.fWidth)));
+      nPrimitives += 2;
+      if (++m_nPoint == s.vPoints.size()) {
+        m_nStroke++;
+        m_nPoint = 1;
+      }
+    }
+    return nPrimitives;
+  }
+};
+
+struct SOptions {
+  unsigned nFrames = 120;
+  unsigned nWarmup = 5;
+  uint64_t nSeed = 1;
+  double dScale = 1.0;
+  const char *pszScene = NULL;
+  const char *pszOutput = NULL;
+  bool bWindow = false;
+};
+
+void Usage(const char *pszProgram) {
+  fprintf(stderr,
+          "Usage : %s [--scene nom] [--frames n] [--warmup n] [--seed n] "
+          "[--scale x] [--output fichier] [--window]\n"
+          "Scènes : particles, dashboard, tilemap, lineplot, paint\n",
+          pszProgram);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  SOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--scene") && i + 1 < argc)
+      options.pszScene = argv[++i];
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+      options.nFrames = (unsigned)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+      options.nWarmup = (unsigned)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+      options.nSeed = strtoull(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--scale") && i + 1 < argc)
+      options.dScale = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+      options.pszOutput = argv[++i];
+    else if (!strcmp(argv[i], "--window"))
+      options.bWindow = true;
+    else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.nFrames == 0 || options.dScale <= 0) {
+    Usage(argv[0]);
+    return 2;
+  }
+  FILE *pOut = options.pszOutput ? fopen(options.pszOutput, "w") : stdout;
+  if (!pOut) {
+    perror(options.pszOutput);
+    return 1;
+  }
+  setenv("LIBGRAPH2_VSYNC", "0", 0);
+#ifndef __OPTIMIZE__
+  fprintf(stderr, "Attention : compilé sans optimisation, utiliser "
+                  "-DCMAKE_BUILD_TYPE=Release\n");
+#endif
+
+  std::vector<std::unique_ptr<CScene>> vScenes;
+  vScenes.emplace_back(new CParticles);
+  vScenes.emplace_back(new CDashboard);
+  vScenes.emplace_back(new CTilemap);
+  vScenes.emplace_back(new CLinePlot);
+  vScenes.emplace_back(new CPaint);
+
+  ILibGraph2_Exp *pLib = GetLibGraph2Exp();
+  CSize szWindow(WINDOW_WIDTH, WINDOW_HEIGHT);
+  if (options.bWindow)
+    pLib->show(szWindow);
+  else
+    pLib->showOffscreen(szWindow);
+  const char *pszBackend = getBackendName();
+
+  typedef std::chrono::steady_clock clock;
+  bool bFound = false;
+  for (const std::unique_ptr<CScene> &pScene : vScenes) {
+    if (options.pszScene && strcmp(options.pszScene, pScene->Name()))
+      continue;
+    bFound = true;
+    CRandom random(options.nSeed);
+    pScene->Setup(pLib, random, options.dScale);
+
+    // Les images d'échauffement (chargements, caches) ne sont pas mesurées ;
+    // les centiles viennent des intervalles entre deux endPaint()
+    unsigned nFrame = 0;
+    for (; nFrame < options.nWarmup && pScene->HasMoreFrames(nFrame);
+         nFrame++) {
+      pLib->beginPaint();
+      pScene->Draw(pLib, nFrame);
+      pLib->endPaint();
+    }
+    pLib->resetFrameTimes();
+
+    unsigned long nPrimitives = 0;
+    unsigned nMeasured = 0;
+    clock::time_point start = clock::now();
+    for (; nMeasured < options.nFrames && pScene->HasMoreFrames(nFrame);
+         nFrame++, nMeasured++) {
+      pLib->beginPaint();
+      nPrimitives += pScene->Draw(pLib, nFrame);
+      pLib->endPaint();
+    }
+    double dSeconds =
+        std::chrono::duration<double>(clock::now() - start).count();
+
+    SFrameTimes interval, response;
+    pLib->getFrameTimes(interval, response);
+    if (nMeasured == 0 || dSeconds <= 0) {
+      fprintf(stderr, "%s : aucune image mesurée\n", pScene->Name());
+      continue;
+    }
+    fprintf(pOut,
+            "{\"backend\":\"%s\",\"scene\":\"%s\",\"seed\":%llu,"
+            "\"scale\":%g,\"frames\":%u,\"primitives\":%lu,"
+            "\"seconds\":%.4f,\"primitives_per_s\":%.0f,\"fps\":%.2f,"
+            "\"p50_ms\":%.3f,\"p90_ms\":%.3f,\"p99_ms\":%.3f,"
+            "\"max_ms\":%.3f,\"over_budget\":%lu}\n",
+            pszBackend, pScene->Name(), (unsigned long long)options.nSeed,
+            options.dScale, nMeasured, nPrimitives, dSeconds,
+            nPrimitives / dSeconds, nMeasured / dSeconds, interval.dP50Ms,
+            interval.dP90Ms, interval.dP99Ms, interval.dMaxMs,
+            interval.nOverBudget);
+    fflush(pOut);
+    fprintf(stderr,
+            "%-10s %5u images %8.1f im/s %12.0f prim/s  p50 %7.2f  p99 %7.2f "
+            "ms\n",
+            pScene->Name(), nMeasured, nMeasured / dSeconds,
+            nPrimitives / dSeconds, interval.dP50Ms, interval.dP99Ms);
+  }
+
+  ReleaseLibGraph2();
+  if (pOut != stdout)
+    fclose(pOut);
+  if (!bFound) {
+    Usage(argv[0]);
+    return 2;
+  }
+  return 0;
+}
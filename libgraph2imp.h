@@ -16,6 +16,15 @@
     along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
 */
 #pragma once
+#ifdef LIBGRAPH2_USE_SFML
+#  include "LibGraph2impSFML.h"
+#endif
+#ifdef LIBGRAPH2_USE_SOFT
+#  include "LibGraph2impSoft.h"
+#endif
+#ifdef LIBGRAPH2_USE_NULL
+#  include "LibGraph2impNull.h"
+#endif
 #ifdef LIBGRAPH2_USE_GDIPLUS
 #  include "LibGraph2impGDIPLUS.h"
 #endif
@@ -0,0 +1,1439 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef LIBGRAPH2_USE_OPENGL
+#define _USE_MATH_DEFINES
+#include "libgraph2impGL.h"
+#include "LibGraph2Font.h"
+#include "LibGraph2Image.h"
+#include "LibGraph2Probes.h"
+#ifdef LIBGRAPH2_HAVE_X11
+#  include "LibGraph2X11.h"
+#endif
+// Types natifs opaques : Xlib n'est incluse que par LibGraph2X11.cpp
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+using namespace LibGraph2;
+
+#define LG_WINDOWTITLE "LibGraph 2"
+
+// Taille de l'atlas des glyphes, en pixels
+static const unsigned ATLAS_SIZE = 1024;
+
+// Objets EGL d'une fenêtre
+struct CLibGraph2GL::SContext {
+  EGLDisplay display;
+  EGLContext context;
+  EGLSurface surface; // EGL_NO_SURFACE hors écran (ou pbuffer de secours)
+  bool bOwnDisplay;   // Display propre à la connexion X11 de la fenêtre
+};
+
+// Shaders : un programme par classe de primitive, même vertex shader
+
+static const char *s_pszVertexShader =
+    "#version 330 core\n"
+    "uniform vec2 uViewport;\n"
+    "in vec2 aPosition;\n"
+    "in vec2 aTexCoord;\n"
+    "in vec4 aColor;\n"
+    "out vec2 vTexCoord;\n"
+    "out vec4 vColor;\n"
+    "void main() {\n"
+    // y = 0 en bas du framebuffer : sa première ligne en mémoire est le haut
+    // de l'image, et glReadPixels() rend les lignes de haut en bas
+    "  gl_Position = vec4(aPosition * 2.0 / uViewport - 1.0, 0.0, 1.0);\n"
+    "  vTexCoord = aTexCoord;\n"
+    "  vColor = aColor;\n"
+    "}\n";
+
+static const char *s_pszFragmentShaders[] = {
+    // ProgramSolid
+    "#version 330 core\n"
+    "in vec2 vTexCoord;\n"
+    "in vec4 vColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() { fragColor = vColor; }\n",
+    // ProgramImage
+    "#version 330 core\n"
+    "uniform sampler2D uTexture;\n"
+    "in vec2 vTexCoord;\n"
+    "in vec4 vColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() { fragColor = texture(uTexture, vTexCoord) * vColor; }\n",
+    // ProgramText
+    "#version 330 core\n"
+    "uniform sampler2D uTexture;\n"
+    "in vec2 vTexCoord;\n"
+    "in vec4 vColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "  fragColor = vec4(vColor.rgb, vColor.a * texture(uTexture, "
+    "vTexCoord).r);\n"
+    "}\n",
+};
+
+static GLuint CompileShader(const SGLFunctions &gl, GLenum nType,
+                            const char *pszSource) {
+  GLuint nShader = gl.CreateShader(nType);
+  gl.ShaderSource(nShader, 1, &pszSource, NULL);
+  gl.CompileShader(nShader);
+  GLint nStatus = GL_FALSE;
+  gl.GetShaderiv(nShader, GL_COMPILE_STATUS, &nStatus);
+  if (nStatus != GL_TRUE) {
+    char szLog[1024] = "";
+    gl.GetShaderInfoLog(nShader, sizeof szLog, NULL, szLog);
+    std::cerr << "LibGraph2 : shader: " << szLog << std::endl;
+    gl.DeleteShader(nShader);
+    return 0;
+  }
+  return nShader;
+}
+
+static GLuint LinkProgram(const SGLFunctions &gl, GLuint nVertexShader,
+                          GLuint nFragmentShader) {
+  GLuint nProgram = gl.CreateProgram();
+  gl.AttachShader(nProgram, nVertexShader);
+  gl.AttachShader(nProgram, nFragmentShader);
+  gl.BindAttribLocation(nProgram, 0, "aPosition");
+  gl.BindAttribLocation(nProgram, 1, "aTexCoord");
+  gl.BindAttribLocation(nProgram, 2, "aColor");
+  gl.LinkProgram(nProgram);
+  GLint nStatus = GL_FALSE;
+  gl.GetProgramiv(nProgram, GL_LINK_STATUS, &nStatus);
+  if (nStatus != GL_TRUE) {
+    char szLog[1024] = "";
+    gl.GetProgramInfoLog(nProgram, sizeof szLog, NULL, szLog);
+    std::cerr << "LibGraph2 : programme: " << szLog << std::endl;
+    gl.DeleteProgram(nProgram);
+    return 0;
+  }
+  return nProgram;
+}
+
+// EGL
+
+static bool HasClientExtension(const char *pszName) {
+  const char *pszList = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  size_t nLen = strlen(pszName);
+  for (const char *p = pszList; p && (p = strstr(p, pszName)); p += nLen)
+    if ((p == pszList || p[-1] == ' ') && (p[nLen] == ' ' || p[nLen] == 0))
+      return true;
+  return false;
+}
+
+static EGLDisplay GetPlatformDisplay(EGLenum nPlatform, void *pNative) {
+  PFNEGLGETPLATFORMDISPLAYEXTPROC pfnGetPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+          "eglGetPlatformDisplayEXT");
+  if (!pfnGetPlatformDisplay)
+    return EGL_NO_DISPLAY;
+  return pfnGetPlatformDisplay(nPlatform, pNative, NULL);
+}
+
+// Display sans serveur graphique, partagé par toutes les fenêtres hors écran.
+// Il n'est jamais terminé : eglTerminate() détruirait les contextes des
+// autres fenêtres
+static EGLDisplay GetOffscreenDisplay() {
+  static std::mutex mutex;
+  static EGLDisplay display = EGL_NO_DISPLAY;
+  static bool bInitialized = false;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!bInitialized) {
+    bInitialized = true;
+    EGLDisplay d = EGL_NO_DISPLAY;
+    if (HasClientExtension("EGL_MESA_platform_surfaceless"))
+      d = GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                             EGL_DEFAULT_DISPLAY);
+    if (d == EGL_NO_DISPLAY)
+      d = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (d != EGL_NO_DISPLAY && eglInitialize(d, NULL, NULL))
+      display = d;
+  }
+  return display;
+}
+
+// Contexte OpenGL 3.3 core, sans partage
+static EGLContext CreateCoreContext(EGLDisplay display, EGLint nSurfaceType,
+                                    EGLConfig &config) {
+  const EGLint configAttribs[] = {EGL_SURFACE_TYPE,
+                                  nSurfaceType,
+                                  EGL_RENDERABLE_TYPE,
+                                  EGL_OPENGL_BIT,
+                                  EGL_RED_SIZE,
+                                  8,
+                                  EGL_GREEN_SIZE,
+                                  8,
+                                  EGL_BLUE_SIZE,
+                                  8,
+                                  EGL_NONE};
+  EGLint nConfigs = 0;
+  if (!eglChooseConfig(display, configAttribs, &config, 1, &nConfigs) ||
+      nConfigs == 0)
+    return EGL_NO_CONTEXT;
+
+  const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                   3,
+                                   EGL_CONTEXT_MINOR_VERSION,
+                                   3,
+                                   EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                   EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                   EGL_NONE};
+  eglBindAPI(EGL_OPENGL_API);
+  return eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+}
+
+// Fenêtre dont le contexte est actif
+CLibGraph2GL *CLibGraph2GL::s_pCurrent = NULL;
+
+bool CLibGraph2GL::IsAvailable() {
+  static std::mutex s_mutex;
+  static int s_nAvailable = -1;
+  std::lock_guard<std::mutex> lock(s_mutex);
+  if (s_nAvailable < 0) {
+    s_nAvailable = 0;
+    EGLDisplay display = GetOffscreenDisplay();
+    EGLConfig config;
+    EGLContext context = display != EGL_NO_DISPLAY
+                             ? CreateCoreContext(display, EGL_PBUFFER_BIT,
+                                                 config)
+                             : EGL_NO_CONTEXT;
+    if (context != EGL_NO_CONTEXT) {
+      s_nAvailable = 1;
+      eglDestroyContext(display, context);
+    }
+  }
+  return s_nAvailable != 0;
+}
+
+// Constructeur
+CLibGraph2GL::CLibGraph2GL()
+    : m_pWindow(NULL), m_programs(),
+      m_nViewportLocations(), m_nVertexArray(0), m_nFramebuffer(0),
+      m_nColorBuffer(0), m_nWidth(0), m_nHeight(0), m_batch(),
+      m_nBoundProgram(-1), m_nBoundTexture(0), m_nAtlas(0), m_nAtlasX(0),
+      m_nAtlasY(0), m_nAtlasRowHeight(0), m_nTextureBytes(0),
+      m_pBrushTexture(NULL), m_nOverlayTexture(0), m_nVideoSlot(-1), m_bGpuTimer(false) {}
+
+// Destructeur
+// Appelé avec le verrou de la liste des fenêtres. Les sorties sont fermées
+// ici, tant que le contexte permet de lire la dernière image
+CLibGraph2GL::~CLibGraph2GL() {
+  stopVideoOutput();
+  stopFrameServer();
+  DestroyContext();
+  for (SReadback &rb : m_vReadbackRequests)
+    rb.callback(NULL, 0, 0);
+}
+
+// Contexte et objets OpenGL
+
+bool CLibGraph2GL::CreateContext(bool bWindowed, bool bFullScreen) {
+  DestroyContext();
+
+  std::unique_ptr<SContext> pContext(new SContext);
+  pContext->display = EGL_NO_DISPLAY;
+  pContext->surface = EGL_NO_SURFACE;
+  pContext->bOwnDisplay = false;
+
+#ifdef LIBGRAPH2_HAVE_X11
+  if (bWindowed) {
+    m_pWindow = new CX11Window;
+    if (m_pWindow->Connect()) {
+      void *pNative = m_pWindow->GetDisplay();
+      pContext->display = GetPlatformDisplay(EGL_PLATFORM_X11_KHR, pNative);
+      if (pContext->display == EGL_NO_DISPLAY)
+        pContext->display = eglGetDisplay((EGLNativeDisplayType)pNative);
+      if (pContext->display != EGL_NO_DISPLAY &&
+          eglInitialize(pContext->display, NULL, NULL))
+        pContext->bOwnDisplay = true;
+      else
+        pContext->display = EGL_NO_DISPLAY;
+    }
+    if (pContext->display == EGL_NO_DISPLAY) {
+      delete m_pWindow;
+      m_pWindow = NULL;
+    }
+  }
+#endif
+  if (bWindowed && !m_pWindow)
+    std::cerr << "LibGraph2 : aucun serveur X11, dessin hors écran"
+              << std::endl;
+  if (!m_pWindow)
+    pContext->display = GetOffscreenDisplay();
+  if (pContext->display == EGL_NO_DISPLAY) {
+    std::cerr << "LibGraph2 : EGL indisponible" << std::endl;
+    return false;
+  }
+
+  EGLConfig config;
+  pContext->context = CreateCoreContext(
+      pContext->display, m_pWindow ? EGL_WINDOW_BIT : EGL_PBUFFER_BIT,
+      config);
+  if (pContext->context == EGL_NO_CONTEXT) {
+    std::cerr << "LibGraph2 : contexte OpenGL 3.3 core indisponible"
+              << std::endl;
+    if (pContext->bOwnDisplay)
+      eglTerminate(pContext->display);
+    return false;
+  }
+
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pWindow) {
+    // La fenêtre doit utiliser le visual de la configuration EGL
+    EGLint nVisualID = 0;
+    eglGetConfigAttrib(pContext->display, config, EGL_NATIVE_VISUAL_ID,
+                       &nVisualID);
+    if (m_pWindow->Create(m_nWidth, m_nHeight, bFullScreen, LG_WINDOWTITLE,
+                          (unsigned long)nVisualID))
+      pContext->surface = eglCreateWindowSurface(
+          pContext->display, config,
+          (EGLNativeWindowType)m_pWindow->GetWindow(), NULL);
+    if (pContext->surface == EGL_NO_SURFACE) {
+      std::cerr << "LibGraph2 : impossible de créer la fenêtre" << std::endl;
+      eglDestroyContext(pContext->display, pContext->context);
+      eglTerminate(pContext->display);
+      delete m_pWindow;
+      m_pWindow = NULL;
+      return false;
+    }
+  }
+#endif
+
+  if (!eglMakeCurrent(pContext->display, pContext->surface,
+                      pContext->surface, pContext->context)) {
+    // Sans EGL_KHR_surfaceless_context, un pbuffer minimal sert de surface
+    const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    pContext->surface =
+        eglCreatePbufferSurface(pContext->display, config, pbufferAttribs);
+    eglMakeCurrent(pContext->display, pContext->surface, pContext->surface,
+                   pContext->context);
+  }
+  // Synchronisation verticale, comme le moteur SFML (LIBGRAPH2_VSYNC=0 la
+  // désactive)
+  const char *szVSync = getenv("LIBGRAPH2_VSYNC");
+  if (m_pWindow)
+    eglSwapInterval(pContext->display,
+                    !szVSync || strcmp(szVSync, "0") != 0 ? 1 : 0);
+
+  m_pContext = std::move(pContext);
+  s_pCurrent = this;
+  if (!CreateObjects()) {
+    DestroyContext();
+    return false;
+  }
+  return true;
+}
+
+void CLibGraph2GL::DestroyContext() {
+  if (m_pContext) {
+    Activate();
+    FlushReadbacks();
+    FlushVideoFrame();
+    DestroyObjects();
+
+    eglMakeCurrent(m_pContext->display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+    if (s_pCurrent == this)
+      s_pCurrent = NULL;
+    if (m_pContext->surface != EGL_NO_SURFACE)
+      eglDestroySurface(m_pContext->display, m_pContext->surface);
+    eglDestroyContext(m_pContext->display, m_pContext->context);
+    if (m_pContext->bOwnDisplay)
+      eglTerminate(m_pContext->display);
+    m_pContext.reset();
+  }
+
+#ifdef LIBGRAPH2_HAVE_X11
+  delete m_pWindow;
+  m_pWindow = NULL;
+#endif
+}
+
+void CLibGraph2GL::Activate() {
+  if (s_pCurrent == this)
+    return;
+  eglMakeCurrent(m_pContext->display, m_pContext->surface, m_pContext->surface,
+                 m_pContext->context);
+  s_pCurrent = this;
+}
+
+bool CLibGraph2GL::CreateObjects() {
+  if (!m_gl.Load(eglGetProcAddress) || !m_gl.bCore) {
+    std::cerr << "LibGraph2 : OpenGL 3.3 indisponible" << std::endl;
+    return false;
+  }
+
+  GLuint nVertexShader =
+      CompileShader(m_gl, GL_VERTEX_SHADER, s_pszVertexShader);
+  if (!nVertexShader)
+    return false;
+  bool bLinked = true;
+  for (int i = 0; i < ProgramCount; i++) {
+    GLuint nFragmentShader =
+        CompileShader(m_gl, GL_FRAGMENT_SHADER, s_pszFragmentShaders[i]);
+    m_programs[i] =
+        nFragmentShader ? LinkProgram(m_gl, nVertexShader, nFragmentShader) : 0;
+    if (nFragmentShader)
+      m_gl.DeleteShader(nFragmentShader);
+    if (!m_programs[i]) {
+      bLinked = false;
+      continue;
+    }
+    m_gl.UseProgram(m_programs[i]);
+    m_nViewportLocations[i] =
+        m_gl.GetUniformLocation(m_programs[i], "uViewport");
+    GLint nTextureLocation = m_gl.GetUniformLocation(m_programs[i], "uTexture");
+    if (nTextureLocation >= 0)
+      m_gl.Uniform1i(nTextureLocation, 0);
+  }
+  m_gl.DeleteShader(nVertexShader);
+  if (!bLinked)
+    return false;
+  m_nBoundProgram = -1;
+
+  // Sommets : le VAO retient le tampon lié à GL_ARRAY_BUFFER par Create()
+  m_gl.GenVertexArrays(1, &m_nVertexArray);
+  m_gl.BindVertexArray(m_nVertexArray);
+  if (!m_vertices.Create(&m_gl, sizeof(SVertex), MAX_VERTICES))
+    return false;
+  m_gl.EnableVertexAttribArray(0);
+  m_gl.EnableVertexAttribArray(1);
+  m_gl.EnableVertexAttribArray(2);
+  m_gl.VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SVertex),
+                           (const void *)offsetof(SVertex, x));
+  m_gl.VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SVertex),
+                           (const void *)offsetof(SVertex, u));
+  // GL_BGRA : l'entier ARGB est lu tel quel, sans conversion
+  m_gl.VertexAttribPointer(2, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE,
+                           sizeof(SVertex),
+                           (const void *)offsetof(SVertex, color));
+  m_batch.nCount = 0;
+
+  m_gl.GenFramebuffers(1, &m_nFramebuffer);
+  m_gl.GenRenderbuffers(1, &m_nColorBuffer);
+  if (!ResizeFramebuffer(m_nWidth, m_nHeight))
+    return false;
+
+  // Même mélange que sf::BlendAlpha
+  glEnable(GL_BLEND);
+  m_gl.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                         GL_ONE_MINUS_SRC_ALPHA);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  m_gl.ActiveTexture(GL_TEXTURE0);
+  if (m_bGpuTimer)
+    m_gpuTimer.Create(&m_gl);
+  // Le pinceau texturé survit à la recréation du contexte
+  if (!m_strBrushTexture.empty())
+    CmdSetTextureBrush(m_strBrushTexture);
+  return true;
+}
+
+void CLibGraph2GL::DestroyObjects() {
+  m_batch.nCount = 0;
+  m_gpuTimer.Destroy();
+  for (auto &entry : m_textures)
+    glDeleteTextures(1, &entry.second.nTexture);
+  m_textures.clear();
+  m_pBrushTexture = NULL;
+  if (m_nAtlas)
+    glDeleteTextures(1, &m_nAtlas);
+  m_nAtlas = 0;
+  m_atlasGlyphs.clear();
+  if (m_nOverlayTexture)
+    glDeleteTextures(1, &m_nOverlayTexture);
+  m_nOverlayTexture = 0;
+  m_nTextureBytes = 0;
+  m_nBoundTexture = 0;
+
+  if (!m_gl.bCore)
+    return;
+  m_vertices.Destroy();
+  if (m_nVertexArray)
+    m_gl.DeleteVertexArrays(1, &m_nVertexArray);
+  m_nVertexArray = 0;
+  for (GLuint &nProgram : m_programs) {
+    if (nProgram)
+      m_gl.DeleteProgram(nProgram);
+    nProgram = 0;
+  }
+  if (m_nFramebuffer)
+    m_gl.DeleteFramebuffers(1, &m_nFramebuffer);
+  if (m_nColorBuffer)
+    m_gl.DeleteRenderbuffers(1, &m_nColorBuffer);
+  m_nFramebuffer = 0;
+  m_nColorBuffer = 0;
+}
+
+bool CLibGraph2GL::ResizeFramebuffer(unsigned nWidth, unsigned nHeight) {
+  m_nWidth = nWidth;
+  m_nHeight = nHeight;
+
+  m_gl.BindRenderbuffer(GL_RENDERBUFFER, m_nColorBuffer);
+  m_gl.RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, nWidth, nHeight);
+  m_gl.BindFramebuffer(GL_FRAMEBUFFER, m_nFramebuffer);
+  m_gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_RENDERBUFFER, m_nColorBuffer);
+  if (m_gl.CheckFramebufferStatus(GL_FRAMEBUFFER) !=
+      GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "LibGraph2 : framebuffer " << nWidth << "x" << nHeight
+              << " incomplet" << std::endl;
+    return false;
+  }
+  glViewport(0, 0, nWidth, nHeight);
+  for (int i = 0; i < ProgramCount; i++) {
+    m_gl.UseProgram(m_programs[i]);
+    m_gl.Uniform2f(m_nViewportLocations[i], (float)nWidth, (float)nHeight);
+  }
+  m_nBoundProgram = -1;
+  return true;
+}
+
+// Lots de primitives
+
+CLibGraph2GL::SVertex *CLibGraph2GL::Reserve(gl_program program,
+                                             GLuint nTexture, GLenum nMode,
+                                             size_t n) {
+  Activate();
+  if (m_batch.nCount != 0 &&
+      (m_batch.program != program || m_batch.nTexture != nTexture ||
+       m_batch.nMode != nMode))
+    Flush();
+  if (!m_vertices.HasRoom(n)) {
+    Flush();
+    m_vertices.NextSection();
+  }
+
+  GLint nFirst;
+  SVertex *p = static_cast<SVertex *>(m_vertices.Allocate(n, nFirst));
+  if (m_batch.nCount == 0) {
+    m_batch.program = program;
+    m_batch.nTexture = nTexture;
+    m_batch.nMode = nMode;
+    m_batch.nFirst = nFirst;
+  }
+  m_batch.nCount += (GLsizei)n;
+  return p;
+}
+
+void CLibGraph2GL::Flush() {
+  CTraceScope trace("Flush");
+  if (m_batch.nCount == 0)
+    return;
+
+  m_vertices.Commit();
+  if (m_nBoundProgram != m_batch.program) {
+    m_gl.UseProgram(m_programs[m_batch.program]);
+    m_nBoundProgram = m_batch.program;
+  }
+  if (m_batch.nTexture && m_batch.nTexture != m_nBoundTexture) {
+    glBindTexture(GL_TEXTURE_2D, m_batch.nTexture);
+    m_nBoundTexture = m_batch.nTexture;
+  }
+  m_gpuTimer.BeginSpan();
+  glDrawArrays(m_batch.nMode, m_batch.nFirst, m_batch.nCount);
+  m_gpuTimer.EndSpan();
+  m_stats.Render().nDrawCalls++;
+  m_stats.Render().nVertices += m_batch.nCount;
+  m_batch.nCount = 0;
+}
+
+static inline void SetVertex(void *pDest, float x, float y, float u, float v,
+                             ARGB color) {
+  float *p = static_cast<float *>(pDest);
+  p[0] = x;
+  p[1] = y;
+  p[2] = u;
+  p[3] = v;
+  memcpy(p + 4, &color, sizeof color);
+}
+
+CLibGraph2GL::SVertex *CLibGraph2GL::ReserveFill(size_t n) {
+  if (m_pBrushTexture)
+    return Reserve(ProgramImage, m_pBrushTexture->nTexture, GL_TRIANGLES, n);
+  return Reserve(ProgramSolid, 0, GL_TRIANGLES, n);
+}
+
+void CLibGraph2GL::SetFillVertex(SVertex *p, float x, float y) {
+  if (m_pBrushTexture)
+    SetVertex(p, x, y, x / m_pBrushTexture->nWidth,
+              y / m_pBrushTexture->nHeight, MakeARGB(255, 255, 255, 255));
+  else
+    SetVertex(p, x, y, 0, 0, m_fillColor);
+}
+
+void CLibGraph2GL::DrawShape(const float *pCoords, uint32_t nCount, float fX,
+                             float fY, float fScaleY) {
+  if (nCount < 3)
+    return;
+
+  // Centre de la boîte englobante, premier sommet de l'éventail de sf::Shape
+  float fMinX = pCoords[0], fMaxX = pCoords[0];
+  float fMinY = pCoords[1], fMaxY = pCoords[1];
+  for (uint32_t i = 1; i < nCount; i++) {
+    fMinX = std::min(fMinX, pCoords[2 * i]);
+    fMaxX = std::max(fMaxX, pCoords[2 * i]);
+    fMinY = std::min(fMinY, pCoords[2 * i + 1]);
+    fMaxY = std::max(fMaxY, pCoords[2 * i + 1]);
+  }
+  float cx = (fMinX + fMaxX) / 2, cy = (fMinY + fMaxY) / 2;
+
+  bool bVisible = IsFillVisible() ||
+                  ((m_outlineColor >> 24) != 0 && m_outlineThickness > 0);
+  if (Cull(bVisible, fMinX + fX, std::min(fMinY * fScaleY, fMaxY * fScaleY) + fY,
+           fMaxX + fX, std::max(fMinY * fScaleY, fMaxY * fScaleY) + fY,
+           std::max(m_outlineThickness, 0.0f) * std::max(fScaleY, 1.0f)))
+    return;
+
+  if (IsFillVisible()) {
+    const uint32_t nMaxTriangles = MAX_VERTICES / 3;
+    for (uint32_t i = 0; i < nCount;) {
+      uint32_t nTriangles = std::min(nCount - i, nMaxTriangles);
+      SVertex *p = ReserveFill(3 * nTriangles);
+      for (uint32_t k = 0; k < nTriangles; k++, i++, p += 3) {
+        uint32_t j = (i + 1) % nCount;
+        SetFillVertex(p, cx + fX, cy * fScaleY + fY);
+        SetFillVertex(p + 1, pCoords[2 * i] + fX,
+                      pCoords[2 * i + 1] * fScaleY + fY);
+        SetFillVertex(p + 2, pCoords[2 * j] + fX,
+                      pCoords[2 * j + 1] * fScaleY + fY);
+      }
+    }
+  }
+
+  if (m_outlineThickness <= 0 || (m_outlineColor >> 24) == 0)
+    return;
+
+  // Contour extérieur calculé comme sf::Shape : chaque sommet est décalé le
+  // long de la bissectrice des normales de ses deux arêtes
+  m_vOutline.resize(2 * nCount);
+  for (uint32_t i = 0; i < nCount; i++) {
+    uint32_t iPrev = (i + nCount - 1) % nCount, iNext = (i + 1) % nCount;
+    float px = pCoords[2 * i], py = pCoords[2 * i + 1];
+    float n[2][2];
+    const uint32_t ends[2][2] = {{iPrev, i}, {i, iNext}};
+    for (int k = 0; k < 2; k++) {
+      float dx = pCoords[2 * ends[k][1]] - pCoords[2 * ends[k][0]];
+      float dy = pCoords[2 * ends[k][1] + 1] - pCoords[2 * ends[k][0] + 1];
+      float len = std::sqrt(dx * dx + dy * dy);
+      n[k][0] = len > 0 ? -dy / len : 0;
+      n[k][1] = len > 0 ? dx / len : 0;
+      // Normale orientée vers l'extérieur
+      if (n[k][0] * (cx - px) + n[k][1] * (cy - py) > 0) {
+        n[k][0] = -n[k][0];
+        n[k][1] = -n[k][1];
+      }
+    }
+    float factor = 1 + n[0][0] * n[1][0] + n[0][1] * n[1][1];
+    if (factor < 1e-3f)
+      factor = 1e-3f;
+    m_vOutline[2 * i] = px + (n[0][0] + n[1][0]) / factor * m_outlineThickness;
+    m_vOutline[2 * i + 1] =
+        py + (n[0][1] + n[1][1]) / factor * m_outlineThickness;
+  }
+
+  // Bande de triangles (sommet, sommet décalé) découpée en triangles
+  const uint32_t nMaxEdges = MAX_VERTICES / 6;
+  for (uint32_t i = 0; i < nCount;) {
+    uint32_t nEdges = std::min(nCount - i, nMaxEdges);
+    SVertex *p = Reserve(ProgramSolid, 0, GL_TRIANGLES, 6 * nEdges);
+    for (uint32_t k = 0; k < nEdges; k++, i++, p += 6) {
+      uint32_t j = (i + 1) % nCount;
+      float pix = pCoords[2 * i] + fX, piy = pCoords[2 * i + 1] * fScaleY + fY;
+      float pjx = pCoords[2 * j] + fX, pjy = pCoords[2 * j + 1] * fScaleY + fY;
+      float oix = m_vOutline[2 * i] + fX;
+      float oiy = m_vOutline[2 * i + 1] * fScaleY + fY;
+      float ojx = m_vOutline[2 * j] + fX;
+      float ojy = m_vOutline[2 * j + 1] * fScaleY + fY;
+      SetVertex(p, pix, piy, 0, 0, m_outlineColor);
+      SetVertex(p + 1, oix, oiy, 0, 0, m_outlineColor);
+      SetVertex(p + 2, pjx, pjy, 0, 0, m_outlineColor);
+      SetVertex(p + 3, oix, oiy, 0, 0, m_outlineColor);
+      SetVertex(p + 4, pjx, pjy, 0, 0, m_outlineColor);
+      SetVertex(p + 5, ojx, ojy, 0, 0, m_outlineColor);
+    }
+  }
+}
+
+void CLibGraph2GL::DrawLines(const float *pCoords, uint32_t nCount,
+                             ARGB color) {
+  if (nCount < 2)
+    return;
+  float fMinX = pCoords[0], fMaxX = pCoords[0];
+  float fMinY = pCoords[1], fMaxY = pCoords[1];
+  for (uint32_t i = 1; i < nCount; i++) {
+    fMinX = std::min(fMinX, pCoords[2 * i]);
+    fMaxX = std::max(fMaxX, pCoords[2 * i]);
+    fMinY = std::min(fMinY, pCoords[2 * i + 1]);
+    fMaxY = std::max(fMaxY, pCoords[2 * i + 1]);
+  }
+  if (Cull((color >> 24) != 0, fMinX, fMinY, fMaxX, fMaxY, 1))
+    return;
+
+  // Ligne brisée en segments indépendants, pour rester dans le même lot que
+  // les autres traits
+  const uint32_t nMaxSegments = MAX_VERTICES / 2;
+  for (uint32_t i = 1; i < nCount;) {
+    uint32_t nSegments = std::min(nCount - i, nMaxSegments);
+    SVertex *p = Reserve(ProgramSolid, 0, GL_LINES, 2 * nSegments);
+    for (uint32_t k = 0; k < nSegments; k++, i++, p += 2) {
+      SetVertex(p, pCoords[2 * i - 2], pCoords[2 * i - 1], 0, 0, color);
+      SetVertex(p + 1, pCoords[2 * i], pCoords[2 * i + 1], 0, 0, color);
+    }
+  }
+}
+
+bool CLibGraph2GL::Cull(bool bVisible, float fMinX, float fMinY, float fMaxX,
+                        float fMaxY, float fMargin) {
+  if (bVisible && !IsOutsideTarget(fMinX, fMinY, fMaxX, fMaxY, fMargin,
+                                   m_nWidth, m_nHeight))
+    return false;
+  m_stats.Render().nCulled++;
+  return true;
+}
+
+// Ressources du contexte
+
+const CLibGraph2GL::STexture *
+CLibGraph2GL::GetTexture(const std::string &filename) {
+  auto it = m_textures.find(filename);
+  if (it != m_textures.end()) {
+    m_stats.Render().nTextureCacheHits++;
+    return &it->second;
+  }
+  m_stats.Render().nTextureCacheMisses++;
+
+  // Les pixels décodés sont partagés par toutes les fenêtres, les textures
+  // appartiennent au contexte
+  const SImage *pImage = m_pResources->GetImage(filename);
+  if (!pImage || pImage->nWidth == 0)
+    return NULL;
+
+  CTraceScope trace("uploadTexture");
+  Activate();
+  Flush();
+  STexture texture = {0, pImage->nWidth, pImage->nHeight};
+  glGenTextures(1, &texture.nTexture);
+  glBindTexture(GL_TEXTURE_2D, texture.nTexture);
+  m_nBoundTexture = texture.nTexture;
+  // Plus proche voisin, comme une texture SFML non lissée. Répétée pour le
+  // pinceau texturé : sans effet sur les images, dont les coordonnées de
+  // texture restent dans [0, 1]
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pImage->nWidth, pImage->nHeight, 0,
+               GL_BGRA, GL_UNSIGNED_BYTE, pImage->vPixels.data());
+  m_stats.Render().nTextureUploads++;
+  m_nTextureBytes += 4ull * pImage->nWidth * pImage->nHeight;
+  return &m_textures.emplace(filename, texture).first->second;
+}
+
+bool CLibGraph2GL::GetAtlasGlyph(const void *pKey, int nWidth, int nHeight,
+                                 const uint8_t *pCoverage,
+                                 SAtlasGlyph &glyph) {
+  auto it = m_atlasGlyphs.find(pKey);
+  if (it != m_atlasGlyphs.end()) {
+    glyph = it->second;
+    return true;
+  }
+  if (nWidth > (int)ATLAS_SIZE || nHeight > (int)ATLAS_SIZE)
+    return false;
+
+  Activate();
+  if (!m_nAtlas) {
+    glGenTextures(1, &m_nAtlas);
+    glBindTexture(GL_TEXTURE_2D, m_nAtlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RED,
+                 GL_UNSIGNED_BYTE, NULL);
+    m_nTextureBytes += ATLAS_SIZE * ATLAS_SIZE;
+    ResetAtlas();
+  }
+
+  // Rangement par étagères, avec un pixel de marge entre les glyphes
+  if (m_nAtlasX + nWidth > ATLAS_SIZE) {
+    m_nAtlasX = 0;
+    m_nAtlasY += m_nAtlasRowHeight + 1;
+    m_nAtlasRowHeight = 0;
+  }
+  if (m_nAtlasY + nHeight > ATLAS_SIZE)
+    ResetAtlas();
+
+  glBindTexture(GL_TEXTURE_2D, m_nAtlas);
+  m_nBoundTexture = m_nAtlas;
+  glTexSubImage2D(GL_TEXTURE_2D, 0, m_nAtlasX, m_nAtlasY, nWidth, nHeight,
+                  GL_RED, GL_UNSIGNED_BYTE, pCoverage);
+  m_stats.Render().nTextureUploads++;
+
+  glyph.u = (float)m_nAtlasX / ATLAS_SIZE;
+  glyph.v = (float)m_nAtlasY / ATLAS_SIZE;
+  m_nAtlasX += nWidth + 1;
+  m_nAtlasRowHeight = std::max(m_nAtlasRowHeight, (unsigned)nHeight);
+  m_atlasGlyphs.emplace(pKey, glyph);
+  return true;
+}
+
+// Atlas plein : les glyphes sont rechargés au fil des besoins
+void CLibGraph2GL::ResetAtlas() {
+  // Le lot en cours utilise encore les anciens emplacements
+  Flush();
+  m_atlasGlyphs.clear();
+  m_nAtlasX = 0;
+  m_nAtlasY = 0;
+  m_nAtlasRowHeight = 0;
+}
+
+// Implémentation des fonctions publiques
+
+void CLibGraph2GL::show(const CSize &szWndSize, bool bFullScreen) {
+  CTraceScope trace("show");
+  int width, height;
+  SetNormalisedSize(szWndSize, width, height);
+
+  m_nWidth = width;
+  m_nHeight = height;
+  m_bShown = CreateContext(true, bFullScreen);
+  m_nFrames = 0;
+  ComputeScaleAndOffset();
+  if (m_bShown)
+    CmdClear(MakeARGB(255, 255, 255, 255));
+}
+
+void CLibGraph2GL::showOffscreen(const CSize &szSize, unsigned long nFrames) {
+  CTraceScope trace("showOffscreen");
+  int width, height;
+  SetNormalisedSize(szSize, width, height);
+
+  m_nWidth = width;
+  m_nHeight = height;
+  m_bShown = CreateContext(false, false);
+  m_nFrames = 0;
+  // Sans nombre d'images, celui de LIBGRAPH2_FRAMES est conservé
+  if (nFrames != 0)
+    m_nMaxFrames = nFrames;
+  ComputeScaleAndOffset();
+  if (m_bShown)
+    CmdClear(MakeARGB(255, 255, 255, 255));
+}
+
+void CLibGraph2GL::hide() {
+  CTraceScope trace("hide");
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pWindow)
+    m_pWindow->SetVisible(false);
+#endif
+}
+
+void CLibGraph2GL::endPaint() {
+  CTraceScope trace("endPaint");
+  m_bBackBuffered = false;
+  if (!m_bShown)
+    return;
+  {
+    CStatsScope scope(m_stats.App().dDisplayMs);
+    MergeRecorders();
+    Present();
+  }
+  m_stats.Render().nTextureBytes = m_nTextureBytes;
+  m_stats.Render().dGpuMs = m_gpuTimer.GetLastMs();
+  m_stats.EndRenderFrame();
+  m_stats.EndAppFrame();
+  m_overlay.AddFrame(m_frameTimes.OnEndPaint(), m_stats.Get());
+}
+
+void CLibGraph2GL::Present() {
+  CTraceScope trace("Present");
+  CStatsScope scope(m_stats.App().dDisplayMs);
+  m_stats.App().nDisplays++;
+  m_frameTimes.OnPresent();
+  CProbeClock probe;
+  CmdDisplay();
+  LIBGRAPH2_PROBE1(display, probe.ElapsedUs());
+  m_frameTimes.OnDisplayed();
+}
+
+void CLibGraph2GL::enableGpuTimer(bool bEnable) {
+  m_bGpuTimer = bEnable;
+  if (!m_pContext)
+    return; // Créé avec les objets du contexte
+  Activate();
+  if (bEnable && !m_gpuTimer.IsCreated())
+    m_gpuTimer.Create(&m_gl);
+  else if (!bEnable)
+    m_gpuTimer.Destroy();
+}
+
+void CLibGraph2GL::enableRenderThread(bool bEnable) {
+  // Une primitive coûte quelques écritures dans le tampon de sommets
+  // projeté : la déporter dans un thread de rendu ne ferait que recopier les
+  // commandes
+}
+
+// Lecture de l'image courante
+
+bool CLibGraph2GL::ReadFramebuffer(std::vector<ARGB> &vPixels) {
+  if (!m_bShown)
+    return false;
+  Activate();
+  Flush();
+  vPixels.resize((size_t)m_nWidth * m_nHeight);
+  // Lignes déjà de haut en bas (voir le vertex shader)
+  glReadPixels(0, 0, m_nWidth, m_nHeight, GL_BGRA, GL_UNSIGNED_BYTE,
+               vPixels.data());
+  return true;
+}
+
+bool CLibGraph2GL::saveFrame(const CString &sFileName) {
+  CTraceScope trace("saveFrame");
+  std::vector<ARGB> vPixels;
+  if (!ReadFramebuffer(vPixels))
+    return false;
+  return SaveImageFile(std::string(sFileName), m_nWidth, m_nHeight,
+                       vPixels.data());
+}
+
+bool CLibGraph2GL::getFramePixels(std::vector<ARGB> &vPixels,
+                                  unsigned &nWidth, unsigned &nHeight) {
+  CTraceScope trace("getFramePixels");
+  if (!ReadFramebuffer(vPixels))
+    return false;
+  nWidth = m_nWidth;
+  nHeight = m_nHeight;
+  return true;
+}
+
+// Sortie vidéo
+
+void CLibGraph2GL::CaptureVideoFrame() {
+  CTraceScope trace("CaptureVideoFrame");
+  if (!m_videoReadback.IsCreated() && m_gl.bPixelBuffers)
+    m_videoReadback.Create(&m_gl, 2);
+
+  if (!m_videoReadback.IsCreated()) {
+    // Pas de PBO : lecture synchrone
+    m_vVideoPixels.resize((size_t)m_nWidth * m_nHeight);
+    glReadPixels(0, 0, m_nWidth, m_nHeight, GL_BGRA, GL_UNSIGNED_BYTE,
+                 m_vVideoPixels.data());
+    SubmitCapturedFrame(m_vVideoPixels.data(), m_nWidth, m_nHeight);
+    return;
+  }
+
+  // Lance la lecture de cette image, puis transmet la précédente, dont la
+  // copie a eu le temps de se terminer pendant l'image écoulée
+  int nPrevious = m_nVideoSlot;
+  m_nVideoSlot = m_videoReadback.Issue(0, 0, m_nWidth, m_nHeight);
+  if (nPrevious >= 0) {
+    unsigned nPrevWidth, nPrevHeight;
+    if (const uint32_t *p =
+            m_videoReadback.Map(nPrevious, nPrevWidth, nPrevHeight))
+      SubmitCapturedFrame(p, nPrevWidth, nPrevHeight);
+    m_videoReadback.Unmap(nPrevious);
+  }
+}
+
+void CLibGraph2GL::SubmitCapturedFrame(const uint32_t *pPixels,
+                                       unsigned nWidth, unsigned nHeight) {
+  if (m_pVideo)
+    m_pVideo->SubmitFrame(pPixels, nWidth, nHeight, false);
+  if (m_pServer)
+    m_pServer->SubmitFrame(pPixels, nWidth, nHeight, false);
+}
+
+// Transmet la dernière image en attente et libère les PBO
+void CLibGraph2GL::FlushVideoFrame() {
+  if (!m_videoReadback.IsCreated())
+    return;
+  if (m_nVideoSlot >= 0) {
+    unsigned nWidth, nHeight;
+    if (const uint32_t *p = m_videoReadback.Map(m_nVideoSlot, nWidth, nHeight))
+      SubmitCapturedFrame(p, nWidth, nHeight);
+    m_videoReadback.Unmap(m_nVideoSlot);
+    m_nVideoSlot = -1;
+  }
+  m_videoReadback.Destroy();
+}
+
+void CLibGraph2GL::FlushCapture() {
+  if (m_pContext) {
+    Activate();
+    FlushVideoFrame();
+  }
+}
+
+// Lecture asynchrone
+
+void CLibGraph2GL::requestReadback(const CRectangle &rect,
+                                   const readback_callback &callback) {
+  CTraceScope trace("requestReadback");
+  if (!m_bShown) {
+    callback(NULL, 0, 0);
+    return;
+  }
+
+  m_vReadbackRequests.emplace_back(UnmapCoordinateX(rect.m_ptTopLeft.m_fX),
+                                   UnmapCoordinateY(rect.m_ptTopLeft.m_fY),
+                                   UnmapWidth(rect.m_szSize.m_fWidth),
+                                   UnmapHeight(rect.m_szSize.m_fHeight),
+                                   callback);
+}
+
+// Appelée à chaque affichage : termine les lectures dont la copie est
+// achevée, puis lance les nouvelles sur l'image qui va être affichée
+void CLibGraph2GL::ServiceReadbacks() {
+  CTraceScope trace("ServiceReadbacks");
+  std::vector<SReadback> vNew;
+  vNew.swap(m_vReadbackRequests);
+  if (vNew.empty() && m_vReadbacks.empty())
+    return;
+
+  if (m_readbackPool.IsCreated()) {
+    m_readbackPool.Tick();
+    size_t n = 0;
+    for (size_t i = 0; i < m_vReadbacks.size(); i++) {
+      if (m_readbackPool.IsReady(m_vReadbacks[i].nSlot))
+        CompleteReadback(m_vReadbacks[i]);
+      else if (i != n)
+        m_vReadbacks[n++] = std::move(m_vReadbacks[i]);
+      else
+        n++;
+    }
+    m_vReadbacks.resize(n);
+  } else if (m_gl.bPixelBuffers) {
+    m_readbackPool.Create(&m_gl, READBACK_POOL_SIZE);
+  }
+
+  for (size_t i = 0; i < vNew.size(); i++) {
+    SReadback &rb = vNew[i];
+    if (!rb.Clip(getPixelWidth(), getPixelHeight())) {
+      rb.callback(NULL, 0, 0);
+      continue;
+    }
+
+    // Les lignes du framebuffer sont dans l'ordre de l'image : aucun
+    // retournement
+    if (!m_readbackPool.IsCreated()) {
+      // Pas de PBO : lecture synchrone
+      m_vReadbackPixels.resize((size_t)rb.nWidth * rb.nHeight);
+      glReadPixels(rb.x, rb.y, rb.nWidth, rb.nHeight, GL_BGRA, GL_UNSIGNED_BYTE,
+                   m_vReadbackPixels.data());
+      rb.callback(m_vReadbackPixels.data(), rb.nWidth, rb.nHeight);
+      continue;
+    }
+
+    rb.nSlot = m_readbackPool.Issue(rb.x, rb.y, rb.nWidth, rb.nHeight);
+    if (rb.nSlot < 0) {
+      // Toutes les lectures du pool sont en cours : les demandes restantes
+      // porteront sur une image suivante
+      m_vReadbackRequests.insert(m_vReadbackRequests.begin(),
+                                 std::make_move_iterator(vNew.begin() + i),
+                                 std::make_move_iterator(vNew.end()));
+      break;
+    }
+    m_vReadbacks.push_back(std::move(rb));
+  }
+}
+
+void CLibGraph2GL::CompleteReadback(SReadback &rb) {
+  unsigned nWidth, nHeight;
+  if (const uint32_t *p = m_readbackPool.Map(rb.nSlot, nWidth, nHeight))
+    rb.callback(p, nWidth, nHeight);
+  else
+    rb.callback(NULL, 0, 0);
+  m_readbackPool.Unmap(rb.nSlot);
+}
+
+// Termine les lectures en cours (en attendant le GPU) et libère le pool. Les
+// demandes pas encore lancées restent en attente du prochain contexte
+void CLibGraph2GL::FlushReadbacks() {
+  for (SReadback &rb : m_vReadbacks)
+    CompleteReadback(rb);
+  m_vReadbacks.clear();
+  m_readbackPool.Destroy();
+}
+
+// Exécution des commandes
+
+void CLibGraph2GL::CmdSetTextureBrush(const std::string &filename) {
+  // Sans contexte, CreateObjects() appliquera le pinceau de l'application.
+  // Une image illisible laisse le pinceau uni
+  m_pBrushTexture = NULL;
+  if (!filename.empty() && m_pContext)
+    m_pBrushTexture = GetTexture(filename);
+}
+
+void CLibGraph2GL::CmdClear(ARGB color) {
+  Activate();
+  // Les primitives en attente seraient effacées : inutile de les dessiner
+  m_batch.nCount = 0;
+  glClearColor(GetR(color) / 255.0f, GetG(color) / 255.0f,
+               GetB(color) / 255.0f, GetA(color) / 255.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void CLibGraph2GL::CmdLine(const SCmdLine &c) {
+  // Comme sf::Lines, le trait fait toujours un pixel d'épaisseur
+  const float coords[4] = {c.x1, c.y1, c.x2, c.y2};
+  DrawLines(coords, 2, m_outlineColor);
+}
+
+void CLibGraph2GL::CmdRectangle(const SCmdRect &c) {
+  const float coords[8] = {c.x,       c.y,       c.x + c.w, c.y,
+                           c.x + c.w, c.y + c.h, c.x,       c.y + c.h};
+  DrawShape(coords, 4);
+}
+
+void CLibGraph2GL::CmdEllipse(const SCmdRect &c) {
+  // sf::CircleShape de 30 points, de rayon horizontal, étirée verticalement
+  const int nPoints = 30;
+  const float pi = 3.141592654f;
+  float radius = c.w / 2.0f;
+  if (radius == 0)
+    return;
+
+  float coords[2 * nPoints];
+  for (int i = 0; i < nPoints; i++) {
+    float angle = i * 2.f * pi / nPoints - pi / 2.f;
+    coords[2 * i] = radius + std::cos(angle) * radius;
+    coords[2 * i + 1] = radius + std::sin(angle) * radius;
+  }
+  DrawShape(coords, nPoints, c.x, c.y, (c.h / 2.0f) / radius);
+}
+
+void CLibGraph2GL::CmdPie(const SCmdPie &c) {
+  const int segments = 50;
+  if (Cull(IsFillVisible(), std::min(c.x, c.x + c.w),
+           std::min(c.y, c.y + c.h), std::max(c.x, c.x + c.w),
+           std::max(c.y, c.y + c.h), 0))
+    return;
+
+  float centerX = c.x + c.w / 2.0f;
+  float centerY = c.y + c.h / 2.0f;
+  float radiusX = c.w / 2.0f;
+  float radiusY = c.h / 2.0f;
+  float startRad = c.fStartAngle * M_PI / 180.0f;
+  float sweepRad = c.fSweepAngle * M_PI / 180.0f;
+
+  // Eventail depuis le centre, comme sf::TriangleFan
+  SVertex *p = ReserveFill(3 * segments);
+  float prevX = centerX + radiusX * cos(startRad);
+  float prevY = centerY + radiusY * sin(startRad);
+  for (int i = 1; i <= segments; i++, p += 3) {
+    float angle = startRad + (sweepRad * i / segments);
+    float x = centerX + radiusX * cos(angle);
+    float y = centerY + radiusY * sin(angle);
+    SetFillVertex(p, centerX, centerY);
+    SetFillVertex(p + 1, prevX, prevY);
+    SetFillVertex(p + 2, x, y);
+    prevX = x;
+    prevY = y;
+  }
+}
+
+void CLibGraph2GL::CmdPolyline(const float *pCoords, uint32_t nCount,
+                               bool bAutoClose) {
+  if (bAutoClose)
+    DrawShape(pCoords, nCount);
+  else
+    DrawLines(pCoords, nCount, m_outlineColor);
+}
+
+void CLibGraph2GL::CmdPixel(const SCmdPixel &c) {
+  if (Cull((c.color >> 24) != 0, c.x, c.y, c.x + 1, c.y + 1, 0))
+    return;
+  SVertex *p = Reserve(ProgramSolid, 0, GL_TRIANGLES, 6);
+  SetVertex(p, c.x, c.y, 0, 0, c.color);
+  SetVertex(p + 1, c.x + 1, c.y, 0, 0, c.color);
+  SetVertex(p + 2, c.x, c.y + 1, 0, 0, c.color);
+  SetVertex(p + 3, c.x + 1, c.y, 0, 0, c.color);
+  SetVertex(p + 4, c.x, c.y + 1, 0, 0, c.color);
+  SetVertex(p + 5, c.x + 1, c.y + 1, 0, 0, c.color);
+}
+
+void CLibGraph2GL::CmdString(const std::wstring &text, float x, float y) {
+  if (!m_pFont)
+    return;
+  // Le texte s'étend à droite et en dessous de la position, à l'italique
+  // près
+  if (Cull((m_fillColor >> 24) != 0, x, y, INFINITY, INFINITY, m_fontSize))
+    return;
+
+  unsigned nSize = (unsigned)m_fontSize;
+  float fLineSpacing = m_pFont->GetLineSpacing(nSize);
+  const float fTexel = 1.0f / ATLAS_SIZE;
+
+  // La ligne de base est à une hauteur de caractère sous la position,
+  // comme avec sf::Text. Les glyphes sont alignés sur les pixels : chaque
+  // fragment lit exactement un texel de l'atlas
+  float penX = x, baseline = y + nSize;
+  for (wchar_t ch : text) {
+    if (ch == L'\n') {
+      penX = x;
+      baseline += fLineSpacing;
+      continue;
+    }
+    const CFont::SGlyph &g = m_pFont->GetGlyph(ch, nSize, m_fontStyle);
+    SAtlasGlyph ag;
+    if (g.nWidth > 0 && g.nHeight > 0 &&
+        GetAtlasGlyph(&g, g.nWidth, g.nHeight, g.vCoverage.data(), ag)) {
+      float x0 = std::floor(penX + 0.5f) + g.nLeft;
+      float y0 = std::floor(baseline + 0.5f) - g.nTop;
+      float x1 = x0 + g.nWidth, y1 = y0 + g.nHeight;
+      float u1 = ag.u + g.nWidth * fTexel, v1 = ag.v + g.nHeight * fTexel;
+      SVertex *p = Reserve(ProgramText, m_nAtlas, GL_TRIANGLES, 6);
+      SetVertex(p, x0, y0, ag.u, ag.v, m_fillColor);
+      SetVertex(p + 1, x1, y0, u1, ag.v, m_fillColor);
+      SetVertex(p + 2, x0, y1, ag.u, v1, m_fillColor);
+      SetVertex(p + 3, x1, y0, u1, ag.v, m_fillColor);
+      SetVertex(p + 4, x0, y1, ag.u, v1, m_fillColor);
+      SetVertex(p + 5, x1, y1, u1, v1, m_fillColor);
+    }
+    penX += g.fAdvance;
+  }
+}
+
+void CLibGraph2GL::CmdBitmap(const std::string &filename,
+                             const SCmdBitmap &c) {
+  const STexture *pTexture = GetTexture(filename);
+  if (!pTexture)
+    return; // Erreur de chargement
+
+  float w = (float)pTexture->nWidth, h = (float)pTexture->nHeight;
+  float ox = 0, oy = 0;
+  if (c.origin == bitmap_origin::Center) {
+    ox = w / 2.0f;
+    oy = h / 2.0f;
+  } else if (c.origin == bitmap_origin::Pivot) {
+    ox = c.fPivotX;
+    oy = c.fPivotY;
+  }
+
+  // Même transformation que sf::Sprite : position + R(angle) * échelle *
+  // (point - origine)
+  float rad = c.fAngle * (float)M_PI / 180.0f;
+  float cs = std::cos(rad) * c.fScale, sn = std::sin(rad) * c.fScale;
+  const float corners[4][4] = {
+      {0, 0, 0, 0}, {w, 0, 1, 0}, {0, h, 0, 1}, {w, h, 1, 1}};
+  float pos[4][2];
+  for (int i = 0; i < 4; i++) {
+    float lx = corners[i][0] - ox, ly = corners[i][1] - oy;
+    pos[i][0] = c.x + lx * cs - ly * sn;
+    pos[i][1] = c.y + lx * sn + ly * cs;
+  }
+  float fMinX = pos[0][0], fMaxX = pos[0][0];
+  float fMinY = pos[0][1], fMaxY = pos[0][1];
+  for (int i = 1; i < 4; i++) {
+    fMinX = std::min(fMinX, pos[i][0]);
+    fMaxX = std::max(fMaxX, pos[i][0]);
+    fMinY = std::min(fMinY, pos[i][1]);
+    fMaxY = std::max(fMaxY, pos[i][1]);
+  }
+  if (Cull(true, fMinX, fMinY, fMaxX, fMaxY, 1))
+    return;
+
+  const int order[6] = {0, 1, 2, 1, 2, 3};
+  SVertex *p = Reserve(ProgramImage, pTexture->nTexture, GL_TRIANGLES, 6);
+  for (int i = 0; i < 6; i++)
+    SetVertex(p + i, pos[order[i]][0], pos[order[i]][1], corners[order[i]][2],
+              corners[order[i]][3], MakeARGB(255, 255, 255, 255));
+}
+
+void CLibGraph2GL::CmdDisplay() {
+  CTraceScope trace("CmdDisplay");
+  if (!m_pContext)
+    return;
+  Activate();
+  Flush();
+  m_gpuTimer.EndFrame();
+  if (m_pVideo || m_pServer)
+    CaptureVideoFrame();
+  ServiceReadbacks();
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pWindow) {
+    // La première ligne du framebuffer va en haut de la fenêtre
+    m_gl.BindFramebuffer(GL_READ_FRAMEBUFFER, m_nFramebuffer);
+    m_gl.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    m_gl.BlitFramebuffer(0, 0, m_nWidth, m_nHeight, 0, m_nHeight, m_nWidth, 0,
+                         GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    DrawOverlay();
+    {
+      CTraceScope swap("swapBuffers");
+      eglSwapBuffers(m_pContext->display, m_pContext->surface);
+    }
+    m_gl.BindFramebuffer(GL_FRAMEBUFFER, m_nFramebuffer);
+  }
+#endif
+}
+
+// Dessine la surimpression dans le framebuffer de la fenêtre, après la copie
+// de l'image : elle n'apparaît ni dans les captures ni dans les images
+// suivantes
+void CLibGraph2GL::DrawOverlay() {
+  if (!m_overlay.GetQuads(m_vOverlayQuads))
+    return;
+  CTraceScope trace("DrawOverlay");
+  if (!m_nOverlayTexture) {
+    glGenTextures(1, &m_nOverlayTexture);
+    glBindTexture(GL_TEXTURE_2D, m_nOverlayTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, CPerfOverlay::ATLAS_WIDTH,
+                 CPerfOverlay::ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE,
+                 CPerfOverlay::GetAtlas());
+    m_nBoundTexture = m_nOverlayTexture;
+  }
+
+  // Le framebuffer de la fenêtre a l'origine en bas
+  const float fU = 1.0f / CPerfOverlay::ATLAS_WIDTH;
+  const float fV = 1.0f / CPerfOverlay::ATLAS_HEIGHT;
+  const float fH = (float)m_nHeight;
+  SVertex *p = Reserve(ProgramText, m_nOverlayTexture, GL_TRIANGLES,
+                       6 * m_vOverlayQuads.size());
+  for (const CPerfOverlay::SQuad &q : m_vOverlayQuads) {
+    SetVertex(p++, q.x0, fH - q.y0, q.u0 * fU, q.v0 * fV, q.color);
+    SetVertex(p++, q.x1, fH - q.y0, q.u1 * fU, q.v0 * fV, q.color);
+    SetVertex(p++, q.x1, fH - q.y1, q.u1 * fU, q.v1 * fV, q.color);
+    SetVertex(p++, q.x0, fH - q.y0, q.u0 * fU, q.v0 * fV, q.color);
+    SetVertex(p++, q.x1, fH - q.y1, q.u1 * fU, q.v1 * fV, q.color);
+    SetVertex(p++, q.x0, fH - q.y1, q.u0 * fU, q.v1 * fV, q.color);
+  }
+  // Un seul appel, qui n'entre pas dans les compteurs affichés
+  SFrameStats counted = m_stats.Render();
+  Flush();
+  m_stats.Render() = counted;
+}
+
+// Événements
+
+bool CLibGraph2GL::waitForEvent(evt &e) {
+  CTraceScope trace("waitForEvent");
+  CFrameTimes::CEventScope frameTimes(m_frameTimes, e);
+  if (m_eventLog.IsReplaying())
+    return ReplayEvent(e);
+
+  if (!m_bShown)
+    return false;
+#ifdef LIBGRAPH2_HAVE_X11
+  if (m_pWindow && !m_pWindow->IsOpen())
+    return false;
+#endif
+
+  if (!PollEvent(e))
+    RefreshEvent(e);
+  m_eventLog.Record(e);
+  m_overlay.OnEvent(e);
+  return e.type != evt_type::evtClose;
+}
+
+bool CLibGraph2GL::PollEvent(evt &e) {
+  bool bFound = false;
+#ifdef LIBGRAPH2_HAVE_X11
+  bFound = m_pWindow && m_pWindow->PollEvent(e);
+#endif
+  // Les entrées des clients sont, comme celles de la fenêtre, en pixels
+  if (!bFound && !(m_pServer && m_pServer->PollEvent(e)))
+    return false;
+
+  switch (e.type) {
+  case evt_type::evtMouseMove:
+  case evt_type::evtMouseDown:
+  case evt_type::evtMouseUp:
+    e.x = (unsigned int)MapCoordinateX((float)e.x);
+    e.y = (unsigned int)MapCoordinateY((float)e.y);
+    break;
+  case evt_type::evtSize:
+    OnResize(e.x, e.y);
+    break;
+  default:
+    break;
+  }
+  m_lastEvent = e;
+  return true;
+}
+
+void CLibGraph2GL::RefreshEvent(evt &e) {
+  if (m_nMaxFrames != 0 && m_nFrames >= m_nMaxFrames) {
+    e.type = evt_type::evtClose;
+    m_bShown = false;
+  } else {
+    CmdClear(MakeARGB(255, 255, 255, 255));
+    e.type = evt_type::evtRefresh;
+    m_nFrames++;
+  }
+  m_lastEvent = e;
+}
+
+bool CLibGraph2GL::ReplayEvent(evt &e) {
+#ifdef LIBGRAPH2_HAVE_X11
+  // La fenêtre reste réactive mais les entrées réelles sont ignorées
+  evt ignored;
+  while (m_pWindow && m_pWindow->PollEvent(ignored))
+    ;
+#endif
+
+  if (!m_eventLog.Replay(e)) {
+    e.type = evt_type::evtClose;
+  } else if (m_bShown) {
+    if (e.type == evt_type::evtRefresh) {
+      CmdClear(MakeARGB(255, 255, 255, 255));
+    } else if (e.type == evt_type::evtSize) {
+#ifdef LIBGRAPH2_HAVE_X11
+      if (m_pWindow)
+        m_pWindow->SetSize(e.x, e.y);
+#endif
+      OnResize(e.x, e.y);
+    }
+  }
+
+  // Fin du journal ou fermeture enregistrée : la fenêtre n'est plus servie
+  // par WaitForAnyEvent()
+  if (e.type == evt_type::evtClose)
+    m_bShown = false;
+  m_lastEvent = e;
+  return e.type != evt_type::evtClose;
+}
+
+void CLibGraph2GL::OnResize(unsigned nWidth, unsigned nHeight) {
+  if (nWidth == 0 || nHeight == 0)
+    return;
+  Activate();
+  // Le contenu du framebuffer est perdu : le programme redessine à l'image
+  // suivante
+  Flush();
+  ResizeFramebuffer(nWidth, nHeight);
+  CmdClear(MakeARGB(255, 255, 255, 255));
+  ComputeScaleAndOffset();
+}
+
+#endif // LIBGRAPH2_USE_OPENGL
@@ -0,0 +1,267 @@
+// Copyright 2010-2024 Benjamin ALBOUY-KISSI - Ported to Linux
+/*
+    This file is part of LibGraph.
+
+    LibGraph is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibGraph is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LibGraph. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#ifdef LIBGRAPH2_USE_OPENGL
+
+#include "LibGraph2Front.h"
+#include "LibGraph2GL.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace LibGraph2;
+
+namespace LibGraph2 {
+class CX11Window;
+} // namespace LibGraph2
+
+/*
+ * Moteur de rendu OpenGL 3.3 (profil core), sans SFML.
+ *
+ * Le contexte est créé par EGL : dans une fenêtre X11 pour show(), sans
+ * surface du tout pour showOffscreen() (EGL_MESA_platform_surfaceless), ce
+ * qui permet de l'utiliser sans serveur graphique avec Mesa llvmpipe. Le
+ * dessin est toujours fait dans un framebuffer object, recopié dans la
+ * fenêtre à chaque affichage : le contenu persiste d'une image à l'autre
+ * comme avec le backbuffer du moteur SFML.
+ *
+ * Chaque primitive est décomposée en triangles (ou en segments pour les
+ * traits d'un pixel) sur le processeur, avec la même géométrie que les
+ * sf::Shape, et les sommets sont écrits directement dans un tampon projeté
+ * en mémoire (CStreamBuffer). Les primitives consécutives qui utilisent le
+ * même programme et la même texture sont regroupées en un seul
+ * glDrawArrays() : un changement de programme, de texture ou de type de
+ * primitive, un effacement ou un affichage soumet le lot en cours.
+ */
+class CLibGraph2GL final : public CLibGraph2Painter,
+                           public CWindowList<CLibGraph2GL> {
+private:
+  friend class CWindowList<CLibGraph2GL>;
+
+  // Fenêtre dont le contexte est actif
+  static CLibGraph2GL *s_pCurrent;
+
+  // Un programme par classe de primitive
+  enum gl_program {
+    ProgramSolid, // Couleur des sommets
+    ProgramImage, // Texture RGBA modulée par la couleur des sommets
+    ProgramText,  // Couverture des glyphes (R8) appliquée à la couleur
+    ProgramCount
+  };
+
+  // Format unique des sommets : position en pixels, coordonnées de texture
+  // normalisées, couleur ARGB lue comme GL_BGRA
+  struct SVertex {
+    float x, y;
+    float u, v;
+    uint32_t color;
+  };
+
+  // Primitives en attente de soumission
+  struct SBatch {
+    gl_program program;
+    GLuint nTexture;
+    GLenum nMode;
+    GLint nFirst;
+    GLsizei nCount;
+  };
+
+  // Texture d'une image chargée
+  struct STexture {
+    GLuint nTexture;
+    unsigned nWidth, nHeight;
+  };
+
+  // Emplacement d'un glyphe dans l'atlas
+  struct SAtlasGlyph {
+    float u, v;
+  };
+
+  struct SContext; // Objets EGL, définis dans libgraph2impGL.cpp
+
+  std::unique_ptr<SContext> m_pContext;
+  CX11Window *m_pWindow; // NULL hors écran
+  SGLFunctions m_gl;
+
+  // Objets OpenGL du contexte
+  GLuint m_programs[ProgramCount];
+  GLint m_nViewportLocations[ProgramCount];
+  GLuint m_nVertexArray;
+  CStreamBuffer m_vertices;
+  GLuint m_nFramebuffer;
+  GLuint m_nColorBuffer;
+  unsigned m_nWidth, m_nHeight;
+
+  // Lot en cours et programme lié
+  SBatch m_batch;
+  int m_nBoundProgram;
+  GLuint m_nBoundTexture;
+
+  // Textures des images, et atlas des glyphes rangés par étagères
+  std::map<std::string, STexture> m_textures;
+  GLuint m_nAtlas;
+  unsigned m_nAtlasX, m_nAtlasY, m_nAtlasRowHeight;
+  std::unordered_map<const void *, SAtlasGlyph> m_atlasGlyphs;
+  unsigned long long m_nTextureBytes; // Images et atlas, en octets
+  // Texture du pinceau texturé (dans m_textures), NULL pour un pinceau uni
+  const STexture *m_pBrushTexture;
+
+  // Atlas (R8) de la surimpression des performances, créé au premier
+  // affichage
+  GLuint m_nOverlayTexture;
+  std::vector<CPerfOverlay::SQuad> m_vOverlayQuads;
+
+  // Lecture PBO qui alimente la sortie vidéo et le serveur de diffusion,
+  // avec une image de retard
+  CReadbackRing m_videoReadback;
+  int m_nVideoSlot;
+  std::vector<uint32_t> m_vVideoPixels;
+
+  // Lectures demandées par requestReadback()
+  static const size_t READBACK_POOL_SIZE = 4;
+  std::vector<SReadback> m_vReadbackRequests; // Pas encore lancées
+  std::vector<SReadback> m_vReadbacks;        // En cours dans le pool
+  CReadbackRing m_readbackPool;
+  std::vector<uint32_t> m_vReadbackPixels;
+
+  // Minutage des lots par le GPU (enableGpuTimer()), recréé avec les objets
+  // du contexte
+  CGpuTimer m_gpuTimer;
+  bool m_bGpuTimer;
+
+  // Tampon de travail réutilisé
+  std::vector<float> m_vOutline;
+
+private:
+  CLibGraph2GL(void);
+  ~CLibGraph2GL(void);
+
+  int getPixelWidth() override { return (int)m_nWidth; }
+  int getPixelHeight() override { return (int)m_nHeight; }
+
+  // Contexte EGL et objets OpenGL
+  bool CreateContext(bool bWindowed, bool bFullScreen);
+  void DestroyContext();
+  bool CreateObjects();
+  void DestroyObjects();
+  bool ResizeFramebuffer(unsigned nWidth, unsigned nHeight);
+  // Rend le contexte de cette fenêtre actif, s'il ne l'est pas déjà
+  void Activate();
+
+  // Réserve n sommets (au plus MAX_VERTICES) pour le lot compatible avec le
+  // programme, la texture et le type de primitive, en soumettant le lot en
+  // cours si besoin
+  SVertex *Reserve(gl_program program, GLuint nTexture, GLenum nMode,
+                   size_t n);
+  // Soumet le lot en cours
+  void Flush();
+
+  // Géométrie des sf::Shape : intérieur en éventail depuis le centre de la
+  // boîte englobante, contour à l'extérieur, avec le pinceau et le crayon
+  // courants. Les points sont exprimés dans le repère de la forme, puis
+  // transformés par (x, y * fScaleY) + (fX, fY), contour compris
+  void DrawShape(const float *pCoords, uint32_t nCount, float fX = 0,
+                 float fY = 0, float fScaleY = 1);
+  // Segments d'un pixel d'épaisseur
+  void DrawLines(const float *pCoords, uint32_t nCount, ARGB color);
+  // Remplissage avec le pinceau courant : triangles du lot de sa couleur ou
+  // de sa texture, répétée depuis le coin du framebuffer
+  bool IsFillVisible() const {
+    return m_pBrushTexture || (m_fillColor >> 24) != 0;
+  }
+  SVertex *ReserveFill(size_t n);
+  void SetFillVertex(SVertex *p, float x, float y);
+
+  // Vrai si la primitive est invisible ou si sa boîte englobante, élargie
+  // de fMargin, est hors du framebuffer : elle est alors comptée comme
+  // éliminée
+  bool Cull(bool bVisible, float fMinX, float fMinY, float fMaxX, float fMaxY,
+            float fMargin);
+
+  // Ressources du contexte, créées au premier usage
+  const STexture *GetTexture(const std::string &strFileName);
+  bool GetAtlasGlyph(const void *pKey, int nWidth, int nHeight,
+                     const uint8_t *pCoverage, SAtlasGlyph &glyph);
+  void ResetAtlas();
+
+  // Lecture du framebuffer
+  bool ReadFramebuffer(std::vector<ARGB> &vPixels);
+  void CaptureVideoFrame();
+  void FlushVideoFrame();
+  void SubmitCapturedFrame(const uint32_t *pPixels, unsigned nWidth,
+                           unsigned nHeight);
+  void ServiceReadbacks();
+  void CompleteReadback(SReadback &rb);
+  void FlushReadbacks();
+
+  // Affiche le framebuffer (ou le transmet aux lectures hors écran)
+  void Present();
+  void DrawOverlay();
+  // Génère un rafraîchissement (ou la fermeture hors écran)
+  void RefreshEvent(evt &e);
+  bool PollEvent(evt &e);
+  bool ReplayEvent(evt &e);
+  void OnResize(unsigned nWidth, unsigned nHeight);
+
+  // Hors de beginPaint()/endPaint(), chaque dessin est affiché aussitôt
+  void OnImmediateDraw() override { Present(); }
+  // Transmet la dernière image lue avant de fermer la sortie
+  void FlushCapture() override;
+
+  // Exécution des commandes de dessin (coordonnées en pixels)
+  void CmdSetTextureBrush(const std::string &strFileName) override;
+  void CmdClear(ARGB color) override;
+  void CmdLine(const SCmdLine &c) override;
+  void CmdRectangle(const SCmdRect &c) override;
+  void CmdEllipse(const SCmdRect &c) override;
+  void CmdPie(const SCmdPie &c) override;
+  void CmdPixel(const SCmdPixel &c) override;
+  void CmdPolyline(const float *pCoords, uint32_t nCount,
+                   bool bAutoClose) override;
+  void CmdString(const std::wstring &text, float x, float y) override;
+  void CmdBitmap(const std::string &strFileName, const SCmdBitmap &c) override;
+  void CmdDisplay() override;
+
+public:
+  // Sommets par section du tampon de sommets
+  static const size_t MAX_VERTICES = 65536;
+
+  // Indique si un contexte OpenGL 3.3 core peut être créé (sans fenêtre)
+  static bool IsAvailable();
+
+  // Implémentation de ILibGraph2_Com
+  virtual void show(const CSize &szWndSize = CSize(), bool bFullScreen = false);
+  virtual void hide();
+  virtual void endPaint();
+  virtual void enableRenderThread(bool bEnable);
+  virtual void showOffscreen(const CSize &szSize = CSize(),
+                             unsigned long nFrames = 0);
+  virtual bool saveFrame(const CString &sFileName);
+  virtual void requestReadback(const CRectangle &rect,
+                               const readback_callback &callback);
+  virtual void enableGpuTimer(bool bEnable);
+  virtual bool getFramePixels(std::vector<ARGB> &vPixels, unsigned &nWidth,
+                              unsigned &nHeight);
+
+  // Fonctions avancées
+  virtual bool waitForEvent(evt &e);
+};
+
+#endif // LIBGRAPH2_USE_OPENGL